@@ -78,10 +78,14 @@ namespace eutelescope
     // PARAMETER NAMES USED IN THE HEADER IMPLEMENTATION
 
 	//! Parameter to store the telescope ROOT geometry file
+	/*! The contents of the environment variable EUTELESCOPE_GEOMETRY_SUFFIX,
+	 *  if set, are inserted before the extension.
+	 */
 	static const std::string GEOFILENAME;
 
 	//! Parameter to specify if dumping of the geo ROOT file is desired
 	static const bool DUMPGEOROOT;
+
     
 	//! Parameter key to store/recall the header version number
     static const char * HEADERVERSION;
@@ -96,6 +100,14 @@ namespace eutelescope
      */
     static const char * DATATYPE;
 
+    //! Parameter key of the number of in-place updates of a noise collection
+    /*! Incremented by the processors changing the noise values of a
+     *  conditions collection in place, e.g.
+     *  EUTelUpdatePedestalNoiseProcessor, so that quantities derived
+     *  from the noise can be cached until the noise changes.
+     */
+    static const char * NOISEUPDATECOUNT;
+
     //! Parameter key to store/recall the number of events in the file
     static const char * NOOFEVENT;
 
@@ -585,6 +597,25 @@ namespace eutelescope
    */
   std::ostream& operator<<(std::ostream& os, const ClusterQuality & quality);
 
+  //! Hit quality enum
+  /*! These bits are stored in the quality of the TrackerHits made
+   *  from clusters.
+   *
+   *  \li <b>kHotPixelChecked</b>: the pixels of the cluster have been
+   *  compared with the hot pixel database when the hit was made.
+   *
+   *  \li <b>kHotPixelHit</b>: at least one pixel of the cluster is in
+   *  the hot pixel database. It is meaningful only together with
+   *  kHotPixelChecked.
+   *
+   *  @see EUTelHotPixelMap
+   */
+  enum HitQuality {
+    kGoodHit         = 0,
+    kHotPixelChecked = 1L << 0,
+    kHotPixelHit     = 1L << 1
+  };
+
   //! Cluster type enum
   /*! This enum is used in the encoding of a TrackerPulse to describe
    *  which was the underlying class used for the description of the
@@ -31,9 +31,13 @@
 #endif
 
 // system includes <>
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #if defined(USE_ROOT) || defined(MARLIN_USE_ROOT)
 #include "TMinuit.h"
@@ -47,8 +51,6 @@ namespace eutelescope {
 
   public:
 
-    static void Chi2Function(Int_t &npar, Double_t *gin, Double_t &f, Double_t *par, Int_t iflag);
-
     //! Variables for hit parameters
     class HitsForFit {
     public:
@@ -65,6 +67,78 @@ namespace eutelescope {
       double secondLayerResolution;
     };
 
+    //! Hit pairs of the fit, one array per coordinate
+    /*! Only the coordinates entering the chi2 are kept. chi2() builds
+     *  the rotation matrix once per call and runs over the arrays in
+     *  blocks whose partial sums are vectorised; samples large enough
+     *  are split across the threads started by startThreads(). The
+     *  blocks and their order do not depend on the number of threads,
+     *  so neither does the result.
+     */
+    class FitData {
+    public:
+      FitData();
+
+      ~FitData();
+
+      void add(const HitsForFit& hits);
+
+      void clear();
+
+      std::size_t size() const { return _measuredX.size(); }
+
+      //! Start the threads chi2() uses, once per fit
+      /*! The number of threads follows from the number of hit pairs,
+       *  so no pairs must be added until stopThreads().
+       */
+      void startThreads();
+
+      //! Stop the threads, chi2() is then computed in the calling thread
+      void stopThreads();
+
+      //! The chi2 of the parameters off_x, off_y, theta_x, theta_y, theta_z, chi2 cut
+      double chi2(const double* par) const;
+
+      const std::vector<double>& getMeasuredX() const { return _measuredX; }
+      const std::vector<double>& getMeasuredY() const { return _measuredY; }
+      const std::vector<double>& getPredictedX() const { return _predictedX; }
+      const std::vector<double>& getPredictedY() const { return _predictedY; }
+
+    private:
+      FitData(const FitData&);
+      FitData& operator=(const FitData&);
+
+      //! Loop of the thread iThread, computes its blocks of every chi2() call
+      void work(std::size_t iThread);
+
+      std::vector<double> _measuredX;
+      std::vector<double> _measuredY;
+      std::vector<double> _predictedX;
+      std::vector<double> _predictedY;
+
+      //! Threads started by startThreads(), the calling thread is thread 0
+      std::vector<std::thread> _workers;
+
+      //! Guards the members below
+      mutable std::mutex _mutex;
+      mutable std::condition_variable _wake;
+      mutable std::condition_variable _done;
+
+      //! Rotation, offsets and cut of the current chi2() call
+      mutable double _task[7];
+
+      //! Partial sums of the blocks
+      mutable std::vector<double> _partial;
+
+      //! Counts the chi2() calls handed to the threads
+      mutable unsigned long _generation;
+
+      //! Threads still working on the current call
+      mutable std::size_t _pending;
+
+      bool _stop;
+    };
+
     class HitsInFirstBox {
     public:
       double measuredX;
@@ -136,7 +210,8 @@ namespace eutelescope {
 
   protected:
 
-    static std::vector<HitsForFit> _hitsForFit;
+    //! Hit pairs collected for the fit
+    FitData _fitData;
 
     //! TrackerHit collection name
     /*! Input collection with measured hits.
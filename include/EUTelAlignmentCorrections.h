@@ -0,0 +1,70 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELALIGNMENTCORRECTIONS_H
+#define EUTELALIGNMENTCORRECTIONS_H
+
+// system includes <>
+#include <map>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Alignment corrections summed over several alignment iterations
+  /*! Every iteration gives, per sensor, shifts and small rotations
+   *  (x, y, z, rotation x, y, z) in the local frame of the sensor at
+   *  that iteration. The local frame changes as the corrections are
+   *  applied, so the corrections are summed in the global frame and
+   *  transformed back into the local frame of the starting geometry,
+   *  the frame of the constants the pede path writes.
+   *
+   *  As in the rest of the alignment the rotations are transformed
+   *  like vectors, which holds for small angles only.
+   */
+  class EUTelAlignmentCorrections {
+
+  public:
+    EUTelAlignmentCorrections();
+
+    //! Remove all the corrections
+    void clear();
+
+    bool empty() const { return _sensors.empty(); }
+
+    //! The IDs of the sensors with corrections, in increasing order
+    std::vector<int> getSensorIDs() const;
+
+    //! Add the corrections of one iteration
+    /*! The rotation given with the first corrections of a sensor is
+     *  its starting frame.
+     *  @param rotation the local to global rotation of the sensor the
+     *  corrections were computed with, 3x3 row by row
+     *  @param local the six corrections in that local frame
+     *  @param global returns the six corrections in the global frame
+     */
+    void add(int sensorID, const double* rotation, const double* local, double* global);
+
+    //! The six summed corrections of a sensor in the global frame, zeros for an unknown sensor
+    void getGlobal(int sensorID, double* global) const;
+
+    //! The six summed corrections of a sensor in the local frame of its starting geometry
+    void getStartingLocal(int sensorID, double* local) const;
+
+  private:
+    struct Sensor {
+      //! Local to global rotation of the starting geometry, row by row
+      double startRotation[9];
+      //! Global frame sum of the corrections
+      double total[6];
+    };
+
+    std::map<int, Sensor> _sensors;
+  };
+
+}
+#endif
@@ -0,0 +1,90 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELALIGNMENTTRANSFORMS_H
+#define EUTELALIGNMENTTRANSFORMS_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Affine transforms of the hit positions of all the sensors
+  /*! Every sensor has at most one transform x' = R x + t, stored as
+   *  the upper 3x4 block of the 4x4 affine matrix and indexed directly
+   *  by the sensor ID. The transforms are computed once, from the
+   *  alignment constants or from the geometry, and then applied to all
+   *  the hits of an event together: the hits are grouped by sensor, so
+   *  that each transform runs over contiguous coordinate arrays in a
+   *  loop the compiler vectorises.
+   */
+  class EUTelAlignmentTransforms {
+
+  public:
+    EUTelAlignmentTransforms();
+
+    //! Remove all the transforms
+    void clear();
+
+    //! Set the transform of a sensor
+    /*! @param rotation the 3x3 matrix R, row by row
+     *  @param translation the vector t
+     */
+    void setTransform(int sensorID, const double* rotation, const double* translation);
+
+    bool hasTransform(int sensorID) const {
+      return sensorID >= 0 && static_cast<std::size_t>(sensorID) < _hasTransform.size() && _hasTransform[sensorID];
+    }
+
+    //! Transform the positions of @a nHits hits
+    /*! The position of hit i on sensor sensorID[i] is read from x[i],
+     *  y[i], z[i] and written into xOut[i], yOut[i], zOut[i]. The
+     *  positions of sensors without a transform are copied unchanged.
+     *  The output arrays must not overlap the input ones.
+     */
+    void apply(std::size_t nHits, const int* sensorID, const double* x, const double* y, const double* z,
+               double* xOut, double* yOut, double* zOut) const;
+
+    //! Rotate the covariance matrices of @a nHits hits, C' = R C R^T
+    /*! The matrices are stored as in TrackerHit::getCovMatrix, six
+     *  values per hit: (xx, yx, yy, zx, zy, zz). Those of sensors
+     *  without a transform are copied unchanged. The output array must
+     *  not overlap the input one.
+     */
+    void rotateCovariances(std::size_t nHits, const int* sensorID, const float* cov, float* covOut) const;
+
+    //! The matrix of a TVector3 rotated by angleX around X, then by angleY around Y and by angleZ around Z
+    /*! @param rotation the 3x3 matrix, row by row
+     */
+    static void eulerRotation(double angleX, double angleY, double angleZ, double* rotation);
+
+  private:
+    //! Sort the hit indices by sensor into _order, the end of every sensor in _offset
+    /*! The last slot collects the hits of the sensors without a
+     *  transform.
+     */
+    void groupBySensor(std::size_t nHits, const int* sensorID) const;
+
+    //! Rows of the affine matrix: (R00 R01 R02 t0) (R10 R11 R12 t1) (R20 R21 R22 t2)
+    struct Transform {
+      double m[12];
+    };
+
+    std::vector<Transform> _transforms;
+    std::vector<char> _hasTransform;
+
+    //! Scratch buffers of apply(), the hits grouped by sensor
+    mutable std::vector<std::size_t> _offset;
+    mutable std::vector<std::size_t> _order;
+    mutable std::vector<double> _in;
+    mutable std::vector<double> _out;
+  };
+
+}
+#endif
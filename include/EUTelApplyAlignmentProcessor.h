@@ -13,6 +13,7 @@
 
 // eutelescope includes ".h"
 #include "EUTelAlignmentConstant.h"
+#include "EUTelAlignmentTransforms.h"
 #include "EUTelEventImpl.h"
 #include "EUTelReferenceHit.h"
 #include "EUTelExceptions.h"
@@ -54,9 +55,12 @@
 #include <IMPL/TrackImpl.h>
 
 // system includes <>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <map>
+#include <utility>
 #include <vector>
 
 
@@ -221,6 +225,62 @@ namespace eutelescope {
     virtual void CheckIOCollections(LCEvent* event);
 
   private:
+    //! The hit transformation done by an alignment step
+    enum StepKind { kDirectStep, kReverseStep, kGearStep };
+
+    //! Transforms of all the sensors for one alignment step
+    /*! The transforms of a Direct or Reverse step are compiled from
+     *  the alignment constant and reference hit collections and
+     *  compiled again only if these collections or their values
+     *  change; the GEAR transforms are compiled sensor by sensor on
+     *  their first hit. All of them are compiled again at every run.
+     */
+    struct AlignmentStep {
+      AlignmentStep(): transforms(), reference(), alignmentCollection(NULL), referenceHitCollection(NULL),
+                       alignmentHash(0), referenceHitHash(0), compiled(false) {}
+      EUTelAlignmentTransforms transforms;
+      //! Reference hit position of every sensor, three values per sensor ID
+      std::vector< double > reference;
+      //! The collections the transforms were compiled from
+      LCCollectionVec* alignmentCollection;
+      LCCollectionVec* referenceHitCollection;
+      //! Hash of the values of these collections, see genericObjectHash()
+      uint64_t alignmentHash;
+      uint64_t referenceHitHash;
+      bool compiled;
+
+      //! The reference hit position of a sensor, the origin if unknown
+      const double* getReference(int sensorID) const {
+        static const double origin[3] = { 0., 0., 0. };
+        if ( sensorID < 0 || 3 * static_cast< std::size_t >( sensorID ) >= reference.size() ) return origin;
+        return &reference[ 3 * sensorID ];
+      }
+    };
+
+    //! The step for the current alignment collection, compiled if needed
+    AlignmentStep& getAlignmentStep(StepKind kind);
+
+    //! Hash of the values of a collection of LCGenericObjects, 0 for none
+    /*! Alignment constant and reference hit collections hold a few
+     *  numbers per sensor, hashing them every event is cheap and
+     *  detects a collection replaced at the same address or changed
+     *  in place.
+     */
+    static uint64_t genericObjectHash(LCCollectionVec* collection);
+
+    //! Compile the Direct or Reverse transform of a sensor
+    /*! @a alignment and @a refhit may be null if the sensor has no
+     *  alignment constant or reference hit.
+     */
+    void setSensorTransform(StepKind kind, int sensorID, EUTelAlignmentConstant* alignment, EUTelReferenceHit* refhit,
+                            AlignmentStep& step);
+
+    //! Compile the GEAR transform of a sensor
+    void setGearTransform(int sensorID, AlignmentStep& step);
+
+    //! Transform all the input hits into _alignedX, _alignedY and _alignedZ
+    void alignHits(StepKind kind, AlignmentStep& step);
+
     //! Conversion ID map.
     /*! In the data file, each cluster is tagged with a detector ID
      *  identify the sensor it belongs to. In the geometry
@@ -420,6 +480,24 @@ namespace eutelescope {
      */
     bool _histogramSwitch;
 
+    //! The compiled alignment steps, by kind and alignment collection name
+    std::map< std::pair< int, std::string >, AlignmentStep > _alignmentSteps;
+
+    //! Sensor ID and position of the input hits of the current step
+    std::vector< int > _hitSensorID;
+    std::vector< double > _hitX;
+    std::vector< double > _hitY;
+    std::vector< double > _hitZ;
+
+    //! The transformed positions of the input hits
+    std::vector< double > _alignedX;
+    std::vector< double > _alignedY;
+    std::vector< double > _alignedZ;
+
+    //! Number of hits transformed and time spent, for the rate printed at the end
+    uint64_t _nHitsAligned;
+    double _alignTime;
+
   };
 
   //! A global instance of the processor
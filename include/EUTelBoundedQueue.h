@@ -0,0 +1,130 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELBOUNDEDQUEUE_H
+#define EUTELBOUNDEDQUEUE_H
+
+// system includes <>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace eutelescope {
+
+  //! Occupancy and stall counters of an EUTelBoundedQueue
+  struct EUTelQueueStatistics {
+    //! Number of elements pushed
+    uint64_t nPushed;
+    //! Number of times a push had to wait because the queue was full
+    uint64_t nProducerStalls;
+    //! Number of times a pop had to wait because the queue was empty
+    uint64_t nConsumerStalls;
+    //! Sum of the queue depth seen by every pop, for the average depth
+    uint64_t sumDepth;
+    //! Largest queue depth
+    std::size_t maxDepth;
+
+    EUTelQueueStatistics(): nPushed(0), nProducerStalls(0), nConsumerStalls(0), sumDepth(0), maxDepth(0) {}
+
+    double getAverageDepth() const { return nPushed > 0 ? static_cast<double>(sumDepth) / nPushed : 0.; }
+  };
+
+  //! Blocking first in, first out queue with a maximum depth
+  /*! Connects a producer and a consumer thread of a processing
+   *  pipeline. push() waits while the queue is full and pop() waits
+   *  while it is empty, so that the producer can run at most @a
+   *  capacity elements ahead of the consumer. After close() no more
+   *  elements are accepted and pop() returns false once the queue has
+   *  been drained, which ends the consumer loop.
+   *
+   *  Every wait is counted: a consumer stall means that the consumer
+   *  was faster than the producer, a producer stall the opposite.
+   */
+  template<class T>
+  class EUTelBoundedQueue {
+
+  public:
+    explicit EUTelBoundedQueue(std::size_t capacity):
+      _capacity(capacity > 0 ? capacity : 1),
+      _closed(false),
+      _queue(),
+      _mutex(),
+      _notFull(),
+      _notEmpty(),
+      _statistics()
+    {}
+
+    //! Append an element, returns false if the queue has been closed
+    bool push(T element) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if ( !_closed && _queue.size() >= _capacity ) {
+        ++_statistics.nProducerStalls;
+        _notFull.wait(lock, [this] { return _closed || _queue.size() < _capacity; });
+      }
+      if ( _closed ) return false;
+      _queue.push_back(std::move(element));
+      ++_statistics.nPushed;
+      if ( _queue.size() > _statistics.maxDepth ) _statistics.maxDepth = _queue.size();
+      lock.unlock();
+      _notEmpty.notify_one();
+      return true;
+    }
+
+    //! Take the oldest element, returns false if the queue is closed and empty
+    bool pop(T& element) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if ( _queue.empty() && !_closed ) {
+        ++_statistics.nConsumerStalls;
+        _notEmpty.wait(lock, [this] { return _closed || !_queue.empty(); });
+      }
+      if ( _queue.empty() ) return false;
+      _statistics.sumDepth += _queue.size();
+      element = std::move(_queue.front());
+      _queue.pop_front();
+      lock.unlock();
+      _notFull.notify_one();
+      return true;
+    }
+
+    //! Stop accepting elements and wake up all the waiting threads
+    /*! The elements already in the queue can still be popped.
+     */
+    void close() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+      }
+      _notFull.notify_all();
+      _notEmpty.notify_all();
+    }
+
+    EUTelQueueStatistics getStatistics() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _statistics;
+    }
+
+    std::size_t getCapacity() const { return _capacity; }
+
+  private:
+    EUTelBoundedQueue(const EUTelBoundedQueue&) = delete;
+    EUTelBoundedQueue& operator=(const EUTelBoundedQueue&) = delete;
+
+    const std::size_t _capacity;
+    bool _closed;
+    std::deque<T> _queue;
+    mutable std::mutex _mutex;
+    std::condition_variable _notFull;
+    std::condition_variable _notEmpty;
+    EUTelQueueStatistics _statistics;
+  };
+
+}
+#endif
@@ -10,6 +10,7 @@
 #define EUTELCLUSTERFILTER_H 1
 
 // eutelescope includes ".h"
+#include "EUTelClusterSummary.h"
 #include "EUTelROI.h"
 
 // marlin includes ".h"
@@ -25,8 +26,6 @@
 
 namespace eutelescope {
 
-  class EUTelVirtualCluster;
-
   //! Cluster filter
   /*! This processor is used during the analysis chain to perform a
    *  further filtering on the available clusters. The main advantage
@@ -346,7 +345,7 @@ namespace eutelescope {
      *  @return True if the @c cluster has a charge below its own threshold.
      *
      */
-    bool isAboveMinTotalCharge(EUTelVirtualCluster * cluster) const ;
+    bool isAboveMinTotalCharge(const EUTelClusterSummary& cluster) const ;
 
 
     //! Check if the total cluster SNR is above a certain value
@@ -358,7 +357,7 @@ namespace eutelescope {
      *  @return True if the @c cluster has a SNR below its own
      *  threshold.
      */
-    bool isAboveMinTotalSNR(EUTelVirtualCluster * cluster) const;
+    bool isAboveMinTotalSNR(const EUTelClusterSummary& cluster) const;
 
     //! Check if the total cluster charge is below a certain value
     /*! This is used to select clusters having a total integrated
@@ -369,7 +368,7 @@ namespace eutelescope {
      *  @return True if the @c cluster has a charge below its own threshold.
      *
      */
-    bool isBelowMaxTotalCharge(EUTelVirtualCluster * /* cluster */ ) const { return true; }
+    bool isBelowMaxTotalCharge(const EUTelClusterSummary& /* cluster */ ) const { return true; }
 
 
     //! Check if the total cluster charge is above a certain value
@@ -381,7 +380,7 @@ namespace eutelescope {
      *  @param cluster The cluster under test.
      *
      */
-    bool isAboveNumberOfHitPixel(EUTelVirtualCluster * cluster) const;
+    bool isAboveNumberOfHitPixel(const EUTelClusterSummary& cluster) const;
 
 
     //! Check against the charge collected by N pixels
@@ -396,7 +395,7 @@ namespace eutelescope {
      *  @return True if the charge is above threshold
      *  @param cluster The cluster under test.
      */
-    bool isAboveNMinCharge(EUTelVirtualCluster * cluster) const;
+    bool isAboveNMinCharge(const EUTelClusterSummary& cluster) const;
 
     //! Check against the SNR of the N most significant pixels
     /*! The SNR of the cluster made by the first N significant pixels
@@ -409,7 +408,7 @@ namespace eutelescope {
      *  @return True if the SNR is above threshold
      *  @param cluster The cluster under test.
      */
-    bool isAboveNMinSNR(EUTelVirtualCluster * cluster) const;
+    bool isAboveNMinSNR(const EUTelClusterSummary& cluster) const;
 
     //! Check against the charge collected by N x N pixels
     /*! This cut is working on the charge collected by a subframe N x
@@ -418,7 +417,7 @@ namespace eutelescope {
      *  @param cluster The cluster under test.
      *  @return True if the charge is above threshold.
      */
-    bool isAboveNxNMinCharge(EUTelVirtualCluster * cluster) const;
+    bool isAboveNxNMinCharge(const EUTelClusterSummary& cluster) const;
 
     //! Check against the SNR collected by N x N pixels
     /*! This cut is working on the SNR collected by a subframe N x
@@ -427,7 +426,7 @@ namespace eutelescope {
      *  @param cluster The cluster under test.
      *  @return True if the SNR is above threshold.
      */
-    bool isAboveNxNMinSNR(EUTelVirtualCluster * cluster) const;
+    bool isAboveNxNMinSNR(const EUTelClusterSummary& cluster) const;
 
     //! Seed pixel cut
     /*! This is used to select clusters having a seed pixel charge
@@ -436,7 +435,7 @@ namespace eutelescope {
      *  @return True if the seed pixel charge is above threshold
      *  @param cluster The cluster under test.
      */
-    bool isAboveMinSeedCharge(EUTelVirtualCluster * cluster) const;
+    bool isAboveMinSeedCharge(const EUTelClusterSummary& cluster) const;
 
     //! Seed SNR cut
     /*! This is used to select clusters having a seed pixel SNR above
@@ -445,7 +444,7 @@ namespace eutelescope {
      *  @return True if the seed SNR is above threshold
      *  @param cluster The cluster under test.
      */
-    bool isAboveMinSeedSNR(EUTelVirtualCluster * cluster) const;
+    bool isAboveMinSeedSNR(const EUTelClusterSummary& cluster) const;
 
     //! Quality cut
     /*! This is a selection cut based on the cluster quality. Only
@@ -458,7 +457,7 @@ namespace eutelescope {
      *  @return True if the quality is correct
      *  @param cluster The cluster under test.
      */
-    bool hasQuality(EUTelVirtualCluster * cluster) const;
+    bool hasQuality(const EUTelClusterSummary& cluster) const;
 
     //! Same number of hits
     /*! This selection criterion can be used to select events in which
@@ -503,7 +502,7 @@ namespace eutelescope {
      *  @param cluster The cluster under test.
      *
      */
-    bool isInsideROI(EUTelVirtualCluster * cluster) const;
+    bool isInsideROI(const EUTelClusterSummary& cluster) const;
 
     //! Outside the ROI
     /*! This selection criterion can be used to get only clusters
@@ -513,7 +512,7 @@ namespace eutelescope {
      *  @param cluster The cluster under test.
      *
      */
-    bool isOutsideROI(EUTelVirtualCluster * cluster) const;
+    bool isOutsideROI(const EUTelClusterSummary& cluster) const;
 
     //! Below the maximum cluster noise
     /*! This selection criterion is based on the full cluster noise.
@@ -522,7 +521,7 @@ namespace eutelescope {
      *  allowed.
      *  @param cluster The cluster under test
      */
-    bool isBelowMaxClusterNoise(EUTelVirtualCluster * cluster) const;
+    bool isBelowMaxClusterNoise(const EUTelClusterSummary& cluster) const;
 
     //! Print the rejection summary
     /*! To better understand which cut is more important, a rejection
@@ -866,6 +865,13 @@ namespace eutelescope {
 
     //digital fixed frame cuts
     std::vector<int> _DFFNHitsCuts;
+
+    //! Derived quantities of the cluster under test
+    /*! Filled once per cluster and passed to all the criteria, so
+     *  that the cost of a cluster does not grow with the number of
+     *  criteria switched on.
+     */
+    EUTelClusterSummary _clusterSummary;
   public:
 
     //! Helper predicate class
@@ -0,0 +1,135 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELCLUSTERPOSITIONBATCH_H
+#define EUTELCLUSTERPOSITIONBATCH_H
+
+// system includes <>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace eutelescope {
+
+  //! Dense lookup table for an Eta function
+  /*! The Eta function stored in EUTelEtaFunctionImpl is a set of
+   *  (bin center, eta value) pairs which are evaluated with a binary
+   *  search and a linear interpolation for every single cluster. This
+   *  class resamples the function once on a uniform grid so that the
+   *  evaluation reduces to an index computation and one linear
+   *  interpolation without any branch. The batch version of eval() is
+   *  written as a plain loop over contiguous arrays and is meant to be
+   *  auto-vectorised by the compiler.
+   *
+   *  Outside the range of the original bin centers the first and the
+   *  last eta values are returned, as EUTelEtaFunctionImpl::getEtaFromCoG
+   *  does.
+   */
+  class EUTelEtaLookupTable {
+
+  public:
+    EUTelEtaLookupTable();
+
+    //! Build the table
+    /*! @param centers The bin centers of the eta function, sorted.
+     *  @param values The corresponding eta values.
+     *  @param nSamples Number of equidistant samples in the table.
+     */
+    void build(const std::vector<double>& centers, const std::vector<double>& values, unsigned int nSamples);
+
+    //! Table has been built
+    bool isValid() const { return _table.size() > 1; }
+
+    //! Eta value for a single CoG shift
+    float eval(float x) const;
+
+    //! Eta values for @a n CoG shifts
+    void eval(const float* x, float* out, std::size_t n) const;
+
+  private:
+    std::vector<float> _table;
+    float _xMin;
+    float _xMax;
+    float _invStep;
+  };
+
+  //! Struct-of-arrays container for the clusters of one plane
+  /*! All pixels of all clusters are stored in three contiguous
+   *  arrays: x, y (in pixel index units) and charge. The pixels of
+   *  cluster @a i are in the range [offset(i), offset(i+1)).
+   */
+  class EUTelClusterBatch {
+
+  public:
+    EUTelClusterBatch();
+
+    void clear();
+    void reserve(std::size_t nClusters, std::size_t nPixels);
+
+    //! Start a new cluster, subsequent addPixel() calls belong to it
+    void beginCluster();
+
+    void addPixel(float x, float y, float q) {
+      _x.push_back(x);
+      _y.push_back(y);
+      _q.push_back(q);
+      ++_offsets.back();
+    }
+
+    std::size_t size() const { return _offsets.size() - 1; }
+    std::size_t getNoOfPixels() const { return _x.size(); }
+
+    const float* x() const { return _x.empty() ? 0 : &_x[0]; }
+    const float* y() const { return _y.empty() ? 0 : &_y[0]; }
+    const float* q() const { return _q.empty() ? 0 : &_q[0]; }
+    const uint32_t* offsets() const { return &_offsets[0]; }
+
+  private:
+    std::vector<float> _x;
+    std::vector<float> _y;
+    std::vector<float> _q;
+    std::vector<uint32_t> _offsets;
+  };
+
+  //! Batch kernels for the cluster position reconstruction
+  /*! All output arrays must hold at least batch.size() elements.
+   *  Positions are returned in pixel index units, as
+   *  EUTelVirtualCluster::getCenterOfGravity does.
+   */
+  namespace ClusterPosition {
+
+    //! Coordinates of the pixel with the highest charge
+    void seed(const EUTelClusterBatch& batch, float* xSeed, float* ySeed);
+
+    //! Charge weighted center of gravity over all pixels
+    void centerOfGravity(const EUTelClusterBatch& batch, float* xCoG, float* yCoG);
+
+    //! Center of gravity restricted to a nx x ny window around the seed
+    /*! @a xSeed and @a ySeed are the output of seed(). Even window
+     *  sizes are rounded up to the next odd number. Pixels outside
+     *  the window are masked rather than skipped to keep the inner
+     *  loop free of branches.
+     */
+    void centerOfGravityNxM(const EUTelClusterBatch& batch, int nx, int ny, const float* xSeed, const float* ySeed,
+                            float* xCoG, float* yCoG);
+
+    //! Center of gravity of the @a n most significant pixels
+    /*! Pixels with the same charge as the n-th one are all included.
+     */
+    void centerOfGravityNPixel(const EUTelClusterBatch& batch, int n, float* xCoG, float* yCoG);
+
+    //! Eta correction
+    /*! pos[i] = seed[i] + eta( cog[i] - seed[i] ) for @a n clusters.
+     *  @a work is a scratch buffer of at least @a n elements.
+     */
+    void applyEta(const EUTelEtaLookupTable& eta, const float* seed, const float* cog, float* pos, float* work, std::size_t n);
+
+  }
+
+}
+#endif
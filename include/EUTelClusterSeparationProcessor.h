@@ -10,6 +10,8 @@
 #define EUTELCLUSTERSEPARATIONPROCESSOR_H 1
 
 // eutelescope includes ".h" 
+#include "EUTelVirtualCluster.h"
+#include "EUTelMergingGroups.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -18,9 +20,10 @@
 #include <IMPL/LCCollectionVec.h>
 
 // system includes <>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
-#include <set>
 
 namespace eutelescope {
 
@@ -121,10 +124,12 @@ namespace eutelescope {
     /*! This is called for each event in the file. As a first thing,
      *  the system will check among all clusters found in the current
      *  event there are pairs of merging clusters on the same
-     *  detector. If at least one pair of merging cluster is found,
-     *  then the groupingMergingPairs(std::vector< pair<int, int> >,
-     *  vector< set<int > > *) is called; otherwise it returns
-     *  immediately.
+     *  detector. The clusters of a detector are sorted along x and
+     *  each one is compared only with the following ones closer than
+     *  the minimum distance along x. If at least one pair of merging
+     *  cluster is found, then the groups are collected by
+     *  groupingMergingClusters(std::vector< std::vector<int > > *) and
+     *  separated; otherwise the input is copied to the output.
      *
      *  @param evt the current LCEvent event as passed by the
      *  ProcessMgr
@@ -155,41 +160,34 @@ namespace eutelescope {
     /*! This is the method where the real separation algorithm is
      *  written/called. 
      *
-     *  @param setVector A STL vector of STL set containing the
-     *  cluster of clusters to be separated.
+     *  @param groupVector A STL vector of groups, each one the
+     *  ordered indices of a cluster of clusters to be separated.
+     *
      *
      *  @param inputCollectionVec A pointer to the input cluster collection
      *  @param outputCollectionVec A pointer to the output cluster collection
      *
      *  @return true if the algorithm was successfully applied.
      */ 
-    bool applySeparationAlgorithm(std::vector< std::set< int > > setVector, 
+    bool applySeparationAlgorithm(const std::vector< std::vector< int > >& groupVector, 
 				  LCCollectionVec * inputCollectionVec,
 				  LCCollectionVec * outputCollectionVec) const ;
 
-    //! Groups together pairs of merging clusters.
+    //! Groups together merging clusters.
     /*! The identification of merging clusters can very easily done on
-     *  a pair basis. It means that after a double loop on clusters, a
-     *  collection of pairs of merging clusters is available. To be
-     *  more general, one should consider the possibility of having
-     *  groups of merging clusters, a sort of cluster of
-     *  clusters. This groupingMergingPairs method is exactly doing
-     *  this, looking if there are pairs of merging clusters that can
-     *  be grouped into a cluster of clusters.
-     *  
-     *  Of course this method is called if, and only if, at least a
-     *  pair merging clusters have been found
-     *
-     *  @param pairVector A STL vector of STL pairs. For each pairs,
-     *  the two integers represent the cluster indices within the
-     *  clusterCollection
+     *  a pair basis. To be more general, one should consider the
+     *  possibility of having groups of merging clusters, a sort of
+     *  cluster of clusters. Every merging pair found is joined in an
+     *  EUTelMergingGroups, and this method reads the groups out of
+     *  it: two clusters are in the same group if a chain of merging
+     *  pairs links them.
      *
-     *  @param setVector A pointer to a STL vector of STL set. Each
-     *  set has to be considered as the cluster of clusters defined
-     *  above and the int value_type of the set represents the cluster
-     *  index in the clusterCollection
+     *  @param groupVector A pointer to a STL vector of groups. Each
+     *  group lists the cluster indices within the clusterCollection in
+     *  increasing order, the groups are ordered by their first
+     *  cluster. Clusters not merging with any other are left out.
      */ 
-    void groupingMergingPairs(std::vector< std::pair<int , int> > pairVector, std::vector< std::set< int > > * setVector) const;
+    void groupingMergingClusters(std::vector< std::vector< int > > * groupVector) ;
 
   protected:
 
@@ -229,6 +227,26 @@ namespace eutelescope {
      */
     int _iEvt;
 
+  private:
+
+    //! The clusters of the current event.
+    /*! One per pulse of the input collection, built once per event
+     *  instead of once per compared pair.
+     */
+    std::vector< std::unique_ptr< EUTelVirtualCluster > > _clusters;
+
+    //! Merging groups of the clusters of the current event.
+    EUTelMergingGroups _mergingGroups;
+
+    //! Center x coordinate and index of the clusters of a detector.
+    /*! Sorted along x, so that a cluster is only compared with the
+     *  following ones closer than the minimum distance along x.
+     */
+    std::vector< std::pair< int, int > > _sweepOrder;
+
+    //! Groups of merging clusters of the current event.
+    std::vector< std::vector< int > > _groupVector;
+
   };
 
   //! A global instance of the processor
@@ -0,0 +1,153 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELCLUSTERSUMMARY_H
+#define EUTELCLUSTERSUMMARY_H
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelVirtualCluster.h"
+
+// system includes <>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Derived quantities of a cluster computed once
+  /*! Every getClusterCharge(n) or getClusterSNR(n) of a cluster
+   *  implementation copies and sorts or scans the pixels again, so a
+   *  processor asking a dozen of them for each cluster pays the sort a
+   *  dozen times. The summary reads the pixels of a cluster once, ranks
+   *  them by signal and keeps the prefix sums, and caches the sub
+   *  cluster sums on the first request. It answers with the same
+   *  methods and, summing in the same order, the same values as the
+   *  cluster it was filled from.
+   *
+   *  Fixed frame (EUTelFFClusterImpl, EUTelDFFClusterImpl) and
+   *  EUTelSparseClusterImpl<EUTelGenericSparsePixel> clusters are
+   *  summarised; for the other types, like EUTelBrickedClusterImpl,
+   *  whose sub clusters are not rectangles, every call is passed to the
+   *  cluster itself.
+   *
+   *  The noise values are read from the cluster by fill(); if they are
+   *  set later, updateNoise() reads them again. The summary does not
+   *  own the cluster and is meant to be filled again for the next one,
+   *  reusing its buffers.
+   */
+  class EUTelClusterSummary {
+
+  public:
+    EUTelClusterSummary();
+
+    //! Read the pixels of @a cluster and reset the cached values
+    void fill(EUTelVirtualCluster* cluster);
+
+    //! Read again the noise values, after setNoiseValues on the cluster
+    void updateNoise();
+
+    EUTelVirtualCluster* getCluster() const { return _cluster; }
+
+    int getDetectorID() const { return _detectorID; }
+
+    //! True if the noise values of the cluster were set
+    bool hasNoise() const { return _hasNoise; }
+
+    ClusterQuality getClusterQuality() const { return _cluster->getClusterQuality(); }
+
+    float getTotalCharge() const;
+
+    float getSeedCharge() const;
+
+    //! Charge of the @a nPixel pixels with the highest signal
+    float getClusterCharge(int nPixel) const;
+
+    //! Charge of the @a xSize x @a ySize pixels around the seed
+    float getClusterCharge(int xSize, int ySize) const;
+
+    float getClusterNoise() const;
+
+    float getClusterSNR() const;
+
+    float getSeedSNR() const;
+
+    //! SNR of the @a nPixel pixels with the highest signal
+    float getClusterSNR(int nPixel) const;
+
+    //! SNR of the @a xSize x @a ySize pixels around the seed
+    float getClusterSNR(int xSize, int ySize) const;
+
+    //! SNR of the n pixels with the highest signal for every n of @a nPixels
+    std::vector<float> getClusterSNR(const std::vector<int>& nPixels) const;
+
+    //! The center of gravity, computed by the cluster on the first call
+    void getCenterOfGravity(float& x, float& y) const;
+
+  private:
+    //! Throw DataNotAvailableException as the clusters do without noise
+    void checkNoise() const;
+
+    //! Charge and squared noise of the pixels within a sub cluster
+    const std::pair<float, float>& subCluster(int xSize, int ySize) const;
+
+    EUTelVirtualCluster* _cluster;
+
+    //! False if the calls are passed to _cluster
+    bool _summarised;
+
+    //! The type of _cluster is EUTelFFClusterImpl or a derived one
+    bool _isFixedFrame;
+
+    int _detectorID;
+
+    bool _hasNoise;
+
+    //! Signal and noise in the order of the cluster pixels
+    std::vector<float> _charge;
+    std::vector<float> _noise;
+    std::vector<double> _noise2;
+
+    //! Pixel position with respect to the cluster center (fixed frame) or seed (sparse)
+    std::vector<int> _dx;
+    std::vector<int> _dy;
+
+    //! Cluster size, used by the fixed frame shortcuts
+    int _xSize;
+    int _ySize;
+
+    float _totalCharge;
+    std::size_t _seedIndex;
+    float _clusterNoise;
+
+    //! Prefix sums of the charges sorted by decreasing signal
+    std::vector<float> _chargePrefix;
+
+    //! Pixel indices by decreasing signal, the lower index first on ties
+    std::vector<std::size_t> _rank;
+
+    //! Prefix sums of signal and squared noise by decreasing signal, the higher index first on ties
+    std::vector<float> _snrSignalPrefix;
+    std::vector<float> _snrNoise2Prefix;
+
+    mutable bool _hasCenterOfGravity;
+    mutable float _xCoG;
+    mutable float _yCoG;
+
+    //! Cached getClusterSNR(nPixel), as (nPixel, SNR)
+    mutable std::vector<std::pair<int, float> > _nPixelSNR;
+
+    //! Cached sub clusters, as ((xSize, ySize), (charge, squared noise))
+    mutable std::vector<std::pair<std::pair<int, int>, std::pair<float, float> > > _subClusters;
+
+    //! Scratch indices of getClusterSNR(nPixel)
+    mutable std::vector<std::size_t> _scratch;
+  };
+
+}
+#endif
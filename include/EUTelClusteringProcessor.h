@@ -17,6 +17,7 @@
 #include "EUTelExceptions.h"
 #include "EUTELESCOPE.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelSeedFinder.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -372,6 +373,9 @@ namespace eutelescope {
      */
     void resetStatus(IMPL::TrackerRawDataImpl * status);
 
+    //! True if the pixel was added to a cluster by the fixed frame or bricked NZS clustering
+    bool isClusteredPixel(int sensorID, int index) const;
+
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     //! Book histograms
     /*! This method is used to prepare the needed directory structure
@@ -436,20 +440,19 @@ namespace eutelescope {
      *  candidates. A seed candidate is defined as a pixel with a
      *  signal to noise ratio in excess the
      *  EUTelClusteringProcessor::_seedPixelCut defined by the
-     *  user. All candidates are added to a vector< pair< float, int > >
-     *  (EUTelClusteringProcessor::_seedCandidateMap) where the first
-     *  template element is the (float) pixel charge and the second is
-     *  the pixel index.
-     *
-     *  \li This is the sorted using the std::algorithm library by the first element of the pair
-     *  i.e. the pixel signal. In this way, at the end of
-     *  the matrix crossing, the last element of the map is the pixel
-     *  seed candidate with the highest signal. The seed candidate map has to be compulsory sorted,
-     *  because the cluster building procedure has to start from a
-     *  seed pixel.
-     *
-     *  \li Starting from the last entry of the seed candidate map
-     *  (i.e. the pixel with the highest signal in the matrix), a
+     *  user. The scan is done by the EUTelSeedFinder of the sensor
+     *  (EUTelClusteringProcessor::_seedFinderMap), which keeps the
+     *  candidates as pairs of the (float) pixel charge and the pixel
+     *  index.
+     *
+     *  \li The candidates are ordered as a heap by the pixel signal,
+     *  so that they are taken from the highest signal down, because
+     *  the cluster building procedure has to start from a seed pixel.
+     *  The pixels added to clusters are kept in a bitmap of the seed
+     *  finder instead of the status matrix.
+     *
+     *  \li Starting from the seed candidate with the highest signal
+     *  in the matrix, a
      *  candidate cluster is built around this seed. The clustering is
      *  done with two nested loops in way that the seed pixel is the
      *  center of the resulting cluster. Only pixels with a good
@@ -742,10 +745,11 @@ namespace eutelescope {
      */
     void readCollections(LCEvent *evt);
 
-    //! The seed candidate pixel map.
-    /*! This is a vector which stores the seed index and the size of the signal. The signal is the floating point and the unsigned integer is the
+    //! The seed finders of the NZS clustering algorithms
+    /*! One per sensorID, they keep the seed candidates and the
+     *  clustered pixels of the last frame of the sensor.
      */
-    std::vector< std::pair<float,unsigned int> > _seedCandidateMap;
+    std::map< int, EUTelSeedFinder > _seedFinderMap;
 
     //! Total cluster found
     /*! This is a map correlating the sensorID number and the
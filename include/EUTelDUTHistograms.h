@@ -13,6 +13,7 @@
 
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
+#include "EUTelHitMatcher.h"
 
 //#include "TrackerHitImpl2.h"
 #include "IMPL/TrackerHitImpl.h"
@@ -257,6 +258,9 @@ protected:
  
     std::vector<float > _DUTalign;
 
+    //! Measured DUT hits binned for the track matching
+    EUTelHitMatcher _hitMatcher;
+
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     //! AIDA histogram maps
@@ -49,6 +49,9 @@ namespace eutelescope {
     std::vector<int> _radLengthIndex, _resXIndex, _resYIndex;    
     //Alignment
     std::vector<int> _shiftXIndex, _shiftYIndex, _scaleXIndex, _scaleYIndex, _zRotIndex, _zPosIndex; 
+    //Minimization
+    std::string _searchMethod;
+    int _estMatThreads;
     
   public:
     // Marlin processor interface funtions
@@ -0,0 +1,99 @@
+#ifndef EUTELEVENTINDEX_H
+#define	EUTELEVENTINDEX_H
+
+// LCIO
+#include "lcio.h"
+#include <EVENT/LCEvent.h>
+
+// system includes <>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace eutelescope {
+
+	/** @class EUTelEventIndex
+	 * Run-level index of the events in an LCIO file.
+	 *
+	 * For every event written the index keeps its position in the file,
+	 * run and event number, event type, the number of elements of each
+	 * collection and an occupancy summary: the total number of charge or
+	 * ADC values of all TrackerData and TrackerRawData collections. For
+	 * zero suppressed data this is proportional to the number of fired
+	 * pixels and is a good measure of the processing cost of an event.
+	 *
+	 * The index is stored as a versioned binary sidecar next to the
+	 * .slcio file and is used by EUTelIndexedLCIOReader to seek to event
+	 * ranges, subsample and split a run into balanced ranges.
+	 */
+	class EUTelEventIndex {
+
+		public:
+			/** Per event record */
+			struct Entry {
+				int32_t runNumber;
+				int32_t eventNumber;
+				int32_t eventType;
+				/** Position of the event in the file, counting from zero */
+				uint32_t ordinal;
+				/** Sum of charge/ADC values of all tracker data collections */
+				uint64_t occupancy;
+				/** Range of this event in the collection size table */
+				uint32_t firstSize;
+				uint32_t nSizes;
+			};
+
+			/** Element count of one collection in one event */
+			struct CollectionSize {
+				uint32_t collection;
+				uint32_t nElements;
+			};
+
+			EUTelEventIndex();
+
+			/** Append an event. Transient collections and the collections matching
+			 * @a dropNames or @a dropTypes are not written to the file and are skipped.
+			 */
+			void addEvent( EVENT::LCEvent* evt, int eventType,
+			               std::vector<std::string> const & dropNames = std::vector<std::string>(),
+			               std::vector<std::string> const & dropTypes = std::vector<std::string>() );
+
+			size_t getNumberOfEvents() const { return _entries.size(); }
+			const Entry& getEntry( size_t i ) const { return _entries.at(i); }
+
+			/** Number of elements of a collection in event i, -1 if the collection is missing */
+			int getCollectionSize( size_t i, std::string const & collectionName ) const;
+
+			const std::vector<std::string>& getCollectionNames() const { return _collectionNames; }
+
+			/** Entries in [first, last] (positions in the file, last < 0 for the end) taking every stride-th */
+			std::vector<size_t> selectRange( size_t first, long last, size_t stride ) const;
+
+			/** Split the selection into nRanges consecutive parts of similar total occupancy
+			 * and return part rangeIndex
+			 */
+			std::vector<size_t> splitRange( std::vector<size_t> const & selection, size_t nRanges, size_t rangeIndex ) const;
+
+			void clear();
+
+			/** Write the index to a binary file. Throws lcio::Exception on failure. */
+			void write( std::string const & fileName ) const;
+
+			/** Read an index from a binary file, replacing the current content.
+			 * Throws lcio::Exception if the file is missing or of an unknown version.
+			 */
+			void read( std::string const & fileName );
+
+			/** Format version stored in the file header */
+			static const uint32_t VERSION = 1;
+
+		private:
+			uint32_t collectionID( std::string const & name );
+
+			std::vector<Entry> _entries;
+			std::vector<CollectionSize> _sizes;
+			std::vector<std::string> _collectionNames;
+	};
+
+}
+#endif
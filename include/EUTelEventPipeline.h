@@ -0,0 +1,105 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELEVENTPIPELINE_H
+#define EUTELEVENTPIPELINE_H
+
+// eutelescope includes ".h"
+#include "EUTelBoundedQueue.h"
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+
+// system includes <>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace eutelescope {
+
+  //! Asynchronous write stage of the event pipeline
+  /*! In the standard Marlin loop the event is owned by the data
+   *  source and deleted as soon as the processor chain returns, so
+   *  the output processor has to serialise it on the spot and the
+   *  reconstruction waits for the disk. A data source owning its
+   *  events (EUTelIndexedLCIOReader with PrefetchDepth > 0) can
+   *  instead hand every processed event over to this stage with
+   *  retire(): if the output processor asked for the event to be
+   *  written (deferWrite()), the event is queued and written by a
+   *  separate thread through the registered writer, otherwise it is
+   *  deleted immediately.
+   *
+   *  The queue is bounded, retire() waits if the writer is that many
+   *  events behind. Only one data source and one writer are supported.
+   *
+   *  Sequence of calls:
+   *  @li output processor init(): setWriter()
+   *  @li data source, before the first event: start()
+   *  @li output processor processEvent(): deferWrite() if isRunning()
+   *  @li data source, after every event: retire()
+   *  @li data source, after the last event: finish(), before the
+   *  processors' end() is called
+   */
+  class EUTelEventPipeline {
+
+  public:
+    typedef std::function<void (EVENT::LCEvent*)> Writer;
+
+    //! The single instance
+    static EUTelEventPipeline& instance();
+
+    //! Register the function writing an event, called from the write thread
+    void setWriter(Writer writer);
+
+    //! Start the write stage, with at most @a writeDepth events waiting
+    /*! Does nothing but mark the pipeline running if no writer has
+     *  been registered.
+     */
+    void start(std::size_t writeDepth);
+
+    //! True between start() and finish()
+    bool isRunning() const { return _running; }
+
+    //! The current event has to be written once it is retired
+    void deferWrite() { _writeRequested = true; }
+
+    //! Hand over a processed event, it is written if requested and then deleted
+    void retire(std::unique_ptr<EVENT::LCEvent> evt);
+
+    //! Write all the queued events and stop the write thread
+    void finish();
+
+    //! Statistics of the write queue of the last start() - finish() period
+    EUTelQueueStatistics getWriteStatistics() const { return _writeStatistics; }
+
+    //! Error message if the writer failed during the last start() - finish() period
+    /*! After a failure no more events are written. Only valid after finish().
+     */
+    const std::string& getWriteError() const { return _writeError; }
+
+  private:
+    EUTelEventPipeline();
+    ~EUTelEventPipeline();
+    EUTelEventPipeline(const EUTelEventPipeline&) = delete;
+    EUTelEventPipeline& operator=(const EUTelEventPipeline&) = delete;
+
+    void writerLoop();
+
+    Writer _writer;
+    bool _running;
+    bool _writeRequested;
+    std::unique_ptr<EUTelBoundedQueue<std::unique_ptr<EVENT::LCEvent> > > _writeQueue;
+    std::thread _writerThread;
+    EUTelQueueStatistics _writeStatistics;
+    std::string _writeError;
+  };
+
+}
+#endif
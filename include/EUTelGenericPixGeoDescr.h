@@ -11,7 +11,9 @@
 
 //STL
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 //ROOT
 #include "TGeoManager.h"
@@ -58,7 +60,11 @@ class EUTelGenericPixGeoDescr {
 
 	  /** Takes the char* as a path name for the plane
 		* and creates the nodes for the pixel representation
-		* in it */
+		* in it. Implementations create their pixel volumes here
+		* and not in the constructor: for a TGeo description read
+		* back from the geometry cache the volumes exist already,
+		* this method is not called and the description is only
+		* used for lookups */
 		virtual void createRootDescr(char const *) = 0;
 
 
@@ -83,6 +89,29 @@ class EUTelGenericPixGeoDescr {
 			return this->getPixIndex( path.c_str() );
 		};
 
+	  /** Centre and half-widths of a pixel in the local frame of the plane */
+		struct PixelGeometry
+		{
+			float posX, posY;
+			float boundaryX, boundaryY;
+		};
+
+	  /** Whether pixel @param x, @param y is inside the index range of this description */
+		bool isPixelInRange(int x, int y) const
+		{
+			return x >= _minIndexX && x <= _maxIndexX && y >= _minIndexY && y <= _maxIndexY;
+		};
+
+	  /** Returns the geometry of pixel @param x, @param y. The first request of a
+		* pixel navigates the TGeo description of the plane @param planePath once,
+		* later requests are served from a cache, so only the pixels that fire
+		* are ever looked up. Since all positions are relative to the plane, the
+		* cache is shared by all planes using this description.
+		* Throws std::out_of_range for a pixel outside the index range, see
+		* isPixelInRange().
+		*/
+		const PixelGeometry& getPixelGeometry(int x, int y, std::string const & planePath);
+
 	protected:
 		TGeoManager* _tGeoManager;
 
@@ -91,6 +120,15 @@ class EUTelGenericPixGeoDescr {
 		int _maxIndexX, _maxIndexY;
 		double _radLength;
 
+		/** Geometry of the pixels looked up so far, keyed by @see getPixelTableIndex() */
+		std::unordered_map<size_t, PixelGeometry> _pixelTable;
+
+	  /** Key of pixel @param x, @param y in the pixel geometry cache */
+		size_t getPixelTableIndex(int x, int y) const
+		{
+			return static_cast<size_t>(x - _minIndexX)*(_maxIndexY - _minIndexY + 1) + (y - _minIndexY);
+		};
+
 	private:
 	  /** Empty constructor is private, no need to ever call it */
 		EUTelGenericPixGeoDescr();
@@ -49,10 +49,14 @@ public:
 	 *
 	 *  @param planeVolume The path of the plane into which the
 	 *  geometry shall be loaded
+	 *
+	 *  @param createRootDescr If false the pixel volumes are neither
+	 *  created nor added to the plane, because they are already part
+	 *  of a TGeo description read back from the geometry cache
 	 */
-	void addPlane(int planeID, std::string geoName, std::string planeVolume);
+	void addPlane(int planeID, std::string geoName, std::string planeVolume, bool createRootDescr = true);
 
-	void addCastedPlane(int planeID, int xPixel, int yPixel, double xSize, double ySize, double zSize, double radLength, std::string planeVolume);
+	void addCastedPlane(int planeID, int xPixel, int yPixel, double xSize, double ySize, double zSize, double radLength, std::string planeVolume, bool createRootDescr = true);
 
 	/** Method to get the EUTelGenericPixGeoDescr of a plane. 
 	 * 
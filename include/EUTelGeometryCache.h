@@ -0,0 +1,106 @@
+/*
+ * File:   EUTelGeometryCache.h
+ *
+ */
+#ifndef EUTELGEOMETRYCACHE_H
+#define	EUTELGEOMETRYCACHE_H
+
+// EUTELESCOPE
+#include "EUTELESCOPE.h"
+
+// C++
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace eutelescope {
+namespace geo {
+
+/** @class EUTelGeometryCache
+ * Index of a persistent snapshot of the TGeo telescope description.
+ *
+ * The snapshot consists of the ROOT file exported by
+ * EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription and of
+ * this small binary index. The index stores a content hash of the GEAR
+ * file and of the plane setup the geometry was built from, the size and
+ * modification time of the exported ROOT file and, for every plane, the
+ * information needed to reattach the pixel geometry descriptions without
+ * rebuilding the TGeo volumes.
+ *
+ * The index is memory-mapped when opened. It is only accepted if the
+ * magic word, the format version and the ROOT file stamp match, the
+ * content hash has to be checked by the caller.
+ */
+class EUTelGeometryCache {
+
+  public:
+	/** Per plane record, fixed size so that it can be used in place */
+	struct PlaneRecord {
+		int32_t sensorID;
+		int32_t castedPlane;
+		/** Name of the pixel geometry library */
+		char pixGeoName[64];
+		/** Name of the TGeo volume of the plane */
+		char volumeName[64];
+		/** TGeo path of the plane */
+		char planePath[128];
+	};
+
+	EUTelGeometryCache();
+	~EUTelGeometryCache();
+
+	/** Map the index file. Returns false if the file does not exist or
+	 * is not a valid index for the current format or ROOT file.
+	 */
+	bool open( std::string const & fileName );
+
+	/** Unmap the index file */
+	void close();
+
+	bool isOpen() const { return _data != nullptr; }
+
+	uint64_t getContentHash() const;
+	std::string getRootFileName() const;
+	size_t getNumberOfPlanes() const;
+	const PlaneRecord& getPlane( size_t i ) const;
+
+	/** Write an index file. Throws lcio::Exception on failure. */
+	static void write( std::string const & fileName, uint64_t contentHash, std::string const & rootFileName,
+	                   std::vector<PlaneRecord> const & planes );
+
+	/** FNV-1a hash of a block of memory, chained through @a seed */
+	static uint64_t hashBytes( const void* data, size_t size, uint64_t seed = FNV_OFFSET );
+
+	/** FNV-1a hash of the content of a file, chained through @a seed.
+	 * An unreadable file leaves the seed unchanged.
+	 */
+	static uint64_t hashFile( std::string const & fileName, uint64_t seed = FNV_OFFSET );
+
+	/** Format version stored in the index header */
+	static const uint32_t VERSION = 1;
+
+	static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+
+  private:
+	DISALLOW_COPY_AND_ASSIGN(EUTelGeometryCache)
+
+	struct Header {
+		char magic[4];
+		uint32_t version;
+		uint64_t contentHash;
+		/** Size and modification time of the ROOT file at writing time */
+		uint64_t rootFileSize;
+		int64_t rootFileMTime;
+		uint32_t nPlanes;
+		uint32_t padding;
+		char rootFileName[256];
+	};
+
+	const char* _data;
+	size_t _size;
+};
+
+} // namespace geo
+} // namespace eutelescope
+#endif	/* EUTELGEOMETRYCACHE_H */
@@ -10,6 +10,7 @@
 #include <string>
 #include <array>
 #include <memory>
+#include <cstdint>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -40,6 +41,7 @@
 // ROOT
 #include "TGeoManager.h"
 #include "TGeoMatrix.h"
+#include "TGeoPhysicalNode.h"
 #include "TVector3.h"
 
 // built only if GEAR is available
@@ -162,6 +164,11 @@ class EUTelGeometryTelescopeGeoDescription
 	/** Map containing plane path (string) and corresponding planeID */
 	std::map<int, std::string> _planePath;
 
+	/** Physical node and alignment matrix of each plane realigned by updateTGeoPlaneTransformations,
+	 * both owned by the TGeo manager */
+	std::map<int, TGeoPhysicalNode*> _alignedPlaneNodes;
+	std::map<int, TGeoCombiTrans*> _alignedPlaneMatrices;
+
 	/** */
 	static unsigned _counter;
 
@@ -335,6 +342,11 @@ class EUTelGeometryTelescopeGeoDescription
 	void initializeTGeoDescription(std::string tgeofilename);
 	void initializeTGeoDescription( std::string const & geomName, bool dumpRoot );
 
+	/** Update the TGeo plane placements after the plane positions/rotations
+	 * have been changed with the set methods
+	 */
+	void updateTGeoPlaneTransformations();
+
 	// Geometry operations
 	float findRad(	const std::map<int,int>& sensorIDToZOrderWithoutExcludedPlanes, 
 			const double globalPosStart[], const double globalPosFinish[], 
@@ -424,6 +436,30 @@ private:
 
 	void translateSiPlane2TGeo(TGeoVolume*,int );
 
+	/** Set @a combi to the local to global transformation of a plane as given by the plane setup */
+	void planeTransformation( int, TGeoCombiTrans& combi );
+
+	/** Attach the pixel geometry description of a plane */
+	void addPixelGeometry( int SensorId, std::string const & volumeName, bool createRootDescr );
+
+	/** Whether the Marlin global parameter UseGeometryCache is set to true */
+	static bool useGeometryCache();
+
+	/** Name of the geometry cache index of the exported ROOT file @a geomName */
+	static std::string geometryCacheFileName( std::string const & geomName );
+
+	/** Hash of the shared library file holding @a symbol */
+	static uint64_t hashLibraryOf( void const * symbol, uint64_t seed );
+
+	/** Hash of the GEAR file, of the plane setup and of the pixel geometry libraries the TGeo description is built from */
+	uint64_t geometryContentHash();
+
+	/** Import the TGeo description from the geometry cache if it is valid for the current setup */
+	bool readTGeoDescriptionCache( std::string const & cacheName );
+
+	/** Write the geometry cache index for the exported TGeo description */
+	void writeTGeoDescriptionCache( std::string const & cacheName, std::string const & geomName );
+
 	void clearMemoizedValues() { _planeNormalMap.clear(); _planeXMap.clear(); _planeYMap.clear(); _planeRadMap.clear(); }
 	std::map<int, TVector3> _planeNormalMap;
 	std::map<int, TVector3> _planeXMap;
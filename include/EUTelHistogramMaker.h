@@ -11,6 +11,7 @@
 
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
+#include "EUTelClusterSummary.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -333,6 +334,9 @@ namespace eutelescope {
      */
     int _iRun;
 
+    //! Derived quantities of the cluster being histogrammed
+    EUTelClusterSummary _clusterSummary;
+
   };
 
   //! A global instance of the processor
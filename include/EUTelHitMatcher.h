@@ -0,0 +1,119 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELHITMATCHER_H
+#define EUTELHITMATCHER_H
+
+// system includes <>
+#include <vector>
+#include <cstddef>
+
+namespace eutelescope {
+
+  //! Track to hit matching on a uniform grid
+  /*! Analyses computing efficiencies and residuals have to find, for
+   *  every track extrapolated to a DUT, the hits inside a matching
+   *  window. Scanning all the hits of the plane for every track costs
+   *  O(nTracks x nHits) per event. This class bins the hits of one
+   *  plane once on a uniform grid whose cells are as large as the
+   *  matching window, so that every query only looks at the hits of
+   *  the 3 x 3 cells around the track.
+   *
+   *  A hit matches a point (x, y) if |x - xHit| < windowX and
+   *  |y - yHit| < windowY. A circular window of radius r is obtained
+   *  with windowX = windowY = r and checking the returned squared
+   *  distance. Hits can be flagged as used, for exclusive matching
+   *  where a hit can be assigned to one track only.
+   *
+   *  Typical use, one instance per DUT:
+   *  @code
+   *  matcher.setWindow( 0.05, 0.05 );
+   *  matcher.clear();
+   *  for ( ... ) matcher.addHit( x, y );
+   *  matcher.build();
+   *  double dist2;
+   *  long iHit = matcher.findNearest( xTrack, yTrack, dist2 );
+   *  if ( iHit >= 0 ) matcher.setUsed( iHit );
+   *  @endcode
+   */
+  class EUTelHitMatcher {
+
+  public:
+    EUTelHitMatcher();
+
+    //! Set the half widths of the matching window
+    /*! Takes effect at the next build(). A non positive width
+     *  disables the cut in that direction.
+     */
+    void setWindow(double windowX, double windowY);
+
+    //! Remove all the hits
+    void clear();
+
+    //! Add a hit, returns its index
+    std::size_t addHit(double x, double y);
+
+    //! Bin the hits, has to be called after the last addHit()
+    void build();
+
+    std::size_t getNumberOfHits() const { return _x.size(); }
+    double getX(std::size_t i) const { return _x[i]; }
+    double getY(std::size_t i) const { return _y[i]; }
+
+    //! Indices of the hits inside the window around (x, y)
+    /*! The indices are returned in increasing order, so that the
+     *  result does not depend on the binning. Used hits are skipped
+     *  if @a skipUsed is set.
+     */
+    void findInWindow(double x, double y, std::vector<std::size_t>& found, bool skipUsed = false) const;
+
+    //! At least one hit inside the window around (x, y)
+    bool hasHitInWindow(double x, double y) const;
+
+    //! Nearest unused hit inside the window around (x, y)
+    /*! Returns -1 if there is none. @a dist2 is set to the squared
+     *  distance of the hit. Of hits at the same distance the one with
+     *  the lowest index is returned, as a linear scan would.
+     */
+    long findNearest(double x, double y, double& dist2) const;
+
+    void setUsed(std::size_t i, bool used = true) { _used[i] = used; }
+    bool isUsed(std::size_t i) const { return _used[i]; }
+    void resetUsed();
+
+    //! Number of hits not flagged as used
+    std::size_t getNumberOfUnused() const;
+
+  private:
+    //! Range of cells covering [x - windowX, x + windowX] and the same in y
+    bool cellRange(double x, double y, int& ixMin, int& ixMax, int& iyMin, int& iyMax) const;
+
+    bool inWindow(std::size_t i, double x, double y) const;
+
+    double _windowX;
+    double _windowY;
+
+    std::vector<double> _x;
+    std::vector<double> _y;
+    std::vector<bool> _used;
+
+    //! Grid geometry
+    double _xMin;
+    double _yMin;
+    double _cellX;
+    double _cellY;
+    int _nCellX;
+    int _nCellY;
+
+    //! Hit indices sorted by cell, cell i holds _cellHits[_cellStart[i] .. _cellStart[i+1]]
+    std::vector<std::size_t> _cellStart;
+    std::vector<std::size_t> _cellHits;
+  };
+
+}
+#endif
@@ -0,0 +1,109 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELHOTPIXELMAP_H
+#define EUTELHOTPIXELMAP_H
+
+// lcio includes <.h>
+#include <EVENT/LCCollection.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <IMPL/TrackerHitImpl.h>
+#include <UTIL/CellIDDecoder.h>
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Hot pixel database of all the sensors as dense bitmaps
+  /*! For every sensor the hot pixels are stored as one bit per pixel
+   *  of the smallest rectangle containing all of them, so that looking
+   *  up a pixel is a range check and a bit test. The sensors are
+   *  indexed directly by their sensor ID.
+   *
+   *  The map is filled once, usually from the hot pixel collection
+   *  written by EUTelProcessorNoisyPixelFinder, and then only read.
+   */
+  class EUTelHotPixelMap {
+
+  public:
+    EUTelHotPixelMap();
+
+    //! Add the pixels of a hot pixel collection
+    /*! Only elements of sparse pixel type kEUTelGenericSparsePixel
+     *  are read, the others are skipped.
+     */
+    void addCollection(EVENT::LCCollection* hotPixelCollection);
+
+    //! Add a single hot pixel
+    void addPixel(int sensorID, int x, int y);
+
+    //! Remove all the hot pixels
+    void clear();
+
+    bool isHot(int sensorID, int x, int y) const {
+      if ( sensorID < 0 || static_cast<std::size_t>(sensorID) >= _sensors.size() ) return false;
+      const SensorBitmap& sensor = _sensors[sensorID];
+      const int ix = x - sensor.offX;
+      const int iy = y - sensor.offY;
+      if ( ix < 0 || ix >= sensor.sizeX || iy < 0 || iy >= sensor.sizeY ) return false;
+      const std::size_t bit = static_cast<std::size_t>(ix) * sensor.sizeY + iy;
+      return ( sensor.bits[ bit >> 6 ] >> ( bit & 63 ) ) & 1;
+    }
+
+    //! True if any pixel of a kEUTelGenericSparsePixel cluster is hot
+    bool clusterContainsHotPixels(const IMPL::TrackerDataImpl* zsCluster) const;
+
+    //! True if the cluster of a hit contains a hot pixel
+    /*! If the hit carries the kHotPixelChecked quality bit, set by
+     *  EUTelProcessorHitMaker, this is a test of the kHotPixelHit bit.
+     *  Otherwise the cluster of a kEUTelSparseClusterImpl hit is looked
+     *  up pixel by pixel; hits of the other cluster types are never
+     *  considered hot.
+     */
+    bool hitContainsHotPixels(const IMPL::TrackerHitImpl* hit) const;
+
+    //! The quality bits of a hit checked against this map
+    /*! @return kHotPixelChecked, with kHotPixelHit if the cluster of
+     *  the hit contains a hot pixel.
+     */
+    int hitQuality(const IMPL::TrackerHitImpl* hit) const;
+
+    //! Number of hot pixels
+    std::size_t size() const { return _nPixels; }
+
+    bool empty() const { return _nPixels == 0; }
+
+  private:
+    struct SensorBitmap {
+      SensorBitmap(): offX(0), offY(0), sizeX(0), sizeY(0), pixels(), bits() {}
+      int offX;
+      int offY;
+      int sizeX;
+      int sizeY;
+      //! The hot pixels as (x, y), to rebuild the bitmap when its range grows
+      std::vector<std::pair<int,int> > pixels;
+      std::vector<uint64_t> bits;
+    };
+
+    //! Fit the bitmap of a sensor to the range of its pixels and refill it
+    static void rebuild(SensorBitmap& sensor);
+
+    //! Set the bit of a pixel in the range of the bitmap, returns false if it is out of the range
+    static bool setBit(SensorBitmap& sensor, int x, int y);
+
+    std::vector<SensorBitmap> _sensors;
+    std::size_t _nPixels;
+    mutable UTIL::CellIDDecoder<IMPL::TrackerDataImpl> _clusterDecoder;
+  };
+
+}
+#endif
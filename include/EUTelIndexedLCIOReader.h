@@ -0,0 +1,121 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELINDEXEDLCIOREADER_H
+#define EUTELINDEXEDLCIOREADER_H 1
+
+// eutelescope includes ".h"
+#include "EUTelEventIndex.h"
+
+// marlin includes ".h"
+#include "marlin/DataSourceProcessor.h"
+
+// system includes <>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Random access reader for LCIO files with an event index
+  /*! This data source reads an LCIO file for which an event index
+   *  (see EUTelEventIndex) has been written by the
+   *  EUTelOutputProcessor. Instead of reading all the events from the
+   *  beginning of the file, the events are selected on the index and
+   *  read with the LCIO direct access, so that
+   *
+   *  @li a range of events can be processed without reading the
+   *  events in front of it;
+   *
+   *  @li the run can be subsampled taking one event every @a Stride;
+   *
+   *  @li the run can be split into @a NumberOfRanges parts with
+   *  similar total occupancy, each processed by a separate job with
+   *  its own @a RangeIndex.
+   *
+   *  The run header is read from the file as usual. Use this
+   *  processor instead of the LCIOInputFiles global parameter.
+   *
+   *  With @a PrefetchDepth > 0 reading, reconstruction and writing
+   *  run in a pipeline: an I/O thread reads and unpacks the upcoming
+   *  events into a queue of that depth while the processors work on
+   *  the current one, and if the EUTelOutputProcessor has
+   *  AsynchronousWrite set the processed events are written by a
+   *  third thread (see EUTelEventPipeline). The queue depths and the
+   *  number of times each stage had to wait are printed at the end of
+   *  the run. This needs the thread safe LCIO reader of LCIO 2.13 or
+   *  newer, with older versions the events are read synchronously.
+   *
+   *  @param InputFile The LCIO input file
+   *  @param EventIndexFile The index file, empty for InputFile + ".idx"
+   *  @param FirstEvent Position in the file of the first event to process
+   *  @param LastEvent Position in the file of the last event, -1 for the end
+   *  @param Stride Process one event every Stride
+   *  @param NumberOfRanges Split the selection into this number of ranges
+   *  @param RangeIndex The range processed by this job
+   *  @param PrefetchDepth Number of events read ahead, 0 to read synchronously
+   */
+  class EUTelIndexedLCIOReader : public marlin::DataSourceProcessor {
+
+  public:
+
+    //! Default constructor
+    EUTelIndexedLCIOReader ();
+
+    //! New processor
+    virtual EUTelIndexedLCIOReader * newProcessor ();
+
+    //! Reads the selected events and passes them to the processors
+    virtual void readDataSource (int numEvents);
+
+    //! Init method
+    virtual void init ();
+
+    //! End method
+    virtual void end ();
+
+  protected:
+
+    //! The LCIO input file
+    std::string _inputFileName;
+
+    //! The event index file
+    std::string _eventIndexFileName;
+
+    //! First event position
+    int _firstEvent;
+
+    //! Last event position
+    int _lastEvent;
+
+    //! Subsampling stride
+    int _stride;
+
+    //! Number of ranges the selection is split into
+    int _nRanges;
+
+    //! Range processed by this job
+    int _rangeIndex;
+
+    //! Number of events read ahead by the I/O thread
+    int _prefetchDepth;
+
+    //! The event index
+    EUTelEventIndex _eventIndex;
+
+  private:
+
+    //! Reads the selected events in an I/O thread, returns false if this is not supported
+    bool readPipelined (std::vector<size_t> const & selection, int numEvents);
+
+  };
+
+  //! A global instance of the processor
+  EUTelIndexedLCIOReader gEUTelIndexedLCIOReader;
+
+}
+#endif
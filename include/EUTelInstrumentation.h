@@ -0,0 +1,145 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELINSTRUMENTATION_H
+#define EUTELINSTRUMENTATION_H
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+
+// system includes <>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+//! Name of the function returning the number of allocations
+/*! It is exported by the libEUTelAllocationCounter preload library,
+ *  the allocations are only counted if Marlin is run with
+ *  LD_PRELOAD=libEUTelAllocationCounter.so. It returns the number of
+ *  allocations of the calling thread.
+ */
+#define EUTEL_ALLOCATION_COUNT_FUNCTION "eutel_allocation_count"
+
+namespace eutelescope {
+
+  //! Collects the per event cost of the sections of a processor chain
+  /*! Marlin does not allow to wrap the processors of a chain, so the
+   *  chain is split into sections by instrumentation points
+   *  (EUTelUtilityInstrumentation processors). Every point measures
+   *  the section between the previous point and itself, i.e. the
+   *  processors in between, and the first point of the chain starts
+   *  the measurement of every event. For every section the registry
+   *  keeps
+   *
+   *  @li the wall clock and the CPU time of the calling thread, as
+   *  totals and as histograms with logarithmic bins;
+   *
+   *  @li the number of heap allocations of the calling thread, if the
+   *  allocation counter preload library is loaded;
+   *
+   *  @li the number of elements of every collection added to the
+   *  event by the section.
+   *
+   *  At the end a summary table is printed and written as JSON.
+   */
+  class EUTelInstrumentation {
+
+  public:
+    //! Number of histogram bins, bin i holds times in [2^i, 2^(i+1)) microseconds
+    static const std::size_t NBINS = 32;
+
+    struct Histogram {
+      std::vector<uint64_t> bins;
+      Histogram(): bins(NBINS, 0) {}
+      void fill(double seconds);
+    };
+
+    struct CollectionStatistics {
+      uint64_t nEvents;
+      uint64_t sum;
+      uint64_t max;
+      CollectionStatistics(): nEvents(0), sum(0), max(0) {}
+    };
+
+    struct SectionStatistics {
+      std::string name;
+      uint64_t nEvents;
+      double wallSum;
+      double wallMax;
+      double cpuSum;
+      double cpuMax;
+      Histogram wallHistogram;
+      Histogram cpuHistogram;
+      uint64_t allocationSum;
+      uint64_t allocationMax;
+      std::map<std::string, CollectionStatistics> collections;
+      SectionStatistics(): name(), nEvents(0), wallSum(0.), wallMax(0.), cpuSum(0.), cpuMax(0.),
+                           wallHistogram(), cpuHistogram(), allocationSum(0), allocationMax(0), collections() {}
+    };
+
+    //! The single instance
+    static EUTelInstrumentation& instance();
+
+    //! Add an instrumentation point, returns its index
+    /*! Points have to be added in the order of the chain, i.e. from
+     *  the init() of the instrumentation processors.
+     */
+    std::size_t addPoint(std::string const & section);
+
+    //! Set the name of the JSON summary, no file is written if empty
+    void setOutputFile(std::string const & fileName);
+
+    //! Record the section ending at @a point
+    void checkpoint(std::size_t point, EVENT::LCEvent* evt);
+
+    //! To be called from the end() of every point, the summary is written after the last one
+    void endPoint();
+
+    //! True if the allocation counter preload library is loaded
+    bool hasAllocationCounter() const { return _allocationCount != 0; }
+
+    std::vector<SectionStatistics> const & getSections() const { return _sections; }
+
+    //! Print the summary table
+    void printSummary(std::ostream& os) const;
+
+    //! Write the summary as JSON
+    void writeJSON(std::ostream& os) const;
+
+  private:
+    EUTelInstrumentation();
+    EUTelInstrumentation(const EUTelInstrumentation&) = delete;
+    EUTelInstrumentation& operator=(const EUTelInstrumentation&) = delete;
+
+    //! CPU time of the calling thread in seconds
+    static double threadCPUTime();
+
+    uint64_t allocationCount() const { return _allocationCount ? _allocationCount() : 0; }
+
+    std::vector<SectionStatistics> _sections;
+    std::string _outputFile;
+    std::size_t _nEnded;
+
+    uint64_t (*_allocationCount)();
+
+    //! State at the previous point of the current event
+    std::size_t _lastPoint;
+    bool _inEvent;
+    std::chrono::steady_clock::time_point _lastWall;
+    double _lastCPU;
+    uint64_t _lastAllocations;
+    std::set<std::string> _knownCollections;
+  };
+
+}
+#endif
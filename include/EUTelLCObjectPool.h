@@ -0,0 +1,195 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELLCOBJECTPOOL_H
+#define EUTELLCOBJECTPOOL_H
+
+// lcio includes <.h>
+#include <EVENT/LCObject.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <IMPL/TrackerHitImpl.h>
+#include <IMPL/TrackerPulseImpl.h>
+#include <LCIOSTLTypes.h>
+
+// system includes <>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Bring a recycled LCIO object back to the state of a new one
+  /*! The vectors are cleared but keep their capacity, which is what
+   *  makes recycling pay off for the charge values of the clusters.
+   */
+  inline void resetLCObject(IMPL::TrackerDataImpl* data) {
+    data->setReadOnly( false );
+    data->setCellID0( 0 );
+    data->setCellID1( 0 );
+    data->setTime( 0 );
+    data->chargeValues().clear();
+  }
+
+  inline void resetLCObject(IMPL::TrackerPulseImpl* pulse) {
+    static const EVENT::FloatVec zeroCovMatrix( 3, 0. );
+    pulse->setReadOnly( false );
+    pulse->setCellID0( 0 );
+    pulse->setCellID1( 0 );
+    pulse->setTime( 0 );
+    pulse->setCharge( 0 );
+    pulse->setQuality( 0 );
+    pulse->setCovMatrix( zeroCovMatrix );
+    pulse->setTrackerData( 0 );
+  }
+
+  inline void resetLCObject(IMPL::TrackerHitImpl* hit) {
+    static const double origin[3] = { 0., 0., 0. };
+    static const EVENT::FloatVec zeroCovMatrix( 6, 0. );
+    hit->setReadOnly( false );
+    hit->setCellID0( 0 );
+    hit->setCellID1( 0 );
+    hit->setType( 0 );
+    hit->setPosition( origin );
+    hit->setCovMatrix( zeroCovMatrix );
+    hit->setEDep( 0 );
+    hit->setEDepError( 0 );
+    hit->setTime( 0 );
+    hit->setQuality( 0 );
+    hit->rawHits().clear();
+  }
+
+  //! Free list of LCIO objects of type @a T, reused from event to event
+  /*! LCIO deletes all the objects of an event together with the
+   *  event, so every cluster, pulse and hit used to be a fresh heap
+   *  allocation (two for a cluster with its charge vector) freed again
+   *  a few processors later. Objects taken with create() are ordinary
+   *  heap objects and may be deleted or stored in any collection, but
+   *  if they end up in an EUTelPooledCollectionVec they are handed back
+   *  here when the event is deleted and the next create() returns them
+   *  instead of allocating.
+   *
+   *  At most getMaxSize() objects are kept, the ones beyond are deleted,
+   *  so that a single event of very high occupancy does not keep its
+   *  memory for the rest of the run. The pool is thread safe, events
+   *  are deleted by the write thread of EUTelEventPipeline.
+   */
+  template<class T>
+  class EUTelLCObjectPool {
+
+  public:
+    //! The pool of type @a T
+    /*! It is never destroyed: events deleted during the static
+     *  destruction can still return their objects.
+     */
+    static EUTelLCObjectPool& instance() {
+      static EUTelLCObjectPool* pool = new EUTelLCObjectPool;
+      return *pool;
+    }
+
+    //! Shortcut for instance().acquire()
+    static T* create() { return instance().acquire(); }
+
+    //! An object in its default state, recycled if possible
+    T* acquire() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if ( !_free.empty() ) {
+          T* object = _free.back();
+          _free.pop_back();
+          ++_nRecycled;
+          return object;
+        }
+        ++_nCreated;
+      }
+      return new T;
+    }
+
+    //! Take back the objects of a collection being deleted, @a objects is left empty
+    /*! Objects of a type derived from T are deleted, not recycled.
+     */
+    void release(std::vector<EVENT::LCObject*>& objects) {
+      std::vector<T*> recycled;
+      recycled.reserve( objects.size() );
+      for ( std::vector<EVENT::LCObject*>::iterator iter = objects.begin(); iter != objects.end(); ++iter ) {
+        T* object = dynamic_cast<T*>( *iter );
+        if ( object && typeid( *object ) == typeid( T ) ) {
+          resetLCObject( object );
+          recycled.push_back( object );
+        } else {
+          delete *iter;
+        }
+      }
+      objects.clear();
+
+      std::size_t nKept = 0;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        nKept = _free.size() < _maxSize ? std::min( _maxSize - _free.size(), recycled.size() ) : 0;
+        _free.insert( _free.end(), recycled.begin(), recycled.begin() + nKept );
+      }
+      for ( std::size_t i = nKept; i < recycled.size(); ++i ) delete recycled[i];
+    }
+
+    //! Maximum number of objects kept for reuse
+    void setMaxSize(std::size_t maxSize) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _maxSize = maxSize;
+    }
+
+    std::size_t getMaxSize() const { return _maxSize; }
+
+    //! Number of objects allocated by acquire()
+    uint64_t getNumberOfCreated() const { return _nCreated; }
+
+    //! Number of objects acquire() returned from the free list
+    uint64_t getNumberOfRecycled() const { return _nRecycled; }
+
+  private:
+    EUTelLCObjectPool():
+      _free(),
+      _maxSize(1 << 18),
+      _nCreated(0),
+      _nRecycled(0),
+      _mutex()
+    {}
+    EUTelLCObjectPool(const EUTelLCObjectPool&) = delete;
+    EUTelLCObjectPool& operator=(const EUTelLCObjectPool&) = delete;
+
+    std::vector<T*> _free;
+    std::size_t _maxSize;
+    uint64_t _nCreated;
+    uint64_t _nRecycled;
+    std::mutex _mutex;
+  };
+
+  //! LCCollectionVec returning its elements to EUTelLCObjectPool<T>
+  /*! Use it in place of LCCollectionVec for the collections a
+   *  processor adds to every event, and fill it with objects from
+   *  EUTelLCObjectPool<T>::create(). It is written and read like any
+   *  other collection of @a type; a subset collection does not own its
+   *  elements and returns nothing.
+   */
+  template<class T>
+  class EUTelPooledCollectionVec : public IMPL::LCCollectionVec {
+
+  public:
+    explicit EUTelPooledCollectionVec(const std::string& type): IMPL::LCCollectionVec(type) {}
+
+    virtual ~EUTelPooledCollectionVec() {
+      // the LCCollectionVec destructor deletes whatever is left
+      if ( !isSubset() ) EUTelLCObjectPool<T>::instance().release( *this );
+    }
+  };
+
+}
+#endif
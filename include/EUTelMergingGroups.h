@@ -0,0 +1,53 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELMERGINGGROUPS_H
+#define EUTELMERGINGGROUPS_H
+
+// system includes <>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Groups of merging clusters, as a union-find forest
+  /*! Every merging pair is joined with merge(); two clusters end up in
+   *  the same group if a chain of merging pairs links them. The root
+   *  of a group is always its lowest cluster index.
+   */
+  class EUTelMergingGroups {
+
+  public:
+    EUTelMergingGroups();
+
+    //! Start over with @a nClusters clusters, none merging
+    void reset(int nClusters);
+
+    int size() const { return static_cast<int>( _parent.size() ); }
+
+    //! Root of the group of a cluster, halving the path on the way
+    int findRoot(int iCluster);
+
+    //! Join the groups of two merging clusters
+    void merge(int iCluster, int iOtherCluster);
+
+    //! The groups of at least two clusters
+    /*! Each group lists its cluster indices in increasing order, the
+     *  groups are ordered by their first cluster.
+     */
+    void getGroups(std::vector< std::vector< int > >& groups);
+
+  private:
+    //! Parent of every cluster in the forest
+    std::vector< int > _parent;
+
+    //! Position of the group of a root cluster in the group vector
+    std::vector< int > _groupIndex;
+  };
+
+}
+#endif
@@ -14,6 +14,8 @@
 #ifdef USE_GEAR
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelHotPixelMap.h"
+#include "EUTelStraightLineFitter.h"
 
 //#include "TrackerHitImpl2.h"
 #include "IMPL/TrackerHitImpl.h"
@@ -385,16 +387,10 @@ namespace eutelescope {
      */
     std::string _hotPixelCollectionName;
 
-    //! Vector of map arrays, keeps record of hit pixels 
-    /*! The vector elements are sorted by Detector ID
-     *  For each Detector unique ID element a map of pixels is created. 
-     *  first level key   sensor unique 
-     *              value sensor map
-     *  sensor map key    unique row number
-     *             value  vector of column numbers.
+    //! Hot pixels of all the sensors
+    /*! One bitmap per sensor, a pixel is hot if its bit is set.
      */
-    
-    std::map<std::string, bool > _hotPixelMap;
+    EUTelHotPixelMap _hotPixelMap;
 
     //! Sensor ID vector
     IntVec _sensorIDVec;
@@ -559,6 +555,14 @@ namespace eutelescope {
     double * _xFitPos;
     double * _yFitPos;
 
+    //! Straight line fit of all the track candidates of an event at once
+    EUTelStraightLineFitter _lineFitter;
+
+    //! Hit positions of the track candidates plane by plane, as _lineFitter takes them
+    DoubleVec _candidateXPos;
+    DoubleVec _candidateYPos;
+    DoubleVec _candidateZPos;
+
     DoubleVec _siPlaneZPosition;
 
     //! Fill histogram switch
@@ -15,6 +15,7 @@
 // system includes <>
 #include <map>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -78,6 +79,13 @@ public:
 	bool findTooManyRejects(std::string output);
 	gbl::MilleBinary * _milleGBL;
 	void CreateBinary();
+	//Flush and close the binary. Must be done before pede is run on it.
+	void closeBinary();
+	//Close the binary and start a new, empty, one. Used to refill the binary between alignment iterations.
+	void resetBinary();
+
+	//Read the results file. Returns for each sensor the 6 local corrections in the order x,y,z shift then x,y,z rotation. 
+	std::map<int, std::vector<double> > readResults();
 
 protected:
 	TMatrixD _jacobian; //Remember you need to create the object before you point ot it
@@ -10,6 +10,7 @@
 
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelReferenceLineMatcher.h"
 
 
 // marlin includes ".h"
@@ -27,6 +28,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <utility>
 
 namespace eutelescope {
     
@@ -187,6 +189,12 @@ namespace eutelescope {
 	
 	//! Count number of created hit per DUT Hit
 	std::vector<unsigned int> _numberOfCreatedHitPerDUTHit; 
+
+        //! Second reference plane hits of the event, for the residual window search
+        EUTelReferenceLineMatcher _referenceLineMatcher;
+
+        //! Accepted second reference plane and DUT hit indices of one first reference plane hit
+        std::vector<std::pair<unsigned int, unsigned int> > _acceptedPairs;
     };
     
     //! A global instance of the processor
@@ -0,0 +1,98 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELOCCUPANCYCOUNTER_H
+#define EUTELOCCUPANCYCOUNTER_H
+
+// system includes <>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+namespace eutelescope {
+
+  //! Per pixel hit counter of one sensor
+  /*! The counts are kept in a single flat array, column by column
+   *  (all the rows of a column are contiguous), so that filling costs
+   *  one index computation and the evaluation is a linear scan over
+   *  contiguous memory. Counts saturate at the maximum of the counter
+   *  type instead of wrapping around. The 16 bit counter halves the
+   *  memory and the scanned bytes with respect to the 32 bit one, it
+   *  is exact as long as no pixel fires more than 65535 times.
+   *
+   *  Pixel indices are given in the sensor frame, the offsets are the
+   *  minimum pixel indices as returned by
+   *  EUTelGenericPixGeoDescr::getPixelIndexRange().
+   */
+  template <typename T>
+  class EUTelOccupancyCounterT {
+
+  public:
+    typedef T CountType;
+
+    EUTelOccupancyCounterT();
+
+    EUTelOccupancyCounterT(int offX, int sizeX, int offY, int sizeY);
+
+    //! Set the pixel range, all counts are reset
+    void resize(int offX, int sizeX, int offY, int sizeY);
+
+    //! Reset all counts to zero
+    void clear();
+
+    //! Count a hit, returns false if the pixel is out of range
+    bool fill(int x, int y) {
+      const int ix = x - _offX;
+      const int iy = y - _offY;
+      if ( ix < 0 || ix >= _sizeX || iy < 0 || iy >= _sizeY ) return false;
+      CountType& count = _counts[ static_cast<std::size_t>(ix) * _sizeY + iy ];
+      count += ( count != MAXCOUNT );
+      ++_nHits;
+      return true;
+    }
+
+    CountType getCount(int x, int y) const {
+      return _counts[ static_cast<std::size_t>(x - _offX) * _sizeY + (y - _offY) ];
+    }
+
+    int getOffX() const { return _offX; }
+    int getOffY() const { return _offY; }
+    int getSizeX() const { return _sizeX; }
+    int getSizeY() const { return _sizeY; }
+
+    //! Number of hits counted since the last clear(), including out of range ones
+    uint64_t getNumberOfHits() const { return _nHits; }
+
+    //! Append the pixels with a count above @a threshold
+    /*! The pixels are returned as (x, y) in the sensor frame, ordered
+     *  by column and then by row.
+     */
+    void findAbove(CountType threshold, std::vector<std::pair<int,int> >& pixels) const;
+
+    //! Number of pixels with at least one hit, for every column
+    void firedPixelsPerColumn(std::vector<int>& nFired) const;
+
+    static const CountType MAXCOUNT = std::numeric_limits<CountType>::max();
+
+  private:
+    int _offX;
+    int _offY;
+    int _sizeX;
+    int _sizeY;
+    uint64_t _nHits;
+    std::vector<CountType> _counts;
+  };
+
+  //! Instantiated in EUTelOccupancyCounter.cc
+  typedef EUTelOccupancyCounterT<uint32_t> EUTelOccupancyCounter;
+  typedef EUTelOccupancyCounterT<uint16_t> EUTelOccupancyCounter16;
+
+}
+#endif
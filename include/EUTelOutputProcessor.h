@@ -13,6 +13,7 @@
 
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
+#include "EUTelEventIndex.h"
 
 // marlin includes ".h"
 #include "marlin/LCIOOutputProcessor.h"
@@ -70,6 +71,10 @@ namespace eutelescope {
    *
    *  @param All parameters available in LCIOOutputProcessir
    *  @param SkipIntermediateEORE Remove EORE in between following runs.
+   *  @param AppendEORE Append the EORE if it is missing at the end.
+   *  @param AsynchronousWrite Write the events in a separate thread,
+   *  only effective with a data source owning its events, see
+   *  EUTelEventPipeline.
    *
    *
    *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
@@ -151,6 +156,41 @@ namespace eutelescope {
      * 
      */ 
     bool _skipIntermediateEORESwitch;
+
+    //! The switch to append the missing EORE in end()
+    /*! Switched off for all but the last part of a run processed in
+     *  parallel by jobsub, so that the merged file has a single EORE.
+     */
+    bool _appendEORE;
+
+    //! The switch to write an event index next to the output file
+    /*! The index (see EUTelEventIndex) is used by
+     *  EUTelIndexedLCIOReader to seek to event ranges without
+     *  reading all the events before them. It describes a single
+     *  file, so it is switched off when the output is split with
+     *  SplitFileSizekB.
+     */
+    bool _writeEventIndex;
+
+    //! The event index file name, empty for the output file name + ".idx"
+    std::string _eventIndexFile;
+
+    //! The event index of the output file
+    EUTelEventIndex _eventIndex;
+
+    //! Run number of the last run header or event written
+    /*! The EORE appended by end() belongs to this run. */
+    int _lastRunNumber;
+
+    //! The switch to write the events in a separate thread
+    /*! If the data source runs the EUTelEventPipeline (i.e. the
+     *  EUTelIndexedLCIOReader with PrefetchDepth > 0), processEvent()
+     *  only marks the event to be written and the event is written
+     *  by the write thread of the pipeline after the processor chain
+     *  is done with it. Otherwise the events are written
+     *  synchronously as usual.
+     */
+    bool _asynchronousWrite;
       
 
   } ;
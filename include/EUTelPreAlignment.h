@@ -11,6 +11,7 @@
 
 // eutelescope includes ".h"
 #include "EUTelReferenceHit.h"
+#include "EUTelHotPixelMap.h"
 
 //ROOT includes
 #include "TVector3.h"
@@ -143,14 +144,10 @@ namespace eutelescope {
      */
     std::string _hotPixelCollectionName;
 
-    //! map of vectors, keeps record of hit pixels 
-    /*! 
-     *  For each Detector a vector is stored in a map.
-     *  Each vector holds pairs of integers (representing X and Y pixel array positions).
-     *  If an element (i.e. the X and Y position of a pixel) is present in the vector,
-     *  this indicates that the corresponding pixel was marked "hot"
+    //! Hot pixels of all the sensors
+    /*! One bitmap per sensor, a pixel is hot if its bit is set.
      */
-    std::map<int, std::vector<std::pair<short, short> > > _hotPixelMap;
+    EUTelHotPixelMap _hotPixelMap;
  
     //! How many events are needed to get reasonable correlation plots 
     /*! (and Offset DB values) 
@@ -23,6 +23,7 @@
 #include "TProfile2D.h"
 #include "cluster.h"
 #include "CrossSection.hpp"
+#include "EUTelHitMatcher.h"
 
 class EUTelProcessorAnalysisPALPIDEfs : public marlin::Processor {
 public:
@@ -94,6 +95,7 @@ protected:
   double dutZ;
   FloatVec chi2Max;
   std::vector<Cluster> clusterVec;
+  std::unordered_map<std::string,int> clusterShapeIndex;
   std::map<int,int> xPairs;
   std::map<int,int> yPairs;
   std::vector< std::vector<int> > symmetryGroups;
@@ -125,6 +127,11 @@ private:
   int nPlanesWithTooManyHits;
   std::vector<int> noiseMaskX;
   std::vector<int> noiseMaskY;
+  // Pixel centres of the hot pixels, the noise mask and the dead
+  // columns, binned once for the per track vetoes
+  eutelescope::EUTelHitMatcher hotPixelMatcher;
+  eutelescope::EUTelHitMatcher noiseMaskMatcher;
+  eutelescope::EUTelHitMatcher deadColumnMatcher;
   double xZero;
   double yZero;
   double xPitch;
@@ -14,6 +14,7 @@
 #ifdef USE_GEAR
 
 // eutelescope includes ".h"
+#include "EUTelAlignmentTransforms.h"
 #include "EUTelUtility.h"
 #include "EUTelEventImpl.h"
 
@@ -37,6 +38,7 @@
 #include <IMPL/LCCollectionVec.h>
 
 // system includes <>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -82,6 +84,32 @@ namespace eutelescope {
 		std::string _hitCollectionNameOutput;
 		bool _undoAlignment;
 
+		//! Take the transform of a sensor from the geometry
+		void setSensorTransform(int sensorID);
+
+		//! Local to global transform of every sensor, global to local with _undoAlignment
+		/*! Read from the geometry on the first hit of the sensor in a run. */
+		EUTelAlignmentTransforms _transforms;
+
+		//! Sensor ID, properties, position and covariance of the input hits
+		std::vector<int> _hitSensorID;
+		std::vector<int> _hitProperties;
+		std::vector<double> _hitX;
+		std::vector<double> _hitY;
+		std::vector<double> _hitZ;
+		std::vector<float> _hitCov;
+
+		//! Transformed position and covariance of the input hits
+		std::vector<double> _outputX;
+		std::vector<double> _outputY;
+		std::vector<double> _outputZ;
+		std::vector<float> _outputCov;
+		EVENT::FloatVec _covMatrix;
+
+		//! Number of hits transformed and time spent, for the rate printed at the end
+		uint64_t _nHitsTransformed;
+		double _transformTime;
+
 	};//close class declaration
 
   //! A global instance of the processor
@@ -8,6 +8,7 @@
 #include <IMPL/TrackerDataImpl.h>
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelEventImpl.h"
+#include "EUTelOccupancyCounter.h"
 #include <UTIL/LCTime.h>
 #include <UTIL/CellIDEncoder.h>
 
@@ -39,6 +40,7 @@ private:
   std::vector<int> _yPixel;
   int _nEvent;
   std::vector<std::vector<bool> > isDead;
+  std::vector<eutelescope::EUTelOccupancyCounter16> _occupancy;
   std::map<int,TH2I*> hitMap;
 };
 #endif
@@ -5,6 +5,7 @@
 // C++
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 #include <cstdio>
@@ -34,6 +35,8 @@
 #include "EUTelTrack.h"
 #include "EUTelState.h"
 #include "EUTelReaderGenericLCIO.h"
+#include "EUTelTrackCache.h"
+#include "EUTelAlignmentCorrections.h"
 
 namespace eutelescope {
 
@@ -70,6 +73,24 @@ namespace eutelescope {
 				void printPointsInformation(std::vector<gbl::GblPoint>& pointList);
 				double printSize(const std::string& address);
 
+				/** Fit a track with GBL and write it to the mille binary */
+				void writeTrackToMille(EUTelTrack& track);
+
+				/** Iterate realign/refit/solve on the track cache until the corrections converge */
+				void alignUsingTrackCache();
+
+				/** Check that pede gave corrections for every aligned sensor. Logs the missing ones */
+				bool hasAllCorrections(std::map<int, std::vector<double> > const & corrections, std::set<int> const & alignedSensors) const;
+
+				/** The local to global rotation of a sensor in the current geometry, 3x3 row by row */
+				void sensorRotation(int sensorID, double* rotation);
+
+				/** Add millepede corrections (local frame) to the geometry. Returns false if any correction is above the convergence tolerance */
+				bool applyAlignmentCorrections(std::map<int, std::vector<double> > const & corrections);
+
+				/** Write the alignment accumulated over all cache iterations to the LCIO constants file, in the local frames of the starting geometry */
+				void writeAccumulatedAlignmentConstants();
+
 		protected: 
 
 				std::string _milleBinaryFilename;
@@ -143,6 +164,30 @@ namespace eutelescope {
         FloatVec _SteeringyResolutions;
 
 	IntVec _excludePlanes;
+
+        /** Run the alignment iterations in-process on the cached track candidates */
+        bool _useTrackCache;
+
+        /** Binary file the track cache is written to (or read from) */
+        std::string _trackCacheFileName;
+
+        /** Take the track candidates from the cache file instead of the event input */
+        bool _readTrackCache;
+
+        /** Maximum number of realign/refit/solve iterations on the cache */
+        int _maxAlignmentIterations;
+
+        /** Convergence tolerance on the shifts [mm] */
+        double _shiftTolerance;
+
+        /** Convergence tolerance on the rotations [rad] */
+        double _rotationTolerance;
+
+        /** Cached track candidates */
+        EUTelTrackCache _trackCache;
+
+        /** Corrections summed over all cache iterations, per sensor */
+        EUTelAlignmentCorrections _accumulatedCorrections;
 };
 
     /** A global instance of the processor */
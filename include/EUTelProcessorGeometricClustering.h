@@ -36,6 +36,7 @@
 #include <string>
 #include <map>
 #include <cmath>
+#include <cstdint>
 #include <vector>
 
 namespace eutelescope {
@@ -159,7 +160,8 @@ public:
 
     //! Called after data processing.
     /*! This method is called when the loop on events is finished. It
-     *  prints only a goodbye message
+     *  prints the clusters found per detector and the number of hit
+     *  pixels clustered per second.
      */
     virtual void end();
 
@@ -345,6 +347,12 @@ private:
     
     //! pulse Collection 
     LCCollectionVec* _pulseCollectionVec;
+
+    //! Number of hit pixels clustered, for the rate printed in end()
+    uint64_t _nPixelsClustered;
+
+    //! Time spent in the clustering of the hit pixels [s]
+    double _clusteringTime;
   
 };
 
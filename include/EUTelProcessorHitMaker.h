@@ -13,6 +13,8 @@
 #ifdef USE_GEAR
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelClusterPositionBatch.h"
+#include "EUTelHotPixelMap.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -197,7 +199,9 @@ namespace eutelescope {
    *  collection.
    *
    *  @param EtaCollectionName A vector of strings with the name of
-   *  the eta collection along x and y.
+   *  the eta collection along x and y. The eta functions are read
+   *  once, on the first event, and resampled into dense lookup tables
+   *  (see EUTelEtaLookupTable).
    *
    *  @param EtaSwitch A boolean to switch on and off the eta
    *  corrections.
@@ -218,6 +222,15 @@ namespace eutelescope {
    *  "NxMPixel". This vector contains respectively the number of
    *  pixel along x and y to be used.
    *
+   *  @param EtaLookupSamples Number of equidistant samples of the
+   *  eta lookup tables.
+   *
+   *  Clusters made of EUTelGenericSparsePixel are not decoded one by
+   *  one: all clusters of a plane are collected into an
+   *  EUTelClusterBatch and their positions are computed with the
+   *  batch kernels in EUTelClusterPositionBatch.h before the hit
+   *  collection is written.
+   *
    *  @param Enable3DHisto This parameter can be use to enable /
    *  disable the filling of the density plot mentioned above. The
    *  reason for this is that such an histogram may require a huge
@@ -343,6 +356,27 @@ namespace eutelescope {
     //! Reference Hit file 
     std::string _referenceHitLCIOFile;
 
+    //! Eta correction switch
+    bool _etaSwitch;
+
+    //! Eta collection names along x and y
+    std::vector< std::string > _etaCollectionNames;
+
+    //! Center of gravity algorithm: "Full", "NPixel" or "NxMPixel"
+    std::string _cogAlgorithm;
+
+    //! Number of pixels used by the "NPixel" algorithm
+    int _nPixel;
+
+    //! Window size used by the "NxMPixel" algorithm
+    std::vector< int > _xyCluSize;
+
+    //! Number of samples in the eta lookup tables
+    int _etaLookupSamples;
+
+    //! Hot pixel collection the clusters are checked against, none if empty
+    std::string _hotPixelCollectionName;
+
 
   private:
 
@@ -442,6 +476,44 @@ namespace eutelescope {
 
    
     void DumpReferenceHitDB();
+
+    //! Build the eta lookup tables from the eta collections in the event
+    void loadEtaTables( LCEvent * event );
+
+    //! Build the hot pixel bitmaps from the hot pixel collection in the event
+    void loadHotPixelMap( LCEvent * event );
+
+    //! Batch position reconstruction
+    /*! All clusters made of EUTelGenericSparsePixel are grouped per
+     *  plane and their local position (in mm) is computed with the
+     *  batch kernels. @a hasPos is set for each cluster for which
+     *  @a xPos and @a yPos were filled, the other clusters are left to
+     *  the per cluster code in processEvent.
+     */
+    void reconstructBatchPositions( LCCollectionVec * pulseCollection, std::vector< double >& xPos,
+                                    std::vector< double >& yPos, std::vector< char >& hasPos );
+
+    //! Eta lookup tables along x and y keyed by sensorID
+    std::map< int, EUTelEtaLookupTable > _xEtaTables;
+    std::map< int, EUTelEtaLookupTable > _yEtaTables;
+
+    //! Eta tables have been looked up
+    bool _etaTablesLoaded;
+
+    //! Hot pixels the hits are flagged with
+    EUTelHotPixelMap _hotPixelMap;
+
+    //! Hot pixel collection has been looked up
+    bool _hotPixelMapLoaded;
+
+    //! Per plane cluster batches, reused from event to event
+    std::map< int, EUTelClusterBatch > _clusterBatches;
+
+    //! Per plane index of the batched clusters in the pulse collection
+    std::map< int, std::vector< int > > _clusterBatchIndices;
+
+    //! The per cluster code ignoring CoGAlgorithm and EtaSwitch has been reported
+    bool _warnedUnbatchedPosition;
  
   };
 
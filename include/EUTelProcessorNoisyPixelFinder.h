@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
 #include "EUTelGenericSparsePixel.h"
+#include "EUTelOccupancyCounter.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -65,6 +66,18 @@ struct sensor {
  *  @param ExcludedPlanes Planes to be excluded from processing
  *
  *  @param HotPixelCollectionName The name of the collection in the output file
+ *
+ *  @param UpdateFrequency If larger than zero, the firing frequencies are
+ *  evaluated every UpdateFrequency events while the NoOfEvents are being
+ *  collected, so that noisy pixels are known during the run
+ *
+ *  @param RunningMaskCollectionName If not empty, the noisy pixels found by
+ *  the last intermediate evaluation, and after NoOfEvents the final ones, are
+ *  added to every event as a transient collection of this name, in the same
+ *  format as the one written to the output file. Its "EvaluatedEvents"
+ *  parameter holds the number of events the mask is based on.
+ *  EUTelProcessorNoisyPixelRemover reads it with its RunningMaskCollectionName
+ *  parameter
  */
 class EUTelProcessorNoisyPixelFinder : public marlin::Processor {
 
@@ -125,6 +138,19 @@ public:
 
     //! HotPixelFinder
     void noisyPixelFinder(EUTelEventImpl *input);
+
+    //! Find the pixels above the firing frequency cut after @a nEvents events
+    void findNoisyPixels(int nEvents, std::map<int, std::vector<EUTelGenericSparsePixel>>& noisyPixelMap, bool verbose);
+
+    //! Find the noisy pixels of one sensor
+    template <typename Counter>
+    void findNoisyPixels(const Counter& hitCounter, int nEvents, std::vector<EUTelGenericSparsePixel>& noisyPixels, bool verbose);
+
+    //! Store the noisy pixels in a TrackerData collection, one element per sensor
+    void fillNoisyPixelCollection(LCCollectionVec* collection, std::map<int, std::vector<EUTelGenericSparsePixel>>& noisyPixelMap);
+
+    //! Adds the current noisy pixel map to the event as the running mask collection
+    void addRunningMask(LCEvent* event);
     
     //! Check call back
     /*! This method is called every event just after the processEvent
@@ -190,13 +216,19 @@ protected:
      */
     std::map<int, sensor> _sensorMap;
 
-    //! Map holding the 2D-"array" which counts the hits
-    /*! The key is the sensorID and the array is implemented as
-     *  a vector of vectors. They are resized initially so there 
-     *  is no real overhead with using std::vectors instead of
-     * arrays.
+    //! Maps holding the hit counters
+    /*! The key is the sensorID, the counter covers the full pixel
+     *  range of the sensor. Only one of the two maps is filled: the
+     *  16 bit counters are used when at most 65535 events are
+     *  counted. A pixel then only saturates if it shows up more than
+     *  once per event, and a saturated pixel still passes any firing
+     *  frequency cut below one.
      */
-    std::map<int, std::vector<std::vector<int>>> _hitVecMap;
+    std::map<int, EUTelOccupancyCounter16> _hitVecMap16;
+    std::map<int, EUTelOccupancyCounter> _hitVecMap;
+
+    //! True if the 16 bit hit counters are used
+    bool _narrowCounters;
     
     //! Map for storing the hot pixels in a std::vector as a value
     /*! The key is once again the sensorID.
@@ -228,6 +260,18 @@ protected:
 
     //! Flag which will be set once we're done finding noisy pixels
     bool _finished;
+
+    //! Number of events between intermediate evaluations, 0 to disable them
+    int _updateFrequency;
+
+    //! Name of the collection with the intermediate noisy pixels added to the events
+    std::string _runningMaskCollectionName;
+
+    //! Noisy pixels found by the last intermediate evaluation
+    std::map<int, std::vector<EUTelGenericSparsePixel>> _runningNoisyPixelMap;
+
+    //! Number of events the last intermediate evaluation was done on
+    int _runningMaskEvents;
 };
 
 //! A global instance of the processor
@@ -97,6 +97,12 @@ class EUTelProcessorNoisyPixelRemover : public marlin::Processor {
 	
 	//! Collection name for noisy pixel collection
 	std::string _noisyPixelCollectionName; 
+
+	//! Collection name of the running mask of EUTelProcessorNoisyPixelFinder, read every event
+	std::string _runningMaskCollectionName;
+
+	//! EvaluatedEvents of the running mask currently in use
+	int _runningMaskEvents;
 	
 	std::map<int, std::vector<int>> _noisyPixelMap;
 	bool _firstEvent = true;
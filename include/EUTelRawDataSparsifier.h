@@ -16,8 +16,14 @@
 #include "marlin/Processor.h"
 
 // lcio includes <.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <IMPL/TrackerRawDataImpl.h>
+#include <LCIOSTLTypes.h>
+#include <EVENT/LCParameters.h>
 
 // system includes <>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 
@@ -189,7 +195,7 @@ namespace eutelescope {
 
     //! Called after data processing.
     /*! This method is called when the loop on events is finished. It
-     *  prints only a goodbye message
+     *  prints the number of pixels zero suppressed per second.
      */
     virtual void end();
 
@@ -257,11 +263,57 @@ namespace eutelescope {
 
   private:
 
+    //! Per pixel thresholds of one detector
+    /*! SigmaCut times the noise, and +inf for the masked pixels, so
+     *  that the zero suppression is a single comparison per pixel.
+     *  The hit and missing marks the clustering sets in the status
+     *  from event to event are not part of them, the status of the
+     *  pixels above threshold is checked for every event. The
+     *  thresholds are recomputed when the noise or status element,
+     *  the EUTELESCOPE::NOISEUPDATECOUNT of the noise or the LCCD
+     *  validity (DBSince) of either collection changes, and for every
+     *  run.
+     */
+    struct Thresholds {
+      Thresholds(): noise(0), updateCount(0), noiseValidSince(), status(0), statusValidSince(), sigmaCut(0), values() {}
+      const IMPL::TrackerDataImpl* noise;
+      int updateCount;
+      std::string noiseValidSince;
+      const IMPL::TrackerRawDataImpl* status;
+      std::string statusValidSince;
+      float sigmaCut;
+      std::vector<float> values;
+    };
+
+    //! Update the thresholds of a detector if its noise or status changed
+    void updateThresholds(Thresholds& thresholds, const IMPL::TrackerDataImpl* noise, const EVENT::LCParameters& noiseParameters,
+                          const IMPL::TrackerRawDataImpl* status, const EVENT::LCParameters& statusParameters,
+                          float sigmaCut, std::size_t nPixels);
+
+    //! Zero suppress a full frame into generic sparse pixels
+    /*! The frame is processed row by row and each row in blocks whose
+     *  comparisons are vectorised; the good pixels above threshold
+     *  are appended to @a sparse as (x, y, signal, time), the layout of
+     *  EUTelGenericSparsePixel, without building pixel objects.
+     */
+    static void sparsifyFrame(const EVENT::ShortVec& raw, const EVENT::FloatVec& pedestal,
+                              const std::vector<float>& threshold, const EVENT::ShortVec& status,
+                              int xMin, int yMin, int xNoOfPixel, EVENT::FloatVec& sparse);
+
     //! Number of detector planes in the run
     /*! This is the total number of detector saved into this input
      *  file
      */
     size_t _noOfDetector;
+
+    //! Thresholds of every detector, in the order of the input collection
+    std::vector<Thresholds> _thresholdsVec;
+
+    //! Number of pixels zero suppressed, for the throughput printed in end()
+    uint64_t _nPixelsProcessed;
+
+    //! Time spent in sparsifyFrame in seconds
+    double _sparsifyTime;
   };
 
   //! A global instance of the processor
@@ -38,13 +38,32 @@
 
 namespace eutelescope {
 
+	/** @class EUTelReaderGenericLCIO
+	 * Writes and reads EUTelTrack collections to/from LCIO.
+	 *
+	 * Tracks are stored packed: one LCGenericObject per event holding all track, state and hit
+	 * values in a flat double array and the offset tables in the int array:
+	 *
+	 *   ints:    version, nTracks, nStates, nHits, track stride, state stride, hit stride,
+	 *            first state of each track (nTracks+1 entries),
+	 *            hit index of each state (nStates entries, -1 if the state has no hit)
+	 *   doubles: all tracks, then all states, then all hits, each with a fixed stride
+	 *
+	 * Files written with the older layout (separate track/state/hit objects linked by
+	 * LCRelations) are still read.
+	 */
 	class  EUTelReaderGenericLCIO{
 		public: 
 			EUTelReaderGenericLCIO();
-            void getColVec( std::vector<EUTelTrack> tracks,LCEvent* evt,std::string colName );
+            void getColVec( std::vector<EUTelTrack>& tracks,LCEvent* evt,std::string colName );
             std::vector<EUTelTrack> getTracks( LCEvent* evt, std::string colName);
 
+            /** Version of the packed layout */
+            static const int PACKEDVERSION = 1;
+
   	private:
+            std::vector<EUTelTrack> getTracksPacked( EVENT::LCCollection* col );
+            std::vector<EUTelTrack> getTracksFromRelations( LCEvent* evt, std::string colName );
 	};
 
 }
@@ -0,0 +1,65 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELREFERENCELINEMATCHER_H
+#define EUTELREFERENCELINEMATCHER_H
+
+// system includes <>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Matches lines through two reference plane hits to DUT hits
+  /*! A line through a first and a second reference plane hit matches
+   *  a DUT hit if, at the z of the DUT hit, its known coordinate is
+   *  closer than the maximum residual to the one of the DUT hit:
+   *  |x1 + (x2-x1)*(zDut-z1)/(z2-z1) - xDut| < maxResidual
+   *
+   *  Solved for x2 this is a window x2 = x1 + (p-x1)*s, with p within
+   *  the maximum residual of xDut and s=(z2-z1)/(zDut-z1), bounded by
+   *  the z range of the second reference plane hits. The second plane
+   *  hits are sorted by the known coordinate once per event and only
+   *  those inside the window are tried, with the test above. If the
+   *  window is unbounded, because the DUT hit or a second plane hit
+   *  is at the z of the first plane hit, all of them are tried.
+   */
+  class EUTelReferenceLineMatcher {
+
+  public:
+    EUTelReferenceLineMatcher();
+
+    //! Set the second reference plane hits of the event
+    /*! @param positions the (x, y, z) position of every hit, they
+     *  must stay valid until the next call
+     *  @param knownHitPos the index of the known coordinate, 0 or 1
+     */
+    void setSecondPlaneHits(const std::vector<const double*>& positions, unsigned int knownHitPos);
+
+    //! Append the matching second plane and DUT hit index pairs of a first plane hit
+    /*! The pairs are appended in increasing order of the second plane
+     *  hit and then of the DUT hit.
+     */
+    void findPairs(const double* firstPlaneHitPos, const std::vector<const double*>& dutHitPositions, double maxResidual,
+                   std::vector<std::pair<unsigned int, unsigned int> >& pairs) const;
+
+  private:
+    std::vector<const double*> _positions;
+
+    unsigned int _knownHitPos;
+
+    //! z range of the second plane hits
+    double _minZ;
+    double _maxZ;
+
+    //! Known coordinate and index of the second plane hits, sorted by the coordinate
+    std::vector<std::pair<double, unsigned int> > _sorted;
+  };
+
+}
+#endif
@@ -0,0 +1,79 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSEEDFINDER_H
+#define EUTELSEEDFINDER_H
+
+// lcio includes <.h>
+#include <LCIOSTLTypes.h>
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Seed candidates and clustered pixels of one NZS frame
+  /*! Used by the fixed frame clustering algorithms of
+   *  EUTelClusteringProcessor. The frame is scanned in blocks: a block
+   *  is first tested as a whole, with a loop the compiler vectorises,
+   *  and only the few blocks containing a candidate are compressed
+   *  into the list of candidate indices. The candidates are then
+   *  ordered as a heap, so that the next seed costs a logarithmic
+   *  number of steps and nothing is sorted beyond the seeds taken.
+   *
+   *  The pixels added to a cluster are kept in a bitmap owned by the
+   *  finder instead of being written as HITPIXEL into the status
+   *  matrix, so the status matrix stays as read from the database.
+   */
+  class EUTelSeedFinder {
+
+  public:
+    EUTelSeedFinder();
+
+    //! Collect the seed candidates of a frame
+    /*! A pixel is a candidate if its status is GOODPIXEL and its
+     *  signal exceeds @a seedCut times its noise. The three vectors
+     *  have the same size. The clustered pixels are reset.
+     */
+    void findCandidates(const EVENT::FloatVec& signal, const EVENT::FloatVec& noise,
+                        const EVENT::ShortVec& status, float seedCut);
+
+    //! The candidates as (signal, pixel index), in no particular order
+    const std::vector<std::pair<float, unsigned int> >& getCandidates() const { return _candidates; }
+
+    //! Take the candidate with the largest signal
+    /*! Ties are taken by decreasing pixel index, the order of a
+     *  reversed std::sort of the candidates.
+     *
+     *  @return false if there are no more candidates
+     */
+    bool nextSeed(unsigned int& index);
+
+    bool isClustered(unsigned int index) const {
+      return index < _nPixels && ( ( _clustered[ index >> 6 ] >> ( index & 63 ) ) & 1 );
+    }
+
+    void markClustered(unsigned int index);
+
+  private:
+    //! Clear the bits set during the previous frame and fit the bitmap to @a nPixels
+    void resetClustered(std::size_t nPixels);
+
+    std::vector<std::pair<float, unsigned int> > _candidates;
+    bool _isHeap;
+    std::size_t _nPixels;
+    std::vector<uint64_t> _clustered;
+    //! Words of _clustered with at least one bit set
+    std::vector<std::size_t> _dirtyWords;
+  };
+
+}
+#endif
@@ -0,0 +1,97 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSTRAIGHTLINEFITTER_H
+#define EUTELSTRAIGHTLINEFITTER_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Analytic straight line fit of many track candidates together
+  /*! The fit of EUTelMille::FitTrack (Blobel, page 162): x and y are
+   *  fitted independently against z, each hit weighted by the
+   *  resolution of its plane. The line is fitted to the planes not
+   *  excluded and the residuals are computed on all of them.
+   *
+   *  setPlanes() fixes the resolutions and the excluded planes and
+   *  computes what depends on them only. fit() then runs over the
+   *  candidates in blocks of a fixed number of tracks, with the planes
+   *  in the outer loop and the tracks of a block in the inner one, so
+   *  that the compiler vectorises it. The positions are given plane by
+   *  plane: the hit of track t on plane p is x[p * nTracks + t].
+   *
+   *  Every track goes through the same operations as in FitTrack,
+   *  single precision sums included, and gets the same results.
+   */
+  class EUTelStraightLineFitter {
+
+  public:
+    EUTelStraightLineFitter();
+
+    //! Set the plane resolutions and the planes left out of the fit
+    /*! @param xResolution the @a nPlanes resolutions in x
+     *  @param yResolution the @a nPlanes resolutions in y
+     *  @param excludedPlanes the indices of the planes not fitted
+     */
+    void setPlanes(std::size_t nPlanes, const double* xResolution, const double* yResolution,
+                   const std::vector<unsigned int>& excludedPlanes);
+
+    //! Fit @a nTracks candidates, their positions stored plane by plane
+    void fit(std::size_t nTracks, const double* x, const double* y, const double* z);
+
+    std::size_t getNumberOfTracks() const { return _nTracks; }
+
+    double getChi2X(std::size_t track) const { return _chi2X[track]; }
+    double getChi2Y(std::size_t track) const { return _chi2Y[track]; }
+
+    //! The fitted line on a plane minus the hit
+    double getResidualX(std::size_t track, std::size_t plane) const { return _residualX[plane * _nTracks + track]; }
+    double getResidualY(std::size_t track, std::size_t plane) const { return _residualY[plane * _nTracks + track]; }
+
+    //! The fitted line at @a z
+    double getFitX(std::size_t track, double z) const { return _offsetX[track] + z * _slopeX[track]; }
+    double getFitY(std::size_t track, double z) const { return _offsetY[track] + z * _slopeY[track]; }
+
+    //! Angle of the line to the z axis in the xz and yz planes
+    double getAngleX(std::size_t track) const { return _angleX[track]; }
+    double getAngleY(std::size_t track) const { return _angleY[track]; }
+
+  private:
+    std::size_t _nPlanes;
+
+    //! 1 for the planes in the fit, 0 for the excluded ones
+    std::vector<char> _fitted;
+
+    //! Squared resolutions of the planes
+    std::vector<double> _xResolution2;
+    std::vector<double> _yResolution2;
+
+    //! Sums of the weights of the fitted planes
+    float _xWeightSum;
+    float _yWeightSum;
+
+    std::size_t _nTracks;
+
+    //! Results of the last fit; the residuals plane by plane like the positions
+    std::vector<double> _chi2X;
+    std::vector<double> _chi2Y;
+    std::vector<float> _offsetX;
+    std::vector<float> _offsetY;
+    std::vector<float> _slopeX;
+    std::vector<float> _slopeY;
+    std::vector<double> _angleX;
+    std::vector<double> _angleY;
+    std::vector<double> _residualX;
+    std::vector<double> _residualY;
+  };
+
+}
+#endif
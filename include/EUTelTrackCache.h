@@ -0,0 +1,103 @@
+#ifndef EUTELTRACKCACHE_H
+#define	EUTELTRACKCACHE_H
+
+#include "EUTelUtility.h"
+#include "EUTelTrack.h"
+#include "EUTelState.h"
+#include "EUTelHit.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+
+// system includes <>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace eutelescope {
+
+	/** @class EUTelTrackCache
+	 * Compact in-memory store of the track candidates used for alignment.
+	 *
+	 * Each track is kept as a flat record: the measured hits in the local frame
+	 * of their sensor (these do not change with alignment) and, for each state,
+	 * the reference point and direction in the global frame. When a track is
+	 * rebuilt the local state parameters are recomputed from the global
+	 * reference with the current geometry. This allows a realign/refit/solve
+	 * loop to run on the cache without rereading the LCIO input or redoing the
+	 * pattern recognition.
+	 *
+	 * The cache can be written to and read back from a versioned binary file.
+	 */
+	class EUTelTrackCache {
+
+		public:
+			/** Per state record */
+			struct CachedState {
+				int32_t location;
+				int32_t dimension;
+				int32_t hitID;
+				int32_t hasHit;
+				/** Hit position in the local frame */
+				double hitPos[3];
+				/** Reference point in the local frame at caching time */
+				float localPos[3];
+				/** Local momentum at caching time */
+				float localMom[3];
+				/** Reference point in the global frame */
+				double globalPos[3];
+				/** Momentum in the global frame */
+				double globalMom[3];
+				/** Combined hit and state covariance in the local frame */
+				float cov[4];
+				float kinks[2];
+				float kinksMedium1[2];
+				float kinksMedium2[2];
+				float arcLength;
+				float radFracSensor;
+				float radFracAir;
+			};
+
+			/** Per track record, states are stored contiguously */
+			struct CachedTrack {
+				float chi2;
+				float ndf;
+				double var;
+				uint32_t firstState;
+				uint32_t nStates;
+			};
+
+			EUTelTrackCache();
+
+			/** Store a track. Global references are computed with the current geometry. */
+			void addTrack(EUTelTrack& track);
+
+			/** Rebuild track i with local states recomputed from the current geometry */
+			EUTelTrack getTrack(size_t i) const;
+
+			size_t getNumberOfTracks() const { return _tracks.size(); }
+			size_t getNumberOfStates() const { return _states.size(); }
+
+			/** IDs of the sensors with at least one cached hit */
+			std::set<int> getSensorsWithHits() const;
+
+			void clear();
+
+			/** Write the cache to a binary file. Throws lcio::Exception on failure. */
+			void write(const std::string& fileName) const;
+
+			/** Read a cache from a binary file, replacing the current content.
+			 * Throws lcio::Exception if the file is missing, of an unknown version,
+			 * or if its sizes and state ranges are not consistent.
+			 */
+			void read(const std::string& fileName);
+
+			/** Format version stored in the file header */
+			static const uint32_t VERSION = 1;
+
+		private:
+			std::vector<CachedTrack> _tracks;
+			std::vector<CachedState> _states;
+	};
+
+}
+#endif
@@ -0,0 +1,93 @@
+#ifndef EUTelUtilityInstrumentation_h
+#define EUTelUtilityInstrumentation_h 1
+
+// C++
+#include <string>
+
+// LCIO
+#include "lcio.h"
+
+// Marlin
+#include "marlin/Processor.h"
+
+
+namespace eutelescope {
+
+  /**  Instrumentation point of a processor chain, see EUTelInstrumentation.
+   *
+   *   Put one instance at the beginning of the chain and one after every
+   *   processor (or group of processors) to be measured. Every instance
+   *   records the wall and CPU time, the heap allocations and the
+   *   collections added since the previous instance, i.e. by the
+   *   processors in between. The first instance only starts the
+   *   measurement. A summary table is printed at the end of the job and
+   *   written as JSON if one instance sets OutputFile.
+   *
+   *   Example:
+   *   @code
+   *   <execute>
+   *     <processor name="StartTimer"/>
+   *     <processor name="Clustering"/>
+   *     <processor name="ClusteringTimer"/>
+   *     <processor name="HitMaker"/>
+   *     <processor name="HitMakerTimer"/>
+   *   </execute>
+   *   @endcode
+   *
+   *   @parameter Section Name of the measured section, the processor name if empty
+   *
+   *   @parameter OutputFile Name of the JSON summary
+   * 
+   */
+  class EUTelUtilityInstrumentation : public marlin::Processor {
+	
+  public:
+	
+    /* This method will be called by the marlin package
+     * It returns a processor of the currend type
+     */
+    virtual Processor*  newProcessor() { 
+      return new EUTelUtilityInstrumentation;
+    }
+
+    /* the default constructor
+     * here the processor parameters are registered to the marlin package
+     * other initialisation should be placed in the init method
+     */
+    EUTelUtilityInstrumentation() ;
+	
+    /* Called at the beginning of the job before anything is read.
+     * Registers this instrumentation point
+     */
+    virtual void init() ;
+	
+    /* Called for every event.
+     * Records the section between the previous point and this one
+     */
+    virtual void processEvent( lcio::LCEvent * evt ) ; 
+	
+    /* Called after data processing.
+     * The last point prints and writes the summary
+     */
+    virtual void end() ;
+	
+	
+  protected:
+	
+    /// name of the measured section
+    std::string _section;
+
+    /// name of the JSON summary file
+    std::string _outputFile;
+
+    /// index of this point in the chain
+    size_t _point;
+
+  };
+  
+  //! A global instance of the processor
+  EUTelUtilityInstrumentation gEUTelUtilityInstrumentation;
+
+}
+
+#endif
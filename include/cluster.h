@@ -5,6 +5,8 @@
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <string>
+#include <unordered_map>
 
 class Cluster {
   public:
@@ -18,6 +20,17 @@ class Cluster {
     std::map<int,int> SymmetryPairs(std::vector<Cluster> clusterVec, const char* type);
     std::vector< std::vector<int> > sameShape(std::vector<Cluster> clusterVec);
     int WhichClusterShape(Cluster cluster, std::vector<Cluster> clusterVec);
+    // Canonical encoding of the shape: the bounding box width followed by the
+    // pixels as a bit mask of the box, row by row. Two clusters have the same
+    // key if and only if they are equal up to a translation (operator==).
+    std::string ShapeKey() const;
+    // The smallest ShapeKey of the cluster mirrored and rotated by 90 degrees,
+    // the same for all the clusters of a sameShape group
+    std::string SymmetricShapeKey() const;
+    // Map from ShapeKey to the index of the shape in clusterVec
+    std::unordered_map<std::string,int> ShapeIndex(const std::vector<Cluster> &clusterVec);
+    // Same as WhichClusterShape, looking the key up in the ShapeIndex of clusterVec
+    int WhichClusterShape(const Cluster &cluster, const std::unordered_map<std::string,int> &shapeIndex);
     std::vector<int> getX() {return x;}
     std::vector<int> getY() {return y;}
     int Size() {return size;}
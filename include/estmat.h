@@ -17,11 +17,9 @@
 #include <Eigen/LU>
 #include <Eigen/Cholesky>
 
-#if DOTHREAD
-#include <boost/thread.hpp>
-#include <boost/thread/detail/thread_group.hpp>
-#include <boost/bind.hpp>
-#endif
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "EUTelDafTrackerSystem.h"
 //#include "simutils.h"
@@ -90,6 +88,8 @@ public:
   void estToSystem( const gsl_vector* params, TrackerSystem<FITTERTYPE, 4>& system);
   void simplexSearch(Minimizer* minimizeMe, size_t iterations, int restarts, size_t itMax = 1000000);
   void quasiNewtonHomeMade(Minimizer* minimizeMe, int iterations);
+  void gradientSearch(Minimizer* minimizeMe, size_t iterations, size_t itMax = 1000000);
+  void gradient(Minimizer* minimizeMe, const gsl_vector* params, gsl_vector* grad, FITTERTYPE& value);
   
   int itMax;
   void readTrack(int track, TrackerSystem<FITTERTYPE,4>& system);
@@ -103,19 +103,31 @@ public:
 
 class Minimizer{
   bool inited;
+  //Worker pool, started once in init() and reused for every evaluation.
+  //Worker ii always fits the tracks ii, ii + nThreads, ..., the main
+  //thread takes offset 0.
+  std::vector<std::thread> workers;
+  std::mutex poolGuard;
+  std::condition_variable workReady, workDone;
+  size_t generation;
+  size_t nBusy;
+  bool stopping;
+  void workerLoop(size_t offset);
+  void stopWorkers();
 public:
   EstMat& mat;
   FITTERTYPE retVal2;
+  //Number of threads the tracks are split over, set before init(). SDR and
+  //FwBw compute their pull statistics per share of the tracks, so their
+  //values depend on it.
   size_t nThreads;
   FITTERTYPE result;
-#if DOTHREAD
-  boost::mutex resultGurad;
-#endif
+  std::mutex resultGurad;
   vector<TrackerSystem<FITTERTYPE, 4> > systems;
   
   //Minimizer(EstMat& mat) : mat(mat) {;}
-  Minimizer(EstMat& mat) : inited(false), mat(mat), nThreads(4) {;}
-  virtual ~Minimizer(){;};
+  Minimizer(EstMat& mat) : inited(false), generation(0), nBusy(0), stopping(false), mat(mat), nThreads(1) {;}
+  virtual ~Minimizer(){ stopWorkers(); };
 
   FITTERTYPE operator() (void);
   virtual void operator() (size_t offset, size_t stride) = 0;
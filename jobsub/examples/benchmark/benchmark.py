@@ -0,0 +1,221 @@
+#!/usr/bin/env python2
+"""
+benchmark: runs the EUTelescope reconstruction chain on deterministic
+synthetic data and appends the throughput and the peak memory of every
+stage to a results file, so that the performance of different revisions
+can be compared on the same machine. See the README in this directory.
+"""
+from __future__ import print_function
+
+import argparse
+import datetime
+import json
+import os
+import socket
+import subprocess
+import sys
+import time
+
+STAGES = ["converter", "clustering", "hitmaker", "align", "fitter"]
+
+# columns of the results file, new columns are only ever appended
+COLUMNS = ["date", "revision", "host", "label", "dataset", "stage", "section",
+           "events", "wall_s", "cpu_s", "events_per_s", "peak_rss_mb", "allocations_per_event", "status"]
+
+
+def findProgram(name, candidates):
+    """ Returns the first existing candidate path or the program found in PATH """
+    for candidate in candidates:
+        if candidate and os.path.isfile(candidate):
+            return candidate
+    for directory in os.environ.get("PATH", "").split(os.pathsep):
+        path = os.path.join(directory, name)
+        if os.path.isfile(path):
+            return path
+    return None
+
+
+def revision(path):
+    """ git revision of the EUTelescope source tree, 'unknown' if not available """
+    try:
+        with open(os.devnull, "w") as devnull:
+            return subprocess.check_output(["git", "describe", "--always", "--dirty"],
+                                           cwd=path, stderr=devnull).strip().decode()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def run(cmd, cwd, logfilename, env=None):
+    """ Runs cmd and returns (exit code, wall time, CPU time, peak RSS in MB)
+
+    The resource usage is taken from wait4(), it includes all the waited for
+    descendants of the process, i.e. the Marlin job started by jobsub.
+    """
+    with open(logfilename, "w") as logfile:
+        start = time.time()
+        process = subprocess.Popen(cmd, cwd=cwd, stdout=logfile, stderr=subprocess.STDOUT, env=env)
+        pid, status, usage = os.wait4(process.pid, 0)
+        wall = time.time() - start
+        process.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -os.WTERMSIG(status)
+    # ru_maxrss is in kB on Linux
+    return process.returncode, wall, usage.ru_utime + usage.ru_stime, usage.ru_maxrss / 1024.
+
+
+def instrumentation(filename):
+    """ Sections measured by the EUTelUtilityInstrumentation points of a stage """
+    try:
+        with open(filename) as jsonfile:
+            return json.load(jsonfile)
+    except (IOError, ValueError):
+        return None
+
+
+def geometryOptions(nPlanes, duts):
+    """ jobsub options depending on the number of planes of the synthetic telescope """
+    telescope = list(range(nPlanes))
+    dutIDs = [20 + i for i in range(len(duts))]
+    allPlanes = telescope[:nPlanes // 2] + dutIDs + telescope[nPlanes // 2:]
+    nAll = len(allPlanes)
+
+    def repeat(value, n):
+        return " ".join([value] * n)
+
+    return {
+        "TelescopePlanes": " ".join(map(str, telescope)),
+        "DutPlanes": " ".join(map(str, dutIDs)),
+        "AllPlanes": " ".join(map(str, allPlanes)),
+        "FixedPlanes": "%d %d" % (telescope[0], telescope[-1]),
+        "RequireNTelPlanes": str(nPlanes),
+        "ResidualsMax": repeat("5.", nAll),
+        "ResidualsMin": repeat("-5.", nAll),
+        "MilleResidualsMax": repeat("1500.", nPlanes),
+        "MilleResidualsMin": repeat("-1500.", nPlanes),
+        "MilleResolution": repeat("18", nPlanes),
+        "MilleResolutionZ": repeat("1000", nPlanes),
+    }
+
+
+def main(argv=None):
+    eutelescope = os.environ.get("EUTELESCOPE", os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "..", "..")))
+    basepath = os.path.dirname(os.path.abspath(__file__))
+
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--events", type=int, default=10000, help="Number of synthetic events")
+    parser.add_argument("--planes", type=int, default=6, help="Number of telescope planes")
+    parser.add_argument("--dut", default="", help="Comma separated DUT types, mimosa26 or fei4")
+    parser.add_argument("--tracks", type=float, default=1., help="Mean number of tracks per event")
+    parser.add_argument("--noise", type=float, default=1e-5, help="Noise occupancy per pixel and event")
+    parser.add_argument("--hotpixels", type=int, default=10, help="Number of hot pixels per plane")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed of the generator")
+    parser.add_argument("--run", type=int, default=1, help="Run number of the synthetic data")
+    parser.add_argument("--stages", default=",".join(STAGES), help="Comma separated stages to run, in the order of the chain")
+    parser.add_argument("--workdir", default="benchmark-work", help="Directory for the data, the steering files and the logs")
+    parser.add_argument("--results", default="benchmark-results.tsv", help="File the results are appended to")
+    parser.add_argument("--label", default="", help="Free text stored with the results, e.g. compiler flags")
+    parser.add_argument("--count-allocations", action="store_true", default=False,
+                        help="Preload libEUTelAllocationCounter.so to count the heap allocations per section")
+    parser.add_argument("--generator", default=None, help="Path of the syntheticdata executable, by default taken from $EUTELESCOPE/bin")
+    parser.add_argument("--keep-data", action="store_true", default=False,
+                        help="Reuse the synthetic data of a previous run with the same options")
+    args = parser.parse_args(argv)
+
+    stages = [stage for stage in args.stages.split(",") if stage]
+    for stage in stages:
+        if stage not in STAGES:
+            print("Unknown stage '%s', the stages are %s" % (stage, ", ".join(STAGES)), file=sys.stderr)
+            return 2
+
+    generator = findProgram("syntheticdata", [args.generator, os.path.join(eutelescope, "bin", "syntheticdata")])
+    jobsub = findProgram("jobsub.py", [os.path.join(eutelescope, "jobsub", "jobsub.py")])
+    if not generator or not jobsub:
+        print("syntheticdata or jobsub.py not found, please install EUTelescope and source build_env.sh", file=sys.stderr)
+        return 1
+
+    runnr = str(args.run).zfill(6)
+    workdir = os.path.abspath(args.workdir)
+    for subdir in ["data", "db", "results", "histo", "logs"]:
+        path = os.path.join(workdir, "output", subdir)
+        if not os.path.isdir(path):
+            os.makedirs(path)
+    datafile = os.path.join(workdir, "output", "data", "run%s-synthetic.slcio" % runnr)
+    gearfile = os.path.join(workdir, "output", "data", "run%s-gear.xml" % runnr)
+
+    # the dataset identifies results that can be compared
+    duts = [dut for dut in args.dut.split(",") if dut]
+    dataset = "events=%d planes=%d dut=%s tracks=%g noise=%g hotpixels=%d seed=%d" % (
+        args.events, args.planes, "+".join(duts) or "none", args.tracks, args.noise, args.hotpixels, args.seed)
+
+    stampfile = os.path.join(workdir, "output", "data", "run%s-dataset.txt" % runnr)
+    if not (args.keep_data and os.path.isfile(datafile) and os.path.isfile(stampfile) and open(stampfile).read() == dataset):
+        print("Generating " + dataset)
+        generatorcmd = [generator, "-o", datafile, "-g", gearfile, "-r", str(args.run), "-n", str(args.events),
+                        "-s", str(args.seed), "--planes", str(args.planes), "--tracks", repr(args.tracks),
+                        "--noise", repr(args.noise), "--hotpixels", str(args.hotpixels)]
+        if duts:
+            generatorcmd += ["--dut", ",".join(duts)]
+        returncode = run(generatorcmd, workdir, os.path.join(workdir, "output", "logs", "syntheticdata.log"))[0]
+        if returncode != 0:
+            print("syntheticdata failed, see " + os.path.join(workdir, "output", "logs", "syntheticdata.log"), file=sys.stderr)
+            return 1
+        with open(stampfile, "w") as stamp:
+            stamp.write(dataset)
+
+    env = dict(os.environ)
+    if args.count_allocations:
+        counter = findProgram("libEUTelAllocationCounter.so", [os.path.join(eutelescope, "lib", "libEUTelAllocationCounter.so")])
+        if not counter:
+            print("libEUTelAllocationCounter.so not found", file=sys.stderr)
+            return 1
+        env["LD_PRELOAD"] = counter
+
+    options = geometryOptions(args.planes, duts)
+    options["MaxRecordNumber"] = str(args.events + 1)
+    joboptions = []
+    for key in sorted(options):
+        joboptions += ["-o", "%s=%s" % (key, options[key])]
+
+    common = [datetime.datetime.now().strftime("%Y-%m-%dT%H:%M:%S"), revision(eutelescope),
+              socket.gethostname(), args.label.replace("\t", " "), dataset]
+    rows = []
+    for stage in stages:
+        print("Running " + stage)
+        cmd = [sys.executable, jobsub, "-c", os.path.join(basepath, "config.cfg"), "--plain"] + joboptions + [stage, str(args.run)]
+        logfilename = os.path.join(workdir, "output", "logs", "%s-%s.log" % (stage, runnr))
+        jsonfilename = os.path.join(workdir, "output", "results", "run%s-%s-instrumentation.json" % (runnr, stage))
+        if os.path.isfile(jsonfilename):
+            os.remove(jsonfilename)
+        returncode, wall, cpu, rss = run(cmd, workdir, logfilename, env)
+        status = "ok" if returncode == 0 else "failed"
+
+        summary = instrumentation(jsonfilename)
+        sections = summary["sections"] if summary else []
+        events = max([section["events"] for section in sections] or [args.events])
+
+        rows.append(common + [stage, "total", events, "%.3f" % wall, "%.3f" % cpu,
+                              "%.1f" % (events / wall if wall > 0 else 0.), "%.1f" % rss, "", status])
+        for section in sections:
+            allocations = ""
+            if summary.get("allocations_counted") and section["events"] > 0:
+                allocations = "%.1f" % (float(section["allocations_sum"]) / section["events"])
+            rows.append(common + [stage, section["name"], section["events"], "%.3f" % section["wall_sum"],
+                                  "%.3f" % section["cpu_sum"],
+                                  "%.1f" % (section["events"] / section["wall_sum"] if section["wall_sum"] > 0 else 0.),
+                                  "", allocations, status])
+
+        print("  %-10s %8.1f s %10.1f events/s %8.1f MB peak RSS  %s" % (stage, wall, events / wall if wall > 0 else 0., rss, status))
+        if returncode != 0:
+            print("  %s failed, see %s" % (stage, logfilename), file=sys.stderr)
+            break
+
+    newfile = not os.path.isfile(args.results)
+    with open(args.results, "a") as results:
+        if newfile:
+            results.write("# " + "\t".join(COLUMNS) + "\n")
+        for row in rows:
+            results.write("\t".join(map(str, row)) + "\n")
+    print("Results appended to " + args.results)
+
+    return 0 if all(row[-1] == "ok" for row in rows) else 1
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -183,8 +183,8 @@ def check_program(name):
         prog = os.path.join(dir, name)
         if os.path.exists(prog): return prog
 
-def runMarlin(filenamebase, jobtask, silent):
-    """ Runs Marlin and stores log of output """
+def runMarlin(filenamebase, jobtask, silent, env=None):
+    """ Runs Marlin and stores log of output; env replaces the environment of the Marlin process if given """
     from sys import exit # use sys.exit instead of built-in exit (latter raises exception)
     log = logging.getLogger('jobsub.' + jobtask)
 
@@ -229,7 +229,7 @@ def runMarlin(filenamebase, jobtask, silent):
         # run process
         log.info ("Now running Marlin on "+filenamebase+".xml")
         log.debug ("Executing: "+cmd)
-        p = Popen(shlex.split(cmd), stdout=PIPE, stderr=PIPE, bufsize=1, close_fds=ON_POSIX)
+        p = Popen(shlex.split(cmd), stdout=PIPE, stderr=PIPE, bufsize=1, close_fds=ON_POSIX, env=env)
         # setup output queues and threads
         qout = Queue()
         tout = Thread(target=enqueue_output, args=(p.stdout, qout))
@@ -407,6 +407,185 @@ def zipLogs(path, filename):
     except IOError: # could not create zip file - path non-existant?!
         log.error("Input/Output error: Could not create log and steering file archive ("+os.path.join(path, filename)+".zip"+")!")
 
+def shardOutputs(sstring):
+    """ Returns the file names in the steering string containing the @Shard@ placeholder, in order of appearance """
+    import re
+    outputs = list()
+    for token in re.findall(r"[^\s<>\"']*@Shard@[^\s<>\"']*", sstring, re.IGNORECASE):
+        if not token in outputs:
+            outputs.append(token)
+    return outputs
+
+def shardSteer(sstring, shard, nshards):
+    """ Fills the shard placeholders of the steering string for one shard (or for serial processing if nshards is 1) """
+    suffix = ""
+    if nshards > 1:
+        suffix = "-shard"+str(shard)
+    lastrange = "true" if shard == nshards-1 else "false"
+    for key, value in (("@Shard@", suffix), ("@RangeIndex@", str(shard)), ("@NumberOfRanges@", str(nshards)), ("@LastRange@", lastrange)):
+        try:
+            sstring = ireplace(key, value, sstring)
+        except EOFError:
+            pass # placeholders are optional for serial processing
+    return sstring
+
+def runShards(filenamebase, jobtask, silent, nshards):
+    """ Runs one Marlin process per shard in parallel and returns the list of their return codes """
+    import os
+    from threading import Thread
+    rcodes = [None]*nshards
+    def runShard(shard):
+        """ runs a single shard; Marlin output parsing is done by runMarlin """
+        # every shard writes and reads its own telescope geometry files in the common working directory
+        env = dict(os.environ)
+        env["EUTELESCOPE_GEOMETRY_SUFFIX"] = "-shard"+str(shard)
+        try:
+            rcodes[shard] = runMarlin(filenamebase+"-shard"+str(shard), jobtask+".shard"+str(shard), silent, env)
+        except SystemExit:
+            rcodes[shard] = 1
+    threads = [Thread(target=runShard, args=(shard,)) for shard in range(nshards)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return rcodes
+
+def mergeEventIndex(target, inputs, log):
+    """ Concatenates the event index files (see EUTelEventIndex) of the shards into the index of the merged LCIO file,
+    shifting the event positions by the number of events of the preceding shards; returns 0 on success """
+    import struct
+    magic = b"EUEI"
+    version = 1
+    entry = struct.Struct("=iiiIQII") # run, event, type, ordinal, occupancy, firstSize, nSizes
+    size = struct.Struct("=II") # collection, nElements
+    count = struct.Struct("=Q")
+    names = list()
+    entries = list()
+    sizes = list()
+    for filename in inputs:
+        try:
+            idxfile = open(filename, "rb")
+            try:
+                data = idxfile.read()
+            finally:
+                idxfile.close()
+            if data[0:4] != magic or struct.unpack_from("=I", data, 4)[0] != version:
+                log.error("Event index "+filename+" has an unknown format, no index is written for "+target)
+                return 1
+            pos = 8
+            nnames = count.unpack_from(data, pos)[0]
+            pos += count.size
+            shardnames = list()
+            for i in range(nnames):
+                length = struct.unpack_from("=I", data, pos)[0]
+                pos += 4
+                shardnames.append(data[pos:pos+length])
+                pos += length
+            # collection ids are positions in the name table of each file
+            remap = list()
+            for name in shardnames:
+                if not name in names:
+                    names.append(name)
+                remap.append(names.index(name))
+            nentries = count.unpack_from(data, pos)[0]
+            pos += count.size
+            shardentries = [list(entry.unpack_from(data, pos+i*entry.size)) for i in range(nentries)]
+            pos += nentries*entry.size
+            nsizes = count.unpack_from(data, pos)[0]
+            pos += count.size
+            if pos + nsizes*size.size != len(data):
+                log.error("Event index "+filename+" is truncated, no index is written for "+target)
+                return 1
+            eventoffset = len(entries)
+            sizeoffset = len(sizes)
+            for values in shardentries:
+                values[3] += eventoffset
+                values[5] += sizeoffset
+                entries.append(values)
+            for i in range(nsizes):
+                collection, nelements = size.unpack_from(data, pos+i*size.size)
+                sizes.append((remap[collection], nelements))
+        except (IOError, struct.error, IndexError):
+            log.error("Could not read event index "+filename+", no index is written for "+target)
+            return 1
+    idxfile = open(target, "wb")
+    try:
+        idxfile.write(magic + struct.pack("=I", version) + count.pack(len(names)))
+        for name in names:
+            idxfile.write(struct.pack("=I", len(name)) + name)
+        idxfile.write(count.pack(len(entries)))
+        for values in entries:
+            idxfile.write(entry.pack(*values))
+        idxfile.write(count.pack(len(sizes)))
+        for values in sizes:
+            idxfile.write(size.pack(*values))
+    finally:
+        idxfile.close()
+    log.info("Event index of "+str(len(entries))+" events written to "+target)
+    return 0
+
+def mergeShardOutputs(outputs, jobtask, nshards):
+    """ Merges the output files of all shards in shard order, i.e. in event order, and removes the shard files """
+    import os
+    import subprocess
+    log = logging.getLogger('jobsub.' + jobtask)
+    rcode = 0
+    for output in outputs:
+        target = ireplace("@Shard@", "", output)
+        inputs = [ireplace("@Shard@", "-shard"+str(shard), output) for shard in range(nshards)]
+        if target.endswith(".idx"):
+            # event index files with a name of their own (EventIndexFile)
+            indices = [filename for filename in inputs if os.path.isfile(filename)]
+            if indices:
+                if len(indices) == nshards and mergeEventIndex(target, indices, log) != 0:
+                    rcode = 1
+                for filename in indices:
+                    os.remove(filename)
+            continue
+        inputs = [filename for filename in inputs if os.path.isfile(filename)]
+        if not inputs:
+            log.debug("No shard output found for "+target)
+            continue
+        if target.endswith(".slcio"):
+            cmd = check_program("lcio_merge_files")
+            if not cmd:
+                log.error("lcio_merge_files executable not found in PATH! Shard outputs of "+target+" are kept")
+                rcode = 1
+                continue
+            cmd = [cmd, target] + inputs
+        elif target.endswith(".root"):
+            cmd = check_program("hadd")
+            if not cmd:
+                log.error("hadd executable not found in PATH! Shard outputs of "+target+" are kept")
+                rcode = 1
+                continue
+            cmd = [cmd, "-f", target] + inputs
+        else:
+            log.warning("Do not know how to merge "+target+", shard outputs are kept")
+            continue
+        log.info("Merging "+str(len(inputs))+" shard outputs into "+target)
+        log.debug("Executing: "+" ".join(cmd))
+        if os.path.isfile(target):
+            os.remove(target) # lcio_merge_files does not overwrite
+        if subprocess.call(cmd) == 0:
+            for filename in inputs:
+                os.remove(filename)
+            # event index files next to the shard outputs (WriteEventIndex)
+            indices = [filename+".idx" for filename in inputs if os.path.isfile(filename+".idx")]
+            if os.path.isfile(target+".idx") and not target+".idx" in [ireplace("@Shard@", "", name) for name in outputs]:
+                os.remove(target+".idx") # left from an earlier job, does not describe the merged file
+            if indices:
+                if len(indices) != len(inputs):
+                    log.error("Event index missing for some shard outputs of "+target+", no index is written")
+                    rcode = 1
+                elif mergeEventIndex(target+".idx", indices, log) != 0:
+                    rcode = 1
+                for filename in indices:
+                    os.remove(filename)
+        else:
+            log.error("Merging into "+target+" failed, shard outputs are kept")
+            rcode = 1
+    return rcode
 
 def main(argv=None):
     """  main routine of jobsub: a tool for EUTelescope job submission to Marlin """
@@ -464,6 +643,7 @@ def main(argv=None):
     parser.add_argument("--dry-run", action="store_true", default=False, help="Write steering files but skip actual Marlin execution")
     parser.add_argument("--subdir", action="store_true", default=False, help="Execute every job in its own subdirectory instead of all in the base path")
     parser.add_argument("--plain", action="store_true", default=False, help="Output written to stdout/stderr and log file in prefix-less format i.e. without time stamping")
+    parser.add_argument("-p", "--parallel", type=int, default=1, help="Split every run into N event ranges processed by N Marlin processes in parallel and merge their outputs; requires the template to use @RangeIndex@, @NumberOfRanges@ and @Shard@, and @LastRange@ for AppendEORE of the output processor", metavar="N")
     parser.add_argument("jobtask", help="Which task to submit (e.g. convert, hitmaker, align); task names are arbitrary and can be set up by the user; they determine e.g. the config section and default steering file names.")
     parser.add_argument("runs", help="The runs to be analyzed; can be a list of single runs and/or a range, e.g. 1056-1060.", nargs='*')
     parser.add_argument("-g", "--graphic", action="store_true", default=False)
@@ -510,6 +690,14 @@ def main(argv=None):
         log.error("No run numbers were specified. Please see '"+progName+" --help' for details.")
         return 2
 
+    if args.parallel < 1:
+        log.error("The number of parallel processes has to be at least 1!")
+        return 2
+
+    if args.parallel > 1 and (args.naf_file or args.lxplus_file):
+        log.error("Parallel processing is only supported when running Marlin locally!")
+        return 2
+
     if len(runs) > len(set(runs)): # sets items are unique
         log.error("At least one run is specified multiple times!")
         return 2
@@ -657,7 +845,19 @@ def main(argv=None):
             log.error("No reference to run number ('@RunNumber@') found in template file "+steeringTmpFileName)
             return 1
                 
-        if not checkSteer(steeringString):
+        # outputs to be merged, the placeholders are filled per shard below
+        outputs = shardOutputs(steeringString)
+        if args.parallel > 1:
+            if not outputs:
+                log.error("Parallel processing requires the @Shard@ placeholder in the output file names of template "+steeringTmpFileName)
+                return 1
+            if steeringString.lower().find("@rangeindex@") < 0 or steeringString.lower().find("@numberofranges@") < 0:
+                log.error("Parallel processing requires the @RangeIndex@ and @NumberOfRanges@ placeholders (EUTelIndexedLCIOReader) in template "+steeringTmpFileName)
+                return 1
+            if steeringString.lower().find("@lastrange@") < 0:
+                log.warning("No @LastRange@ placeholder (AppendEORE of EUTelOutputProcessor) in template "+steeringTmpFileName+": the merged LCIO files contain an EORE after every range, process them with SkipIntermediateEORE set to true")
+
+        if not checkSteer(shardSteer(steeringString, 0, args.parallel)):
             return 1
 
         if args.naf_file and args.lxplus_file:
@@ -686,18 +886,22 @@ def main(argv=None):
             savedPath = os.getcwd()
             os.chdir(basedirectory)
         
-        # Write the steering file:
+        # Write the steering file, one per shard if running in parallel:
         basefilename = args.jobtask+"-"+runnr
-        steeringFile = open(basefilename+".xml", "w")
-
-        try:
-            steeringFile.write(steeringString)
-        finally:
-            steeringFile.close()
+        if args.parallel > 1:
+            shardfilenames = [basefilename+"-shard"+str(shard) for shard in range(args.parallel)]
+        else:
+            shardfilenames = [basefilename]
+        for shard, shardfilename in enumerate(shardfilenames):
+            steeringFile = open(shardfilename+".xml", "w")
+            try:
+                steeringFile.write(shardSteer(steeringString, shard, args.parallel))
+            finally:
+                steeringFile.close()
 
         # bail out if running a dry run
         if args.dry_run:
-            log.info("Dry run: skipping Marlin execution. Steering file written to "+basefilename+'.xml')
+            log.info("Dry run: skipping Marlin execution. Steering file(s) written to "+', '.join(name+'.xml' for name in shardfilenames))
         elif args.naf_file:
             rcode = submitNAF(basefilename, args.jobtask, args.naf_file, runnr) # start NAF submission
             if rcode == 0:
@@ -710,6 +914,17 @@ def main(argv=None):
                 log.info("LXPLUS job submitted")
             else:
                 log.error("LXPLUS submission returned with error code "+str(rcode))
+        elif args.parallel > 1:
+            log.info("Running "+str(args.parallel)+" Marlin processes in parallel")
+            rcodes = runShards(basefilename, args.jobtask, args.silent, args.parallel) # start Marlin execution of all shards
+            if all(rcode == 0 for rcode in rcodes):
+                log.info("Marlin execution done")
+                if mergeShardOutputs(outputs, args.jobtask, args.parallel) != 0:
+                    log.error("Merging of the shard outputs failed")
+            else:
+                log.error("Marlin returned with error codes "+', '.join(map(str, rcodes))+"; shard outputs are not merged")
+            for shardfilename in shardfilenames:
+                zipLogs(parameters["logpath"], shardfilename)
         else:
             rcode = runMarlin(basefilename, args.jobtask, args.silent) # start Marlin execution
             if rcode == 0:
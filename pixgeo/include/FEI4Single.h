@@ -30,6 +30,11 @@ class FEI4Single : public EUTelGenericPixGeoDescr {
 		std::pair<int, int> getPixIndex(char const *);
 
 	protected:
+	  /** Creates the material and the volumes of the sensitive area, called by
+		* createRootDescr(), so that a description registered for a geometry
+		* read back from the cache creates no volumes */
+		void createPixelVolumes();
+
 		TGeoMaterial* matSi;
 		TGeoMedium* Si;
 		TGeoVolume* plane;
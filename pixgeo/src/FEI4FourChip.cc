@@ -6,7 +6,13 @@ namespace geo {
 
 FEI4FourChip::FEI4FourChip(): EUTelGenericPixGeoDescr(	40.4, 35.18, 0.025,	//size X, Y, Z
 							0, 159, 0, 671,		//min max X,Y
-							9.3660734 )		//rad length					
+							9.3660734 ),		//rad length
+	matSi(NULL),
+	Si(NULL),
+	plane(NULL)
+{}
+
+void FEI4FourChip::createPixelVolumes()
 {
 	//Create the material for the sensor
 	matSi = new TGeoMaterial( "Si", 28.0855 , 14.0, 2.33, -_radLength, 45.753206 );
@@ -48,6 +54,9 @@ FEI4FourChip::~FEI4FourChip()
 
 void  FEI4FourChip::createRootDescr(char const * planeVolume)
 {
+	//The pixel volumes are made once, on the first plane using this description
+	if( plane == NULL ) createPixelVolumes();
+
 	//Get the plane as provided by the EUTelGeometryTelescopeGeoDescription
 	TGeoVolume* topplane =_tGeoManager->GetVolume(planeVolume);
 	//Finaly add the sensitive area to the plane
@@ -5,7 +5,13 @@ namespace geo {
 
 FEI4Single::FEI4Single(): EUTelGenericPixGeoDescr(	20.30, 16.8, 0.025,	//size X, Y, Z
 							0, 79, 0, 335,		//min max X,Y
-							9.3660734 )		//rad length					
+							9.3660734 ),		//rad length
+	matSi(NULL),
+	Si(NULL),
+	plane(NULL)
+{}
+
+void FEI4Single::createPixelVolumes()
 {
 	//Create the material for the sensor
 	matSi = new TGeoMaterial( "Si", 28.0855 , 14.0, 2.33, -_radLength, 45.753206 );
@@ -29,7 +35,6 @@ FEI4Single::FEI4Single(): EUTelGenericPixGeoDescr(	20.30, 16.8, 0.025,	//size X,
 	plane->AddNode(centreregion, 1, new TGeoTranslation( 0.00 , 0 , 0) );
 	plane->AddNode(edgeregion,   1, new TGeoTranslation(-9.95 , 0 , 0) );
 	plane->AddNode(edgeregion,   2, new TGeoTranslation( 9.95 , 0 , 0) );
-
 }
 
 FEI4Single::~FEI4Single()
@@ -40,6 +45,9 @@ FEI4Single::~FEI4Single()
 
 void  FEI4Single::createRootDescr(char const * planeVolume)
 {
+	//The pixel volumes are made once, on the first plane using this description
+	if( plane == NULL ) createPixelVolumes();
+
 	//Get the plane as provided by the EUTelGeometryTelescopeGeoDescription
 	TGeoVolume* topplane =_tGeoManager->GetVolume(planeVolume);
 	//Finaly add the sensitive area to the plane
@@ -5,7 +5,13 @@ namespace geo {
 
 Mimosa26::Mimosa26(): EUTelGenericPixGeoDescr(	21.2, 10.6, 0.02,	//size X, Y, Z
 						0, 1151, 0, 575,	//min max X,Y
-						9.3660734 )		//rad length
+						9.3660734 ),		//rad length
+	matSi(NULL),
+	Si(NULL),
+	plane(NULL)
+{}
+
+void Mimosa26::createPixelVolumes()
 {
 	//Create the material for the sensor
 	matSi = new TGeoMaterial( "Si", 28.0855 , 14.0, 2.33, -_radLength, 45.753206 );
@@ -16,7 +22,6 @@ Mimosa26::Mimosa26(): EUTelGenericPixGeoDescr(	21.2, 10.6, 0.02,	//size X, Y, Z
 	//Divide the regions to create pixels
   	TGeoVolume* row = plane->Divide("mimorow", 1 , 1152 , 0 , 1, 0, "N"); 
 	row->Divide("mimopixel", 2 , 576, 0 , 1, 0, "N");
-
 }
 
 Mimosa26::~ Mimosa26()
@@ -28,6 +33,9 @@ Mimosa26::~ Mimosa26()
 
 void  Mimosa26::createRootDescr(char const * planeVolume)
 {
+	//The pixel volumes are made once, on the first plane using this description
+	if( plane == NULL ) createPixelVolumes();
+
 	//Get the plane as provided by the EUTelGeometryTelescopeGeoDescription
 	TGeoVolume* topplane =_tGeoManager->GetVolume(planeVolume);
 	//Add the sensitive area to the plane
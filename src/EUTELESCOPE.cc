@@ -13,16 +13,27 @@
 
 // system includes
 #include <algorithm>
+#include <cstdlib>
 #include <string>
 
 using namespace eutelescope;
 
-const std::string EUTELESCOPE::GEOFILENAME		= "telescope_geometry.root";
+namespace {
+	// Marlin processes running in the same directory at the same time (jobsub --parallel)
+	// get distinct geometry files through the EUTELESCOPE_GEOMETRY_SUFFIX environment variable
+	std::string geometryFileName( std::string const & base, std::string const & extension ) {
+		const char* suffix = std::getenv( "EUTELESCOPE_GEOMETRY_SUFFIX" );
+		return base + ( suffix != nullptr ? suffix : "" ) + extension;
+	}
+}
+
+const std::string EUTELESCOPE::GEOFILENAME		= geometryFileName( "telescope_geometry", ".root" );
 const bool EUTELESCOPE::DUMPGEOROOT				= true;
 
 const char *   EUTELESCOPE::HEADERVERSION       = "HeaderVersion";
 const char *   EUTELESCOPE::NOOFEVENT           = "NoOfEvent";
 const char *   EUTELESCOPE::DATATYPE            = "DataType";
+const char *   EUTELESCOPE::NOISEUPDATECOUNT    = "NoiseUpdateCount";
 const char *   EUTELESCOPE::DATETIME            = "DateTime";
 const char *   EUTELESCOPE::DAQHWNAME           = "DAQHWName";
 const char *   EUTELESCOPE::DAQHWVERSION        = "DAQHWVersion";
@@ -186,18 +186,18 @@ bool EUTelAPIXTbTrackTuple::readHits( std::string hitColName, LCEvent* event )
   	
 	int nHit = hitCollection->getNumberOfElements();
 	_nHits = nHit;
+
+	UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder ( EUTELESCOPE::HITENCODING );
  
   	for(int ihit=0; ihit< nHit ; ihit++)
        	{
     		TrackerHitImpl* meshit = dynamic_cast<TrackerHitImpl*>( hitCollection->getElementAt(ihit) ) ;
     		const double* pos = meshit->getPosition();	
-    		LCObjectVec clusterVec = (meshit->getRawHits());
 
-		UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder ( EUTELESCOPE::HITENCODING );
     		int sensorID = hitDecoder(meshit)["sensorID"];
 
-		//Only dump DUT hits
-		if( std::find( _DUTIDs.begin(), _DUTIDs.end(), sensorID) == _DUTIDs.end() )
+		//Only dump DUT hits, the sensor size map is filled for the DUTs only
+		if( _xSensSize.find(sensorID) == _xSensSize.end() )
 		{
 			continue;
 		}
@@ -256,11 +256,10 @@ bool EUTelAPIXTbTrackTuple::readTracks(LCEvent* event)
 			       	continue;
 		       	}
 
-     			UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder ( EUTELESCOPE::HITENCODING );
-      			int sensorID = hitDecoder(fittedHit)["sensorID"];
+      			int sensorID = hitCellDecoder(fittedHit)["sensorID"];
 
 			//Dump the (fitted) hits for the DUTs
-			if( std::find( _DUTIDs.begin(), _DUTIDs.end(), sensorID) == _DUTIDs.end() )
+			if( _xSensSize.find(sensorID) == _xSensSize.end() )
 			{
 				continue;
 			}
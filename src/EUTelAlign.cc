@@ -60,7 +60,11 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 using namespace std;
 using namespace marlin;
@@ -76,11 +80,191 @@ std::string EUTelAlign::_residualXLocalname            = "ResidualX";
 std::string EUTelAlign::_residualYLocalname            = "ResidualY";
 #endif
 
-void fitFunctionWrapper(Int_t &npar, Double_t *gin, Double_t &f, Double_t *par, Int_t iflag) {
-  EUTelAlign::Chi2Function(npar,gin,f,par,iflag);
+namespace {
+
+  //! Hit pairs per partial sum of the chi2
+  const size_t CHI2BLOCK = 4096;
+
+  //! Partial sums kept side by side, so that the compiler vectorises
+  const size_t CHI2LANES = 4;
+
+  //! Samples of fewer blocks are not worth starting threads for
+  const size_t MINBLOCKSPERTHREAD = 16;
+
+  //! Chi2 of the hit pairs [begin, end) for the rotation rot and the offsets
+  template<bool useCut>
+  double blockChi2(const EUTelAlign::FitData& data, size_t begin, size_t end,
+                   const double rot[4], double offX, double offY, double cut) {
+    const double * mx = &data.getMeasuredX()[0];
+    const double * my = &data.getMeasuredY()[0];
+    const double * px = &data.getPredictedX()[0];
+    const double * py = &data.getPredictedY()[0];
+
+    double acc[CHI2LANES] = { 0., 0., 0., 0. };
+    size_t i = begin;
+    for ( ; i + CHI2LANES <= end; i += CHI2LANES ) {
+      for ( size_t k = 0; k < CHI2LANES; ++k ) {
+        const double x = rot[0] * mx[i + k] + rot[1] * my[i + k] + offX;
+        const double y = rot[2] * mx[i + k] + rot[3] * my[i + k] + offY;
+        const double distance = ( ( x - px[i + k] ) * ( x - px[i + k] ) + ( y - py[i + k] ) * ( y - py[i + k] ) ) / 100;
+        acc[k] += ( !useCut || distance < cut ) ? distance : 0.;
+      }
+    }
+    double chi2 = ( acc[0] + acc[1] ) + ( acc[2] + acc[3] );
+    for ( ; i < end; ++i ) {
+      const double x = rot[0] * mx[i] + rot[1] * my[i] + offX;
+      const double y = rot[2] * mx[i] + rot[3] * my[i] + offY;
+      const double distance = ( ( x - px[i] ) * ( x - px[i] ) + ( y - py[i] ) * ( y - py[i] ) ) / 100;
+      if ( !useCut || distance < cut ) chi2 += distance;
+    }
+    return chi2;
+  }
+
+  //! Fill the partial sums of the blocks firstBlock, firstBlock + step, ...
+  void blocksChi2(const EUTelAlign::FitData& data, size_t firstBlock, size_t step,
+                  const double rot[4], double offX, double offY, double cut, vector<double>& partial) {
+    for ( size_t iBlock = firstBlock; iBlock < partial.size(); iBlock += step ) {
+      const size_t begin = iBlock * CHI2BLOCK;
+      const size_t end   = min( begin + CHI2BLOCK, data.size() );
+      partial[iBlock] = ( cut == 0.0 ) ?
+        blockChi2<false>( data, begin, end, rot, offX, offY, cut ) :
+        blockChi2<true>( data, begin, end, rot, offX, offY, cut );
+    }
+  }
+
+  //! TMinuit minimising the chi2 of a FitData
+  /*! TMinuit calls Eval() for every evaluation, so the fit data is
+   *  reached through the instance instead of a global.
+   */
+  class FitDataMinuit : public TMinuit {
+  public:
+    FitDataMinuit(const EUTelAlign::FitData& data) : TMinuit(6), _data(data) {}
+
+    virtual Int_t Eval(Int_t /* npar */, Double_t * /* grad */, Double_t &fval, Double_t *par, Int_t /* flag */) {
+      fval = _data.chi2(par);
+      return 0;
+    }
+
+  private:
+    const EUTelAlign::FitData& _data;
+  };
+}
+
+EUTelAlign::FitData::FitData() :
+  _measuredX(),
+  _measuredY(),
+  _predictedX(),
+  _predictedY(),
+  _workers(),
+  _mutex(),
+  _wake(),
+  _done(),
+  _partial(),
+  _generation(0),
+  _pending(0),
+  _stop(false)
+{}
+
+EUTelAlign::FitData::~FitData() {
+  stopThreads();
+}
+
+void EUTelAlign::FitData::add(const HitsForFit& hits) {
+  _measuredX.push_back( hits.secondLayerMeasuredX );
+  _measuredY.push_back( hits.secondLayerMeasuredY );
+  _predictedX.push_back( hits.secondLayerPredictedX );
+  _predictedY.push_back( hits.secondLayerPredictedY );
 }
 
-vector<EUTelAlign::HitsForFit > EUTelAlign::_hitsForFit;
+void EUTelAlign::FitData::clear() {
+  _measuredX.clear();
+  _measuredY.clear();
+  _predictedX.clear();
+  _predictedY.clear();
+}
+
+void EUTelAlign::FitData::startThreads() {
+  stopThreads();
+  const size_t nBlocks = ( size() + CHI2BLOCK - 1 ) / CHI2BLOCK;
+  const size_t nThreads = min<size_t>( thread::hardware_concurrency(), nBlocks / MINBLOCKSPERTHREAD );
+  _stop = false;
+  for ( size_t iThread = 1; iThread < nThreads; ++iThread ) {
+    _workers.push_back( thread( &FitData::work, this, iThread ) );
+  }
+}
+
+void EUTelAlign::FitData::stopThreads() {
+  {
+    lock_guard<mutex> lock( _mutex );
+    _stop = true;
+  }
+  _wake.notify_all();
+  for ( size_t iThread = 0; iThread < _workers.size(); ++iThread ) _workers[iThread].join();
+  _workers.clear();
+}
+
+void EUTelAlign::FitData::work(size_t iThread) {
+  unsigned long generation = 0;
+  while ( true ) {
+    {
+      unique_lock<mutex> lock( _mutex );
+      while ( !_stop && _generation == generation ) _wake.wait( lock );
+      if ( _stop ) return;
+      generation = _generation;
+    }
+    // _task and the size of _partial only change while no thread is pending
+    blocksChi2( *this, iThread, _workers.size() + 1, _task, _task[4], _task[5], _task[6], _partial );
+    {
+      lock_guard<mutex> lock( _mutex );
+      if ( --_pending == 0 ) _done.notify_one();
+    }
+  }
+}
+
+double EUTelAlign::FitData::chi2(const double* par) const {
+
+  // Parameters:
+  // par[0]:       off_x
+  // par[1]:       off_y
+  // par[2]:       theta_x
+  // par[3]:       theta_y
+  // par[4]:       theta_z
+  // par[5]:       cut on the distance, 0 for none
+
+  // the rotation is the same for all the hits, followed by off_x, off_y and the cut
+  const double task[7] = {
+    cos(par[3])*cos(par[4]),
+    (-1)*sin(par[2])*sin(par[3])*cos(par[4]) + cos(par[2])*sin(par[4]),
+    (-1)*cos(par[3])*sin(par[4]),
+    sin(par[2])*sin(par[3])*sin(par[4]) + cos(par[2])*cos(par[4]),
+    par[0],
+    par[1],
+    par[5]
+  };
+
+  const size_t nBlocks = ( size() + CHI2BLOCK - 1 ) / CHI2BLOCK;
+
+  if ( _workers.empty() ) {
+    _partial.assign( nBlocks, 0. );
+    blocksChi2( *this, 0, 1, task, task[4], task[5], task[6], _partial );
+  } else {
+    {
+      lock_guard<mutex> lock( _mutex );
+      copy( task, task + 7, _task );
+      _partial.assign( nBlocks, 0. );
+      _pending = _workers.size();
+      ++_generation;
+    }
+    _wake.notify_all();
+    blocksChi2( *this, 0, _workers.size() + 1, task, task[4], task[5], task[6], _partial );
+    unique_lock<mutex> lock( _mutex );
+    while ( _pending != 0 ) _done.wait( lock );
+  }
+
+  double chi2 = 0.0;
+  for ( size_t iBlock = 0; iBlock < nBlocks; ++iBlock ) chi2 += _partial[iBlock];
+  return chi2;
+}
 
 EUTelAlign::EUTelAlign () : Processor("EUTelAlign") {
 
@@ -707,7 +891,7 @@ void EUTelAlign::processEvent (LCEvent * event) {
             hitsForFit.firstLayerResolution = allHitsFirstLayerResolution[firsthit];
             hitsForFit.secondLayerResolution = allHitsSecondLayerResolution[take];
 
-            _hitsForFit.push_back(hitsForFit);
+            _fitData.add(hitsForFit);
 
           }
 
@@ -759,7 +943,7 @@ void EUTelAlign::processEvent (LCEvent * event) {
             hitsForFit.firstLayerResolution = allHitsFirstLayerResolution[firsthit];
             hitsForFit.secondLayerResolution = allHitsSecondLayerResolution[take];
 
-            _hitsForFit.push_back(hitsForFit);
+            _fitData.add(hitsForFit);
 
           }
 
@@ -769,7 +953,7 @@ void EUTelAlign::processEvent (LCEvent * event) {
 
     } // end if check number of hits
 
-      // _hitsForFit.push_back(hitsForFit);
+      // _fitData.add(hitsForFit);
 
   } catch (DataNotAvailableException& e) {
     streamlog_out  ( WARNING2 ) <<  "No input collection found on event " << event->getEventNumber() << " in run " << event->getRunNumber() << endl;
@@ -784,61 +968,13 @@ void EUTelAlign::processEvent (LCEvent * event) {
   streamlog_out ( MESSAGE2 ) << "Read event: " << _iEvt << endl;
   streamlog_out ( MESSAGE2 ) << "Number of hits in first plane: " << nHitsFirstPlane << endl;
   streamlog_out ( MESSAGE2 ) << "Number of hits in the last plane: " << nHitsSecondPlane << endl;
-  streamlog_out ( MESSAGE2 ) << "Hit pairs found so far: " << _hitsForFit.size() << endl;
-
-}
-
-void EUTelAlign::Chi2Function(Int_t &npar, Double_t *gin, Double_t &f, Double_t *par, Int_t iflag) {
-
-  // Chi2 function for Minuit
-  // ------------------------
-  //
-  // Parameters:
-  // par[0]:       off_x
-  // par[1]:       off_y
-  // par[2]:       theta_x
-  // par[3]:       theta_y
-  // par[4]:       theta_z
-
-  double x, y, distance;
-  double chi2 = 0.0;
-  int usedevents = 0;
-
-  // loop over all events
-  for (size_t i = 0; i < _hitsForFit.size(); i++) {
-
-    // just to be sure
-    distance = 0.0;
-
-    x = (cos(par[3])*cos(par[4])) * _hitsForFit[i].secondLayerMeasuredX + ((-1)*sin(par[2])*sin(par[3])*cos(par[4]) + cos(par[2])*sin(par[4])) * _hitsForFit[i].secondLayerMeasuredY + par[0];
-    y = ((-1)*cos(par[3])*sin(par[4])) * _hitsForFit[i].secondLayerMeasuredX + (sin(par[2])*sin(par[3])*sin(par[4]) + cos(par[2])*cos(par[4])) * _hitsForFit[i].secondLayerMeasuredY + par[1];
-
-    distance = ((x - _hitsForFit[i].secondLayerPredictedX) * (x - _hitsForFit[i].secondLayerPredictedX) + (y - _hitsForFit[i].secondLayerPredictedY) * (y - _hitsForFit[i].secondLayerPredictedY)) / 100;
-
-    // add chi2 cut here later?
-    if (par[5] == 0.0) {
-
-      chi2 = chi2 + distance;
-      usedevents++;
-
-    } else if (distance < par[5]) {
-
-      chi2 = chi2 + distance;
-      usedevents++;
-
-    }
-
-  } // end loop over all events
-
-  // streamlog_out ( MESSAGE2) << usedevents << " ";
-
-  f = chi2;
+  streamlog_out ( MESSAGE2 ) << "Hit pairs found so far: " << _fitData.size() << endl;
 
 }
 
 void EUTelAlign::end() {
 
-  streamlog_out ( MESSAGE2 ) << "Number of Events used in the fit: " << _hitsForFit.size() << endl;
+  streamlog_out ( MESSAGE2 ) << "Number of Events used in the fit: " << _fitData.size() << endl;
 
   streamlog_out ( MESSAGE2 ) << "Minuit will soon be started" << endl;
 
@@ -847,14 +983,14 @@ void EUTelAlign::end() {
 
   gSystem->Load("libMinuit");
 
-  // init Minuit for 6 parameters
-  TMinuit *gMinuit = new TMinuit(6);
+  // init Minuit for 6 parameters, it minimises _fitData.chi2
+  TMinuit *gMinuit = new FitDataMinuit(_fitData);
 
   // set print level (-1 = quiet, 0 = normal, 1 = verbose)
   gMinuit->SetPrintLevel(0);
 
-  // set function
-  gMinuit->SetFCN(fitFunctionWrapper);
+  // the threads computing the chi2 live as long as the fit
+  _fitData.startThreads();
 
   double arglist[10];
   int ierflag = 0;
@@ -915,10 +1051,10 @@ void EUTelAlign::end() {
   double residual_y_simple = 1000.0;
 
   // loop over all events
-  for (size_t i = 0; i < _hitsForFit.size(); i++) {
+  for (size_t i = 0; i < _fitData.size(); i++) {
 
-    residual_x_simple = off_x_simple + _hitsForFit[i].secondLayerMeasuredX - _hitsForFit[i].secondLayerPredictedX;
-    residual_y_simple = off_y_simple + _hitsForFit[i].secondLayerMeasuredY - _hitsForFit[i].secondLayerPredictedY;
+    residual_x_simple = off_x_simple + _fitData.getMeasuredX()[i] - _fitData.getPredictedX()[i];
+    residual_y_simple = off_y_simple + _fitData.getMeasuredY()[i] - _fitData.getPredictedY()[i];
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 
@@ -997,6 +1133,8 @@ void EUTelAlign::end() {
   gMinuit->GetParameter(3,theta_y,theta_y_error);
   gMinuit->GetParameter(4,theta_z,theta_z_error);
 
+  _fitData.stopThreads();
+
   streamlog_out ( MESSAGE2 ) << endl << "Alignment constants from the fit:" << endl;
   streamlog_out ( MESSAGE2 ) << "---------------------------------" << endl;
   streamlog_out ( MESSAGE2 ) << "off_x: " << off_x << " +/- " << off_x_error << endl;
@@ -1013,14 +1151,19 @@ void EUTelAlign::end() {
   double residual_x = 1000.0;
   double residual_y = 1000.0;
 
+  const double r00 = cos(theta_y)*cos(theta_z);
+  const double r01 = (-1)*sin(theta_x)*sin(theta_y)*cos(theta_z) + cos(theta_x)*sin(theta_z);
+  const double r10 = (-1)*cos(theta_y)*sin(theta_z);
+  const double r11 = sin(theta_x)*sin(theta_y)*sin(theta_z) + cos(theta_x)*cos(theta_z);
+
   // loop over all events
-  for (size_t i = 0; i < _hitsForFit.size(); i++) {
+  for (size_t i = 0; i < _fitData.size(); i++) {
 
-    x = (cos(theta_y)*cos(theta_z)) * _hitsForFit[i].secondLayerMeasuredX + ((-1)*sin(theta_x)*sin(theta_y)*cos(theta_z) + cos(theta_x)*sin(theta_z)) * _hitsForFit[i].secondLayerMeasuredY + off_x;
-    y = ((-1)*cos(theta_y)*sin(theta_z)) * _hitsForFit[i].secondLayerMeasuredX + (sin(theta_x)*sin(theta_y)*sin(theta_z) + cos(theta_x)*cos(theta_z)) * _hitsForFit[i].secondLayerMeasuredY + off_y;
+    x = r00 * _fitData.getMeasuredX()[i] + r01 * _fitData.getMeasuredY()[i] + off_x;
+    y = r10 * _fitData.getMeasuredX()[i] + r11 * _fitData.getMeasuredY()[i] + off_y;
 
-    residual_x = x - _hitsForFit[i].secondLayerPredictedX;
-    residual_y = y - _hitsForFit[i].secondLayerPredictedY;
+    residual_x = x - _fitData.getPredictedX()[i];
+    residual_y = y - _fitData.getPredictedY()[i];
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 
@@ -0,0 +1,75 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelAlignmentCorrections.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+namespace {
+  //! out = r v
+  void rotate(const double* r, const double* v, double* out) {
+    for ( int row = 0; row < 3; ++row ) out[row] = r[3 * row] * v[0] + r[3 * row + 1] * v[1] + r[3 * row + 2] * v[2];
+  }
+
+  //! out = r^T v
+  void rotateBack(const double* r, const double* v, double* out) {
+    for ( int col = 0; col < 3; ++col ) out[col] = r[col] * v[0] + r[3 + col] * v[1] + r[6 + col] * v[2];
+  }
+}
+
+EUTelAlignmentCorrections::EUTelAlignmentCorrections():
+  _sensors()
+{}
+
+void EUTelAlignmentCorrections::clear() {
+  _sensors.clear();
+}
+
+std::vector<int> EUTelAlignmentCorrections::getSensorIDs() const {
+  std::vector<int> sensorIDs;
+  sensorIDs.reserve( _sensors.size() );
+  for ( std::map<int, Sensor>::const_iterator it = _sensors.begin(); it != _sensors.end(); ++it ) sensorIDs.push_back( it->first );
+  return sensorIDs;
+}
+
+void EUTelAlignmentCorrections::add(int sensorID, const double* rotation, const double* local, double* global) {
+  std::map<int, Sensor>::iterator it = _sensors.find( sensorID );
+  if ( it == _sensors.end() ) {
+    Sensor sensor;
+    std::copy( rotation, rotation + 9, sensor.startRotation );
+    std::fill( sensor.total, sensor.total + 6, 0. );
+    it = _sensors.insert( std::make_pair( sensorID, sensor ) ).first;
+  }
+  rotate( rotation, local, global );
+  rotate( rotation, local + 3, global + 3 );
+  for ( int i = 0; i < 6; ++i ) it->second.total[i] += global[i];
+}
+
+void EUTelAlignmentCorrections::getGlobal(int sensorID, double* global) const {
+  std::map<int, Sensor>::const_iterator it = _sensors.find( sensorID );
+  if ( it == _sensors.end() ) {
+    std::fill( global, global + 6, 0. );
+    return;
+  }
+  std::copy( it->second.total, it->second.total + 6, global );
+}
+
+void EUTelAlignmentCorrections::getStartingLocal(int sensorID, double* local) const {
+  std::map<int, Sensor>::const_iterator it = _sensors.find( sensorID );
+  if ( it == _sensors.end() ) {
+    std::fill( local, local + 6, 0. );
+    return;
+  }
+  rotateBack( it->second.startRotation, it->second.total, local );
+  rotateBack( it->second.startRotation, it->second.total + 3, local + 3 );
+}
@@ -0,0 +1,237 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelAlignmentTransforms.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+namespace {
+  //! Hits transformed together, the trip count of the vectorised loop
+  const std::size_t TRANSFORMBLOCK = 8;
+
+  //! Apply the affine matrix m to N points
+  template <std::size_t N>
+  inline void transformBlock(const double* m, const double* x, const double* y, const double* z,
+                             double* xOut, double* yOut, double* zOut) {
+    double bx[N], by[N], bz[N];
+    for ( std::size_t i = 0; i < N; ++i ) {
+      bx[i] = m[0] * x[i] + m[1] * y[i] + m[2]  * z[i] + m[3];
+      by[i] = m[4] * x[i] + m[5] * y[i] + m[6]  * z[i] + m[7];
+      bz[i] = m[8] * x[i] + m[9] * y[i] + m[10] * z[i] + m[11];
+    }
+    std::copy( bx, bx + N, xOut );
+    std::copy( by, by + N, yOut );
+    std::copy( bz, bz + N, zOut );
+  }
+
+  //! Apply the affine matrix m to n points, in blocks of TRANSFORMBLOCK
+  void transformRange(const double* m, std::size_t n, const double* x, const double* y, const double* z,
+                      double* xOut, double* yOut, double* zOut) {
+    std::size_t i = 0;
+    for ( ; i + TRANSFORMBLOCK <= n; i += TRANSFORMBLOCK ) {
+      transformBlock<TRANSFORMBLOCK>( m, x + i, y + i, z + i, xOut + i, yOut + i, zOut + i );
+    }
+    for ( ; i < n; ++i ) {
+      transformBlock<1>( m, x + i, y + i, z + i, xOut + i, yOut + i, zOut + i );
+    }
+  }
+
+  //! C' = R C R^T for N symmetric matrices stored as six arrays (xx, yx, yy, zx, zy, zz)
+  template <std::size_t N>
+  inline void covarianceBlock(const double* r, const double* const* c, double* const* cOut) {
+    double out[6][N];
+    for ( std::size_t i = 0; i < N; ++i ) {
+      const double xx = c[0][i], yx = c[1][i], yy = c[2][i], zx = c[3][i], zy = c[4][i], zz = c[5][i];
+      // the rows of R C
+      const double a0 = r[0] * xx + r[1] * yx + r[2] * zx;
+      const double a1 = r[0] * yx + r[1] * yy + r[2] * zy;
+      const double a2 = r[0] * zx + r[1] * zy + r[2] * zz;
+      const double b0 = r[3] * xx + r[4] * yx + r[5] * zx;
+      const double b1 = r[3] * yx + r[4] * yy + r[5] * zy;
+      const double b2 = r[3] * zx + r[4] * zy + r[5] * zz;
+      const double c0 = r[6] * xx + r[7] * yx + r[8] * zx;
+      const double c1 = r[6] * yx + r[7] * yy + r[8] * zy;
+      const double c2 = r[6] * zx + r[7] * zy + r[8] * zz;
+      out[0][i] = a0 * r[0] + a1 * r[1] + a2 * r[2];
+      out[1][i] = b0 * r[0] + b1 * r[1] + b2 * r[2];
+      out[2][i] = b0 * r[3] + b1 * r[4] + b2 * r[5];
+      out[3][i] = c0 * r[0] + c1 * r[1] + c2 * r[2];
+      out[4][i] = c0 * r[3] + c1 * r[4] + c2 * r[5];
+      out[5][i] = c0 * r[6] + c1 * r[7] + c2 * r[8];
+    }
+    for ( int k = 0; k < 6; ++k ) std::copy( out[k], out[k] + N, cOut[k] );
+  }
+
+  //! c = a b for 3x3 matrices stored row by row
+  void multiply(const double* a, const double* b, double* c) {
+    for ( int row = 0; row < 3; ++row ) {
+      for ( int col = 0; col < 3; ++col ) {
+        c[3 * row + col] = a[3 * row] * b[col] + a[3 * row + 1] * b[3 + col] + a[3 * row + 2] * b[6 + col];
+      }
+    }
+  }
+}
+
+EUTelAlignmentTransforms::EUTelAlignmentTransforms():
+  _transforms(),
+  _hasTransform(),
+  _offset(),
+  _order(),
+  _in(),
+  _out()
+{}
+
+void EUTelAlignmentTransforms::clear() {
+  _transforms.clear();
+  _hasTransform.clear();
+}
+
+void EUTelAlignmentTransforms::setTransform(int sensorID, const double* rotation, const double* translation) {
+  if ( sensorID < 0 ) return;
+  if ( static_cast<std::size_t>(sensorID) >= _transforms.size() ) {
+    _transforms.resize( sensorID + 1 );
+    _hasTransform.resize( sensorID + 1, 0 );
+  }
+  double* m = _transforms[sensorID].m;
+  for ( int row = 0; row < 3; ++row ) {
+    m[4 * row]     = rotation[3 * row];
+    m[4 * row + 1] = rotation[3 * row + 1];
+    m[4 * row + 2] = rotation[3 * row + 2];
+    m[4 * row + 3] = translation[row];
+  }
+  _hasTransform[sensorID] = 1;
+}
+
+void EUTelAlignmentTransforms::groupBySensor(std::size_t nHits, const int* sensorID) const {
+  // counting sort, the last slot for the sensors without a transform
+  const std::size_t nSlots = _transforms.size() + 1;
+  _offset.assign( nSlots + 1, 0 );
+  for ( std::size_t i = 0; i < nHits; ++i ) {
+    const std::size_t slot = hasTransform( sensorID[i] ) ? sensorID[i] : nSlots - 1;
+    ++_offset[ slot + 1 ];
+  }
+  for ( std::size_t slot = 1; slot <= nSlots; ++slot ) _offset[slot] += _offset[slot - 1];
+
+  _order.resize( nHits );
+  for ( std::size_t i = 0; i < nHits; ++i ) {
+    const std::size_t slot = hasTransform( sensorID[i] ) ? sensorID[i] : nSlots - 1;
+    _order[ _offset[slot]++ ] = i;
+  }
+  // now _offset[slot] is the end of the slot and the begin of the next one
+}
+
+void EUTelAlignmentTransforms::apply(std::size_t nHits, const int* sensorID, const double* x, const double* y, const double* z,
+                                     double* xOut, double* yOut, double* zOut) const {
+  groupBySensor( nHits, sensorID );
+
+  _in.resize( 3 * nHits );
+  _out.resize( 3 * nHits );
+  double* inX  = _in.data();
+  double* inY  = inX + nHits;
+  double* inZ  = inY + nHits;
+  double* outX = _out.data();
+  double* outY = outX + nHits;
+  double* outZ = outY + nHits;
+  for ( std::size_t k = 0; k < nHits; ++k ) {
+    inX[k] = x[ _order[k] ];
+    inY[k] = y[ _order[k] ];
+    inZ[k] = z[ _order[k] ];
+  }
+
+  const std::size_t nSlots = _transforms.size() + 1;
+  std::size_t begin = 0;
+  for ( std::size_t slot = 0; slot < nSlots; ++slot ) {
+    const std::size_t end = _offset[slot];
+    if ( end == begin ) continue;
+    if ( slot < nSlots - 1 ) {
+      transformRange( _transforms[slot].m, end - begin, inX + begin, inY + begin, inZ + begin,
+                      outX + begin, outY + begin, outZ + begin );
+    } else {
+      std::copy( inX + begin, inX + end, outX + begin );
+      std::copy( inY + begin, inY + end, outY + begin );
+      std::copy( inZ + begin, inZ + end, outZ + begin );
+    }
+    begin = end;
+  }
+
+  for ( std::size_t k = 0; k < nHits; ++k ) {
+    xOut[ _order[k] ] = outX[k];
+    yOut[ _order[k] ] = outY[k];
+    zOut[ _order[k] ] = outZ[k];
+  }
+}
+
+void EUTelAlignmentTransforms::rotateCovariances(std::size_t nHits, const int* sensorID, const float* cov, float* covOut) const {
+  groupBySensor( nHits, sensorID );
+
+  // the six elements as six arrays in the grouped order
+  _in.resize( 6 * nHits );
+  _out.resize( 6 * nHits );
+  const double* in[6];
+  double* out[6];
+  for ( std::size_t e = 0; e < 6; ++e ) {
+    in[e]  = _in.data() + e * nHits;
+    out[e] = _out.data() + e * nHits;
+  }
+  for ( std::size_t k = 0; k < nHits; ++k ) {
+    for ( std::size_t e = 0; e < 6; ++e ) _in[ e * nHits + k ] = cov[ 6 * _order[k] + e ];
+  }
+
+  const std::size_t nSlots = _transforms.size() + 1;
+  std::size_t begin = 0;
+  for ( std::size_t slot = 0; slot < nSlots; ++slot ) {
+    const std::size_t end = _offset[slot];
+    if ( end == begin ) continue;
+    if ( slot < nSlots - 1 ) {
+      // the rotation part of the affine matrix, row by row
+      const double* m = _transforms[slot].m;
+      const double r[9] = { m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10] };
+      std::size_t i = begin;
+      for ( ; i < end; ) {
+        const double* c[6];
+        double* cOut[6];
+        for ( std::size_t e = 0; e < 6; ++e ) {
+          c[e]    = in[e] + i;
+          cOut[e] = out[e] + i;
+        }
+        if ( i + TRANSFORMBLOCK <= end ) {
+          covarianceBlock<TRANSFORMBLOCK>( r, c, cOut );
+          i += TRANSFORMBLOCK;
+        } else {
+          covarianceBlock<1>( r, c, cOut );
+          ++i;
+        }
+      }
+    } else {
+      for ( std::size_t e = 0; e < 6; ++e ) std::copy( in[e] + begin, in[e] + end, out[e] + begin );
+    }
+    begin = end;
+  }
+
+  for ( std::size_t k = 0; k < nHits; ++k ) {
+    for ( std::size_t e = 0; e < 6; ++e ) covOut[ 6 * _order[k] + e ] = static_cast<float>( _out[ e * nHits + k ] );
+  }
+}
+
+void EUTelAlignmentTransforms::eulerRotation(double angleX, double angleY, double angleZ, double* rotation) {
+  const double cx = std::cos( angleX ), sx = std::sin( angleX );
+  const double cy = std::cos( angleY ), sy = std::sin( angleY );
+  const double cz = std::cos( angleZ ), sz = std::sin( angleZ );
+  const double rotX[9] = { 1., 0., 0.,   0., cx, -sx,   0., sx, cx };
+  const double rotY[9] = { cy, 0., sy,   0., 1., 0.,   -sy, 0., cy };
+  const double rotZ[9] = { cz, -sz, 0.,   sz, cz, 0.,   0., 0., 1. };
+  double rotYX[9];
+  multiply( rotY, rotX, rotYX );
+  multiply( rotZ, rotYX, rotation );
+}
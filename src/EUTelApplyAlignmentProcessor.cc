@@ -17,6 +17,7 @@
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelHistogramManager.h"
 #include "EUTelExceptions.h"
+#include "EUTelGeometryCache.h"
 #include "EUTelVirtualCluster.h"
 #include "EUTelFFClusterImpl.h"
 #include "EUTelDFFClusterImpl.h"
@@ -53,6 +54,7 @@
 #include <UTIL/CellIDDecoder.h>
 #include <EVENT/LCCollection.h>
 #include <EVENT/LCEvent.h>
+#include <EVENT/LCGenericObject.h>
 #include <IMPL/LCCollectionVec.h>
 //#include <TrackerHitImpl2.h>
 #include <IMPL/TrackerHitImpl.h>
@@ -73,6 +75,7 @@
 #include <cstdlib>
 #include <limits>
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -142,7 +145,17 @@ EUTelApplyAlignmentProcessor::EUTelApplyAlignmentProcessor ()
   _siPlanesLayerLayout(NULL),
   _siPlaneZPosition(NULL),
   _orderedSensorIDVec(),
-  _histogramSwitch(false)
+  _histogramSwitch(false),
+  _alignmentSteps(),
+  _hitSensorID(),
+  _hitX(),
+  _hitY(),
+  _hitZ(),
+  _alignedX(),
+  _alignedY(),
+  _alignedZ(),
+  _nHitsAligned(0),
+  _alignTime(0)
 {
   // modify processor description
   _description =
@@ -379,6 +392,9 @@ void EUTelApplyAlignmentProcessor::processRunHeader (LCRunHeader * runHeader) {
 
   message<MESSAGE4> ( log() << detectorName << " : " << detectorDescription ) ;
 
+  // the alignment transforms are compiled again for the new run
+  _alignmentSteps.clear();
+
   // pick up correct alignment collection
   _alignmentCollectionNames.clear();
   _hitCollectionNames.clear();
@@ -602,8 +618,6 @@ void EUTelApplyAlignmentProcessor::processEvent (LCEvent * event) {
 
 void EUTelApplyAlignmentProcessor::ApplyGear6D( LCEvent *event) 
 {
-  UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder ( EUTELESCOPE::HITENCODING );
-
   EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event);
 
   if ( evt->getEventType() == kEORE ) 
@@ -639,46 +653,13 @@ void EUTelApplyAlignmentProcessor::ApplyGear6D( LCEvent *event)
       return;
     }
 
+    AlignmentStep& step = getAlignmentStep( kGearStep );
+    alignHits( kGearStep, step );
+
     for (size_t iHit = 0; iHit < _inputCollectionVec->size(); iHit++) 
     {
 
-      TrackerHitImpl* inputHit  = dynamic_cast<TrackerHitImpl*>( _inputCollectionVec->getElementAt(iHit) );
-
-      // now we have to understand which layer this hit belongs to.
-      int sensorID = hitDecoder(inputHit)["sensorID"];
-
-      if ( _conversionIdMap.size() != static_cast< unsigned >( _siPlanesParameters->getSiPlanesNumber()) ) 
-      {
-          // first of all try to see if this sensorID already belong to
-          if ( _conversionIdMap.find( sensorID ) == _conversionIdMap.end() ) 
-          {
-              // this means that this detector ID was not already inserted,
-              // so this is the right place to do that
-          
-              for ( int iLayer = 0; iLayer < _siPlanesLayerLayout->getNLayers(); iLayer++ ) 
-              {
-                  if ( _siPlanesLayerLayout->getID(iLayer) == sensorID ) 
-                  {
-                      _conversionIdMap.insert( make_pair( sensorID, iLayer ) );
-                      break;
-                  }
-              }
-          }
-      }
-
-      int layerIndex   = _conversionIdMap[sensorID];
-
-      // determine z position of the plane
-	  // 20 December 2010 @libov
-      float	z_sensor = 0;
-	  for ( int iPlane = 0 ; iPlane < _siPlanesLayerLayout->getNLayers(); ++iPlane ) 
-      {
-          if (sensorID == _siPlanesLayerLayout->getID( iPlane ) ) 
-          {
-              z_sensor = _siPlanesLayerLayout -> getSensitivePositionZ( iPlane ) + 0.5 * _siPlanesLayerLayout->getSensitiveThickness( iPlane );
-              break;
-          }
-      }
+      TrackerHitImpl* inputHit  = static_cast<TrackerHitImpl*>( _inputCollectionVec->getElementAt(iHit) );
 
       // copy the input to the output, at least for the common part
       TrackerHitImpl   * outputHit  = new TrackerHitImpl;
@@ -687,96 +668,14 @@ void EUTelApplyAlignmentProcessor::ApplyGear6D( LCEvent *event)
       outputHit->setCellID0( inputHit->getCellID0() );
       outputHit->setCellID1( inputHit->getCellID1() );
       outputHit->setTime( inputHit->getTime() );
+      outputHit->setQuality( inputHit->getQuality() );
 
-      double * inputPosition      = const_cast< double * > ( inputHit->getPosition() ) ;
-      double   outputPosition[3]  = { 0., 0., 0. };
-
-      if ( 1==1 ) 
-      {
-
-          double telPos[3]    = {0., 0., 0.};
-          double gRotation[3] = { 0., 0., 0.}; // not rotated
-
-          if ( _debugSwitch )
-         {
-              telPos[0] = 0.;
-              telPos[1] = 0.;
-              telPos[2] = 0.; 
-              gRotation[0] = _alpha;
-              gRotation[1] = _beta ;
-              gRotation[2] = _gamma;
-          }
-          else
-          {
-              gRotation[0]    = _siPlanesLayerLayout->getLayerRotationXY(layerIndex); // Euler alpha ;
-              gRotation[1]    = _siPlanesLayerLayout->getLayerRotationZX(layerIndex); // Euler alpha ;
-              gRotation[2]    = _siPlanesLayerLayout->getLayerRotationZY(layerIndex); // Euler alpha ;
-
-              // input angles are in DEGREEs !!!
-              // translate into radians
-    
-              gRotation[0]  =   gRotation[0] *3.1415926/180.; // 
-              gRotation[1]  =   gRotation[1] *3.1415926/180.; //
-              gRotation[2]  =   gRotation[2] *3.1415926/180.; //
-
-              telPos[0]  =  _siPlanesLayerLayout->getSensitivePositionX(layerIndex); // mm
-              telPos[1]  =  _siPlanesLayerLayout->getSensitivePositionY(layerIndex); // mm
-              telPos[2]  =  _siPlanesLayerLayout->getSensitivePositionZ(layerIndex); // mm
-              
-          }
- 
-      
-          if( _iEvt < _printEvents )
-          {
-                if ( _debugSwitch ) 
-                {
-                    streamlog_out ( MESSAGE5 )  << "Debugmode ON " << endl;                                   
-                }
-                
-                streamlog_out ( DEBUG2 )  << "_applyGear6D " << endl;
-                streamlog_out ( DEBUG2 )  << " telPos[0] = " << telPos[0]  << endl;
-                streamlog_out ( DEBUG2 )  << " telPos[1] = " << telPos[1]  << endl;
-                streamlog_out ( DEBUG2 )  << " telPos[2] = " << telPos[2]  << endl;
-                streamlog_out ( DEBUG2 )  << " gRotation[0] = " << gRotation[0]  << endl;
-                streamlog_out ( DEBUG2 )  << " gRotation[1] = " << gRotation[1]  << endl;
-                streamlog_out ( DEBUG2 )  << " gRotation[2] = " << gRotation[2]  << endl;
-          }
-
-          // rotations first
- 
-          outputPosition[0] = inputPosition[0];
-          outputPosition[1] = inputPosition[1];
-          outputPosition[2] = inputPosition[2] - z_sensor;
-          
-          _EulerRotation(outputPosition, gRotation);
-
-          // then the shifts
-//          outputPosition[0]  = telPos[0];
-//          outputPosition[1]  = telPos[1];
-//          outputPosition[2]  = telPos[2];
-
-          outputPosition[2] += z_sensor;
-      }
-      else
-      {
-          // this hit belongs to a plane whose sensorID is not in the
-          // alignment constants. So the idea is to eventually advice
-          // the users if running in DEBUG and copy the not aligned hit
-          // in the new collection.
-//          streamlog_out ( DEBUG3 ) << "Sensor ID " << sensorID << " not found. Skipping alignment for hit "
-//                                    << iHit << endl;
-
-          for ( size_t i = 0; i < 3; ++i )
-          {
-              outputPosition[i] = inputPosition[i];
-          }
-          
-      }
+      double   outputPosition[3]  = { _alignedX[iHit], _alignedY[iHit], _alignedZ[iHit] };
 
       if ( _iEvt < _printEvents )
       {
-         streamlog_out ( DEBUG2 ) << "ApplyGear: INPUT: Sensor ID " << sensorID << " " << inputPosition[0] << " " << inputPosition[1] << " " << inputPosition[2] << " " << z_sensor << endl;                
-         streamlog_out ( DEBUG2 ) << "ApplyGear: OUTPUT:Sensor ID " << sensorID << " " << outputPosition[0] << " " << outputPosition[1] << " " << outputPosition[2] << " " << z_sensor << endl;                
+         streamlog_out ( DEBUG2 ) << "ApplyGear: INPUT: Sensor ID " << _hitSensorID[iHit] << " " << _hitX[iHit] << " " << _hitY[iHit] << " " << _hitZ[iHit] << endl;                
+         streamlog_out ( DEBUG2 ) << "ApplyGear: OUTPUT:Sensor ID " << _hitSensorID[iHit] << " " << outputPosition[0] << " " << outputPosition[1] << " " << outputPosition[2] << endl;                
       }
 
        outputHit->setPosition( outputPosition ) ;
@@ -922,6 +821,7 @@ void EUTelApplyAlignmentProcessor::RevertGear6D( LCEvent *event)
       outputHit->setCellID0( inputHit->getCellID0() );
       outputHit->setCellID1( inputHit->getCellID1() );
       outputHit->setTime( inputHit->getTime() );
+      outputHit->setQuality( inputHit->getQuality() );
 
       const double * inputPosition      = const_cast< const double * > ( inputHit->getPosition() ) ;
       double   outputPosition[3]  = { 0., 0., 0. };
@@ -1047,8 +947,6 @@ void EUTelApplyAlignmentProcessor::RevertGear6D( LCEvent *event)
 }
 
 void EUTelApplyAlignmentProcessor::Direct(LCEvent *event) {
-  UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder ( EUTELESCOPE::HITENCODING );
-
   EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event);
 
   if ( evt->getEventType() == kEORE ) 
@@ -1127,95 +1025,13 @@ void EUTelApplyAlignmentProcessor::Direct(LCEvent *event) {
     streamlog_out ( DEBUG5 ) << "DIRECT:-----:-----: EUTelApplyAlignmentProcessor::Direct. going to proceeed with " <<  _inputCollectionVec->size() << " hits " << endl;
 
 // go-go
-    for (size_t iHit = 0; iHit < _inputCollectionVec->size(); iHit++) {
-
-      streamlog_out ( DEBUG5 ) << "DIRECT:-----:-----: hit " << iHit << " of  " <<  _inputCollectionVec->size() << " hits " << endl;
-
-      TrackerHitImpl* inputHit = dynamic_cast<TrackerHitImpl*>( _inputCollectionVec->getElementAt(iHit) );
-
-      // now we have to understand which layer this hit belongs to.
-      int sensorID = hitDecoder(inputHit)["sensorID"];
-
-      //find proper alignment colleciton:
-            double alpha = 0.;
-            double beta  = 0.;
-            double gamma = 0.;
-            double offsetX = 0.;
-            double offsetY = 0.;
-            double offsetZ = 0.;
- 
-      // now that we know at which sensor the hit belongs to, we can
-      // get the corresponding alignment constants
-      map< int , int >::iterator  positionIter = _lookUpTable[ _alignmentCollectionName ].find( sensorID );
-
-     streamlog_out( DEBUG5 ) << "DIRECT:-----:-----: iHit [" <<  iHit << "] for sensor  "<<  sensorID << endl;
-     if ( positionIter == _lookUpTable[ _alignmentCollectionName ].end() )
-         {
-          streamlog_out( DEBUG5 ) << "DIRECT:-----:-----: wrong sensorID : " <<  sensorID << " ?? " << endl;
-//          continue; //do nothing as if alignment == 0.
-         }
-      else
-         {
-           EUTelAlignmentConstant * alignment = static_cast< EUTelAlignmentConstant * >  ( _alignmentCollectionVec->getElementAt( positionIter->second ) );
-           streamlog_out( DEBUG5 ) << "DIRECT:-----:-----: iHit [" <<  iHit << "] at "<<  positionIter->second << " found at (EUTelAlignmentConstant*) " << alignment ;
-           streamlog_out( DEBUG5 ) << " with alignment collection name : " << _alignmentCollectionName << endl;
-           alpha   = alignment->getAlpha();
-           beta    = alignment->getBeta();
-           gamma   = alignment->getGamma();
-           offsetX = alignment->getXOffset();
-           offsetY = alignment->getYOffset();
-           offsetZ = alignment->getZOffset();
-         }  
-
-
-      // refhit = center-of-the-sensor coordinates:
-      double x_refhit = 0.; 
-      double y_refhit = 0.; 
-      double z_refhit = 0.; 
-      
-      if( !_applyToReferenceHitCollection || _referenceHitVec == 0 )
-      {
-	// todo: is this case (no reference vector) treated correctly?
-        streamlog_out( DEBUG5 ) << "DIRECT:-----:-----: _referenceHitVec is empty" << endl;
-      }
-      else
-      {
-        streamlog_out( DEBUG5 ) << "DIRECT:-----:-----: reference Hit collection name : " << _referenceHitCollectionName << endl;
- 
-       for(size_t ii = 0 ; ii <  static_cast< size_t >(_referenceHitVec->getNumberOfElements()); ii++)
-       {
-        EUTelReferenceHit * refhit = static_cast< EUTelReferenceHit*> ( _referenceHitVec->getElementAt(ii) ) ;
-        if( sensorID != refhit->getSensorID() )
-        {
-//          streamlog_out( DEBUG5 ) << "DIRECT:-----:-----: Looping through a varity of sensor IDs" << endl;
-          continue;
-        }
-        else
-        {
-          streamlog_out( DEBUG5 ) << "DIRECT:-----:-----: Sensor ID and Alignment plane ID match!" << endl;
-          x_refhit =  refhit->getXOffset();
-          y_refhit =  refhit->getYOffset();
-          z_refhit =  refhit->getZOffset();
+    AlignmentStep& step = getAlignmentStep( kDirectStep );
+    alignHits( kDirectStep, step );
 
-          // possible source of inconsistency; Apply to reference hit collection flag should be enabled in steering file
-          // otherwise the following three lines (undo alignment shifts) makes no sense !!!
-          x_refhit += offsetX;
-          y_refhit += offsetY;
-          z_refhit += offsetZ;
+    for (size_t iHit = 0; iHit < _inputCollectionVec->size(); iHit++) {
 
-          break;
-        } 
-           streamlog_out( DEBUG5 ) << "DIRECT:-----:-----: sensorID "<<
-             refhit->getSensorID(   )  << " X: "   <<                
-             refhit->getXOffset(    )  << " Y: "   <<
-             refhit->getYOffset(    )  << " Z: "   <<
-             refhit->getZOffset(    )  << " X_REFHIT: "   <<
-             x_refhit << " Y_REFHIT: "   <<
-             y_refhit << " Z_REFHIT: "   <<
-             z_refhit << "  "   << endl;        
-       }
-      }
-      streamlog_out( DEBUG5 ) << "DIRECT:-----:-----: refhit found for sensorID " << sensorID << endl;
+      TrackerHitImpl* inputHit = static_cast<TrackerHitImpl*>( _inputCollectionVec->getElementAt(iHit) );
+      const int sensorID = _hitSensorID[iHit];
 
       // copy the input to the output, at least for the common part
       TrackerHitImpl   * outputHit  = new TrackerHitImpl;
@@ -1225,36 +1041,18 @@ void EUTelApplyAlignmentProcessor::Direct(LCEvent *event) {
       outputHit->setCellID0( inputHit->getCellID0() );
       outputHit->setCellID1( inputHit->getCellID1() );
       outputHit->setTime( inputHit->getTime() );
+      outputHit->setQuality( inputHit->getQuality() );
 
-      // hit coordinates in the center-of-the sensor frame (axis coincide with the global frame)
-      const double *inputS = static_cast<const double*> ( inputHit->getPosition() ) ;
-
-      double inputPosition[3]      = { inputS[0], inputS[1], inputS[2] };
-      double inputPosition_orig[3] = { inputS[0], inputS[1], inputS[2] };
-
-      // calculate hit position on a sensor relative to its center (assuming that refhit is still without alignment corrections)
-      inputPosition[0] = inputPosition[0] - x_refhit;
-      inputPosition[1] = inputPosition[1] - y_refhit;
-      inputPosition[2] = inputPosition[2] - z_refhit;
-
-      // initial setting of the sensor = center-of-the sensor coordinates in the global frame
-      double   outputPosition[3]  = { 0., 0., 0. };
-      outputPosition[0] = x_refhit;
-      outputPosition[1] = y_refhit;
-      outputPosition[2] = z_refhit;
-/*
-        printf("PRE sensorID: %5d   [%5.2f %5.2f %5.2f]\n",
-                sensorID, x_refhit, y_refhit, z_refhit
-        );
-*/
-
-
-//      if ( positionIter != _lookUpTable[ _alignmentCollectionName ].end() ) {
+      double outputPosition[3] = { _alignedX[iHit], _alignedY[iHit], _alignedZ[iHit] };
 
+      if ( _histogramSwitch || _iEvt < _printEvents )
+      {
+        // hit position on a sensor relative to its center, as before the alignment
+        const double * reference = step.getReference( sensorID );
+        const double inputPosition[3] = { _hitX[iHit] - reference[0], _hitY[iHit] - reference[1], _hitZ[iHit] - reference[2] };
 
 #if ( defined(USE_AIDA) || defined(MARLIN_USE_AIDA) )
         string tempHistoName;
-//        AIDA::IHistogram3D *histo3D; 
         if ( _histogramSwitch ) {
           {
             stringstream ss;
@@ -1270,77 +1068,7 @@ void EUTelApplyAlignmentProcessor::Direct(LCEvent *event) {
                                         << ".\nDisabling histogramming from now on " << endl;
               _histogramSwitch = false;
             }
-//          histo3D = dynamic_cast<AIDA::IHistogram3D*> (_aidaHistoMap[ _densityPlotBeforeAlignName ] );
-//          if ( histo3D ) histo3D->fill( inputPosition[0], inputPosition[1], inputPosition[2] );
-//          else {
-//            streamlog_out ( ERROR1 )  << "DIRECT:-----:-----: Not able to retrieve histogram pointer for " << _densityPlotBeforeAlignName
-//                                      << ".\nDisabling histogramming from now on " << endl;
-//            _histogramSwitch = false;
-//          }
-        }
-#endif
-
-        
-        if ( _correctionMethod == 0 ) 
-        {
-
-            // this is the shift only case
-            outputPosition[0] += inputPosition[0] - offsetX;                
-            outputPosition[1] += inputPosition[1] - offsetY; 
-            outputPosition[2] += inputPosition[2] - offsetZ;
-
-        } 
-        else if ( _correctionMethod == 1 ) 
-        {
-            if ( _debugSwitch )
-            {
-                alpha = _alpha;
-                beta  = _beta;
-                gamma = _gamma; 
-                offsetX = 0.;
-                offsetY = 0.;
-                offsetZ = 0.;
-            }
-            else
-            {
-            }
-
-            if( _iEvt < _printEvents )
-            {
-                if ( _debugSwitch ) 
-                {
-                    streamlog_out ( DEBUG5 )  << "DIRECT:-----:-----: Debugmode ON " << endl;                                   
-                }
-                streamlog_out ( DEBUG5 )  << "DIRECT:-----:-----: _correctionMethod == rotation first " << endl;
-                streamlog_out ( DEBUG5 )  << "DIRECT:-----:-----:  alignment->getAlpha() = " << alpha  << endl;
-                streamlog_out ( DEBUG5 )  << "DIRECT:-----:-----:  alignment->getBeta()  = " <<  beta  << endl;
-                streamlog_out ( DEBUG5 )  << "DIRECT:-----:-----:  alignment->getGamma() = " << gamma << endl;
-                streamlog_out ( DEBUG5 )  << "DIRECT:-----:-----:  alignment->getXOffest() = " << offsetX  << endl;
-                streamlog_out ( DEBUG5 )  << "DIRECT:-----:-----:  alignment->getYOffest() = " << offsetY  << endl;
-                streamlog_out ( DEBUG5 )  << "DIRECT:-----:-----:  alignment->getZOffest() = " << offsetZ  << endl;
-            }
-            // this is the rotation first
-            TVector3 iCenterOfSensorFrame(  inputPosition[0],  inputPosition[1],  inputPosition[2] );
-
-            iCenterOfSensorFrame.RotateX( -alpha );
-            iCenterOfSensorFrame.RotateY( -beta  );
-            iCenterOfSensorFrame.RotateZ( -gamma );
-
-            outputPosition[0] += iCenterOfSensorFrame(0);
-            outputPosition[1] += iCenterOfSensorFrame(1);
-            outputPosition[2] += iCenterOfSensorFrame(2);
-
-            // second the shift
-            outputPosition[0] -= offsetX; 
-            outputPosition[1] -= offsetY; 
-            outputPosition[2] -= offsetZ; 
-          
         }
-        else if ( _correctionMethod == 2 ) 
-        {
-        }
-
-#if ( defined(USE_AIDA) || defined(MARLIN_USE_AIDA) ) 
         if ( _histogramSwitch ) {
           {
             stringstream ss;
@@ -1355,41 +1083,15 @@ void EUTelApplyAlignmentProcessor::Direct(LCEvent *event) {
                                       << ".\nDisabling histogramming from now on " << endl;
             _histogramSwitch = false;
           }
-//          histo3D = dynamic_cast<AIDA::IHistogram3D*> (_aidaHistoMap[ _densityPlotAfterAlignName ] );
-//          if ( histo3D ) histo3D->fill( outputPosition[0], outputPosition[1], outputPosition[2] );
-//          else {
-//            streamlog_out ( ERROR1 )  << "DIRECT:-----:-----: Not able to retrieve histogram pointer for " << _densityPlotAfterAlignName
-//                                      << ".\nDisabling histogramming from now on " << endl;
-//            _histogramSwitch = false;
-//          }
         }
 #endif
 
-/*
-      } 
-      else 
-      {
-
-        // this hit belongs to a plane whose sensorID is not in the
-        // alignment constants. So the idea is to eventually advice
-        // the users if running in DEBUG and copy the not aligned hit
-        // in the new collection.
-//        streamlog_out ( DEBUG5 ) << "Sensor ID " << sensorID << " not found. Skipping alignment for hit "
-//                                << iHit << endl;
-
-        for ( size_t i = 0; i < 3; ++i )
+        if ( _iEvt < _printEvents )
         {
-            outputPosition[i] = inputPosition[i];
+           streamlog_out ( DEBUG1 ) << "DIRECT:-----:-----:" << _alignmentCollectionName.c_str() << " : ORIGI: Sensor ID " << sensorID << " " << _hitX[iHit] << " " << _hitY[iHit] << " " << _hitZ[iHit] <<  endl;   
+           streamlog_out ( DEBUG1 ) << "DIRECT:-----:-----:" << _alignmentCollectionName.c_str() << " : INPUT: Sensor ID " << sensorID << " " << inputPosition[0] << " " << inputPosition[1] << " " << inputPosition[2] <<  endl;   
+           streamlog_out ( DEBUG1 ) << "DIRECT:-----:-----:" << _alignmentCollectionName.c_str() << " : OUTPUT:Sensor ID " << sensorID << " " << outputPosition[0] << " " << outputPosition[1] << " " << outputPosition[2]  << endl;
         }
-
-      }
-*/
-
-      if ( _iEvt < _printEvents )
-      {
-         streamlog_out ( DEBUG1 ) << "DIRECT:-----:-----:" << _alignmentCollectionName.c_str() << " : ORIGI: Sensor ID " << sensorID << " " << inputPosition_orig[0] << " " << inputPosition_orig[1] << " " << inputPosition_orig[2] <<  endl;   
-         streamlog_out ( DEBUG1 ) << "DIRECT:-----:-----:" << _alignmentCollectionName.c_str() << " : INPUT: Sensor ID " << sensorID << " " << inputPosition[0] << " " << inputPosition[1] << " " << inputPosition[2] <<  endl;   
-         streamlog_out ( DEBUG1 ) << "DIRECT:-----:-----:" << _alignmentCollectionName.c_str() << " : OUTPUT:Sensor ID " << sensorID << " " << outputPosition[0] << " " << outputPosition[1] << " " << outputPosition[2]  << endl;
       }
 
       outputHit->setPosition( outputPosition ) ;
@@ -1399,8 +1101,6 @@ void EUTelApplyAlignmentProcessor::Direct(LCEvent *event) {
 
 void EUTelApplyAlignmentProcessor::Reverse(LCEvent *event) {
 
-    UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder ( EUTELESCOPE::HITENCODING ); 
-    
     EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event);
 
     if ( evt->getEventType() == kEORE ) 
@@ -1475,86 +1175,14 @@ void EUTelApplyAlignmentProcessor::Reverse(LCEvent *event) {
     }
 
 // go-go
-        for (size_t iHit = 0; iHit < _inputCollectionVec->size(); iHit++) 
-        {
-
-	TrackerHitImpl* inputHit  = dynamic_cast<TrackerHitImpl*>( _inputCollectionVec->getElementAt(iHit) );
-
-	// now we have to understand which layer this hit belongs to.
-	int sensorID = hitDecoder(inputHit)["sensorID"];
+    AlignmentStep& step = getAlignmentStep( kReverseStep );
+    alignHits( kReverseStep, step );
 
-      //find proper alignment colleciton:
-      double alpha = 0.;
-      double beta  = 0.;
-      double gamma = 0.;
-      double offsetX = 0.;
-      double offsetY = 0.;
-      double offsetZ = 0.;
- 
-      // now that we know at which sensor the hit belongs to, we can
-      // get the corresponding alignment constants
-      map< int , int >::iterator  positionIter = _lookUpTable[ _alignmentCollectionName ].find( sensorID );
-
-      if ( positionIter == _lookUpTable[ _alignmentCollectionName ].end() )
-         {
-           streamlog_out( DEBUG5 ) <<  "REVERSE: wrong sensorId " << sensorID  << endl;
-	   // continue; do nothing as if alignment == 0.
-         }
-      else
-         {
-           streamlog_out( DEBUG5 ) << "REVERSE: FOUND alignment collection "<< _alignmentCollectionName.c_str() <<" record for sensorId " << sensorID  << endl;
-           EUTelAlignmentConstant * alignment = static_cast< EUTelAlignmentConstant * >  ( _alignmentCollectionVec->getElementAt( positionIter->second ) );
-
-           alpha   = alignment->getAlpha();
-           beta    = alignment->getBeta();
-           gamma   = alignment->getGamma();
-           offsetX = alignment->getXOffset();
-           offsetY = alignment->getYOffset();
-           offsetZ = alignment->getZOffset();
-         }  
-
-      // refhit = center-of-the-sensor coordinates:
-      double x_refhit = 0.; 
-      double y_refhit = 0.; 
-      double z_refhit = 0.; 
+    for (size_t iHit = 0; iHit < _inputCollectionVec->size(); iHit++) {
 
-      if( !_applyToReferenceHitCollection || _referenceHitVec == 0 )
-      {
-	// todo: is this case (no reference vector) treated correctly?
-        // streamlog_out( MESSAGE5 ) << "_referenceHitVec is empty" << endl;
-      }
-      else
-      {
-        if(_fevent) streamlog_out( MESSAGE5 ) << "REVERSE: reference Hit collection name : " << _referenceHitCollectionName << " at " << _referenceHitVec  << endl;
+      TrackerHitImpl* inputHit = static_cast<TrackerHitImpl*>( _inputCollectionVec->getElementAt(iHit) );
+      const int sensorID = _hitSensorID[iHit];
 
-        for(size_t ii = 0 ; ii <  static_cast< size_t >(_referenceHitVec->getNumberOfElements()); ii++)
-        {
-          EUTelReferenceHit * refhit = static_cast< EUTelReferenceHit*> ( _referenceHitVec->getElementAt(ii) ) ;
-          if( sensorID != refhit->getSensorID() )
-          {
-            // Looping through a varity of sensor IDs
-            continue;
-          }
-          else
-          {
-	    // Sensor ID and Alignment plane ID match!
-            x_refhit =  refhit->getXOffset();
-            y_refhit =  refhit->getYOffset();
-            z_refhit =  refhit->getZOffset();
-
-// do not apply this part: refhits should be just as they where befre the alignment has been applied
-// = it means the anti-apply alignment should have been applied already in the AlignReferenceHit
-//---//
-//          x_refhit -= offsetX;
-//          y_refhit -= offsetY;
-//          z_refhit -= offsetZ;
-//---//
-
-            break;
-          } 
-        }
-      }
- 
       // copy the input to the output, at least for the common part
       TrackerHitImpl   * outputHit  = new TrackerHitImpl;
       outputHit->setType( inputHit->getType() );
@@ -1562,197 +1190,371 @@ void EUTelApplyAlignmentProcessor::Reverse(LCEvent *event) {
       outputHit->setCellID0( inputHit->getCellID0() );
       outputHit->setCellID1( inputHit->getCellID1() );
       outputHit->setTime( inputHit->getTime() );
+      outputHit->setQuality( inputHit->getQuality() );
 
-      // now that we know at which sensor the hit belongs to, we can
-      // get the corresponding alignment constants
-      // map< int , int >::iterator  positionIter = _lookUpTable[ _alignmentCollectionName ].find( sensorID );
+      double outputPosition[3] = { _alignedX[iHit], _alignedY[iHit], _alignedZ[iHit] };
 
-      // hit coordinates in the center-of-the sensor frame (axis coincide with the global frame)
-      const double *inputS = static_cast<const double*> ( inputHit->getPosition() ) ;
+      if ( _histogramSwitch || _iEvt < _printEvents )
+      {
+        // hit position on a sensor relative to its center
+        const double * reference = step.getReference( sensorID );
+        const double inputPosition[3] = { _hitX[iHit] - reference[0], _hitY[iHit] - reference[1], _hitZ[iHit] - reference[2] };
 
-      double inputPosition[3]      = { inputS[0], inputS[1], inputS[2] };
-      double inputPosition_orig[3] = { inputS[0], inputS[1], inputS[2] };
+#if ( defined(USE_AIDA) || defined(MARLIN_USE_AIDA) )
+        string tempHistoName;
+        if ( _histogramSwitch ) {
+          {
+            stringstream ss;
+            ss  << _hitHistoBeforeAlignName << "_" << sensorID ;
+            tempHistoName = ss.str();
+          }
+          if ( AIDA::IHistogram2D * histo = dynamic_cast<AIDA::IHistogram2D*> ( _aidaHistoMap[ tempHistoName ] )) {
+            histo->fill( inputPosition[0], inputPosition[1] );
+          }
+          else
+            {
+              streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << tempHistoName
+                                        << ".\nDisabling histogramming from now on " << endl;
+              _histogramSwitch = false;
+            }
+        }
+        if ( _histogramSwitch ) {
+          {
+            stringstream ss;
+            ss  << _hitHistoAfterAlignName << "_" << sensorID ;
+            tempHistoName = ss.str();
+          }
+          if ( AIDA::IHistogram2D * histo = dynamic_cast<AIDA::IHistogram2D*> ( _aidaHistoMap[ tempHistoName ] )) {
+            histo->fill( outputPosition[0], outputPosition[1] );
+          }
+          else {
+            streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << tempHistoName
+                                      << ".\nDisabling histogramming from now on " << endl;
+            _histogramSwitch = false;
+          }
+        }
+#endif
 
-      inputPosition[0] = inputPosition[0] - x_refhit;
-      inputPosition[1] = inputPosition[1] - y_refhit;
-      inputPosition[2] = inputPosition[2] - z_refhit;
+        if ( _iEvt < _printEvents )
+        {
+           streamlog_out ( DEBUG0 ) <<_alignmentCollectionName.c_str() << " REVERT: ORIGI: Sensor ID " << sensorID << " " << _hitX[iHit] << " " << _hitY[iHit] << " " << _hitZ[iHit] <<  endl;   
+           streamlog_out ( DEBUG0 ) <<_alignmentCollectionName.c_str() << " REVERT: INPUT: Sensor ID " << sensorID << " " << inputPosition[0] << " " << inputPosition[1] << " " << inputPosition[2] <<  endl;   
+           streamlog_out ( DEBUG0 ) <<_alignmentCollectionName.c_str() << " REVERT: OUTPUT:Sensor ID " << sensorID << " " << outputPosition[0] << " " << outputPosition[1] << " " << outputPosition[2]  << endl;
+        }
+      }
 
+      outputHit->setPosition( outputPosition ) ;
+      _outputCollectionVec->push_back( outputHit );
+    }
+}
 
-//            const double * inputPosition = const_cast< const double * > ( inputHit->getPosition() ) ;
-//            double   outputPosition[3]   = { 0., 0., 0. };
-  
-      // initial setting of the sensor = center-of-the sensor coordinates in the global frame
-      double   outputPosition[3]  = { 0., 0., 0. };
-      outputPosition[0] = x_refhit;
-      outputPosition[1] = y_refhit;
-      outputPosition[2] = z_refhit;
+EUTelApplyAlignmentProcessor::AlignmentStep& EUTelApplyAlignmentProcessor::getAlignmentStep(StepKind kind)
+{
+  AlignmentStep& step = _alignmentSteps[ make_pair( static_cast< int >( kind ), _alignmentCollectionName ) ];
 
-//            if ( positionIter != _lookUpTable[ _alignmentCollectionName ].end() ) 
-//            {
+  // the GEAR transforms are compiled sensor by sensor in alignHits
+  if ( kind == kGearStep ) return step;
 
-#if ( defined(USE_AIDA) || defined(MARLIN_USE_AIDA) )
-                string tempHistoName;
-//                AIDA::IHistogram3D *histo3D; 
-                if ( _histogramSwitch ) 
-                {
-                    {
-                        stringstream ss;
-                        ss  << _hitHistoBeforeAlignName << "_" << sensorID ;
-                        tempHistoName = ss.str();
-                    }
-                    if ( AIDA::IHistogram2D * histo = dynamic_cast<AIDA::IHistogram2D*> ( _aidaHistoMap[ tempHistoName ] )) 
-                    {
-                        histo->fill( inputPosition[0], inputPosition[1] );
-                    }
-                    else
-                    {
-                        streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << tempHistoName
-                                                  << ".\nDisabling histogramming from now on " << endl;
-                        _histogramSwitch = false;
-                    }
-                    
-//                    histo3D = dynamic_cast<AIDA::IHistogram3D*> (_aidaHistoMap[ _densityPlotBeforeAlignName ] );
-//                    if ( histo3D ) 
-//                    {
-//                        histo3D->fill( inputPosition[0], inputPosition[1], inputPosition[2] );
-//                    }
-//                    else 
-//                    {
-//                        streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << _densityPlotBeforeAlignName
-//                                                  << ".\nDisabling histogramming from now on " << endl;
-//                       _histogramSwitch = false;
-//                    }
-                }
-#endif
+  LCCollectionVec * referenceHitVec = _applyToReferenceHitCollection ? _referenceHitVec : 0;
+  const uint64_t alignmentHash    = genericObjectHash( _alignmentCollectionVec );
+  const uint64_t referenceHitHash = genericObjectHash( referenceHitVec );
+  if ( step.compiled && step.alignmentCollection == _alignmentCollectionVec && step.referenceHitCollection == referenceHitVec
+       && step.alignmentHash == alignmentHash && step.referenceHitHash == referenceHitHash )
+  {
+    return step;
+  }
 
-       
-                if ( _correctionMethod == 0 ) 
-                {                   
+  streamlog_out ( DEBUG5 ) << "Compiling the alignment transforms of [" << _alignmentCollectionName << "]" << endl;
+  step.transforms.clear();
+  step.reference.clear();
+  step.alignmentCollection    = _alignmentCollectionVec;
+  step.referenceHitCollection = referenceHitVec;
+  step.alignmentHash          = alignmentHash;
+  step.referenceHitHash       = referenceHitHash;
+  step.compiled               = true;
+
+  // as with the former look up table the last constant of a sensor is
+  // used, and the first of its reference hits
+  vector< EUTelAlignmentConstant * > alignments;
+  vector< EUTelReferenceHit * >      refhits;
+  if ( _alignmentCollectionVec != 0 )
+  {
+    for ( size_t iPos = 0; iPos < _alignmentCollectionVec->size(); ++iPos )
+    {
+      EUTelAlignmentConstant * alignment = static_cast< EUTelAlignmentConstant * > ( _alignmentCollectionVec->getElementAt( iPos ) );
+      const int sensorID = alignment->getSensorID();
+      if ( sensorID < 0 ) continue;
+      if ( static_cast< size_t >( sensorID ) >= alignments.size() )
+      {
+        alignments.resize( sensorID + 1, 0 );
+        refhits.resize( sensorID + 1, 0 );
+      }
+      alignments[ sensorID ] = alignment;
+    }
+  }
+  if ( referenceHitVec != 0 )
+  {
+    for ( size_t ii = 0; ii < static_cast< size_t >( referenceHitVec->getNumberOfElements() ); ii++ )
+    {
+      EUTelReferenceHit * refhit = static_cast< EUTelReferenceHit * > ( referenceHitVec->getElementAt( ii ) );
+      const int sensorID = refhit->getSensorID();
+      if ( sensorID < 0 ) continue;
+      if ( static_cast< size_t >( sensorID ) >= alignments.size() )
+      {
+        alignments.resize( sensorID + 1, 0 );
+        refhits.resize( sensorID + 1, 0 );
+      }
+      if ( refhits[ sensorID ] == 0 ) refhits[ sensorID ] = refhit;
+    }
+  }
 
-                    // this is the shift only case
+  for ( size_t sensorID = 0; sensorID < alignments.size(); ++sensorID )
+  {
+    if ( alignments[ sensorID ] != 0 || refhits[ sensorID ] != 0 )
+    {
+      setSensorTransform( kind, sensorID, alignments[ sensorID ], refhits[ sensorID ], step );
+    }
+  }
+  return step;
+}
 
-                    outputPosition[0] = inputPosition[0] + offsetX ;
-                    outputPosition[1] = inputPosition[1] + offsetY ;
-                    outputPosition[2] = inputPosition[2] + offsetZ ;
+uint64_t EUTelApplyAlignmentProcessor::genericObjectHash(LCCollectionVec* collection)
+{
+  if ( collection == 0 ) return 0;
 
-                }
-                else
-                    if ( _correctionMethod == 1 ) 
-                    {
-                        // this is the rotation first
-                        if ( _debugSwitch )
-                        {
-                          alpha = _alpha;
-                          beta  = _beta;
-                          gamma = _gamma; 
-                          offsetX = 0.;
-                          offsetY = 0.;
-                          offsetZ = 0.;
-                        }
-                        else
-                        {
-                        }
-
-            if( _iEvt < _printEvents )
-            {
-                if ( _debugSwitch ) 
-                {
-                    streamlog_out ( DEBUG1 )  << "Debugmode ON " << endl;                                   
-                }
-                
-                streamlog_out ( DEBUG1 )  << "_correctionMethod == rotation first " << endl;
-                streamlog_out ( DEBUG1 )  << " alignment->getAlpha() = " << alpha  << endl;
-                streamlog_out ( DEBUG1 )  << " alignment->getBeta()  = " <<  beta  << endl;
-                streamlog_out ( DEBUG1 )  << " alignment->getGamma() = " << gamma << endl;
-                streamlog_out ( DEBUG1 )  << " alignment->getXOffest() = " << offsetX  << endl;
-                streamlog_out ( DEBUG1 )  << " alignment->getYOffest() = " << offsetY  << endl;
-                streamlog_out ( DEBUG1 )  << " alignment->getZOffest() = " << offsetZ  << endl;
-            }
-        
-            // this is the rotation first
-            TVector3 iCenterOfSensorFrame(  inputPosition[0],  inputPosition[1],  inputPosition[2] );
+  uint64_t hash = geo::EUTelGeometryCache::hashBytes( 0, 0 );
+  for ( int iPos = 0; iPos < collection->getNumberOfElements(); ++iPos )
+  {
+    LCGenericObject * object = static_cast< LCGenericObject * > ( collection->getElementAt( iPos ) );
+    for ( int i = 0; i < object->getNInt(); ++i )
+    {
+      const int value = object->getIntVal( i );
+      hash = geo::EUTelGeometryCache::hashBytes( &value, sizeof( value ), hash );
+    }
+    for ( int i = 0; i < object->getNFloat(); ++i )
+    {
+      const float value = object->getFloatVal( i );
+      hash = geo::EUTelGeometryCache::hashBytes( &value, sizeof( value ), hash );
+    }
+    for ( int i = 0; i < object->getNDouble(); ++i )
+    {
+      const double value = object->getDoubleVal( i );
+      hash = geo::EUTelGeometryCache::hashBytes( &value, sizeof( value ), hash );
+    }
+  }
+  return hash;
+}
 
-            iCenterOfSensorFrame.RotateZ( +gamma );
-            iCenterOfSensorFrame.RotateY( +beta  );
-            iCenterOfSensorFrame.RotateX( +alpha );
+void EUTelApplyAlignmentProcessor::setSensorTransform(StepKind kind, int sensorID, EUTelAlignmentConstant* alignment,
+                                                      EUTelReferenceHit* refhit, AlignmentStep& step)
+{
+  double alpha = 0.;
+  double beta  = 0.;
+  double gamma = 0.;
+  double offset[3] = { 0., 0., 0. };
+  if ( alignment != 0 )
+  {
+    alpha     = alignment->getAlpha();
+    beta      = alignment->getBeta();
+    gamma     = alignment->getGamma();
+    offset[0] = alignment->getXOffset();
+    offset[1] = alignment->getYOffset();
+    offset[2] = alignment->getZOffset();
+  }
 
-            outputPosition[0] += iCenterOfSensorFrame(0);
-            outputPosition[1] += iCenterOfSensorFrame(1);
-            outputPosition[2] += iCenterOfSensorFrame(2);
+  // refhit = center-of-the-sensor coordinates; in the direct direction
+  // the alignment shifts are undone, the reverse expects the refhits
+  // as they were before the alignment
+  double reference[3] = { 0., 0., 0. };
+  if ( refhit != 0 )
+  {
+    reference[0] = refhit->getXOffset();
+    reference[1] = refhit->getYOffset();
+    reference[2] = refhit->getZOffset();
+    if ( kind == kDirectStep )
+    {
+      reference[0] += offset[0];
+      reference[1] += offset[1];
+      reference[2] += offset[2];
+    }
+  }
 
-            // second the shift
-            outputPosition[0] += offsetX; 
-            outputPosition[1] += offsetY; 
-            outputPosition[2] += offsetZ; 
+  if ( _correctionMethod == 1 && _debugSwitch )
+  {
+    alpha = _alpha;
+    beta  = _beta;
+    gamma = _gamma;
+    offset[0] = 0.;
+    offset[1] = 0.;
+    offset[2] = 0.;
+  }
 
-                    }
-                    else
-                        if ( _correctionMethod == 2 ) 
-                        {
-                        }
+  if ( _iEvt < _printEvents )
+  {
+    streamlog_out ( DEBUG5 ) << ( kind == kDirectStep ? "DIRECT" : "REVERSE" ) << ": sensor " << sensorID
+                             << " alpha " << alpha << " beta " << beta << " gamma " << gamma
+                             << " offsets " << offset[0] << " " << offset[1] << " " << offset[2]
+                             << " refhit " << reference[0] << " " << reference[1] << " " << reference[2] << endl;
+  }
 
-#if ( defined(USE_AIDA) || defined(MARLIN_USE_AIDA) ) 
+  // the shifts are subtracted in the direct direction and added back in the reverse one
+  const double sign = ( kind == kDirectStep ) ? -1. : 1.;
+  double rotation[9]    = { 1., 0., 0.,   0., 1., 0.,   0., 0., 1. };
+  double translation[3] = { 0., 0., 0. };
 
-                if ( _histogramSwitch ) 
-                {
-                    {
-                        stringstream ss;
-                        ss  << _hitHistoAfterAlignName << "_" << sensorID ;
-                        tempHistoName = ss.str();
-                    }
-                    if ( AIDA::IHistogram2D * histo = dynamic_cast<AIDA::IHistogram2D*> ( _aidaHistoMap[ tempHistoName ] )) 
-                    {
-                        histo->fill( outputPosition[0], outputPosition[1] );
-                    }
-                    else 
-                    {
-                        streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << tempHistoName
-                                                  << ".\nDisabling histogramming from now on " << endl;
-                        _histogramSwitch = false;
-                    }
-                    
-//                    histo3D = dynamic_cast<AIDA::IHistogram3D*> (_aidaHistoMap[ _densityPlotAfterAlignName ] );
-//                    if ( histo3D )
-//                    {
-//                        histo3D->fill( outputPosition[0], outputPosition[1], outputPosition[2] );
-//                    }
-//                    else 
-//                    {
-//                        streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << _densityPlotAfterAlignName
-//                                                  << ".\nDisabling histogramming from now on " << endl;
-//                        _histogramSwitch = false;
-//                    }
-                }
-#endif
-/*
-            }
-            else 
-            {
+  if ( _correctionMethod == 0 )
+  {
+    // this is the shift only case; the reverse one does not restore the refhit position
+    for ( int i = 0; i < 3; ++i )
+    {
+      translation[i] = sign * offset[i] - ( kind == kReverseStep ? reference[i] : 0. );
+    }
+  }
+  else if ( _correctionMethod == 1 )
+  {
+    // this is the rotation first, around the refhit, and then the shift:
+    // the direct rotation is a TVector3 rotated by -alpha around X, -beta around Y
+    // and -gamma around Z, the reverse one is its inverse
+    EUTelAlignmentTransforms::eulerRotation( -alpha, -beta, -gamma, rotation );
+    if ( kind == kReverseStep )
+    {
+      swap( rotation[1], rotation[3] );
+      swap( rotation[2], rotation[6] );
+      swap( rotation[5], rotation[7] );
+    }
+    for ( int i = 0; i < 3; ++i )
+    {
+      translation[i] = reference[i]
+        - ( rotation[3 * i] * reference[0] + rotation[3 * i + 1] * reference[1] + rotation[3 * i + 2] * reference[2] )
+        + sign * offset[i];
+    }
+  }
+  else
+  {
+    // no correction for the other methods: the hits are left at the refhit position
+    fill( rotation, rotation + 9, 0. );
+    copy( reference, reference + 3, translation );
+  }
 
-                // this hit belongs to a plane whose sensorID is not in the
-                // alignment constants. So the idea is to eventually advice
-                // the users if running in DEBUG and copy the not aligned hit
-                // in the new collection.
+  if ( sensorID < 0 ) return;
+  step.transforms.setTransform( sensorID, rotation, translation );
+  if ( 3 * static_cast< size_t >( sensorID ) >= step.reference.size() ) step.reference.resize( 3 * ( sensorID + 1 ), 0. );
+  copy( reference, reference + 3, step.reference.begin() + 3 * sensorID );
+}
 
-                streamlog_out ( DEBUG5 ) << "Sensor ID " << sensorID << " not found. Skipping alignment for hit "
-                                          << iHit << endl;
-                
-                for ( size_t i = 0; i < 3; ++i )
-                {
-                    outputPosition[i] = inputPosition[i];
-                }
-            }
-*/
-      if ( _iEvt < _printEvents )
+void EUTelApplyAlignmentProcessor::setGearTransform(int sensorID, AlignmentStep& step)
+{
+  if ( _conversionIdMap.size() != static_cast< unsigned >( _siPlanesParameters->getSiPlanesNumber()) ) 
+  {
+      // first of all try to see if this sensorID already belong to
+      if ( _conversionIdMap.find( sensorID ) == _conversionIdMap.end() ) 
       {
-         streamlog_out ( DEBUG0 ) <<_alignmentCollectionName.c_str() << " REVERT: ORIGI: Sensor ID " << sensorID << " " << inputPosition_orig[0] << " " << inputPosition_orig[1] << " " << inputPosition_orig[2] <<  endl;   
-         streamlog_out ( DEBUG0 ) <<_alignmentCollectionName.c_str() << " REVERT: INPUT: Sensor ID " << sensorID << " " << inputPosition[0] << " " << inputPosition[1] << " " << inputPosition[2] <<  endl;   
-         streamlog_out ( DEBUG0 ) <<_alignmentCollectionName.c_str() << " REVERT: OUTPUT:Sensor ID " << sensorID << " " << outputPosition[0] << " " << outputPosition[1] << " " << outputPosition[2]  << endl;
+          // this means that this detector ID was not already inserted,
+          // so this is the right place to do that
+          for ( int iLayer = 0; iLayer < _siPlanesLayerLayout->getNLayers(); iLayer++ ) 
+          {
+              if ( _siPlanesLayerLayout->getID(iLayer) == sensorID ) 
+              {
+                  _conversionIdMap.insert( make_pair( sensorID, iLayer ) );
+                  break;
+              }
+          }
       }
+  }
 
-            outputHit->setPosition( outputPosition ) ;
-            _outputCollectionVec->push_back( outputHit );
-        }
+  int layerIndex   = _conversionIdMap[sensorID];
+
+  // determine z position of the plane
+  // 20 December 2010 @libov
+  float z_sensor = 0;
+  for ( int iPlane = 0 ; iPlane < _siPlanesLayerLayout->getNLayers(); ++iPlane ) 
+  {
+      if (sensorID == _siPlanesLayerLayout->getID( iPlane ) ) 
+      {
+          z_sensor = _siPlanesLayerLayout -> getSensitivePositionZ( iPlane ) + 0.5 * _siPlanesLayerLayout->getSensitiveThickness( iPlane );
+          break;
+      }
+  }
+
+  double gRotation[3] = { 0., 0., 0.}; // not rotated
+  if ( _debugSwitch )
+  {
+      gRotation[0] = _alpha;
+      gRotation[1] = _beta ;
+      gRotation[2] = _gamma;
+  }
+  else
+  {
+      // input angles are in DEGREEs !!!
+      // translate into radians
+      gRotation[0] = _siPlanesLayerLayout->getLayerRotationXY(layerIndex) *3.1415926/180.;
+      gRotation[1] = _siPlanesLayerLayout->getLayerRotationZX(layerIndex) *3.1415926/180.;
+      gRotation[2] = _siPlanesLayerLayout->getLayerRotationZY(layerIndex) *3.1415926/180.;
+  }
+
+  if ( _iEvt < _printEvents )
+  {
+      streamlog_out ( DEBUG2 )  << "_applyGear6D sensor " << sensorID << " z_sensor = " << z_sensor << endl;
+      streamlog_out ( DEBUG2 )  << " gRotation[0] = " << gRotation[0]  << endl;
+      streamlog_out ( DEBUG2 )  << " gRotation[1] = " << gRotation[1]  << endl;
+      streamlog_out ( DEBUG2 )  << " gRotation[2] = " << gRotation[2]  << endl;
+  }
+
+  // as in _EulerRotation: the angles below 1e-6 are skipped, the hit is
+  // rotated in ZY, then in ZX and in XY around the plane center in z
+  for ( int i = 0; i < 3; ++i )
+  {
+      if ( TMath::Abs( gRotation[i] ) <= 1e-6 ) gRotation[i] = 0.;
+  }
+  double rotation[9];
+  EUTelAlignmentTransforms::eulerRotation( gRotation[2], gRotation[1], gRotation[0], rotation );
+  const double center[3] = { 0., 0., z_sensor };
+  double translation[3];
+  for ( int i = 0; i < 3; ++i )
+  {
+      translation[i] = center[i] - rotation[3 * i + 2] * center[2];
+  }
+  step.transforms.setTransform( sensorID, rotation, translation );
+}
+
+void EUTelApplyAlignmentProcessor::alignHits(StepKind kind, AlignmentStep& step)
+{
+  UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder ( EUTELESCOPE::HITENCODING );
+
+  const size_t nHits = _inputCollectionVec->size();
+  _hitSensorID.resize( nHits );
+  _hitX.resize( nHits );
+  _hitY.resize( nHits );
+  _hitZ.resize( nHits );
+  _alignedX.resize( nHits );
+  _alignedY.resize( nHits );
+  _alignedZ.resize( nHits );
+
+  for ( size_t iHit = 0; iHit < nHits; iHit++ )
+  {
+    TrackerHitImpl* inputHit = dynamic_cast<TrackerHitImpl*>( _inputCollectionVec->getElementAt(iHit) );
+
+    // now we have to understand which layer this hit belongs to.
+    const int sensorID = hitDecoder(inputHit)["sensorID"];
+    if ( !step.transforms.hasTransform( sensorID ) )
+    {
+      // a sensor without alignment constants and reference hit, or seen for the first time by the GEAR step
+      if ( kind == kGearStep ) setGearTransform( sensorID, step );
+      else setSensorTransform( kind, sensorID, 0, 0, step );
+    }
+
+    const double * inputPosition = inputHit->getPosition();
+    _hitSensorID[iHit] = sensorID;
+    _hitX[iHit] = inputPosition[0];
+    _hitY[iHit] = inputPosition[1];
+    _hitZ[iHit] = inputPosition[2];
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  step.transforms.apply( nHits, _hitSensorID.data(), _hitX.data(), _hitY.data(), _hitZ.data(),
+                         _alignedX.data(), _alignedY.data(), _alignedZ.data() );
+  _alignTime += chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+  _nHitsAligned += nHits;
 }
 
 void EUTelApplyAlignmentProcessor::bookHistos() {
@@ -1959,6 +1761,10 @@ void EUTelApplyAlignmentProcessor::check (LCEvent * /* evt */ ) {
 
 
 void EUTelApplyAlignmentProcessor::end() {
+  if ( _alignTime > 0 ) {
+    streamlog_out ( MESSAGE9 ) << "Aligned " << _nHitsAligned << " hits in " << _alignTime << " s, "
+                               << _nHitsAligned / _alignTime << " hits/s" << endl;
+  }
   streamlog_out ( MESSAGE9 ) <<  "Successfully finished" << endl;
   delete [] _siPlaneZPosition;
 }
@@ -979,25 +979,28 @@ void EUTelClusterFilter::processEvent (LCEvent * event) {
 
             bool isAccepted = true;
 
+            // the pixels are read and sorted once for all the criteria
+            _clusterSummary.fill( cluster );
+
             if ( type == kEUTelDFFClusterImpl )
             {
-                isAccepted &= isAboveNumberOfHitPixel(cluster);
+                isAccepted &= isAboveNumberOfHitPixel(_clusterSummary);
             }
             else
             {
-                isAccepted &= isAboveMinTotalCharge(cluster);
-                isAccepted &= isAboveMinTotalSNR(cluster);
-                isAccepted &= isAboveNMinCharge(cluster);
-                isAccepted &= isAboveNMinSNR(cluster);
-                isAccepted &= isAboveNxNMinCharge(cluster);
-                isAccepted &= isAboveNxNMinSNR(cluster);
-                isAccepted &= isAboveMinSeedCharge(cluster);
-                isAccepted &= isAboveMinSeedSNR(cluster);
-                isAccepted &= isBelowMaxClusterNoise(cluster);
+                isAccepted &= isAboveMinTotalCharge(_clusterSummary);
+                isAccepted &= isAboveMinTotalSNR(_clusterSummary);
+                isAccepted &= isAboveNMinCharge(_clusterSummary);
+                isAccepted &= isAboveNMinSNR(_clusterSummary);
+                isAccepted &= isAboveNxNMinCharge(_clusterSummary);
+                isAccepted &= isAboveNxNMinSNR(_clusterSummary);
+                isAccepted &= isAboveMinSeedCharge(_clusterSummary);
+                isAccepted &= isAboveMinSeedSNR(_clusterSummary);
+                isAccepted &= isBelowMaxClusterNoise(_clusterSummary);
             }
-            isAccepted &= hasQuality(cluster);
-            isAccepted &= isInsideROI(cluster);
-            isAccepted &= isOutsideROI(cluster);
+            isAccepted &= hasQuality(_clusterSummary);
+            isAccepted &= isInsideROI(_clusterSummary);
+            isAccepted &= isOutsideROI(_clusterSummary);
 
             if ( isAccepted )  acceptedClusterVec.push_back(iPulse);
 
@@ -1157,18 +1160,18 @@ bool EUTelClusterFilter::hasSameNumberOfHit(std::vector<int > clusterNoVec) cons
   return hasSameNumber;
 }
 
-bool EUTelClusterFilter::isAboveNumberOfHitPixel(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveNumberOfHitPixel(const EUTelClusterSummary& cluster) const {
   if ( !_dffnhitsswitch ) {
     return true;
   }
   streamlog_out ( DEBUG1 ) << "Filtering against number of hit pixel inside a cluster " << endl;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap[ detectorID ];
 
-  if ( static_cast< int >(cluster->getTotalCharge()) >= _DFFNHitsCuts[detectorPos] ) return true;
+  if ( static_cast< int >(cluster.getTotalCharge()) >= _DFFNHitsCuts[detectorPos] ) return true;
   else {
-    streamlog_out ( DEBUG2 )  << "Rejected cluster because the number of hit pixel is " << static_cast< int >(cluster->getTotalCharge())
+    streamlog_out ( DEBUG2 )  << "Rejected cluster because the number of hit pixel is " << static_cast< int >(cluster.getTotalCharge())
                               << " and the threshold is " << _DFFNHitsCuts[detectorPos] << endl;
     _rejectionMap["MinHitPixel"][detectorPos]++;
     return false;
@@ -1177,55 +1180,55 @@ bool EUTelClusterFilter::isAboveNumberOfHitPixel(EUTelVirtualCluster * cluster)
 
 
 
-bool EUTelClusterFilter::isAboveMinTotalCharge(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveMinTotalCharge(const EUTelClusterSummary& cluster) const {
 
   if ( !_minTotalChargeSwitch ) {
     return true;
   }
   streamlog_out ( DEBUG1 ) << "Filtering against the total charge " << endl;
 
-  int detectorID  = cluster->getDetectorID();
+  int detectorID  = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap[ detectorID ];
 
-  if ( cluster->getTotalCharge() > _minTotalChargeVec[detectorPos] ) return true;
+  if ( cluster.getTotalCharge() > _minTotalChargeVec[detectorPos] ) return true;
   else {
-    streamlog_out ( DEBUG2 )  << "Rejected cluster because its charge is " << cluster->getTotalCharge()
+    streamlog_out ( DEBUG2 )  << "Rejected cluster because its charge is " << cluster.getTotalCharge()
                               << " and the threshold is " << _minTotalChargeVec[detectorPos] << endl;
     _rejectionMap["MinTotalChargeCut"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::isAboveMinTotalSNR(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveMinTotalSNR(const EUTelClusterSummary& cluster) const {
 
   if ( !_noiseRelatedCuts   ) return true;
   if ( !_minTotalSNRSwitch  ) return true;
 
-  int detectorID  = cluster->getDetectorID();
+  int detectorID  = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
 
   streamlog_out ( DEBUG1 ) << "Filtering against the minimum total SNR " << endl;
-  if  ( cluster->getClusterSNR() > _minTotalSNRVec[ detectorPos ] ) return true;
+  if  ( cluster.getClusterSNR() > _minTotalSNRVec[ detectorPos ] ) return true;
   else {
-    streamlog_out ( DEBUG2 )  << "Rejected cluster because its SNR is " << cluster->getClusterSNR()
+    streamlog_out ( DEBUG2 )  << "Rejected cluster because its SNR is " << cluster.getClusterSNR()
                               << " and the threshold is " << _minTotalSNRVec[ detectorPos ] << endl;
     _rejectionMap["MinTotalSNRCut"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::isAboveNMinCharge(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveNMinCharge(const EUTelClusterSummary& cluster) const {
 
   if ( !_minNChargeSwitch ) return true;
 
   streamlog_out ( DEBUG1 ) << "Filtering against the N Pixel charge " << endl;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
   vector<float >::const_iterator iter = _minNChargeVec.begin();
   while ( iter != _minNChargeVec.end() ) {
     int nPixel      = static_cast<int > (*iter);
-    float charge    = cluster->getClusterCharge(nPixel);
+    float charge    = cluster.getClusterCharge(nPixel);
     float threshold = (* (iter + detectorPos + 1) );
     if ( charge > threshold ) {
       iter += _noOfDetectors + 1;
@@ -1240,19 +1243,19 @@ bool EUTelClusterFilter::isAboveNMinCharge(EUTelVirtualCluster * cluster) const
 }
 
 
-bool EUTelClusterFilter::isAboveNMinSNR(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveNMinSNR(const EUTelClusterSummary& cluster) const {
 
   if ( !_noiseRelatedCuts ) return true;
   if ( !_minNSNRSwitch    ) return true;
 
   streamlog_out ( DEBUG1 ) << "Filtering against the N pixel SNR " << endl;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
   vector<float >::const_iterator iter = _minNSNRVec.begin();
   while ( iter !=  _minNSNRVec.end() ) {
     int nPixel      = static_cast<int > (*iter);
-    float SNR       = cluster->getClusterSNR(nPixel);
+    float SNR       = cluster.getClusterSNR(nPixel);
     float threshold = (* (iter + detectorPos + 1 ) );
     if ( SNR > threshold ) {
       iter += _noOfDetectors + 1;
@@ -1269,18 +1272,18 @@ bool EUTelClusterFilter::isAboveNMinSNR(EUTelVirtualCluster * cluster) const {
 
 
 
-bool EUTelClusterFilter::isAboveNxNMinCharge(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveNxNMinCharge(const EUTelClusterSummary& cluster) const {
 
   if ( !_minNxNChargeSwitch ) return true;
 
   streamlog_out ( DEBUG1 ) << "Filtering against the N x N pixel charge" << endl;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
   vector<float >::const_iterator iter = _minNxNChargeVec.begin();
   while ( iter != _minNxNChargeVec.end() ) {
     int nxnPixel    = static_cast<int > ( *iter ) ;
-    float charge    = cluster->getClusterCharge(nxnPixel, nxnPixel);
+    float charge    = cluster.getClusterCharge(nxnPixel, nxnPixel);
     float threshold = (* ( iter + detectorPos + 1 )) ;
     if ( ( threshold <= 0) || (charge > threshold) ) {
       iter += _noOfDetectors + 1;
@@ -1295,19 +1298,19 @@ bool EUTelClusterFilter::isAboveNxNMinCharge(EUTelVirtualCluster * cluster) cons
 }
 
 
-bool EUTelClusterFilter::isAboveNxNMinSNR(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveNxNMinSNR(const EUTelClusterSummary& cluster) const {
 
   if ( !_noiseRelatedCuts  ) return true;
   if ( !_minNxNSNRSwitch   ) return true;
 
   streamlog_out ( DEBUG1 ) << "Filtering against the N x N pixel charge" << endl;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
   vector<float >::const_iterator iter = _minNxNSNRVec.begin();
   while ( iter != _minNxNSNRVec.end() ) {
     int nxnPixel    = static_cast<int > ( *iter ) ;
-    float snr       = cluster->getClusterSNR(nxnPixel, nxnPixel);
+    float snr       = cluster.getClusterSNR(nxnPixel, nxnPixel);
     float threshold = (* ( iter + detectorPos + 1 )) ;
     if ( ( threshold <= 0) || (snr > threshold) ) {
       iter += _noOfDetectors + 1;
@@ -1322,35 +1325,35 @@ bool EUTelClusterFilter::isAboveNxNMinSNR(EUTelVirtualCluster * cluster) const {
 
 }
 
-bool EUTelClusterFilter::isAboveMinSeedCharge(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveMinSeedCharge(const EUTelClusterSummary& cluster) const {
 
   if ( !_minSeedChargeSwitch ) return true;
 
   streamlog_out ( DEBUG1 ) << "Filtering against the seed charge " << endl;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
-  if ( cluster->getSeedCharge() > _minSeedChargeVec[detectorPos] ) return true;
+  if ( cluster.getSeedCharge() > _minSeedChargeVec[detectorPos] ) return true;
   else {
-    streamlog_out ( DEBUG2 )  << "Rejected cluster because its seed charge is " << cluster->getSeedCharge()
+    streamlog_out ( DEBUG2 )  << "Rejected cluster because its seed charge is " << cluster.getSeedCharge()
                               << " and the threshold is " <<  _minSeedChargeVec[detectorPos] << endl;
     _rejectionMap["MinSeedChargeCut"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::isAboveMinSeedSNR(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveMinSeedSNR(const EUTelClusterSummary& cluster) const {
 
   if ( !_noiseRelatedCuts  ) return true;
   if ( !_minSeedSNRSwitch  ) return true;
 
   streamlog_out ( DEBUG1 ) << "Filtering against the seed SNR " << endl;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
-  if ( cluster->getSeedSNR() > _minSeedSNRVec[detectorPos] ) return true;
+  if ( cluster.getSeedSNR() > _minSeedSNRVec[detectorPos] ) return true;
   else {
-    streamlog_out ( DEBUG2 ) << "Rejected cluster because its seed charge is " << cluster->getSeedSNR()
+    streamlog_out ( DEBUG2 ) << "Rejected cluster because its seed charge is " << cluster.getSeedSNR()
                              << " and the threshold is " <<  _minSeedSNRVec[detectorPos] << endl;
     _rejectionMap["MinSeedSNRCut"][detectorPos]++;
     return false;
@@ -1359,15 +1362,15 @@ bool EUTelClusterFilter::isAboveMinSeedSNR(EUTelVirtualCluster * cluster) const
 
 
 
-bool EUTelClusterFilter::hasQuality(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::hasQuality(const EUTelClusterSummary& cluster) const {
 
   if ( !_clusterQualitySwitch ) return true;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
   if ( _clusterQualityVec[detectorID] < 0 ) return true;
 
-  ClusterQuality actual = cluster->getClusterQuality();
+  ClusterQuality actual = cluster.getClusterQuality();
   ClusterQuality needed = static_cast<ClusterQuality> ( _clusterQualityVec[detectorPos] );
 
   if ( actual == needed ) return true;
@@ -1379,18 +1382,18 @@ bool EUTelClusterFilter::hasQuality(EUTelVirtualCluster * cluster) const {
   }
 }
 
-bool EUTelClusterFilter::isBelowMaxClusterNoise(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isBelowMaxClusterNoise(const EUTelClusterSummary& cluster) const {
 
   if ( !_noiseRelatedCuts       ) return true;
   if ( !_maxClusterNoiseSwitch  ) return true;
 
   streamlog_out ( DEBUG1 ) << "Filtering against the maximum cluster noise"  << endl;
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
-  if (  ( cluster->getClusterNoise() < _maxClusterNoiseVec[detectorPos] ) ||
+  if (  ( cluster.getClusterNoise() < _maxClusterNoiseVec[detectorPos] ) ||
         ( _maxClusterNoiseVec[detectorID] < 0 ) ) return true;
   else {
-    streamlog_out ( DEBUG2 )  << "Rejected cluster because its noise is " << cluster->getClusterNoise()
+    streamlog_out ( DEBUG2 )  << "Rejected cluster because its noise is " << cluster.getClusterNoise()
                               << " and the threshold is " <<  _maxClusterNoiseVec[detectorPos] << endl;
     _rejectionMap["MaxClusterNoiseCut"][detectorPos]++;
     return false;
@@ -1398,14 +1401,14 @@ bool EUTelClusterFilter::isBelowMaxClusterNoise(EUTelVirtualCluster * cluster) c
 }
 
 
-bool EUTelClusterFilter::isInsideROI(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isInsideROI(const EUTelClusterSummary& cluster) const {
 
   if ( !_insideROISwitch ) return true;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
   float x, y;
-  cluster->getCenterOfGravity(x, y);
+  cluster.getCenterOfGravity(x, y);
 
   bool tempAccepted = true;
   vector<EUTelROI>::const_iterator iter = _insideROIVec.begin();
@@ -1429,14 +1432,14 @@ bool EUTelClusterFilter::isInsideROI(EUTelVirtualCluster * cluster) const {
 
 }
 
-bool EUTelClusterFilter::isOutsideROI(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isOutsideROI(const EUTelClusterSummary& cluster) const {
 
   if ( !_outsideROISwitch ) return true;
 
-  int detectorID = cluster->getDetectorID();
+  int detectorID = cluster.getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
   float x, y;
-  cluster->getCenterOfGravity(x, y);
+  cluster.getCenterOfGravity(x, y);
 
   bool tempAccepted = true;
   vector<EUTelROI>::const_iterator iter = _outsideROIVec.begin();
@@ -0,0 +1,193 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelClusterPositionBatch.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+using namespace eutelescope;
+
+EUTelEtaLookupTable::EUTelEtaLookupTable():
+_table(),
+_xMin(0),
+_xMax(0),
+_invStep(0)
+{}
+
+void EUTelEtaLookupTable::build(const std::vector<double>& centers, const std::vector<double>& values, unsigned int nSamples) {
+  _table.clear();
+  if( centers.size() < 2 || centers.size() != values.size() || nSamples < 2 ) return;
+
+  _xMin = static_cast<float>( centers.front() );
+  _xMax = static_cast<float>( centers.back() );
+  const double step = ( centers.back() - centers.front() ) / ( nSamples - 1 );
+  if( step <= 0 ) return;
+  _invStep = static_cast<float>( 1. / step );
+
+  // the bin centers are sorted, so a single forward scan is enough
+  // to resample the piecewise linear function on the uniform grid
+  _table.resize( nSamples );
+  std::size_t right = 1;
+  for( unsigned int i = 0; i < nSamples; ++i ) {
+    const double x = std::min( centers.front() + i * step, centers.back() );
+    while( right < centers.size() - 1 && centers[right] < x ) ++right;
+    const double xl = centers[right - 1];
+    const double xr = centers[right];
+    const double f  = ( xr > xl ) ? ( x - xl ) / ( xr - xl ) : 0.;
+    _table[i] = static_cast<float>( values[right - 1] + f * ( values[right] - values[right - 1] ) );
+  }
+}
+
+float EUTelEtaLookupTable::eval(float x) const {
+  float out;
+  eval( &x, &out, 1 );
+  return out;
+}
+
+void EUTelEtaLookupTable::eval(const float* x, float* out, std::size_t n) const {
+  const float* table = &_table[0];
+  const float last   = static_cast<float>( _table.size() - 1 );
+  const float xMin   = _xMin;
+  const float invStep = _invStep;
+  for( std::size_t i = 0; i < n; ++i ) {
+    float t = ( x[i] - xMin ) * invStep;
+    t = t < 0.f ? 0.f : t;
+    t = t > last ? last : t;
+    // the last sample is reached with f == 1 on the previous interval
+    int index = static_cast<int>( t );
+    index = index > static_cast<int>( last ) - 1 ? static_cast<int>( last ) - 1 : index;
+    const float f = t - index;
+    out[i] = table[index] + f * ( table[index + 1] - table[index] );
+  }
+}
+
+EUTelClusterBatch::EUTelClusterBatch():
+_x(),
+_y(),
+_q(),
+_offsets(1, 0)
+{}
+
+void EUTelClusterBatch::clear() {
+  _x.clear();
+  _y.clear();
+  _q.clear();
+  _offsets.assign( 1, 0 );
+}
+
+void EUTelClusterBatch::reserve(std::size_t nClusters, std::size_t nPixels) {
+  _x.reserve( nPixels );
+  _y.reserve( nPixels );
+  _q.reserve( nPixels );
+  _offsets.reserve( nClusters + 1 );
+}
+
+void EUTelClusterBatch::beginCluster() {
+  _offsets.push_back( _offsets.back() );
+}
+
+void ClusterPosition::seed(const EUTelClusterBatch& batch, float* xSeed, float* ySeed) {
+  const float* x = batch.x();
+  const float* y = batch.y();
+  const float* q = batch.q();
+  const uint32_t* offsets = batch.offsets();
+  for( std::size_t c = 0; c < batch.size(); ++c ) {
+    uint32_t best = offsets[c];
+    for( uint32_t p = offsets[c] + 1; p < offsets[c + 1]; ++p ) {
+      best = q[p] > q[best] ? p : best;
+    }
+    xSeed[c] = ( offsets[c + 1] > offsets[c] ) ? x[best] : 0.f;
+    ySeed[c] = ( offsets[c + 1] > offsets[c] ) ? y[best] : 0.f;
+  }
+}
+
+void ClusterPosition::centerOfGravity(const EUTelClusterBatch& batch, float* xCoG, float* yCoG) {
+  const float* x = batch.x();
+  const float* y = batch.y();
+  const float* q = batch.q();
+  const uint32_t* offsets = batch.offsets();
+  for( std::size_t c = 0; c < batch.size(); ++c ) {
+    // the arithmetic of EUTelGenericSparseClusterImpl::getCenterOfGravity:
+    // products in double, position sums in float, total charge in double
+    float sumX = 0.f, sumY = 0.f;
+    double sumQ = 0.;
+    for( uint32_t p = offsets[c]; p < offsets[c + 1]; ++p ) {
+      const double charge = q[p];
+      sumX += x[p] * charge;
+      sumY += y[p] * charge;
+      sumQ += charge;
+    }
+    xCoG[c] = sumX / sumQ;
+    yCoG[c] = sumY / sumQ;
+  }
+}
+
+void ClusterPosition::centerOfGravityNxM(const EUTelClusterBatch& batch, int nx, int ny, const float* xSeed, const float* ySeed,
+                                         float* xCoG, float* yCoG) {
+  const float* x = batch.x();
+  const float* y = batch.y();
+  const float* q = batch.q();
+  const uint32_t* offsets = batch.offsets();
+  const float halfX = static_cast<float>( nx / 2 );
+  const float halfY = static_cast<float>( ny / 2 );
+  for( std::size_t c = 0; c < batch.size(); ++c ) {
+    const float xs = xSeed[c];
+    const float ys = ySeed[c];
+    double sumX = 0., sumY = 0., sumQ = 0.;
+    for( uint32_t p = offsets[c]; p < offsets[c + 1]; ++p ) {
+      const float inside = ( std::fabs( x[p] - xs ) <= halfX && std::fabs( y[p] - ys ) <= halfY ) ? 1.f : 0.f;
+      const float w = inside * q[p];
+      sumX += x[p] * w;
+      sumY += y[p] * w;
+      sumQ += w;
+    }
+    xCoG[c] = static_cast<float>( sumX / sumQ );
+    yCoG[c] = static_cast<float>( sumY / sumQ );
+  }
+}
+
+void ClusterPosition::centerOfGravityNPixel(const EUTelClusterBatch& batch, int n, float* xCoG, float* yCoG) {
+  const float* x = batch.x();
+  const float* y = batch.y();
+  const float* q = batch.q();
+  const uint32_t* offsets = batch.offsets();
+  std::vector<float> charges;
+  for( std::size_t c = 0; c < batch.size(); ++c ) {
+    const uint32_t begin = offsets[c];
+    const uint32_t end   = offsets[c + 1];
+    // the threshold is the charge of the n-th most significant pixel,
+    // the weighted sum below is then a masked one over the full cluster
+    float threshold = -std::numeric_limits<float>::max();
+    if( n > 0 && end - begin > static_cast<uint32_t>( n ) ) {
+      charges.assign( q + begin, q + end );
+      std::nth_element( charges.begin(), charges.begin() + ( n - 1 ), charges.end(), std::greater<float>() );
+      threshold = charges[n - 1];
+    }
+    double sumX = 0., sumY = 0., sumQ = 0.;
+    for( uint32_t p = begin; p < end; ++p ) {
+      const float w = ( q[p] >= threshold ) ? q[p] : 0.f;
+      sumX += x[p] * w;
+      sumY += y[p] * w;
+      sumQ += w;
+    }
+    xCoG[c] = static_cast<float>( sumX / sumQ );
+    yCoG[c] = static_cast<float>( sumY / sumQ );
+  }
+}
+
+void ClusterPosition::applyEta(const EUTelEtaLookupTable& eta, const float* seed, const float* cog, float* pos, float* work, std::size_t n) {
+  for( std::size_t i = 0; i < n; ++i ) work[i] = cog[i] - seed[i];
+  eta.eval( work, work, n );
+  for( std::size_t i = 0; i < n; ++i ) pos[i] = seed[i] + work[i];
+}
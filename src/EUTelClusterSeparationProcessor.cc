@@ -29,9 +29,9 @@
 #include <UTIL/CellIDEncoder.h>
 
 // system includes <>
+#include <algorithm>
 #include <vector>
 #include <string>
-#include <set>
 #include <memory>
 #include <iostream>
 #include <iomanip>
@@ -112,9 +112,11 @@ void EUTelClusterSeparationProcessor::processEvent (LCEvent * event) {
   CellIDEncoder<TrackerPulseImpl> outputEncoder(EUTELESCOPE::PULSEDEFAULTENCODING, outputCollectionVec);
   CellIDDecoder<TrackerPulseImpl> cellDecoder(clusterCollectionVec);
 
-  vector< pair<int, int > >       mergingPairVector;
+  const int nClusters = clusterCollectionVec->getNumberOfElements();
+  _clusters.clear();
+  _mergingGroups.reset( nClusters );
 
-  for ( int iCluster = 0 ; iCluster < clusterCollectionVec->getNumberOfElements() ; iCluster++) {
+  for ( int iCluster = 0 ; iCluster < nClusters ; iCluster++) {
 
     TrackerPulseImpl   * pulse   = dynamic_cast<TrackerPulseImpl *>   ( clusterCollectionVec->getElementAt(iCluster) );
     ClusterType          type    = static_cast<ClusterType> (static_cast<int>( cellDecoder(pulse)["type"] ) );
@@ -152,70 +154,77 @@ void EUTelClusterSeparationProcessor::processEvent (LCEvent * event) {
         throw UnknownDataTypeException("Pixel type unknown");
       }
 
+      // only fixed frame and bricked clusters can be compared
+      if ( iCluster + 1 < nClusters ) {
+        delete cluster;
+        streamlog_out ( ERROR4 ) << "Unknown cluster type. Sorry for quitting" << endl;
+        throw UnknownDataTypeException("Cluster type unknown");
+      }
+
     } else {
       streamlog_out ( ERROR4 ) <<  "Unknown cluster type. Sorry for quitting" << endl;
       throw UnknownDataTypeException("Cluster type unknown");
     }
 
-    int  iOtherCluster     = iCluster + 1;
-    bool isExisisting      = (iOtherCluster < clusterCollectionVec->getNumberOfElements() );
-    bool isOnSameDetector  = true;
-
-
-    while ( isOnSameDetector && isExisisting ) {
-
-      // get the next cluster in the collection
-      TrackerPulseImpl    * otherPulse   = dynamic_cast<TrackerPulseImpl *> (clusterCollectionVec->getElementAt(iOtherCluster)) ;
-      EUTelVirtualCluster * otherCluster;
+    _clusters.push_back( std::unique_ptr<EUTelVirtualCluster>( cluster ) );
+  }
 
-      if ( type == kEUTelFFClusterImpl )
-        otherCluster = new EUTelFFClusterImpl( static_cast<TrackerDataImpl*> (otherPulse->getTrackerData()) );
-      else if ( type == kEUTelBrickedClusterImpl )
-        otherCluster = new EUTelBrickedClusterImpl( static_cast<TrackerDataImpl*> (otherPulse->getTrackerData()) );
-      else
-      {
-        streamlog_out ( ERROR4 ) << "Unknown cluster type. Sorry for quitting" << endl;
-        throw UnknownDataTypeException("Cluster type unknown");
+  if ( _minimumDistance == 0 ) {
+    // ok we need to calculate the touching distance, from the first
+    // two neighbouring clusters on the same detector
+    for ( int iCluster = 0 ; iCluster + 1 < nClusters ; iCluster++) {
+      if ( _clusters[iCluster]->getDetectorID() == _clusters[iCluster + 1]->getDetectorID() ) {
+        _minimumDistance = _clusters[iCluster]->getExternalRadius() + _clusters[iCluster + 1]->getExternalRadius();
+        break;
       }
+    }
+  }
 
-      // check if the two are on the same detector
-      if ( cluster->getDetectorID() == otherCluster->getDetectorID() ) {
-
-        if ( _minimumDistance == 0 ) {
-          // ok we need to calculate the touching distance
-          float radius      = cluster->getExternalRadius();
-          float otherRadius = otherCluster->getExternalRadius();
-          _minimumDistance  = radius + otherRadius;
-        }
+  // the clusters of a detector are consecutive in the collection. Two
+  // clusters closer than _minimumDistance are closer than that along
+  // x too, so sorting them along x each one needs to be compared only
+  // with the following few.
+  bool hasMergingPair = false;
+  int iBegin = 0;
+  while ( iBegin < nClusters ) {
+    int iEnd = iBegin + 1;
+    while ( iEnd < nClusters && _clusters[iEnd]->getDetectorID() == _clusters[iBegin]->getDetectorID() ) ++iEnd;
+
+    _sweepOrder.clear();
+    for ( int iCluster = iBegin ; iCluster < iEnd ; iCluster++) {
+      int xCenter, yCenter;
+      _clusters[iCluster]->getCenterCoord( xCenter, yCenter );
+      _sweepOrder.push_back( make_pair( xCenter, iCluster ) );
+    }
+    sort( _sweepOrder.begin(), _sweepOrder.end() );
 
-        // ok they are on the same plane, so it makes sense check it
-        // they are merging
-        float distance = cluster->getDistance(otherCluster);
+    for ( size_t iSweep = 0 ; iSweep < _sweepOrder.size() ; iSweep++) {
+      for ( size_t iOtherSweep = iSweep + 1 ;
+            iOtherSweep < _sweepOrder.size() && _sweepOrder[iOtherSweep].first - _sweepOrder[iSweep].first < _minimumDistance ;
+            iOtherSweep++) {
+        // the lower index first, as the pairs were compared before
+        int iCluster      = min( _sweepOrder[iSweep].second, _sweepOrder[iOtherSweep].second );
+        int iOtherCluster = max( _sweepOrder[iSweep].second, _sweepOrder[iOtherSweep].second );
+        float distance = _clusters[iCluster]->getDistance( _clusters[iOtherCluster].get() );
 
         if ( distance < _minimumDistance ) {
           // they are merging! we need to apply the separation
           // algorithm
-          mergingPairVector.push_back( make_pair(iCluster, iOtherCluster) );
+          _mergingGroups.merge( iCluster, iOtherCluster );
+          hasMergingPair = true;
         }
-
-      } else {
-        isOnSameDetector = false;
       }
-      isExisisting = (++iOtherCluster <  clusterCollectionVec->getNumberOfElements() );
-      delete otherCluster;
     }
-
-    delete cluster;
+    iBegin = iEnd;
   }
-
-  // at this point we have inserted into the mergingPairVector all the
-  // pairs of merging clusters. we can try to put together all groups
-  // of clusters, but only in the case the mergingPairVector has a non
-  // null size
-  if ( mergingPairVector.empty() ) {
-    // if the mergingPairVector is empty, then there are no merging
-    // clusters, i.e. that the input and the output collections are
-    // exactly the same
+  _clusters.clear();
+
+  // at this point all the merging clusters are joined. we can put
+  // together all groups of clusters, but only in the case at least a
+  // pair was found
+  if ( !hasMergingPair ) {
+    // if there are no merging clusters, then the input and the output
+    // collections are exactly the same
     for ( int iPulse = 0; iPulse < clusterCollectionVec->getNumberOfElements() ; iPulse++ ) {
       TrackerPulseImpl * pulse    = dynamic_cast<TrackerPulseImpl *> ( clusterCollectionVec->getElementAt( iPulse ) );
       TrackerPulseImpl * newPulse = new TrackerPulseImpl;
@@ -232,25 +241,24 @@ void EUTelClusterSeparationProcessor::processEvent (LCEvent * event) {
     return ;
   }
 
-  // all merging clusters are collected into a vector of set. Each set
-  // is a group of clusters all merging.
-  vector< set<int > > mergingSetVector;
-  groupingMergingPairs(mergingPairVector, &mergingSetVector) ;
+  // all merging clusters are collected into a vector of groups. Each
+  // group is a set of clusters all merging.
+  groupingMergingClusters(&_groupVector) ;
 
-  applySeparationAlgorithm(mergingSetVector, clusterCollectionVec, outputCollectionVec);
+  applySeparationAlgorithm(_groupVector, clusterCollectionVec, outputCollectionVec);
   evt->addCollection( outputCollectionVec, _clusterOutputCollectionName );
 
 
 }
 
 
-bool EUTelClusterSeparationProcessor::applySeparationAlgorithm(std::vector<std::set <int > > setVector,
+bool EUTelClusterSeparationProcessor::applySeparationAlgorithm(const std::vector<std::vector <int > >& groupVector,
                                                                LCCollectionVec * inputCollectionVec,
                                                                LCCollectionVec * outputCollectionVec) const {
 
   //  message<DEBUG5> ( log() << "Applying cluster separation algorithm
   //  " << _separationAlgo );
-  streamlog_out ( DEBUG0 ) <<  "Found "  << setVector.size() << " group(s) of merging clusters " << endl;
+  streamlog_out ( DEBUG0 ) <<  "Found "  << groupVector.size() << " group(s) of merging clusters " << endl;
 
   if ( _separationAlgo == EUTELESCOPE::FLAGONLY ) {
 
@@ -280,13 +288,13 @@ bool EUTelClusterSeparationProcessor::applySeparationAlgorithm(std::vector<std::
 
     int iCounter = 0;
 
-    vector<set <int > >::iterator vectorIterator = setVector.begin();
-    while ( vectorIterator != setVector.end() ) {
+    vector<vector <int > >::const_iterator vectorIterator = groupVector.begin();
+    while ( vectorIterator != groupVector.end() ) {
 
 
       streamlog_out ( DEBUG4 )  <<  "     Group " << (iCounter++) << " with the following clusters " << endl;
 
-      set <int >::iterator setIterator = (*vectorIterator).begin();
+      vector <int >::const_iterator setIterator = (*vectorIterator).begin();
       while ( setIterator != (*vectorIterator).end() ) {
         TrackerPulseImpl    * pulse   = dynamic_cast<TrackerPulseImpl * > ( outputCollectionVec->getElementAt( *setIterator ) ) ;
         ClusterType           type    = static_cast<ClusterType> (static_cast<int>( cellDecoder(pulse)["type"] ) );
@@ -326,43 +334,11 @@ bool EUTelClusterSeparationProcessor::applySeparationAlgorithm(std::vector<std::
 
 }
 
-void EUTelClusterSeparationProcessor::groupingMergingPairs(std::vector< std::pair<int , int> > pairVector,
-                                                           std::vector< std::set<int > > * setVector) const {
-
-  streamlog_out ( DEBUG0 ) << "Grouping merging pairs of clusters " << endl;
-
-  vector< pair<int, int> >::iterator iter = pairVector.begin();
-  while ( iter != pairVector.end() ) {
+void EUTelClusterSeparationProcessor::groupingMergingClusters(std::vector< std::vector<int > > * groupVector) {
 
-    set<int > tempSet;
-    // add the pair to the tempSet
-    tempSet.insert(pairVector.front().first);
-    tempSet.insert(pairVector.front().second);
+  streamlog_out ( DEBUG0 ) << "Grouping merging clusters " << endl;
 
-    vector<vector< pair<int, int> >::iterator > tempIterVec;
-    tempIterVec.push_back(iter);
-
-    if ( iter + 1 != pairVector.end() ) {
-      vector< pair<int, int> >::iterator otherIter = iter + 1;
-      while (otherIter != pairVector.end() ) {
-        if ( ( tempSet.find(otherIter->first)  != tempSet.end() ) ||
-             ( tempSet.find(otherIter->second) != tempSet.end() ) ) {
-          tempSet.insert(otherIter->first);
-          tempSet.insert(otherIter->second);
-          tempIterVec.push_back(otherIter);
-        }
-        ++otherIter;
-      }
-    }
-    setVector->push_back(tempSet);
-
-    // remove the pairs already grouped starting from the last
-    vector<vector< pair<int, int> >::iterator >::reverse_iterator iterIter = tempIterVec.rbegin();
-    while ( iterIter != tempIterVec.rend() ) {
-      pairVector.erase(*iterIter);
-      ++iterIter;
-    }
-  }
+  _mergingGroups.getGroups( *groupVector );
 }
 
 void EUTelClusterSeparationProcessor::check (LCEvent * /* evt */ ) {
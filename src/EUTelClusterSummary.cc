@@ -0,0 +1,305 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelClusterSummary.h"
+#include "EUTelFFClusterImpl.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelSparseClusterImpl.h"
+
+// lcio includes <.h>
+#include <Exceptions.h>
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+
+using namespace eutelescope;
+
+namespace {
+  //! Order of the single getClusterSNR(nPixel): decreasing signal, lower index first
+  struct HigherSignal {
+    explicit HigherSignal(const std::vector<float>& charge): _charge(charge) {}
+    bool operator()(std::size_t a, std::size_t b) const { return _charge[a] > _charge[b]; }
+    const std::vector<float>& _charge;
+  };
+}
+
+EUTelClusterSummary::EUTelClusterSummary():
+  _cluster(0),
+  _summarised(false),
+  _isFixedFrame(false),
+  _detectorID(0),
+  _hasNoise(false),
+  _charge(),
+  _noise(),
+  _noise2(),
+  _dx(),
+  _dy(),
+  _xSize(0),
+  _ySize(0),
+  _totalCharge(0),
+  _seedIndex(0),
+  _clusterNoise(0),
+  _chargePrefix(),
+  _rank(),
+  _snrSignalPrefix(),
+  _snrNoise2Prefix(),
+  _hasCenterOfGravity(false),
+  _xCoG(0),
+  _yCoG(0),
+  _nPixelSNR(),
+  _subClusters(),
+  _scratch()
+{}
+
+void EUTelClusterSummary::fill(EUTelVirtualCluster* cluster) {
+  _cluster = cluster;
+  _detectorID = cluster->getDetectorID();
+  _hasCenterOfGravity = false;
+  _nPixelSNR.clear();
+  _subClusters.clear();
+  _charge.clear();
+  _dx.clear();
+  _dy.clear();
+
+  EUTelFFClusterImpl* ffCluster = dynamic_cast<EUTelFFClusterImpl*>( cluster );
+  EUTelSparseClusterImpl<EUTelGenericSparsePixel>* sparseCluster =
+    dynamic_cast<EUTelSparseClusterImpl<EUTelGenericSparsePixel>*>( cluster );
+  _isFixedFrame = ( ffCluster != 0 );
+  _summarised   = ( ffCluster != 0 || sparseCluster != 0 );
+  if ( !_summarised ) {
+    _hasNoise = false;
+    return;
+  }
+
+  cluster->getClusterSize( _xSize, _ySize );
+  if ( ffCluster ) {
+    // the pixels of the frame, row by row around the center
+    const EVENT::FloatVec& values = ffCluster->trackerData()->getChargeValues();
+    _charge.assign( values.begin(), values.end() );
+    for ( int yPixel = -1 * ( _ySize / 2 ); yPixel <= ( _ySize / 2 ); yPixel++ ) {
+      for ( int xPixel = -1 * ( _xSize / 2 ); xPixel <= ( _xSize / 2 ); xPixel++ ) {
+        _dx.push_back( xPixel );
+        _dy.push_back( yPixel );
+      }
+    }
+    _dx.resize( _charge.size(), 0 );
+    _dy.resize( _charge.size(), 0 );
+  } else {
+    int xSeed, ySeed;
+    sparseCluster->getSeedCoord( xSeed, ySeed );
+    EUTelGenericSparsePixel pixel;
+    for ( unsigned int iPixel = 0; iPixel < sparseCluster->size(); iPixel++ ) {
+      sparseCluster->getSparsePixelAt( iPixel, &pixel );
+      _charge.push_back( pixel.getSignal() );
+      _dx.push_back( static_cast<int>( pixel.getXCoord() ) - xSeed );
+      _dy.push_back( static_cast<int>( pixel.getYCoord() ) - ySeed );
+    }
+  }
+  const std::size_t nPixels = _charge.size();
+
+  // the sums run in the order of the cluster methods, so that the
+  // rounding is the same too
+  _totalCharge = 0;
+  _seedIndex = 0;
+  float maxSignal = -1 * std::numeric_limits<float>::max();
+  for ( std::size_t i = 0; i < nPixels; ++i ) {
+    _totalCharge += _charge[i];
+    if ( _charge[i] > maxSignal ) {
+      maxSignal = _charge[i];
+      _seedIndex = i;
+    }
+  }
+
+  std::vector<float> sorted( _charge );
+  std::sort( sorted.begin(), sorted.end(), std::greater<float>() );
+  _chargePrefix.assign( 1, 0.f );
+  float charge = 0;
+  for ( std::size_t i = 0; i < nPixels; ++i ) {
+    charge += sorted[i];
+    _chargePrefix.push_back( charge );
+  }
+
+  _rank.resize( nPixels );
+  for ( std::size_t i = 0; i < nPixels; ++i ) _rank[i] = i;
+  std::stable_sort( _rank.begin(), _rank.end(), HigherSignal( _charge ) );
+
+  updateNoise();
+}
+
+void EUTelClusterSummary::updateNoise() {
+  _nPixelSNR.clear();
+  _subClusters.clear();
+  if ( !_summarised ) return;
+
+  const std::size_t nPixels = _charge.size();
+  try {
+    _noise = _cluster->getNoiseValues();
+    _hasNoise = ( _noise.size() == nPixels );
+  } catch ( lcio::DataNotAvailableException& ) {
+    _noise.clear();
+    _hasNoise = false;
+  }
+
+  _noise2.clear();
+  _snrSignalPrefix.clear();
+  _snrNoise2Prefix.clear();
+  _clusterNoise = 0;
+  if ( !_hasNoise ) return;
+
+  float squaredSum = 0;
+  for ( std::size_t i = 0; i < nPixels; ++i ) {
+    _noise2.push_back( std::pow( _noise[i], 2 ) );
+    squaredSum += _noise2[i];
+  }
+  _clusterNoise = std::sqrt( squaredSum );
+
+  // the vector getClusterSNR ranks the pixels in a multimap, which
+  // puts the higher index first among equal signals
+  _snrSignalPrefix.assign( 1, 0.f );
+  _snrNoise2Prefix.assign( 1, 0.f );
+  float signal = 0, noise2 = 0;
+  std::size_t begin = 0;
+  while ( begin < nPixels ) {
+    std::size_t end = begin + 1;
+    while ( end < nPixels && _charge[ _rank[end] ] == _charge[ _rank[begin] ] ) ++end;
+    for ( std::size_t i = end; i > begin; --i ) {
+      signal += _charge[ _rank[i - 1] ];
+      noise2 += _noise2[ _rank[i - 1] ];
+      _snrSignalPrefix.push_back( signal );
+      _snrNoise2Prefix.push_back( noise2 );
+    }
+    begin = end;
+  }
+}
+
+float EUTelClusterSummary::getTotalCharge() const {
+  if ( !_summarised ) return _cluster->getTotalCharge();
+  return _totalCharge;
+}
+
+float EUTelClusterSummary::getSeedCharge() const {
+  if ( !_summarised ) return _cluster->getSeedCharge();
+  if ( _charge.empty() ) return -1 * std::numeric_limits<float>::max();
+  return _charge[ _seedIndex ];
+}
+
+float EUTelClusterSummary::getClusterCharge(int nPixel) const {
+  if ( !_summarised ) return _cluster->getClusterCharge( nPixel );
+  if ( nPixel <= 0 ) return 0;
+  if ( static_cast<std::size_t>( nPixel ) >= _charge.size() ) return _totalCharge;
+  return _chargePrefix[ nPixel ];
+}
+
+float EUTelClusterSummary::getClusterCharge(int xSize, int ySize) const {
+  if ( !_summarised ) return _cluster->getClusterCharge( xSize, ySize );
+  if ( _isFixedFrame && xSize >= _xSize && ySize >= _ySize ) return _totalCharge;
+  return subCluster( xSize, ySize ).first;
+}
+
+float EUTelClusterSummary::getClusterNoise() const {
+  if ( !_summarised ) return _cluster->getClusterNoise();
+  checkNoise();
+  return _clusterNoise;
+}
+
+float EUTelClusterSummary::getClusterSNR() const {
+  if ( !_summarised ) return _cluster->getClusterSNR();
+  checkNoise();
+  if ( _clusterNoise == 0 ) return 0.;
+  return _totalCharge / _clusterNoise;
+}
+
+float EUTelClusterSummary::getSeedSNR() const {
+  if ( !_summarised ) return _cluster->getSeedSNR();
+  checkNoise();
+  return _charge[ _seedIndex ] / _noise[ _seedIndex ];
+}
+
+float EUTelClusterSummary::getClusterSNR(int nPixel) const {
+  if ( !_summarised ) return _cluster->getClusterSNR( nPixel );
+  checkNoise();
+  if ( nPixel >= static_cast<int>( _charge.size() ) ) return getClusterSNR();
+
+  for ( std::vector<std::pair<int, float> >::const_iterator iter = _nPixelSNR.begin(); iter != _nPixelSNR.end(); ++iter ) {
+    if ( iter->first == nPixel ) return iter->second;
+  }
+
+  // the cluster methods add the highest pixels in the order of their index
+  _scratch.assign( _rank.begin(), _rank.begin() + std::max( nPixel, 0 ) );
+  std::sort( _scratch.begin(), _scratch.end() );
+  float signal = 0, noise2 = 0;
+  for ( std::vector<std::size_t>::const_iterator iter = _scratch.begin(); iter != _scratch.end(); ++iter ) {
+    signal += _charge[ *iter ];
+    noise2 += _noise2[ *iter ];
+  }
+  const float snr = ( noise2 == 0 ) ? 0 : signal / std::sqrt( noise2 );
+  _nPixelSNR.push_back( std::make_pair( nPixel, snr ) );
+  return snr;
+}
+
+float EUTelClusterSummary::getClusterSNR(int xSize, int ySize) const {
+  if ( !_summarised ) return _cluster->getClusterSNR( xSize, ySize );
+  checkNoise();
+  if ( _isFixedFrame && xSize >= _xSize && ySize >= _ySize ) return getClusterSNR();
+  const std::pair<float, float>& sums = subCluster( xSize, ySize );
+  if ( sums.second == 0 ) return 0.;
+  return sums.first / std::sqrt( sums.second );
+}
+
+std::vector<float> EUTelClusterSummary::getClusterSNR(const std::vector<int>& nPixels) const {
+  if ( !_summarised ) return _cluster->getClusterSNR( nPixels );
+  checkNoise();
+  std::vector<float> snr;
+  snr.reserve( nPixels.size() );
+  for ( std::vector<int>::const_iterator iter = nPixels.begin(); iter != nPixels.end(); ++iter ) {
+    if ( _isFixedFrame && *iter >= _xSize * _ySize ) {
+      snr.push_back( getClusterSNR() );
+      continue;
+    }
+    const std::size_t n = std::min( static_cast<std::size_t>( std::max( *iter, 0 ) ), _charge.size() );
+    if ( _snrNoise2Prefix[n] == 0 ) snr.push_back( 0. );
+    else snr.push_back( _snrSignalPrefix[n] / std::sqrt( _snrNoise2Prefix[n] ) );
+  }
+  return snr;
+}
+
+void EUTelClusterSummary::getCenterOfGravity(float& x, float& y) const {
+  if ( !_hasCenterOfGravity ) {
+    _cluster->getCenterOfGravity( _xCoG, _yCoG );
+    _hasCenterOfGravity = true;
+  }
+  x = _xCoG;
+  y = _yCoG;
+}
+
+void EUTelClusterSummary::checkNoise() const {
+  if ( !_hasNoise ) throw lcio::DataNotAvailableException("No noise values set");
+}
+
+const std::pair<float, float>& EUTelClusterSummary::subCluster(int xSize, int ySize) const {
+  for ( std::vector<std::pair<std::pair<int, int>, std::pair<float, float> > >::const_iterator iter = _subClusters.begin();
+        iter != _subClusters.end(); ++iter ) {
+    if ( iter->first.first == xSize && iter->first.second == ySize ) return iter->second;
+  }
+
+  float charge = 0, noise2 = 0;
+  for ( std::size_t i = 0; i < _charge.size(); ++i ) {
+    if ( std::abs( _dx[i] ) <= ( xSize / 2 ) && std::abs( _dy[i] ) <= ( ySize / 2 ) ) {
+      charge += _charge[i];
+      if ( _hasNoise ) noise2 += _noise2[i];
+    }
+  }
+  _subClusters.push_back( std::make_pair( std::make_pair( xSize, ySize ), std::make_pair( charge, noise2 ) ) );
+  return _subClusters.back().second;
+}
@@ -94,7 +94,7 @@ EUTelClusteringProcessor::EUTelClusteringProcessor ()
       _iEvt(0),
       _fillHistos(false),
       _histoInfoFileName(""),
-      _seedCandidateMap(),
+      _seedFinderMap(),
       _totClusterMap(),
       _noOfDetector(0),
       _ExcludedPlanes(),
@@ -2284,40 +2284,29 @@ void EUTelClusteringProcessor::fixedFrameClustering(LCEvent * evt, LCCollectionV
         // prepare the matrix decoder
         EUTelMatrixDecoder matrixDecoder(cellDecoder, nzsData);
 
-        // reset the status
-        resetStatus(status);
+        // the clustered pixels are kept by the seed finder, the status
+        // only needs cleaning from what was stored in it before
+        if ( isFirstEvent() ) resetStatus(status);
 
         // initialize the cluster counter
         short clusterCounter = 0;
         short limitExceed    = 0;
 
-        _seedCandidateMap.clear();
-
-        for (unsigned int iPixel = 0; iPixel < nzsData->getChargeValues().size(); iPixel++)
-        {
-            if (status->getADCValues()[iPixel] == EUTELESCOPE::GOODPIXEL)
-            {
-                if ( nzsData->getChargeValues()[iPixel] > _ffSeedCut * noise->getChargeValues()[iPixel])
-                {
-                    _seedCandidateMap.push_back(make_pair( nzsData->getChargeValues()[iPixel], iPixel));
-                }
-            }
-        }
+        EUTelSeedFinder& seedFinder = _seedFinderMap[ sensorID ];
+        seedFinder.findCandidates( nzsData->getChargeValues(), noise->getChargeValues(), status->getADCValues(), _ffSeedCut );
 
         // continue only if seed candidate map is not empty!
-        if ( !_seedCandidateMap.empty() ) {
+        if ( !seedFinder.getCandidates().empty() ) {
 
-            streamlog_out ( DEBUG0 ) << "There are << " << _seedCandidateMap.size() << " seed candidates." << endl;
+            streamlog_out ( DEBUG0 ) << "There are << " << seedFinder.getCandidates().size() << " seed candidates." << endl;
 
-            // now built up a cluster for each seed candidate
-            //Start by sorting the vector in order of smallest to largest seed signal
-            std::sort(_seedCandidateMap.begin(),_seedCandidateMap.end());
-            vector< pair< float, unsigned int > >::iterator mapIter = _seedCandidateMap.end();
-            while ( mapIter != _seedCandidateMap.begin() ) {
-                --mapIter;
+            // now built up a cluster for each seed candidate, starting
+            // from the largest seed signal
+            unsigned int seedIndex;
+            while ( seedFinder.nextSeed( seedIndex ) ) {
                 // check if this seed candidate has not been already added to a
                 // cluster
-                if ( status->adcValues()[(*mapIter).second] == EUTELESCOPE::GOODPIXEL ) {
+                if ( !seedFinder.isClustered( seedIndex ) ) {
                     // if we enter here, this means that at least the seed pixel
                     // wasn't added yet to another cluster.  Note that now we need
                     // to build a candidate cluster that has to pass the
@@ -2327,7 +2316,7 @@ void EUTelClusteringProcessor::fixedFrameClustering(LCEvent * evt, LCCollectionV
                     FloatVec clusterCandidateCharges;
                     IntVec   clusterCandidateIndeces;
                     int seedX, seedY;
-                    matrixDecoder.getXYFromIndex((*mapIter).second,seedX, seedY);
+                    matrixDecoder.getXYFromIndex(seedIndex,seedX, seedY);
 
                     // start looping around the seed pixel. Remember that the seed
                     // pixel has to stay in the center of cluster
@@ -2339,8 +2328,8 @@ void EUTelClusteringProcessor::fixedFrameClustering(LCEvent * evt, LCCollectionV
                                  ( yPixel >= minY )  &&  ( yPixel <= maxY ) ) {
                                 int index = matrixDecoder.getIndexFromXY(xPixel, yPixel);
 
-                                bool isHit  = ( status->getADCValues()[index] == EUTELESCOPE::HITPIXEL  );
-                                bool isGood = ( status->getADCValues()[index] == EUTELESCOPE::GOODPIXEL );
+                                bool isHit  = seedFinder.isClustered( index );
+                                bool isGood = !isHit && ( status->getADCValues()[index] == EUTELESCOPE::GOODPIXEL );
 
                                 if(isGood)
                                     clusterCandidateIndeces.push_back(index);
@@ -2410,7 +2399,7 @@ void EUTelClusteringProcessor::fixedFrameClustering(LCEvent * evt, LCCollectionV
 
                         while ( indexIter != clusterCandidateIndeces.end() ) {
                             if (*indexIter != -1 ) {
-                                status->adcValues()[(*indexIter)] = EUTELESCOPE::HITPIXEL;
+                                seedFinder.markClustered( *indexIter );
                             }
                             ++indexIter;
                         }
@@ -2542,52 +2531,46 @@ void EUTelClusteringProcessor::nzsBrickedClustering(LCEvent * evt, LCCollectionV
         // reset the cluster counter for the clusterID
         int clusterID = 0;
 
-        // reset the status
-        resetStatus(status);
+        // the clustered pixels are kept by the seed finder, the status
+        // only needs cleaning from what was stored in it before
+        if ( isFirstEvent() ) resetStatus(status);
 
-        // prepare a multimap for the seed candidates
-        vector< pair <float, int> > seedCandidateMap;
+        //! CUT 1
+        EUTelSeedFinder& seedFinder = _seedFinderMap[ sensorID ];
+        seedFinder.findCandidates( nzsData->getChargeValues(), noise->getChargeValues(), status->getADCValues(), _ffSeedCut );
 
-        // fill the seed candidate map
-        for (unsigned int iPixel = 0; iPixel < nzsData->getChargeValues().size(); iPixel++)
+        const vector< pair<float, unsigned int> >& seedCandidates = seedFinder.getCandidates();
+        for ( vector< pair<float, unsigned int> >::const_iterator candIter = seedCandidates.begin(); candIter != seedCandidates.end(); ++candIter )
         {
-            if (status->getADCValues()[iPixel] == EUTELESCOPE::GOODPIXEL)
-            {
-                //! CUT 1
-                if ( nzsData->getChargeValues()[iPixel] > _ffSeedCut * noise->getChargeValues()[iPixel])
-                {
-                    seedCandidateMap.push_back(make_pair( nzsData->getChargeValues()[iPixel], iPixel));
-                    streamlog_out ( MESSAGE2 )
-                        << "Added pixel at (index=" << iPixel
-                        << ") with signal " << nzsData->getChargeValues()[iPixel]
-                        << " to the seedCandidateMap" << endl;
+            const unsigned int iPixel = (*candIter).second;
+            streamlog_out ( MESSAGE2 )
+                << "Added pixel at (index=" << iPixel
+                << ") with signal " << nzsData->getChargeValues()[iPixel]
+                << " to the seedCandidateMap" << endl;
 
-                    if ( noise->getChargeValues()[ iPixel ] < 0.01 )
-                    {
-                        streamlog_out ( ERROR2 )    << "ZERO NOISE SEED PIXEL ADDED (nszBrickedClustering)!"
-                                                    << "\n index=" << iPixel
-                                                    << "\n amp=" << nzsData->getChargeValues()[ iPixel ]
-                                                    << "\n status=" << status->getADCValues()[ iPixel ]
-                                                    <<    " GOODP   =  0,"
-                                                    <<    " BAD     =  1,"
-                                                    <<    " HIT     = -1,"
-                                                    <<    " MISSING =  2,"
-                                                    <<    " FIRING  =  3.";
-                    }
-                }
+            if ( noise->getChargeValues()[ iPixel ] < 0.01 )
+            {
+                streamlog_out ( ERROR2 )    << "ZERO NOISE SEED PIXEL ADDED (nszBrickedClustering)!"
+                                            << "\n index=" << iPixel
+                                            << "\n amp=" << nzsData->getChargeValues()[ iPixel ]
+                                            << "\n status=" << status->getADCValues()[ iPixel ]
+                                            <<    " GOODP   =  0,"
+                                            <<    " BAD     =  1,"
+                                            <<    " HIT     = -1,"
+                                            <<    " MISSING =  2,"
+                                            <<    " FIRING  =  3.";
             }
         }
 
-        streamlog_out ( DEBUG0 ) << "The number of seed candidates is: " << seedCandidateMap.size() << endl;
-        std::sort(seedCandidateMap.begin(),seedCandidateMap.end());
-        if ( !seedCandidateMap.empty() )
+        streamlog_out ( DEBUG0 ) << "The number of seed candidates is: " << seedCandidates.size() << endl;
+        if ( !seedCandidates.empty() )
         {
-            // now build up a cluster for each seed candidate
-            vector< pair<float, int> >::iterator rMapIter = seedCandidateMap.end();
-            while ( rMapIter != seedCandidateMap.begin() )
+            // now build up a cluster for each seed candidate, starting
+            // from the largest seed signal
+            unsigned int seedIndex;
+            while ( seedFinder.nextSeed( seedIndex ) )
             {
-                rMapIter--;
-                if ( status->adcValues()[ (*rMapIter).second ] == EUTELESCOPE::GOODPIXEL )
+                if ( !seedFinder.isClustered( seedIndex ) )
                 {
                     // if we enter here, this means that at least the seed pixel
                     // wasn't added yet to another cluster.  Note that now we need
@@ -2604,7 +2587,7 @@ void EUTelClusteringProcessor::nzsBrickedClustering(LCEvent * evt, LCCollectionV
                     // start looping around the seed pixel. Remember that the seed
                     // pixel has to stay in the center of cluster
                     int seedX, seedY;
-                    matrixDecoder.getXYFromIndex ( (*rMapIter).second, seedX, seedY );
+                    matrixDecoder.getXYFromIndex ( seedIndex, seedX, seedY );
 
                     for (int yPixel = seedY - (_ffYClusterSize / 2); yPixel <= seedY + (_ffYClusterSize / 2); yPixel++)
                     {
@@ -2626,8 +2609,8 @@ void EUTelClusteringProcessor::nzsBrickedClustering(LCEvent * evt, LCCollectionV
                                 //get noise for each and every pixel! (because it's available)
                                 noiseValueVec.push_back(noise->getChargeValues()[ index ]);
 
-                                bool isHit  = ( status->getADCValues()[index] == EUTELESCOPE::HITPIXEL  ); //this is set for pixels already used for another cluster
-                                bool isGood = ( status->getADCValues()[index] == EUTELESCOPE::GOODPIXEL );
+                                bool isHit  = seedFinder.isClustered( index ); //this is set for pixels already used for another cluster
+                                bool isGood = !isHit && ( status->getADCValues()[index] == EUTELESCOPE::GOODPIXEL );
 
                                 if ( isGood ) //normal case
                                 {
@@ -2766,7 +2749,7 @@ void EUTelClusteringProcessor::nzsBrickedClustering(LCEvent * evt, LCCollectionV
                             {
                                 if ( (*indexIter) != -1 )
                                 {
-                                    status->adcValues()[(*indexIter)] = EUTELESCOPE::HITPIXEL;
+                                    seedFinder.markClustered( *indexIter );
                                 }
                             }
                             ++indexIter;
@@ -2808,7 +2791,7 @@ void EUTelClusteringProcessor::nzsBrickedClustering(LCEvent * evt, LCCollectionV
                     delete brickedClusterCandidate;
 
                 } //END: if ( currentSeedpixelcandidate == EUTELESCOPE::GOODPIXEL )
-            } //END: while (not all seed candidates in the map have been processed) ((while ( rMapIter != seedCandidateMap.rend() )))
+            } //END: while (not all seed candidates have been processed)
         } //END: if ( seedCandidateMap.size() != 0 )
     } //for ( unsigned int i = 0 ; i < zsInputDataCollectionVec->size(); i++ )
 
@@ -2861,6 +2844,11 @@ if(_fillHistos) {
 
 
 
+bool EUTelClusteringProcessor::isClusteredPixel(int sensorID, int index) const {
+    std::map< int, EUTelSeedFinder >::const_iterator finder = _seedFinderMap.find( sensorID );
+    return finder != _seedFinderMap.end() && index >= 0 && finder->second.isClustered( static_cast<unsigned int>(index) );
+}
+
 void EUTelClusteringProcessor::resetStatus(IMPL::TrackerRawDataImpl * status) {
 
     int i = 0;
@@ -3019,7 +3007,7 @@ void EUTelClusteringProcessor::fillHistos (LCEvent * evt) {
                              ( yPixel >= minY )  &&  ( yPixel <= maxY ) ) {
                             int index = noiseMatrixDecoder.getIndexFromXY(xPixel, yPixel);
                             // the corresponding position in the status matrix has to be HITPIXEL
-                            bool isHit      = ( statusMatrix->getADCValues()[index] == EUTELESCOPE::HITPIXEL );
+                            bool isHit      = ( statusMatrix->getADCValues()[index] == EUTELESCOPE::HITPIXEL ) || isClusteredPixel( detectorID, index );
                             bool isBad      = ( statusMatrix->getADCValues()[index] == EUTELESCOPE::BADPIXEL );
                             bool isMissing  = ( statusMatrix->getADCValues()[index] == EUTELESCOPE::MISSINGPIXEL );
                             if ( !isMissing && !isBad && isHit ) {
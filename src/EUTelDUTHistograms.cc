@@ -123,6 +123,7 @@ EUTelDUTHistograms::EUTelDUTHistograms()
   _bgfittedX(),
   _bgfittedY(),
   _DUTalign(),
+  _hitMatcher(),
 _ClusterSizeHistos(),
 _ShiftHistos(),
 _MeasuredHistos(),
@@ -384,6 +385,16 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
   int nMatch=0;
   double distmin;
 
+  // Matched hits are flagged as used instead of being removed, so
+  // that the hit index stays valid for the cluster size vectors
+  _hitMatcher.setWindow( _distMax, _distMax );
+  _hitMatcher.clear();
+  for(int ihit=0; ihit< static_cast<int>(_measuredX.size()) ; ihit++)
+    {
+      _hitMatcher.addHit( _measuredX[ihit], _measuredY[ihit] );
+    }
+  _hitMatcher.build();
+
   for(int itrack=0; itrack< _maptrackid; itrack++)
   {
     int bestfit=-1;
@@ -395,28 +406,21 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
  
     for(int ifit=0;ifit<static_cast<int>(_fittedX[itrack].size()); ifit++)
     {
-      if( _measuredX.empty() ) continue;
+      double dist2rd = 0.;
+      long ihit = _hitMatcher.findNearest( _fittedX[itrack][ifit], _fittedY[itrack][ifit], dist2rd );
+      if( ihit < 0 ) continue;
 
-      for(int ihit=0; ihit< static_cast<int>(_measuredX.size()) ; ihit++)
+      if(streamlog_level(DEBUG5)){
+        message<DEBUG5> ( log() << "Fit ["<< itrack << ":" << _maptrackid <<"], ifit= " << ifit << " ["<< _fittedX[itrack][ifit] << ":" << _fittedY[itrack][ifit] << "]" << endl) ;
+        message<DEBUG5> ( log() << "rec " << ihit << " ["<< _measuredX[ihit] << ":" << _measuredY[ihit] << "]" << endl) ;
+        message<DEBUG5> ( log() << "distance : " << TMath::Sqrt( dist2rd )  << endl) ;
+      }
+      if(dist2rd<distmin)
         {
-
-          double dist2rd=
-            (_measuredX[ihit]-_fittedX[itrack][ifit])*(_measuredX[ihit]-_fittedX[itrack][ifit])
-            + (_measuredY[ihit]-_fittedY[itrack][ifit])*(_measuredY[ihit]-_fittedY[itrack][ifit]);
-
-	  if(streamlog_level(DEBUG5)){
-	    message<DEBUG5> ( log() << "Fit ["<< itrack << ":" << _maptrackid <<"], ifit= " << ifit << " ["<< _fittedX[itrack][ifit] << ":" << _fittedY[itrack][ifit] << "]" << endl) ;
-	    message<DEBUG5> ( log() << "rec " << ihit << " ["<< _measuredX[ihit] << ":" << _measuredY[ihit] << "]" << endl) ;
-	    message<DEBUG5> ( log() << "distance : " << TMath::Sqrt( dist2rd )  << endl) ;
-	  }
-          if(dist2rd<distmin)
-            {
-              distmin = dist2rd;
-              besthit = ihit;
-              bestfit = ifit;
-            }
+          distmin = dist2rd;
+          besthit = ihit;
+          bestfit = ifit;
         }
- 
     }
  
     // Match found:
@@ -553,8 +557,7 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
         _fittedX[itrack].erase(_fittedX[itrack].begin()+bestfit);
         _fittedY[itrack].erase(_fittedY[itrack].begin()+bestfit);
 
-        _measuredX.erase(_measuredX.begin()+besthit);
-        _measuredY.erase(_measuredY.begin()+besthit);
+        _hitMatcher.setUsed( besthit );
 
         _localX[itrack].erase(_localX[itrack].begin()+bestfit);
         _localY[itrack].erase(_localY[itrack].begin()+bestfit);
@@ -566,7 +569,7 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
 
     if(streamlog_level(DEBUG5)){
       message<DEBUG5> ( log() << nMatch << " DUT hits matched to fitted tracks ");
-      message<DEBUG5> ( log() << _measuredX.size() << " DUT hits not matched to any track ");
+      message<DEBUG5> ( log() << _hitMatcher.getNumberOfUnused() << " DUT hits not matched to any track ");
       message<DEBUG5> ( log() << "track "<<itrack<<" has " << _fittedX[itrack].size() << " _fittedX[itrack].size() not matched to any DUT hit ");
     }
 
@@ -594,6 +597,8 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
   // Noise plots - unmatched hits
 
   for(int ihit=0;ihit<static_cast<int>(_measuredX.size()); ihit++){
+      if( _hitMatcher.isUsed( ihit ) ) continue;
+
       (dynamic_cast<AIDA::IProfile1D*> ( _NoiseHistos.at(projX)))->fill(_measuredX[ihit],1.);
       (dynamic_cast<AIDA::IProfile1D*> ( _NoiseHistos.at(projY)))->fill(_measuredY[ihit],1.);
       (dynamic_cast<AIDA::IProfile2D*> ( _NoiseHistos.at(projXY)))->fill(_measuredX[ihit],_measuredY[ihit],1.);
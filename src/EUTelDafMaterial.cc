@@ -129,6 +129,11 @@ void EUTelDafMaterial::dafParams(){
 			    _zRotIndex, std::vector<int>());
   registerOptionalParameter("ZPosIndex", "Plane Index for Z Pos estimator",
 			    _zPosIndex, std::vector<int>());
+
+  registerOptionalParameter("SearchMethod", "Minimization of the estimator: QuasiNewton, Simplex (GSL Nelder-Mead) or Gradient (GSL BFGS)",
+			    _searchMethod, std::string("QuasiNewton"));
+  registerOptionalParameter("EstimatorThreads", "Number of threads the tracks are split over for every evaluation of the estimator",
+			    _estMatThreads, static_cast<int>(1));
 }
 
 void EUTelDafMaterial::dafInit() {
@@ -317,10 +322,19 @@ void EUTelDafMaterial::dafEnd() {
   //Minimizer* minimize = new SDR(true,true,false,_matest); //SDR3, 
   //Minimizer* minimize = new FakeChi2(_matest);
   //Minimizer* minimize = new FakeAbsDev(_matest);
-  //_matest.simplexSearch(minimize, 3000, 30);
   
   FwBw* minimize = new FwBw(_matest);
-  _matest.quasiNewtonHomeMade(minimize, 400);
+  minimize->nThreads = _estMatThreads > 1 ? _estMatThreads : 1;
+  if( _searchMethod == "Simplex" ){
+    _matest.simplexSearch(minimize, 3000, 30);
+  } else if( _searchMethod == "Gradient" ){
+    _matest.gradientSearch(minimize, 300);
+  } else {
+    if( _searchMethod != "QuasiNewton" ){
+      streamlog_out ( WARNING2 ) << "Unknown SearchMethod " << _searchMethod << ", using QuasiNewton" << std::endl;
+    }
+    _matest.quasiNewtonHomeMade(minimize, 400);
+  }
   
   //Use this for alignment only. 
   // Minimizer* minimize = new Chi2(_matest); //Alignment
@@ -328,5 +342,6 @@ void EUTelDafMaterial::dafEnd() {
   
   //Plot the resulting pulls, residuals, chi2s
   //_matest.plot((char*) "/home/haavagj/estmat.root");
+  delete minimize;
 }
 #endif // USE_GEAR
@@ -0,0 +1,197 @@
+#include "EUTelEventIndex.h"
+
+// LCIO
+#include <EVENT/LCCollection.h>
+#include <EVENT/TrackerData.h>
+#include <EVENT/TrackerRawData.h>
+
+// MARLIN
+#include "marlin/VerbosityLevels.h"
+
+// system includes <>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace eutelescope;
+
+namespace {
+	const char INDEX_MAGIC[4] = {'E','U','E','I'};
+
+	template<class T>
+	void writeVector( std::ofstream& file, std::vector<T> const & vec ) {
+		const uint64_t n = vec.size();
+		file.write( reinterpret_cast<const char*>(&n), sizeof(n) );
+		if( n > 0 ) file.write( reinterpret_cast<const char*>(&vec[0]), n*sizeof(T) );
+	}
+
+	template<class T>
+	void readVector( std::ifstream& file, std::vector<T>& vec ) {
+		uint64_t n = 0;
+		file.read( reinterpret_cast<char*>(&n), sizeof(n) );
+		if( !file.good() ) return;
+		vec.resize( n );
+		if( n > 0 ) file.read( reinterpret_cast<char*>(&vec[0]), n*sizeof(T) );
+	}
+}
+
+EUTelEventIndex::EUTelEventIndex():
+_entries(),
+_sizes(),
+_collectionNames()
+{}
+
+void EUTelEventIndex::clear() {
+	_entries.clear();
+	_sizes.clear();
+	_collectionNames.clear();
+}
+
+uint32_t EUTelEventIndex::collectionID( std::string const & name ) {
+	std::vector<std::string>::iterator it = std::find( _collectionNames.begin(), _collectionNames.end(), name );
+	if( it != _collectionNames.end() ) return it - _collectionNames.begin();
+	_collectionNames.push_back( name );
+	return _collectionNames.size() - 1;
+}
+
+void EUTelEventIndex::addEvent( EVENT::LCEvent* evt, int eventType,
+                                std::vector<std::string> const & dropNames, std::vector<std::string> const & dropTypes ) {
+	Entry entry;
+	entry.runNumber = evt->getRunNumber();
+	entry.eventNumber = evt->getEventNumber();
+	entry.eventType = eventType;
+	entry.ordinal = _entries.size();
+	entry.occupancy = 0;
+	entry.firstSize = _sizes.size();
+	entry.nSizes = 0;
+
+	const std::vector<std::string>* names = evt->getCollectionNames();
+	for( std::vector<std::string>::const_iterator name = names->begin(); name != names->end(); ++name ) {
+		EVENT::LCCollection* col = evt->getCollection( *name );
+		if( col->isTransient()
+		    || std::find( dropNames.begin(), dropNames.end(), *name ) != dropNames.end()
+		    || std::find( dropTypes.begin(), dropTypes.end(), col->getTypeName() ) != dropTypes.end() ) continue;
+
+		CollectionSize size;
+		size.collection = collectionID( *name );
+		size.nElements = col->getNumberOfElements();
+		_sizes.push_back( size );
+		++entry.nSizes;
+
+		if( col->getTypeName() == lcio::LCIO::TRACKERDATA ) {
+			for( int i = 0; i < col->getNumberOfElements(); ++i ) {
+				entry.occupancy += static_cast<EVENT::TrackerData*>( col->getElementAt(i) )->getChargeValues().size();
+			}
+		} else if( col->getTypeName() == lcio::LCIO::TRACKERRAWDATA ) {
+			for( int i = 0; i < col->getNumberOfElements(); ++i ) {
+				entry.occupancy += static_cast<EVENT::TrackerRawData*>( col->getElementAt(i) )->getADCValues().size();
+			}
+		}
+	}
+	_entries.push_back( entry );
+}
+
+int EUTelEventIndex::getCollectionSize( size_t i, std::string const & collectionName ) const {
+	std::vector<std::string>::const_iterator it = std::find( _collectionNames.begin(), _collectionNames.end(), collectionName );
+	if( it == _collectionNames.end() ) return -1;
+	const uint32_t id = it - _collectionNames.begin();
+	const Entry& entry = _entries.at(i);
+	for( uint32_t j = entry.firstSize; j < entry.firstSize + entry.nSizes; ++j ) {
+		if( _sizes[j].collection == id ) return _sizes[j].nElements;
+	}
+	return -1;
+}
+
+std::vector<size_t> EUTelEventIndex::selectRange( size_t first, long last, size_t stride ) const {
+	std::vector<size_t> selection;
+	if( _entries.empty() ) return selection;
+	const size_t end = ( last < 0 || static_cast<size_t>(last) >= _entries.size() ) ? _entries.size() : last + 1;
+	if( stride == 0 ) stride = 1;
+	for( size_t i = first; i < end; i += stride ) {
+		selection.push_back( i );
+	}
+	return selection;
+}
+
+std::vector<size_t> EUTelEventIndex::splitRange( std::vector<size_t> const & selection, size_t nRanges, size_t rangeIndex ) const {
+	if( nRanges <= 1 ) return selection;
+	if( rangeIndex >= nRanges ) return std::vector<size_t>();
+
+	// every event costs at least one unit, so that runs without tracker
+	// data are split by event count
+	uint64_t total = 0;
+	for( size_t i = 0; i < selection.size(); ++i ) {
+		total += _entries.at( selection[i] ).occupancy + 1;
+	}
+	const uint64_t lower = total * rangeIndex / nRanges;
+	const uint64_t upper = total * ( rangeIndex + 1 ) / nRanges;
+
+	std::vector<size_t> range;
+	uint64_t cumulative = 0;
+	for( size_t i = 0; i < selection.size(); ++i ) {
+		const uint64_t cost = _entries[ selection[i] ].occupancy + 1;
+		// an event belongs to the range that contains its first unit
+		if( cumulative >= lower && cumulative < upper ) range.push_back( selection[i] );
+		cumulative += cost;
+	}
+	return range;
+}
+
+void EUTelEventIndex::write( std::string const & fileName ) const {
+	std::ofstream file( fileName.c_str(), std::ios::binary | std::ios::trunc );
+	if( !file.good() ) {
+		throw( lcio::Exception("Can not open event index file for writing: " + fileName) );
+	}
+	const uint32_t version = VERSION;
+	file.write( INDEX_MAGIC, sizeof(INDEX_MAGIC) );
+	file.write( reinterpret_cast<const char*>(&version), sizeof(version) );
+
+	const uint64_t nNames = _collectionNames.size();
+	file.write( reinterpret_cast<const char*>(&nNames), sizeof(nNames) );
+	for( size_t i = 0; i < _collectionNames.size(); ++i ) {
+		const uint32_t length = _collectionNames[i].size();
+		file.write( reinterpret_cast<const char*>(&length), sizeof(length) );
+		file.write( _collectionNames[i].data(), length );
+	}
+	writeVector( file, _entries );
+	writeVector( file, _sizes );
+	if( !file.good() ) {
+		throw( lcio::Exception("Failed writing event index file: " + fileName) );
+	}
+	streamlog_out(MESSAGE5) << "Event index written to " << fileName << ": " << _entries.size() << " events" << std::endl;
+}
+
+void EUTelEventIndex::read( std::string const & fileName ) {
+	std::ifstream file( fileName.c_str(), std::ios::binary );
+	if( !file.good() ) {
+		throw( lcio::Exception("Can not open event index file: " + fileName) );
+	}
+	char magic[4];
+	uint32_t version = 0;
+	file.read( magic, sizeof(magic) );
+	file.read( reinterpret_cast<char*>(&version), sizeof(version) );
+	if( !file.good() || std::memcmp( magic, INDEX_MAGIC, sizeof(magic) ) != 0 ) {
+		throw( lcio::Exception("File is not an event index: " + fileName) );
+	}
+	if( version != VERSION ) {
+		throw( lcio::Exception("Event index " + fileName + " was written with an incompatible version.") );
+	}
+
+	clear();
+	uint64_t nNames = 0;
+	file.read( reinterpret_cast<char*>(&nNames), sizeof(nNames) );
+	for( uint64_t i = 0; i < nNames && file.good(); ++i ) {
+		uint32_t length = 0;
+		file.read( reinterpret_cast<char*>(&length), sizeof(length) );
+		std::string name( length, ' ' );
+		if( length > 0 ) file.read( &name[0], length );
+		_collectionNames.push_back( name );
+	}
+	readVector( file, _entries );
+	readVector( file, _sizes );
+	if( !file.good() ) {
+		clear();
+		throw( lcio::Exception("Event index file is truncated: " + fileName) );
+	}
+	streamlog_out(MESSAGE5) << "Event index read from " << fileName << ": " << _entries.size() << " events" << std::endl;
+}
@@ -0,0 +1,85 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelEventPipeline.h"
+
+// system includes <>
+#include <exception>
+#include <utility>
+
+using namespace eutelescope;
+
+EUTelEventPipeline& EUTelEventPipeline::instance() {
+  static EUTelEventPipeline pipeline;
+  return pipeline;
+}
+
+EUTelEventPipeline::EUTelEventPipeline():
+  _writer(),
+  _running(false),
+  _writeRequested(false),
+  _writeQueue(),
+  _writerThread(),
+  _writeStatistics(),
+  _writeError()
+{}
+
+EUTelEventPipeline::~EUTelEventPipeline() {
+  finish();
+}
+
+void EUTelEventPipeline::setWriter(Writer writer) {
+  _writer = writer;
+}
+
+void EUTelEventPipeline::start(std::size_t writeDepth) {
+  finish();
+  _writeRequested = false;
+  _writeStatistics = EUTelQueueStatistics();
+  _writeError.clear();
+  if ( _writer ) {
+    _writeQueue.reset( new EUTelBoundedQueue<std::unique_ptr<EVENT::LCEvent> >(writeDepth) );
+    _writerThread = std::thread( &EUTelEventPipeline::writerLoop, this );
+  }
+  _running = true;
+}
+
+void EUTelEventPipeline::retire(std::unique_ptr<EVENT::LCEvent> evt) {
+  if ( _writeRequested && _writeQueue ) {
+    _writeQueue->push( std::move(evt) );
+  }
+  _writeRequested = false;
+}
+
+void EUTelEventPipeline::finish() {
+  if ( _writeQueue ) {
+    _writeQueue->close();
+    if ( _writerThread.joinable() ) _writerThread.join();
+    _writeStatistics = _writeQueue->getStatistics();
+    _writeQueue.reset();
+  }
+  _running = false;
+}
+
+void EUTelEventPipeline::writerLoop() {
+  std::unique_ptr<EVENT::LCEvent> evt;
+  while ( _writeQueue->pop(evt) ) {
+    // after a failure the events left in the queue are only deleted
+    if ( _writeError.empty() ) {
+      try {
+        _writer( evt.get() );
+      } catch ( std::exception& e ) {
+        _writeError = e.what();
+        _writeQueue->close();
+      }
+    }
+    evt.reset();
+  }
+}
@@ -1,5 +1,18 @@
 #include "EUTelGenericPixGeoDescr.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelUtility.h"
+
+// MARLIN
+#include "marlin/VerbosityLevels.h"
+
+//ROOT
+#include "TGeoBBox.h"
+
+//STL
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 using namespace eutelescope;
 using namespace geo;
@@ -14,6 +27,48 @@ EUTelGenericPixGeoDescr::EUTelGenericPixGeoDescr(double sizeX, double sizeY, dou
 				_minIndexY(minY),
 				_maxIndexX(maxX),
 				_maxIndexY(maxY),
-				_radLength(radLen)
+				_radLength(radLen),
+				_pixelTable()
 {}
 
+const EUTelGenericPixGeoDescr::PixelGeometry& EUTelGenericPixGeoDescr::getPixelGeometry(int x, int y, std::string const & planePath)
+{
+	if( !isPixelInRange(x, y) ) {
+		std::stringstream ss;
+		ss << "Pixel (" << x << ", " << y << ") is outside the index range [" << _minIndexX << ", " << _maxIndexX
+		   << "] x [" << _minIndexY << ", " << _maxIndexY << "] of the pixel geometry description";
+		throw std::out_of_range( ss.str() );
+	}
+
+	std::unordered_map<size_t, PixelGeometry>::iterator it = _pixelTable.find( getPixelTableIndex(x, y) );
+	if( it != _pixelTable.end() ) return it->second;
+
+	TGeoManager* geoManager = gGeometry()._geoManager.get();
+	std::string pixelPath = planePath + getPixName(x, y);
+
+	//Navigate to the pixel and get its embedding box
+	geoManager->cd( pixelPath.c_str() );
+	TGeoBBox* bbox = dynamic_cast<TGeoBBox*>( geoManager->GetCurrentVolume()->GetShape() );
+
+	//Three levels for the telescope/plane, the remaining ones have to be
+	//transformed to get to the local plane coordinate system
+	std::vector<std::string> split = Utility::stringSplit( pixelPath, "/", false );
+	int recursionDepth = split.size() - 3;
+
+	Double_t origin_pt[3] = {0,0,0};
+	Double_t transformed1_pt[3];
+	Double_t transformed2_pt[3];
+	geoManager->GetCurrentNode()->LocalToMaster(origin_pt, transformed1_pt);
+	std::copy( transformed1_pt, transformed1_pt+3, transformed2_pt );
+	for( int i = 1; i < recursionDepth; ++i ) {
+		geoManager->GetMother(i)->LocalToMaster(transformed1_pt, transformed2_pt);
+		std::copy( transformed2_pt, transformed2_pt+3, transformed1_pt );
+	}
+
+	PixelGeometry& pixel = _pixelTable[ getPixelTableIndex(x, y) ];
+	pixel.posX = transformed2_pt[0];
+	pixel.posY = transformed2_pt[1];
+	pixel.boundaryX = bbox->GetDX();
+	pixel.boundaryY = bbox->GetDY();
+	return pixel;
+}
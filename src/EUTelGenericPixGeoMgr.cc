@@ -39,7 +39,7 @@ EUTelGenericPixGeoMgr::~EUTelGenericPixGeoMgr()
 }
 
 //TODO: comments
-void EUTelGenericPixGeoMgr::addCastedPlane(int planeID, int xPixel, int yPixel, double xSize, double ySize, double zSize, double radLength, std::string planeVolume)
+void EUTelGenericPixGeoMgr::addCastedPlane(int planeID, int xPixel, int yPixel, double xSize, double ySize, double zSize, double radLength, std::string planeVolume, bool createRootDescr)
 {
 	EUTelGenericPixGeoDescr* pixgeodescrptr = NULL;
 	int xSizeMap  = static_cast<int>(1000*xSize+0.5);  
@@ -71,11 +71,11 @@ void EUTelGenericPixGeoMgr::addCastedPlane(int planeID, int xPixel, int yPixel,
 	}
 	
 	streamlog_out( MESSAGE3 )  << "Adding plane: " << planeID << " with geoLibName: " << name << " in volume " << planeVolume << std::endl;
-	pixgeodescrptr->createRootDescr(planeVolume);
+	if( createRootDescr ) pixgeodescrptr->createRootDescr(planeVolume);
 }
 
 
-void EUTelGenericPixGeoMgr::addPlane(int planeID, std::string geoName, std::string planeVolume)
+void EUTelGenericPixGeoMgr::addPlane(int planeID, std::string geoName, std::string planeVolume, bool createRootDescr)
 {
 	EUTelGenericPixGeoDescr* pixgeodescrptr = NULL;
 	std::map<std::string, EUTelGenericPixGeoDescr*>::iterator it;
@@ -128,7 +128,7 @@ void EUTelGenericPixGeoMgr::addPlane(int planeID, std::string geoName, std::stri
 	streamlog_out( MESSAGE3 )  << "Adding plane: " << planeID << " with geoLibName: " << geoName << " in volume " << planeVolume << std::endl;
 	
 	//Call the factory method to actually load the geoemtry!
-	pixgeodescrptr->createRootDescr(planeVolume);
+	if( createRootDescr ) pixgeodescrptr->createRootDescr(planeVolume);
 }
 
 EUTelGenericPixGeoDescr* EUTelGenericPixGeoMgr::getPixGeoDescr(int planeID)
@@ -0,0 +1,169 @@
+/*
+ * File:   EUTelGeometryCache.cc
+ *
+ */
+#include "EUTelGeometryCache.h"
+
+// C++
+#include <cstring>
+#include <fstream>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// LCIO
+#include <lcio.h>
+
+// MARLIN
+#include "marlin/VerbosityLevels.h"
+
+using namespace eutelescope;
+using namespace geo;
+
+namespace {
+	const char CACHE_MAGIC[4] = {'E','U','G','C'};
+	const uint64_t FNV_PRIME = 1099511628211ULL;
+
+	bool fileStamp( std::string const & fileName, uint64_t& size, int64_t& mtime ) {
+		struct stat st;
+		if( stat( fileName.c_str(), &st ) != 0 ) return false;
+		size = static_cast<uint64_t>( st.st_size );
+		mtime = static_cast<int64_t>( st.st_mtime );
+		return true;
+	}
+}
+
+EUTelGeometryCache::EUTelGeometryCache():
+_data(nullptr),
+_size(0)
+{}
+
+EUTelGeometryCache::~EUTelGeometryCache() {
+	close();
+}
+
+void EUTelGeometryCache::close() {
+	if( _data != nullptr ) {
+		munmap( const_cast<char*>(_data), _size );
+	}
+	_data = nullptr;
+	_size = 0;
+}
+
+bool EUTelGeometryCache::open( std::string const & fileName ) {
+	close();
+
+	int fd = ::open( fileName.c_str(), O_RDONLY );
+	if( fd < 0 ) {
+		streamlog_out( MESSAGE4 ) << "No geometry cache " << fileName << " found" << std::endl;
+		return false;
+	}
+	struct stat st;
+	if( fstat( fd, &st ) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header) ) {
+		::close( fd );
+		streamlog_out( WARNING3 ) << "Geometry cache " << fileName << " is truncated, ignoring it" << std::endl;
+		return false;
+	}
+	void* mapped = mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	::close( fd );
+	if( mapped == MAP_FAILED ) {
+		streamlog_out( WARNING3 ) << "Can not map geometry cache " << fileName << ", ignoring it" << std::endl;
+		return false;
+	}
+	_data = static_cast<const char*>(mapped);
+	_size = st.st_size;
+
+	const Header* header = reinterpret_cast<const Header*>(_data);
+	if( std::memcmp( header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC) ) != 0 || header->version != VERSION ) {
+		streamlog_out( WARNING3 ) << "Geometry cache " << fileName << " has an unknown format, ignoring it" << std::endl;
+		close();
+		return false;
+	}
+	if( _size != sizeof(Header) + header->nPlanes*sizeof(PlaneRecord) ) {
+		streamlog_out( WARNING3 ) << "Geometry cache " << fileName << " is truncated, ignoring it" << std::endl;
+		close();
+		return false;
+	}
+
+	// the ROOT file is written by every job dumping the geometry, make
+	// sure it is still the one this index was made for
+	uint64_t rootSize = 0;
+	int64_t rootMTime = 0;
+	if( !fileStamp( getRootFileName(), rootSize, rootMTime )
+	    || rootSize != header->rootFileSize || rootMTime != header->rootFileMTime ) {
+		streamlog_out( MESSAGE4 ) << "Geometry cache " << fileName << " does not match " << getRootFileName() << ", ignoring it" << std::endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+uint64_t EUTelGeometryCache::getContentHash() const {
+	return reinterpret_cast<const Header*>(_data)->contentHash;
+}
+
+std::string EUTelGeometryCache::getRootFileName() const {
+	const Header* header = reinterpret_cast<const Header*>(_data);
+	return std::string( header->rootFileName, strnlen( header->rootFileName, sizeof(header->rootFileName) ) );
+}
+
+size_t EUTelGeometryCache::getNumberOfPlanes() const {
+	return reinterpret_cast<const Header*>(_data)->nPlanes;
+}
+
+const EUTelGeometryCache::PlaneRecord& EUTelGeometryCache::getPlane( size_t i ) const {
+	return reinterpret_cast<const PlaneRecord*>( _data + sizeof(Header) )[i];
+}
+
+void EUTelGeometryCache::write( std::string const & fileName, uint64_t contentHash, std::string const & rootFileName,
+                                std::vector<PlaneRecord> const & planes ) {
+	Header header;
+	std::memset( &header, 0, sizeof(Header) );
+	std::memcpy( header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC) );
+	header.version = VERSION;
+	header.contentHash = contentHash;
+	header.nPlanes = planes.size();
+	if( rootFileName.size() >= sizeof(header.rootFileName) ) {
+		throw( lcio::Exception("Geometry file name too long for the geometry cache: " + rootFileName) );
+	}
+	std::strncpy( header.rootFileName, rootFileName.c_str(), sizeof(header.rootFileName) - 1 );
+	if( !fileStamp( rootFileName, header.rootFileSize, header.rootFileMTime ) ) {
+		throw( lcio::Exception("Can not stat the geometry file for the geometry cache: " + rootFileName) );
+	}
+
+	std::ofstream file( fileName.c_str(), std::ios::binary | std::ios::trunc );
+	if( !file.good() ) {
+		throw( lcio::Exception("Can not open geometry cache file for writing: " + fileName) );
+	}
+	file.write( reinterpret_cast<const char*>(&header), sizeof(Header) );
+	if( !planes.empty() ) file.write( reinterpret_cast<const char*>(&planes[0]), planes.size()*sizeof(PlaneRecord) );
+	if( !file.good() ) {
+		throw( lcio::Exception("Failed writing geometry cache file: " + fileName) );
+	}
+	streamlog_out( MESSAGE4 ) << "Geometry cache written to " << fileName << " for " << rootFileName << std::endl;
+}
+
+uint64_t EUTelGeometryCache::hashBytes( const void* data, size_t size, uint64_t seed ) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed;
+	for( size_t i = 0; i < size; ++i ) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+uint64_t EUTelGeometryCache::hashFile( std::string const & fileName, uint64_t seed ) {
+	std::ifstream file( fileName.c_str(), std::ios::binary );
+	if( !file.good() ) return seed;
+	uint64_t hash = seed;
+	char buffer[4096];
+	while( file ) {
+		file.read( buffer, sizeof(buffer) );
+		hash = hashBytes( buffer, file.gcount(), hash );
+	}
+	return hash;
+}
@@ -9,7 +9,9 @@
 #include <string>
 #include <cstring>
 #include <cmath>
+#include <set>
 #include <sstream>
+#include <dlfcn.h>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -20,8 +22,10 @@
 #include "gearxml/GearXML.h"
 
 // EUTELESCOPE
+#include "EUTELESCOPE.h"
 #include "EUTelExceptions.h"
 #include "EUTelGenericPixGeoMgr.h"
+#include "EUTelGeometryCache.h"
 #include "EUTelNav.h"
 
 // ROOT
@@ -31,6 +35,7 @@
 #include "TGeoMedium.h"
 #include "TGeoMaterial.h"
 #include "TGeoBBox.h"
+#include "TGeoPhysicalNode.h"
 #include "TVectorD.h"
 #include "TVector3.h"
 #include "TMath.h"
@@ -270,6 +275,8 @@ _trackerPlanesLayerLayout(nullptr),
 _sensorIDVec(),
 _nPlanes(0),
 _isGeoInitialized(false),
+_alignedPlaneNodes(),
+_alignedPlaneMatrices(),
 _geoManager(nullptr)
 {
 	//Set ROOTs verbosity to only display error messages or higher (so info will not be streamed to stderr)
@@ -332,14 +339,11 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
 /**
  *
  */
-void EUTelGeometryTelescopeGeoDescription::translateSiPlane2TGeo(TGeoVolume* pvolumeWorld, int SensorId ) {
+void EUTelGeometryTelescopeGeoDescription::planeTransformation( int SensorId, TGeoCombiTrans& combi ) {
 	double xc, yc, zc;   // volume center position 
 	double alpha, beta, gamma;
 	double rotRef1, rotRef2, rotRef3, rotRef4;
 
-	std::stringstream strId;
-	strId << SensorId;
-
 	// Get sensor center position
 	xc = siPlaneXPosition( SensorId );
 	yc = siPlaneYPosition( SensorId );
@@ -363,14 +367,6 @@ void EUTelGeometryTelescopeGeoDescription::translateSiPlane2TGeo(TGeoVolume* pvo
 		streamlog_out(ERROR5) << "SensorID: " << SensorId << ". Determinant =  " <<determinant << std::endl;   
 		throw(lcio::Exception("The initial rotation and reflection matrix does not have determinant of 1 or -1. Gear file input must be wrong.")); 	
 	}
-	//Create spatial TGeoTranslation object.
-	std::string stTranslationName = "matrixTranslationSensor";
-	stTranslationName.append( strId.str() );
-	TGeoTranslation* pMatrixTrans = new TGeoTranslation( stTranslationName.c_str(), xc, yc, zc );
-	//ALL clsses deriving from TGeoMatrix are not owned by the ROOT geometry manager, invoking RegisterYourself() transfers
-	//ownership and thus ROOT will clean up
-	pMatrixTrans->RegisterYourself();      
-
 	//Create TGeoRotation object. 
 	//Translations are of course just positional changes in the global frame.
 	//Note that each subsequent rotation is using the new coordinate system of the last transformation all the way back to the global frame.
@@ -380,16 +376,28 @@ void EUTelGeometryTelescopeGeoDescription::translateSiPlane2TGeo(TGeoVolume* pvo
 	//Z rotations specified by in degrees.
 	//X rotations 
 	//Y rotations
-	TGeoRotation* pMatrixRotRefCombined = new TGeoRotation();
+	TGeoRotation rotRefCombined;
 	//We have to ensure that we retain a right handed coordinate system, i.e. if we only flip the x or y axis, we have to also flip the z-axis. If we flip both we have to flip twice.	
 	double integerRotationsAndReflections[9]={rotRef1,rotRef2,0,rotRef3,rotRef4,0,0,0, determinant};
-	pMatrixRotRefCombined->SetMatrix(integerRotationsAndReflections);
-	pMatrixRotRefCombined->RotateZ(gamma);//Z Rotation (degrees)//This will again rotate a vector around z axis usign the right hand rule.  
-	pMatrixRotRefCombined->RotateX(alpha);//X Rotations (degrees)//This will rotate a vector usign the right hand rule round the x-axis
-	pMatrixRotRefCombined->RotateY(beta);//Y Rotations (degrees)//Same again for Y axis 
-	pMatrixRotRefCombined->RegisterYourself();//We must allow the matrix to be used by the TGeo manager.
+	rotRefCombined.SetMatrix(integerRotationsAndReflections);
+	rotRefCombined.RotateZ(gamma);//Z Rotation (degrees)//This will again rotate a vector around z axis usign the right hand rule.  
+	rotRefCombined.RotateX(alpha);//X Rotations (degrees)//This will rotate a vector usign the right hand rule round the x-axis
+	rotRefCombined.RotateY(beta);//Y Rotations (degrees)//Same again for Y axis 
+	// Combined translation and orientation. The rotation is copied into the combined matrix.
+	combi.SetTranslation( xc, yc, zc );
+	combi.SetRotation( rotRefCombined );
+}
+
+/**
+ *
+ */
+void EUTelGeometryTelescopeGeoDescription::translateSiPlane2TGeo(TGeoVolume* pvolumeWorld, int SensorId ) {
+	std::stringstream strId;
+	strId << SensorId;
+
 	// Combined translation and orientation
-	TGeoCombiTrans* combi = new TGeoCombiTrans( *pMatrixTrans, *pMatrixRotRefCombined );
+	TGeoCombiTrans* combi = new TGeoCombiTrans();
+	planeTransformation( SensorId, *combi );
 	//This is to print to screen the rotation and translation matrices used to transform from local to global frame.
 	streamlog_out(MESSAGE9) << "THESE MATRICES ARE USED TO TAKE A POINT IN THE LOCAL FRAME AND MOVE IT TO THE GLOBAL FRAME."  << std::endl;   
 	streamlog_out(MESSAGE9) << "SensorID: " << SensorId << " Rotation/Reflection matrix for this object."  << std::endl;   
@@ -451,14 +459,22 @@ void EUTelGeometryTelescopeGeoDescription::translateSiPlane2TGeo(TGeoVolume* pvo
 	pvolumeSensor->SetVisLeaves( kTRUE );
 	pvolumeWorld->AddNode(pvolumeSensor, 1/*(SensorId)*/, combi);
 
-	//this line tells the pixel geometry manager to load the pixel geometry into the plane			
-	streamlog_out(DEBUG1) << " sensorID: " << SensorId << " " << stVolName << std::endl;   
+	addPixelGeometry( SensorId, stVolName, true );
+}
+
+/**
+ * Tell the pixel geometry manager to load the pixel geometry of a plane.
+ * If createRootDescr is false the pixel volumes are expected to be part
+ * of the TGeo description already, only the description is registered.
+ */
+void EUTelGeometryTelescopeGeoDescription::addPixelGeometry( int SensorId, std::string const & volumeName, bool createRootDescr ) {
+	streamlog_out(DEBUG1) << " sensorID: " << SensorId << " " << volumeName << std::endl;   
 	std::string name = geoLibName(SensorId);
 
 	if( name == "CAST" ) {
-		_pixGeoMgr->addCastedPlane( SensorId, siPlaneXNpixels(SensorId), siPlaneYNpixels(SensorId), siPlaneXSize(SensorId), siPlaneYSize(SensorId), siPlaneZSize(SensorId), siPlaneRadLength(SensorId), stVolName);
+		_pixGeoMgr->addCastedPlane( SensorId, siPlaneXNpixels(SensorId), siPlaneYNpixels(SensorId), siPlaneXSize(SensorId), siPlaneYSize(SensorId), siPlaneZSize(SensorId), siPlaneRadLength(SensorId), volumeName, createRootDescr );
 	} else {
-		_pixGeoMgr->addPlane( SensorId, name, stVolName);
+		_pixGeoMgr->addPlane( SensorId, name, volumeName, createRootDescr );
 	}
 }
 
@@ -472,6 +488,9 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
 	if( _isGeoInitialized ) {
 		streamlog_out( WARNING3 ) << "EUTelGeometryTelescopeGeoDescription: Geometry already initialized, using old initialization" << std::endl;
 		return;
+	} else if( useGeometryCache() && readTGeoDescriptionCache( geometryCacheFileName( geomName ) ) ) {
+		_isGeoInitialized = true;
+		return;
 	} else {
     		_geoManager = std::make_unique<TGeoManager>("Telescope", "v0.1");
 			_geoManager->SetBit(kCanDelete);
@@ -521,10 +540,202 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
     _geoManager->CloseGeometry();
     _isGeoInitialized = true;
     // Dump ROOT TGeo object into file
-    if ( dumpRoot ) _geoManager->Export( geomName.c_str() );
+    if ( dumpRoot ) {
+		_geoManager->Export( geomName.c_str() );
+		if( useGeometryCache() ) writeTGeoDescriptionCache( geometryCacheFileName( geomName ), geomName );
+	}
     return;
 }
 
+/**
+ * The geometry cache is switched on by the Marlin global parameter
+ * UseGeometryCache set to true, it is off by default.
+ */
+bool EUTelGeometryTelescopeGeoDescription::useGeometryCache() {
+	return marlin::Global::parameters != nullptr && marlin::Global::parameters->getStringVal("UseGeometryCache") == "true";
+}
+
+/**
+ * The cache index is kept next to the exported ROOT file, with the
+ * extension .cache instead of .root.
+ */
+std::string EUTelGeometryTelescopeGeoDescription::geometryCacheFileName( std::string const & geomName ) {
+	std::string::size_type const dot = geomName.rfind('.');
+	std::string::size_type const slash = geomName.rfind('/');
+	if( dot == std::string::npos || ( slash != std::string::npos && dot < slash ) ) return geomName + ".cache";
+	return geomName.substr( 0, dot ) + ".cache";
+}
+
+/**
+ * Hash of the shared library holding @a symbol, or the seed if it can not
+ * be found. The pixel geometry descriptions are compiled code, so a
+ * rebuilt library changes the pixel volumes of the exported description.
+ */
+uint64_t EUTelGeometryTelescopeGeoDescription::hashLibraryOf( void const * symbol, uint64_t seed ) {
+	Dl_info info;
+	if( symbol == nullptr || dladdr( symbol, &info ) == 0 || info.dli_fname == nullptr ) return seed;
+	return EUTelGeometryCache::hashFile( info.dli_fname, seed );
+}
+
+/**
+ * The TGeo description is fully determined by the plane setup (positions,
+ * rotations, sizes, pixel geometry libraries), by the GEAR file it was
+ * read from and by the code of the pixel geometry descriptions. All of
+ * them enter the hash, so that in-memory changes of the setup before the
+ * initialisation or a rebuilt pixel geometry library invalidate the
+ * cache as well.
+ */
+uint64_t EUTelGeometryTelescopeGeoDescription::geometryContentHash() {
+	uint64_t hash = EUTelGeometryCache::FNV_OFFSET;
+	if( marlin::Global::parameters != nullptr ) {
+		try {
+			hash = EUTelGeometryCache::hashFile( marlin::Global::parameters->getStringVal("GearXMLFile"), hash );
+		} catch(...) {
+			streamlog_out( DEBUG5 ) << "No GearXMLFile parameter, hashing the plane setup only" << std::endl;
+		}
+	}
+	for( IntVec::const_iterator itrPlaneId = _sensorIDVec.begin(); itrPlaneId != _sensorIDVec.end(); ++itrPlaneId ) {
+		const int sensorID = *itrPlaneId;
+		const EUTelPlane& plane = _planeSetup.at( sensorID );
+		const double values[] = { plane.xPos, plane.yPos, plane.zPos, plane.alpha, plane.beta, plane.gamma,
+		                          plane.r1, plane.r2, plane.r3, plane.r4, plane.xSize, plane.ySize, plane.zSize,
+		                          plane.xPitch, plane.yPitch, plane.radLength };
+		const int counts[] = { sensorID, plane.xPixelNo, plane.yPixelNo };
+		hash = EUTelGeometryCache::hashBytes( values, sizeof(values), hash );
+		hash = EUTelGeometryCache::hashBytes( counts, sizeof(counts), hash );
+		hash = EUTelGeometryCache::hashBytes( plane.pixGeoName.data(), plane.pixGeoName.size(), hash );
+	}
+
+	// the library of every distinct pixel geometry, found as addPlane() will load it;
+	// the casted planes are described by GEARPixGeoDescr, part of this library
+	std::set<std::string> libraries;
+	for( IntVec::const_iterator itrPlaneId = _sensorIDVec.begin(); itrPlaneId != _sensorIDVec.end(); ++itrPlaneId ) {
+		libraries.insert( geoLibName( *itrPlaneId ) );
+	}
+	for( std::set<std::string>::const_iterator itrLib = libraries.begin(); itrLib != libraries.end(); ++itrLib ) {
+		if( *itrLib == "CAST" ) {
+			hash = hashLibraryOf( &EUTELESCOPE::GEOFILENAME, hash );
+			continue;
+		}
+		std::string const libName = "lib" + *itrLib;
+		void* handle = dlopen( libName.c_str(), RTLD_NOW );
+		if( handle == nullptr ) {
+			streamlog_out( DEBUG5 ) << "Can't load " << libName << " to hash it: " << dlerror() << std::endl;
+			continue;
+		}
+		hash = hashLibraryOf( dlsym( handle, "maker" ), hash );
+		dlclose( handle );
+	}
+	return hash;
+}
+
+/**
+ * Import the TGeo description exported by an earlier job if the geometry
+ * cache index is valid for the current GEAR file and plane setup. Only
+ * the pixel geometry descriptions are registered again, their volumes are
+ * part of the imported description.
+ *
+ * @param cacheName name of the geometry cache index file
+ * @return true if the geometry has been read from the cache
+ */
+bool EUTelGeometryTelescopeGeoDescription::readTGeoDescriptionCache( std::string const & cacheName ) {
+	EUTelGeometryCache cache;
+	if( !cache.open( cacheName ) ) return false;
+
+	if( cache.getContentHash() != geometryContentHash() || cache.getNumberOfPlanes() != _sensorIDVec.size() ) {
+		streamlog_out( MESSAGE4 ) << "Geometry cache " << cacheName << " is outdated, rebuilding the geometry" << std::endl;
+		return false;
+	}
+	for( size_t i = 0; i < cache.getNumberOfPlanes(); ++i ) {
+		if( cache.getPlane(i).sensorID != _sensorIDVec.at(i) ) {
+			streamlog_out( MESSAGE4 ) << "Geometry cache " << cacheName << " has different planes, rebuilding the geometry" << std::endl;
+			return false;
+		}
+	}
+
+	std::string const rootFileName = cache.getRootFileName();
+	TGeoManager* imported = TGeoManager::Import( rootFileName.c_str() );
+	if( imported == nullptr ) {
+		streamlog_out( WARNING3 ) << "Can't import " << rootFileName << " from the geometry cache, rebuilding the geometry" << std::endl;
+		return false;
+	}
+	_geoManager = std::unique_ptr<TGeoManager>( imported );
+	_geoManager->SetBit(kCanDelete);
+	if( !_geoManager->IsClosed() ) _geoManager->CloseGeometry();
+
+	for( size_t i = 0; i < cache.getNumberOfPlanes(); ++i ) {
+		EUTelGeometryCache::PlaneRecord const & record = cache.getPlane(i);
+		_planePath.insert( std::make_pair( record.sensorID, std::string(record.planePath) ) );
+		addPixelGeometry( record.sensorID, record.volumeName, false );
+	}
+	clearMemoizedValues();
+
+	streamlog_out( MESSAGE5 ) << "Geometry read from cache " << cacheName << " (" << rootFileName << ")" << std::endl;
+	return true;
+}
+
+/**
+ * @param cacheName name of the geometry cache index file
+ * @param geomName name of the exported ROOT geometry file
+ */
+void EUTelGeometryTelescopeGeoDescription::writeTGeoDescriptionCache( std::string const & cacheName, std::string const & geomName ) {
+	std::vector<EUTelGeometryCache::PlaneRecord> planes;
+	for( IntVec::const_iterator itrPlaneId = _sensorIDVec.begin(); itrPlaneId != _sensorIDVec.end(); ++itrPlaneId ) {
+		EUTelGeometryCache::PlaneRecord record;
+		std::memset( &record, 0, sizeof(record) );
+		std::stringstream strId;
+		strId << *itrPlaneId;
+		std::string const volumeName = "volume_SensorID:" + strId.str();
+		std::string const & planePath = _planePath[*itrPlaneId];
+		std::string const pixGeoName = geoLibName( *itrPlaneId );
+		if( pixGeoName.size() >= sizeof(record.pixGeoName) || volumeName.size() >= sizeof(record.volumeName)
+		    || planePath.size() >= sizeof(record.planePath) ) {
+			streamlog_out( WARNING3 ) << "Plane " << *itrPlaneId << " does not fit into the geometry cache, no cache written" << std::endl;
+			return;
+		}
+		record.sensorID = *itrPlaneId;
+		record.castedPlane = ( pixGeoName == "CAST" ) ? 1 : 0;
+		std::strncpy( record.pixGeoName, pixGeoName.c_str(), sizeof(record.pixGeoName) - 1 );
+		std::strncpy( record.volumeName, volumeName.c_str(), sizeof(record.volumeName) - 1 );
+		std::strncpy( record.planePath, planePath.c_str(), sizeof(record.planePath) - 1 );
+		planes.push_back( record );
+	}
+	try {
+		EUTelGeometryCache::write( cacheName, geometryContentHash(), geomName, planes );
+	} catch( lcio::Exception& e ) {
+		// the cache is an optimisation only, never fail the job because of it
+		streamlog_out( WARNING3 ) << e.what() << std::endl;
+	}
+}
+
+/**
+ * Propagate the plane positions and rotations currently held in the plane setup
+ * into the already built TGeo description. This is used when the alignment is
+ * changed in memory, e.g. during in-process iterative alignment, so that the
+ * navigation and local/global transformations pick up the new constants.
+ */
+void EUTelGeometryTelescopeGeoDescription::updateTGeoPlaneTransformations() {
+	if( !_isGeoInitialized ) {
+		streamlog_out( WARNING3 ) << "EUTelGeometryTelescopeGeoDescription: TGeo description not initialized, nothing to update" << std::endl;
+		return;
+	}
+	for( IntVec::const_iterator itrPlaneId = _sensorIDVec.begin(); itrPlaneId != _sensorIDVec.end(); ++itrPlaneId ) {
+		// one physical node and one alignment matrix per plane, made on the first update
+		// and owned by the TGeo manager; later updates only change the matrix and realign
+		std::map<int, TGeoPhysicalNode*>::iterator itrNode = _alignedPlaneNodes.find( *itrPlaneId );
+		if( itrNode == _alignedPlaneNodes.end() ) {
+			TGeoCombiTrans* matrix = new TGeoCombiTrans();
+			matrix->RegisterYourself();
+			_alignedPlaneMatrices[*itrPlaneId] = matrix;
+			itrNode = _alignedPlaneNodes.insert( std::make_pair( *itrPlaneId, _geoManager->MakePhysicalNode( _planePath[*itrPlaneId].c_str() ) ) ).first;
+		}
+		TGeoCombiTrans* matrix = _alignedPlaneMatrices[*itrPlaneId];
+		planeTransformation( *itrPlaneId, *matrix );
+		itrNode->second->Align( matrix );
+	}
+	clearMemoizedValues();
+}
+
 Eigen::Matrix3d EUTelGeometryTelescopeGeoDescription::rotationMatrixFromAngles(int sensorID) {
 	return rotationMatrixFromAngles( (long double)siPlaneXRotationRadians(sensorID), (long double)siPlaneYRotationRadians(sensorID), (long double)siPlaneZRotationRadians(sensorID) );
 }
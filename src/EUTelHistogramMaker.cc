@@ -287,32 +287,35 @@ void EUTelHistogramMaker::processEvent (LCEvent * evt) {
 
       }
 
-      int detectorID = cluster->getDetectorID();
+      // the pixels are read and sorted once for all the histograms
+      _clusterSummary.fill( cluster );
+
+      int detectorID = _clusterSummary.getDetectorID();
       // increment of one unit the event counter for this plane
       eventCounterMap[detectorID]++;
 
       string tempHistoName = _clusterSignalHistoName + "_d" + to_string( detectorID );
-      (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(cluster->getTotalCharge());
+      (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(_clusterSummary.getTotalCharge());
 
       if(type == kEUTelDFFClusterImpl ) {
         tempHistoName = _clusterNumberOfHitPixelName + "_d" + to_string( detectorID );
-        (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(cluster->getTotalCharge());
+        (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(_clusterSummary.getTotalCharge());
       }
 
       tempHistoName = _seedSignalHistoName + "_d" + to_string( detectorID );
-      (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(cluster->getSeedCharge());
+      (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(_clusterSummary.getSeedCharge());
 
       vector<int >::iterator iter = _clusterSpectraNVector.begin();
       while ( iter != _clusterSpectraNVector.end() ) {
         tempHistoName = _clusterSignalHistoName + to_string( *iter ) + "_d" + to_string( detectorID ) ;
-        (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(cluster->getClusterCharge((*iter)));
+        (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(_clusterSummary.getClusterCharge((*iter)));
         ++iter;
       }
 
       iter = _clusterSpectraNxNVector.begin();
       while ( iter != _clusterSpectraNxNVector.end() ) {
         tempHistoName = _clusterSignalHistoName + to_string(*iter) + "x" + to_string(*iter) + "_d" + to_string(detectorID);
-        (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(cluster->getClusterCharge((*iter), (*iter)));
+        (dynamic_cast<AIDA::IHistogram1D*> (_aidaHistoMap[tempHistoName]))->fill(_clusterSummary.getClusterCharge((*iter), (*iter)));
         ++iter;
       }
 
@@ -450,6 +453,7 @@ void EUTelHistogramMaker::processEvent (LCEvent * evt) {
             
             try {
               cluster->setNoiseValues( noiseValues );
+              _clusterSummary.updateNoise();
             } catch ( IncompatibleDataSetException& e ) {
               streamlog_out ( ERROR1 )  << e.what() << endl <<  "Continuing without filling the histograms" << endl;
               _noiseHistoSwitch = false;
@@ -463,25 +467,25 @@ void EUTelHistogramMaker::processEvent (LCEvent * evt) {
         tempHistoName = _clusterNoiseHistoName + "_d" + to_string( detectorID );
         histo = dynamic_cast<AIDA::IHistogram1D* > ( _aidaHistoMap[tempHistoName] );
         if ( histo ) {
-          histo->fill( cluster->getClusterNoise() );
+          histo->fill( _clusterSummary.getClusterNoise() );
         }
 
         tempHistoName =  _clusterSNRHistoName + "_d" + to_string( detectorID );
         histo = dynamic_cast<AIDA::IHistogram1D* > ( _aidaHistoMap[tempHistoName] );
         if ( histo ) {
-          histo->fill( cluster->getClusterSNR() );
+          histo->fill( _clusterSummary.getClusterSNR() );
         }
 
         tempHistoName = _seedSNRHistoName + "_d" + to_string( detectorID );
         histo = dynamic_cast<AIDA::IHistogram1D * > ( _aidaHistoMap[tempHistoName] );
         if ( histo ) {
-          histo->fill( cluster->getSeedSNR() );
+          histo->fill( _clusterSummary.getSeedSNR() );
         }
 
         tempHistoName = _clusterSNRHistoName + "_d" + to_string( detectorID ) ;
         histo = dynamic_cast<AIDA::IHistogram1D * > ( _aidaHistoMap[tempHistoName] );
         if ( histo ) {
-          histo->fill( cluster->getClusterSNR() );
+          histo->fill( _clusterSummary.getClusterSNR() );
         }
 
         vector<int >::iterator iter = _clusterSpectraNxNVector.begin();
@@ -489,12 +493,12 @@ void EUTelHistogramMaker::processEvent (LCEvent * evt) {
           tempHistoName = _clusterSNRHistoName + to_string(*iter) + "x" + to_string(*iter) + "_d" + to_string(detectorID);
           histo = dynamic_cast<AIDA::IHistogram1D*> ( _aidaHistoMap[tempHistoName] ) ;
           if ( histo ) {
-            histo->fill(cluster->getClusterSNR( (*iter), (*iter) ));
+            histo->fill(_clusterSummary.getClusterSNR( (*iter), (*iter) ));
           }
           ++iter;
         }
 
-        vector<float > snrs = cluster->getClusterSNR(_clusterSpectraNVector);
+        vector<float > snrs = _clusterSummary.getClusterSNR(_clusterSpectraNVector);
         for ( unsigned int i = 0; i < snrs.size() ; i++ ) {
           tempHistoName = _clusterSNRHistoName + to_string( _clusterSpectraNVector[i] ) + "_d" + to_string( detectorID );
           histo = dynamic_cast<AIDA::IHistogram1D * > ( _aidaHistoMap[tempHistoName] ) ;
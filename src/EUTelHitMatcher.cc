@@ -0,0 +1,199 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelHitMatcher.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+namespace {
+  //! Upper limit on the number of cells per hit, for very sparse planes with a small window
+  const double MAXCELLSPERHIT = 4.;
+}
+
+EUTelHitMatcher::EUTelHitMatcher():
+  _windowX(0.),
+  _windowY(0.),
+  _x(),
+  _y(),
+  _used(),
+  _xMin(0.),
+  _yMin(0.),
+  _cellX(1.),
+  _cellY(1.),
+  _nCellX(1),
+  _nCellY(1),
+  _cellStart(),
+  _cellHits()
+{}
+
+void EUTelHitMatcher::setWindow(double windowX, double windowY) {
+  _windowX = windowX;
+  _windowY = windowY;
+}
+
+void EUTelHitMatcher::clear() {
+  _x.clear();
+  _y.clear();
+  _used.clear();
+  _cellStart.clear();
+  _cellHits.clear();
+}
+
+std::size_t EUTelHitMatcher::addHit(double x, double y) {
+  _x.push_back(x);
+  _y.push_back(y);
+  _used.push_back(false);
+  return _x.size() - 1;
+}
+
+void EUTelHitMatcher::build() {
+  const std::size_t nHits = _x.size();
+  _nCellX = _nCellY = 1;
+  _cellStart.assign(2, 0);
+  _cellHits.clear();
+  if ( nHits == 0 ) return;
+
+  double xMax = _xMin = _x[0];
+  double yMax = _yMin = _y[0];
+  for ( std::size_t i = 1; i < nHits; ++i ) {
+    _xMin = std::min(_xMin, _x[i]);
+    xMax  = std::max(xMax,  _x[i]);
+    _yMin = std::min(_yMin, _y[i]);
+    yMax  = std::max(yMax,  _y[i]);
+  }
+  const double xExtent = xMax - _xMin;
+  const double yExtent = yMax - _yMin;
+
+  // cells as large as the window, a disabled window gives a single cell
+  _cellX = ( _windowX > 0. && _windowX < xExtent ) ? _windowX : std::max(xExtent, 1.);
+  _cellY = ( _windowY > 0. && _windowY < yExtent ) ? _windowY : std::max(yExtent, 1.);
+  double nX = std::floor(xExtent / _cellX) + 1.;
+  double nY = std::floor(yExtent / _cellY) + 1.;
+  const double maxCells = MAXCELLSPERHIT * nHits + 1.;
+  if ( nX * nY > maxCells ) {
+    const double scale = std::sqrt(nX * nY / maxCells);
+    _cellX *= scale;
+    _cellY *= scale;
+    nX = std::floor(xExtent / _cellX) + 1.;
+    nY = std::floor(yExtent / _cellY) + 1.;
+  }
+  _nCellX = static_cast<int>(nX);
+  _nCellY = static_cast<int>(nY);
+
+  // counting sort of the hits by cell
+  std::vector<std::size_t> cellOf(nHits);
+  _cellStart.assign(static_cast<std::size_t>(_nCellX) * _nCellY + 1, 0);
+  for ( std::size_t i = 0; i < nHits; ++i ) {
+    const int ix = std::min(static_cast<int>((_x[i] - _xMin) / _cellX), _nCellX - 1);
+    const int iy = std::min(static_cast<int>((_y[i] - _yMin) / _cellY), _nCellY - 1);
+    cellOf[i] = static_cast<std::size_t>(iy) * _nCellX + ix;
+    ++_cellStart[cellOf[i] + 1];
+  }
+  for ( std::size_t c = 1; c < _cellStart.size(); ++c ) _cellStart[c] += _cellStart[c - 1];
+  _cellHits.resize(nHits);
+  std::vector<std::size_t> fill(_cellStart.begin(), _cellStart.end() - 1);
+  for ( std::size_t i = 0; i < nHits; ++i ) {
+    _cellHits[fill[cellOf[i]]++] = i;
+  }
+}
+
+bool EUTelHitMatcher::cellRange(double x, double y, int& ixMin, int& ixMax, int& iyMin, int& iyMax) const {
+  if ( _cellHits.empty() ) return false;
+
+  ixMin = 0; ixMax = _nCellX - 1;
+  if ( _windowX > 0. ) {
+    const double lo = std::floor((x - _windowX - _xMin) / _cellX);
+    const double hi = std::floor((x + _windowX - _xMin) / _cellX);
+    if ( hi < 0. || lo > ixMax ) return false;
+    ixMin = static_cast<int>(std::max(lo, 0.));
+    ixMax = static_cast<int>(std::min(hi, static_cast<double>(ixMax)));
+  }
+  iyMin = 0; iyMax = _nCellY - 1;
+  if ( _windowY > 0. ) {
+    const double lo = std::floor((y - _windowY - _yMin) / _cellY);
+    const double hi = std::floor((y + _windowY - _yMin) / _cellY);
+    if ( hi < 0. || lo > iyMax ) return false;
+    iyMin = static_cast<int>(std::max(lo, 0.));
+    iyMax = static_cast<int>(std::min(hi, static_cast<double>(iyMax)));
+  }
+  return true;
+}
+
+bool EUTelHitMatcher::inWindow(std::size_t i, double x, double y) const {
+  return ( _windowX <= 0. || std::abs(_x[i] - x) < _windowX )
+      && ( _windowY <= 0. || std::abs(_y[i] - y) < _windowY );
+}
+
+void EUTelHitMatcher::findInWindow(double x, double y, std::vector<std::size_t>& found, bool skipUsed) const {
+  found.clear();
+  int ixMin, ixMax, iyMin, iyMax;
+  if ( !cellRange(x, y, ixMin, ixMax, iyMin, iyMax) ) return;
+
+  for ( int iy = iyMin; iy <= iyMax; ++iy ) {
+    for ( int ix = ixMin; ix <= ixMax; ++ix ) {
+      const std::size_t cell = static_cast<std::size_t>(iy) * _nCellX + ix;
+      for ( std::size_t k = _cellStart[cell]; k < _cellStart[cell + 1]; ++k ) {
+        const std::size_t i = _cellHits[k];
+        if ( skipUsed && _used[i] ) continue;
+        if ( inWindow(i, x, y) ) found.push_back(i);
+      }
+    }
+  }
+  std::sort(found.begin(), found.end());
+}
+
+bool EUTelHitMatcher::hasHitInWindow(double x, double y) const {
+  int ixMin, ixMax, iyMin, iyMax;
+  if ( !cellRange(x, y, ixMin, ixMax, iyMin, iyMax) ) return false;
+
+  for ( int iy = iyMin; iy <= iyMax; ++iy ) {
+    for ( int ix = ixMin; ix <= ixMax; ++ix ) {
+      const std::size_t cell = static_cast<std::size_t>(iy) * _nCellX + ix;
+      for ( std::size_t k = _cellStart[cell]; k < _cellStart[cell + 1]; ++k ) {
+        if ( inWindow(_cellHits[k], x, y) ) return true;
+      }
+    }
+  }
+  return false;
+}
+
+long EUTelHitMatcher::findNearest(double x, double y, double& dist2) const {
+  long best = -1;
+  int ixMin, ixMax, iyMin, iyMax;
+  if ( !cellRange(x, y, ixMin, ixMax, iyMin, iyMax) ) return best;
+
+  for ( int iy = iyMin; iy <= iyMax; ++iy ) {
+    for ( int ix = ixMin; ix <= ixMax; ++ix ) {
+      const std::size_t cell = static_cast<std::size_t>(iy) * _nCellX + ix;
+      for ( std::size_t k = _cellStart[cell]; k < _cellStart[cell + 1]; ++k ) {
+        const std::size_t i = _cellHits[k];
+        if ( _used[i] || !inWindow(i, x, y) ) continue;
+        const double d2 = (_x[i] - x) * (_x[i] - x) + (_y[i] - y) * (_y[i] - y);
+        if ( best < 0 || d2 < dist2 || ( d2 == dist2 && static_cast<long>(i) < best ) ) {
+          best = i;
+          dist2 = d2;
+        }
+      }
+    }
+  }
+  return best;
+}
+
+void EUTelHitMatcher::resetUsed() {
+  std::fill(_used.begin(), _used.end(), false);
+}
+
+std::size_t EUTelHitMatcher::getNumberOfUnused() const {
+  return std::count(_used.begin(), _used.end(), false);
+}
@@ -0,0 +1,149 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelHotPixelMap.h"
+#include "EUTELESCOPE.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+
+// lcio includes <.h>
+#include <EVENT/LCObject.h>
+
+// system includes <>
+#include <algorithm>
+#include <limits>
+
+using namespace eutelescope;
+
+EUTelHotPixelMap::EUTelHotPixelMap():
+  _sensors(),
+  _nPixels(0),
+  _clusterDecoder(EUTELESCOPE::ZSCLUSTERDEFAULTENCODING)
+{}
+
+void EUTelHotPixelMap::addCollection(EVENT::LCCollection* hotPixelCollection) {
+  UTIL::CellIDDecoder<IMPL::TrackerDataImpl> cellDecoder( hotPixelCollection );
+  std::vector<bool> touched( _sensors.size(), false );
+
+  for ( int i = 0; i < hotPixelCollection->getNumberOfElements(); ++i ) {
+    IMPL::TrackerDataImpl* hotPixelData = dynamic_cast<IMPL::TrackerDataImpl*>( hotPixelCollection->getElementAt(i) );
+    SparsePixelType type = static_cast<SparsePixelType>( static_cast<int>( cellDecoder( hotPixelData )["sparsePixelType"] ) );
+    if ( type != kEUTelGenericSparsePixel ) continue;
+    int sensorID = static_cast<int>( cellDecoder( hotPixelData )["sensorID"] );
+    if ( sensorID < 0 ) continue;
+
+    if ( static_cast<std::size_t>(sensorID) >= _sensors.size() ) {
+      _sensors.resize( sensorID + 1 );
+      touched.resize( sensorID + 1, false );
+    }
+    SensorBitmap& sensor = _sensors[sensorID];
+    touched[sensorID] = true;
+
+    EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> sparseData( hotPixelData );
+    EUTelGenericSparsePixel pixel;
+    for ( unsigned int iPixel = 0; iPixel < sparseData.size(); ++iPixel ) {
+      sparseData.getSparsePixelAt( iPixel, &pixel );
+      sensor.pixels.push_back( std::make_pair( static_cast<int>(pixel.getXCoord()), static_cast<int>(pixel.getYCoord()) ) );
+    }
+  }
+
+  // one rebuild per sensor instead of one per pixel outside the current range
+  for ( std::size_t iSensor = 0; iSensor < touched.size(); ++iSensor ) {
+    if ( touched[iSensor] ) rebuild( _sensors[iSensor] );
+  }
+
+  _nPixels = 0;
+  for ( std::vector<SensorBitmap>::const_iterator iter = _sensors.begin(); iter != _sensors.end(); ++iter ) {
+    _nPixels += iter->pixels.size();
+  }
+}
+
+void EUTelHotPixelMap::addPixel(int sensorID, int x, int y) {
+  if ( sensorID < 0 || isHot( sensorID, x, y ) ) return;
+  if ( static_cast<std::size_t>(sensorID) >= _sensors.size() ) _sensors.resize( sensorID + 1 );
+
+  SensorBitmap& sensor = _sensors[sensorID];
+  sensor.pixels.push_back( std::make_pair( x, y ) );
+  ++_nPixels;
+  if ( !setBit( sensor, x, y ) ) rebuild( sensor );
+}
+
+void EUTelHotPixelMap::clear() {
+  _sensors.clear();
+  _nPixels = 0;
+}
+
+bool EUTelHotPixelMap::clusterContainsHotPixels(const IMPL::TrackerDataImpl* zsCluster) const {
+  const UTIL::BitField64& cellID = _clusterDecoder( zsCluster );
+  if ( static_cast<SparsePixelType>( static_cast<int>( cellID["sparsePixelType"] ) ) != kEUTelGenericSparsePixel ) return false;
+  const int sensorID = static_cast<int>( cellID["sensorID"] );
+  if ( sensorID < 0 || static_cast<std::size_t>(sensorID) >= _sensors.size() || _sensors[sensorID].pixels.empty() ) return false;
+
+  // the pixels are stored as (x, y, signal, time) in the charge values
+  const EVENT::FloatVec& values = zsCluster->getChargeValues();
+  const std::size_t nElement = EUTelGenericSparsePixel().getNoOfElements();
+  for ( std::size_t i = 0; i + nElement <= values.size(); i += nElement ) {
+    if ( isHot( sensorID, static_cast<short>( values[i] ), static_cast<short>( values[i + 1] ) ) ) return true;
+  }
+  return false;
+}
+
+bool EUTelHotPixelMap::hitContainsHotPixels(const IMPL::TrackerHitImpl* hit) const {
+  const int quality = hit->getQuality();
+  if ( quality & kHotPixelChecked ) return quality & kHotPixelHit;
+
+  if ( _nPixels == 0 || hit->getType() != kEUTelSparseClusterImpl ) return false;
+  const EVENT::LCObjectVec& clusterVector = hit->getRawHits();
+  if ( clusterVector.empty() ) return false;
+  const IMPL::TrackerDataImpl* zsCluster = dynamic_cast<const IMPL::TrackerDataImpl*>( clusterVector[0] );
+  return zsCluster && clusterContainsHotPixels( zsCluster );
+}
+
+int EUTelHotPixelMap::hitQuality(const IMPL::TrackerHitImpl* hit) const {
+  return hitContainsHotPixels( hit ) ? ( kHotPixelChecked | kHotPixelHit ) : kHotPixelChecked;
+}
+
+void EUTelHotPixelMap::rebuild(SensorBitmap& sensor) {
+  std::sort( sensor.pixels.begin(), sensor.pixels.end() );
+  sensor.pixels.erase( std::unique( sensor.pixels.begin(), sensor.pixels.end() ), sensor.pixels.end() );
+
+  sensor.bits.clear();
+  if ( sensor.pixels.empty() ) {
+    sensor.offX = sensor.offY = sensor.sizeX = sensor.sizeY = 0;
+    return;
+  }
+
+  int minX = std::numeric_limits<int>::max(), maxX = std::numeric_limits<int>::min();
+  int minY = std::numeric_limits<int>::max(), maxY = std::numeric_limits<int>::min();
+  for ( std::vector<std::pair<int,int> >::const_iterator iter = sensor.pixels.begin(); iter != sensor.pixels.end(); ++iter ) {
+    minX = std::min( minX, iter->first );
+    maxX = std::max( maxX, iter->first );
+    minY = std::min( minY, iter->second );
+    maxY = std::max( maxY, iter->second );
+  }
+  sensor.offX = minX;
+  sensor.offY = minY;
+  sensor.sizeX = maxX - minX + 1;
+  sensor.sizeY = maxY - minY + 1;
+  sensor.bits.assign( ( static_cast<std::size_t>(sensor.sizeX) * sensor.sizeY + 63 ) / 64, 0 );
+
+  for ( std::vector<std::pair<int,int> >::const_iterator iter = sensor.pixels.begin(); iter != sensor.pixels.end(); ++iter ) {
+    setBit( sensor, iter->first, iter->second );
+  }
+}
+
+bool EUTelHotPixelMap::setBit(SensorBitmap& sensor, int x, int y) {
+  const int ix = x - sensor.offX;
+  const int iy = y - sensor.offY;
+  if ( ix < 0 || ix >= sensor.sizeX || iy < 0 || iy >= sensor.sizeY ) return false;
+  const std::size_t bit = static_cast<std::size_t>(ix) * sensor.sizeY + iy;
+  sensor.bits[ bit >> 6 ] |= uint64_t(1) << ( bit & 63 );
+  return true;
+}
@@ -0,0 +1,242 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelIndexedLCIOReader.h"
+#include "EUTELESCOPE.h"
+#include "EUTelBoundedQueue.h"
+#include "EUTelEventPipeline.h"
+
+// marlin includes ".h"
+#include "marlin/Global.h"
+#include "marlin/Exceptions.h"
+#include "marlin/ProcessorMgr.h"
+
+// lcio includes <.h>
+#include <lcio.h>
+#include <IO/LCReader.h>
+#include <IOIMPL/LCFactory.h>
+#if LCIO_VERSION_GE(2, 13)
+#include <MT/LCReader.h>
+#endif
+
+// system includes <>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace std;
+using namespace marlin;
+using namespace lcio;
+using namespace eutelescope;
+
+EUTelIndexedLCIOReader::EUTelIndexedLCIOReader ():
+DataSourceProcessor("EUTelIndexedLCIOReader"),
+_inputFileName(""),
+_eventIndexFileName(""),
+_firstEvent(0),
+_lastEvent(-1),
+_stride(1),
+_nRanges(1),
+_rangeIndex(0),
+_prefetchDepth(0),
+_eventIndex()
+{
+  _description = "Reads a selection of events from an LCIO file using the event index written by EUTelOutputProcessor";
+
+  registerProcessorParameter("InputFile", "The LCIO input file", _inputFileName, string("run.slcio") );
+
+  registerOptionalParameter("EventIndexFile", "The event index file, empty for the input file name with .idx appended",
+                            _eventIndexFileName, string("") );
+
+  registerOptionalParameter("FirstEvent", "Position in the file of the first event to process", _firstEvent, static_cast<int>(0) );
+
+  registerOptionalParameter("LastEvent", "Position in the file of the last event to process, -1 for the end of the file",
+                            _lastEvent, static_cast<int>(-1) );
+
+  registerOptionalParameter("Stride", "Process one event every Stride events", _stride, static_cast<int>(1) );
+
+  registerOptionalParameter("NumberOfRanges", "Split the selected events into this number of ranges of similar occupancy",
+                            _nRanges, static_cast<int>(1) );
+
+  registerOptionalParameter("RangeIndex", "The range processed by this job, from 0 to NumberOfRanges-1", _rangeIndex, static_cast<int>(0) );
+
+  registerOptionalParameter("PrefetchDepth", "Number of events read ahead by a separate I/O thread, 0 to read synchronously",
+                            _prefetchDepth, static_cast<int>(0) );
+}
+
+EUTelIndexedLCIOReader * EUTelIndexedLCIOReader::newProcessor () {
+  return new EUTelIndexedLCIOReader;
+}
+
+void EUTelIndexedLCIOReader::init () {
+  printParameters ();
+
+  if ( _firstEvent < 0 || _stride < 1 || _nRanges < 1 || _rangeIndex < 0 || _rangeIndex >= _nRanges || _prefetchDepth < 0 ) {
+    throw InvalidParameterException("EUTelIndexedLCIOReader: FirstEvent, Stride, NumberOfRanges, RangeIndex or PrefetchDepth out of range");
+  }
+
+  if ( _eventIndexFileName.empty() ) _eventIndexFileName = _inputFileName + ".idx";
+  try {
+    _eventIndex.read( _eventIndexFileName );
+  } catch ( lcio::Exception& e ) {
+    streamlog_out ( ERROR5 ) << e.what() << endl;
+    throw StopProcessingException(this);
+  }
+}
+
+void EUTelIndexedLCIOReader::readDataSource (int numEvents) {
+
+  vector<size_t> selection = _eventIndex.selectRange( _firstEvent, _lastEvent, _stride );
+  selection = _eventIndex.splitRange( selection, _nRanges, _rangeIndex );
+
+  streamlog_out ( MESSAGE5 ) << "Reading " << selection.size() << " of " << _eventIndex.getNumberOfEvents()
+                             << " events from " << _inputFileName << endl;
+
+  if ( _prefetchDepth > 0 ) {
+    if ( readPipelined( selection, numEvents ) ) return;
+    streamlog_out ( WARNING5 ) << "Prefetching needs LCIO 2.13 or newer, reading synchronously" << endl;
+  }
+
+  unique_ptr<IO::LCReader> lcReader( LCFactory::getInstance()->createLCReader( IO::LCReader::directAccess ) );
+  try {
+    lcReader->open( _inputFileName );
+  } catch ( IOException& e ) {
+    streamlog_out ( ERROR5 ) << "Can't open the input file: " << e.what() << endl;
+    throw StopProcessingException(this);
+  }
+
+  try {
+    LCRunHeader* runHeader = lcReader->readNextRunHeader();
+    if ( runHeader ) ProcessorMgr::instance()->processRunHeader( runHeader );
+  } catch ( IOException& e ) {
+    streamlog_out ( ERROR5 ) << "Can't access the run header: " << e.what() << endl;
+  }
+
+  int eventCounter = 0;
+  for ( size_t i = 0; i < selection.size(); ++i ) {
+    if ( numEvents > 0 && eventCounter >= numEvents ) break;
+
+    const EUTelEventIndex::Entry& entry = _eventIndex.getEntry( selection[i] );
+
+    // the EORE is only passed on if it is the last event of the file,
+    // i.e. the selection reaches the end of the run
+    if ( entry.eventType == kEORE && selection[i] + 1 != _eventIndex.getNumberOfEvents() ) continue;
+
+    LCEvent* event = lcReader->readEvent( entry.runNumber, entry.eventNumber );
+    if ( event == 0 ) {
+      streamlog_out ( WARNING5 ) << "Event " << entry.eventNumber << " of run " << entry.runNumber
+                                 << " listed in the index but not found in " << _inputFileName << endl;
+      continue;
+    }
+    ProcessorMgr::instance()->processEvent( event );
+    ++eventCounter;
+  }
+
+  lcReader->close();
+}
+
+#if LCIO_VERSION_GE(2, 13)
+bool EUTelIndexedLCIOReader::readPipelined (vector<size_t> const & selection, int numEvents) {
+
+  MT::LCReader lcReader( MT::LCReader::directAccess );
+  try {
+    lcReader.open( _inputFileName );
+  } catch ( IOException& e ) {
+    streamlog_out ( ERROR5 ) << "Can't open the input file: " << e.what() << endl;
+    throw StopProcessingException(this);
+  }
+
+  // the run header has to outlive the events
+  unique_ptr<LCRunHeader> runHeader;
+  try {
+    runHeader = lcReader.readNextRunHeader();
+    if ( runHeader ) ProcessorMgr::instance()->processRunHeader( runHeader.get() );
+  } catch ( IOException& e ) {
+    streamlog_out ( ERROR5 ) << "Can't access the run header: " << e.what() << endl;
+  }
+
+  // the I/O thread reads and unpacks the events into the queue, the
+  // events are deleted or handed over to the write stage once processed
+  EUTelBoundedQueue<unique_ptr<LCEvent> > readQueue( _prefetchDepth );
+  vector<size_t> missingEvents;
+  string readError;
+  thread ioThread( [&] () {
+    int eventCounter = 0;
+    try {
+      for ( size_t i = 0; i < selection.size(); ++i ) {
+        if ( numEvents > 0 && eventCounter >= numEvents ) break;
+        const EUTelEventIndex::Entry& entry = _eventIndex.getEntry( selection[i] );
+        if ( entry.eventType == kEORE && selection[i] + 1 != _eventIndex.getNumberOfEvents() ) continue;
+        unique_ptr<LCEvent> event = lcReader.readEvent( entry.runNumber, entry.eventNumber );
+        if ( !event ) {
+          missingEvents.push_back( selection[i] );
+          continue;
+        }
+        if ( !readQueue.push( std::move(event) ) ) break;
+        ++eventCounter;
+      }
+    } catch ( lcio::Exception& e ) {
+      readError = e.what();
+    }
+    readQueue.close();
+  } );
+
+  EUTelEventPipeline& pipeline = EUTelEventPipeline::instance();
+  pipeline.start( _prefetchDepth );
+
+  unique_ptr<LCEvent> event;
+  try {
+    while ( readQueue.pop( event ) ) {
+      ProcessorMgr::instance()->processEvent( event.get() );
+      pipeline.retire( std::move(event) );
+    }
+  } catch ( ... ) {
+    // e.g. StopProcessingException: stop reading, write what has been processed
+    readQueue.close();
+    ioThread.join();
+    pipeline.finish();
+    throw;
+  }
+  ioThread.join();
+  pipeline.finish();
+  lcReader.close();
+
+  for ( size_t i = 0; i < missingEvents.size(); ++i ) {
+    const EUTelEventIndex::Entry& entry = _eventIndex.getEntry( missingEvents[i] );
+    streamlog_out ( WARNING5 ) << "Event " << entry.eventNumber << " of run " << entry.runNumber
+                               << " listed in the index but not found in " << _inputFileName << endl;
+  }
+  if ( !readError.empty() ) {
+    streamlog_out ( ERROR5 ) << "Reading stopped: " << readError << endl;
+  }
+  if ( !pipeline.getWriteError().empty() ) {
+    streamlog_out ( ERROR5 ) << "Writing stopped: " << pipeline.getWriteError() << endl;
+  }
+
+  const EUTelQueueStatistics readStatistics = readQueue.getStatistics();
+  const EUTelQueueStatistics writeStatistics = pipeline.getWriteStatistics();
+  streamlog_out ( MESSAGE5 ) << "Pipeline statistics:" << endl
+                             << "  read queue:  " << readStatistics.nPushed << " events, average depth " << readStatistics.getAverageDepth()
+                             << " of " << _prefetchDepth << ", reconstruction waited " << readStatistics.nConsumerStalls
+                             << " times for input, reading waited " << readStatistics.nProducerStalls << " times for a free slot" << endl
+                             << "  write queue: " << writeStatistics.nPushed << " events, average depth " << writeStatistics.getAverageDepth()
+                             << " of " << _prefetchDepth << ", reconstruction waited " << writeStatistics.nProducerStalls
+                             << " times for the writer" << endl;
+  return true;
+}
+#else
+bool EUTelIndexedLCIOReader::readPipelined (vector<size_t> const & /*selection*/, int /*numEvents*/) {
+  return false;
+}
+#endif
+
+void EUTelIndexedLCIOReader::end () {
+  streamlog_out ( MESSAGE4 ) << "Successfully finished" << endl;
+}
@@ -0,0 +1,252 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelInstrumentation.h"
+
+// lcio includes <.h>
+#include <EVENT/LCCollection.h>
+
+// marlin includes ".h"
+#include "marlin/VerbosityLevels.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <dlfcn.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace eutelescope;
+
+namespace {
+  //! JSON string literal
+  std::string quote(std::string const & str) {
+    std::string quoted("\"");
+    for ( std::string::const_iterator c = str.begin(); c != str.end(); ++c ) {
+      const unsigned char code = static_cast<unsigned char>( *c );
+      if ( *c == '"' || *c == '\\' ) {
+        quoted += '\\';
+        quoted += *c;
+      } else if ( *c == '\n' ) {
+        quoted += "\\n";
+      } else if ( *c == '\t' ) {
+        quoted += "\\t";
+      } else if ( *c == '\r' ) {
+        quoted += "\\r";
+      } else if ( code < 0x20 ) {
+        // the other control characters as unicode escapes
+        const char hex[] = "0123456789abcdef";
+        quoted += "\\u00";
+        quoted += hex[ code >> 4 ];
+        quoted += hex[ code & 0xf ];
+      } else {
+        quoted += *c;
+      }
+    }
+    return quoted + "\"";
+  }
+
+  void writeHistogram(std::ostream& os, EUTelInstrumentation::Histogram const & histogram) {
+    os << "[";
+    for ( std::size_t i = 0; i < histogram.bins.size(); ++i ) {
+      os << ( i ? ", " : "" ) << histogram.bins[i];
+    }
+    os << "]";
+  }
+}
+
+const std::size_t EUTelInstrumentation::NBINS;
+
+void EUTelInstrumentation::Histogram::fill(double seconds) {
+  const double microseconds = seconds * 1e6;
+  std::size_t bin = 0;
+  if ( microseconds >= 2. ) {
+    bin = std::min( static_cast<std::size_t>( std::log2(microseconds) ), bins.size() - 1 );
+  }
+  ++bins[bin];
+}
+
+EUTelInstrumentation& EUTelInstrumentation::instance() {
+  static EUTelInstrumentation instrumentation;
+  return instrumentation;
+}
+
+EUTelInstrumentation::EUTelInstrumentation():
+  _sections(),
+  _outputFile(""),
+  _nEnded(0),
+  _allocationCount(0),
+  _lastPoint(0),
+  _inEvent(false),
+  _lastWall(),
+  _lastCPU(0.),
+  _lastAllocations(0),
+  _knownCollections()
+{
+  // only present if the allocation counter has been preloaded
+  void* symbol = dlsym( RTLD_DEFAULT, EUTEL_ALLOCATION_COUNT_FUNCTION );
+  if ( symbol ) _allocationCount = reinterpret_cast<uint64_t (*)()>( symbol );
+}
+
+std::size_t EUTelInstrumentation::addPoint(std::string const & section) {
+  _sections.push_back( SectionStatistics() );
+  _sections.back().name = section;
+  return _sections.size() - 1;
+}
+
+void EUTelInstrumentation::setOutputFile(std::string const & fileName) {
+  _outputFile = fileName;
+}
+
+double EUTelInstrumentation::threadCPUTime() {
+  timespec ts;
+  if ( clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts ) != 0 ) return 0.;
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+void EUTelInstrumentation::checkpoint(std::size_t point, EVENT::LCEvent* evt) {
+  // read the clocks first, the bookkeeping below belongs to the next section
+  const std::chrono::steady_clock::time_point wall = std::chrono::steady_clock::now();
+  const double cpu = threadCPUTime();
+  const uint64_t allocations = allocationCount();
+
+  const std::vector<std::string>* names = evt->getCollectionNames();
+
+  // a point not later in the chain than the previous one starts a new event
+  if ( _inEvent && point > _lastPoint && point < _sections.size() ) {
+    SectionStatistics& section = _sections[point];
+    const double wallTime = std::chrono::duration<double>( wall - _lastWall ).count();
+    const double cpuTime = cpu - _lastCPU;
+    const uint64_t nAllocations = allocations - _lastAllocations;
+
+    ++section.nEvents;
+    section.wallSum += wallTime;
+    section.wallMax = std::max( section.wallMax, wallTime );
+    section.wallHistogram.fill( wallTime );
+    section.cpuSum += cpuTime;
+    section.cpuMax = std::max( section.cpuMax, cpuTime );
+    section.cpuHistogram.fill( cpuTime );
+    section.allocationSum += nAllocations;
+    section.allocationMax = std::max( section.allocationMax, nAllocations );
+
+    // the collections added by the section
+    for ( std::vector<std::string>::const_iterator name = names->begin(); name != names->end(); ++name ) {
+      if ( _knownCollections.count( *name ) ) continue;
+      const uint64_t nElements = evt->getCollection( *name )->getNumberOfElements();
+      CollectionStatistics& collection = section.collections[ *name ];
+      ++collection.nEvents;
+      collection.sum += nElements;
+      collection.max = std::max( collection.max, nElements );
+    }
+  }
+
+  _knownCollections.clear();
+  _knownCollections.insert( names->begin(), names->end() );
+  _inEvent = true;
+  _lastPoint = point;
+
+  // leave the time spent here out of the next section
+  _lastWall = std::chrono::steady_clock::now();
+  _lastCPU = threadCPUTime();
+  _lastAllocations = allocationCount();
+}
+
+void EUTelInstrumentation::endPoint() {
+  if ( ++_nEnded < _sections.size() ) return;
+
+  std::ostringstream summary;
+  printSummary( summary );
+  streamlog_out ( MESSAGE5 ) << summary.str();
+
+  if ( _outputFile.empty() ) return;
+  std::ofstream file( _outputFile.c_str() );
+  if ( !file.good() ) {
+    streamlog_out ( ERROR5 ) << "Can not open the instrumentation output file " << _outputFile << std::endl;
+    return;
+  }
+  writeJSON( file );
+  streamlog_out ( MESSAGE5 ) << "Instrumentation summary written to " << _outputFile << std::endl;
+}
+
+void EUTelInstrumentation::printSummary(std::ostream& os) const {
+  double wallTotal = 0.;
+  for ( std::vector<SectionStatistics>::const_iterator section = _sections.begin(); section != _sections.end(); ++section ) {
+    wallTotal += section->wallSum;
+  }
+
+  os << "Instrumentation summary (times per event in ms):" << std::endl
+     << std::left << std::setw(32) << "  section" << std::right
+     << std::setw(9) << "events" << std::setw(11) << "wall" << std::setw(11) << "wall max"
+     << std::setw(11) << "cpu" << std::setw(8) << "share" << std::setw(14) << "allocations" << std::endl;
+  for ( std::vector<SectionStatistics>::const_iterator section = _sections.begin(); section != _sections.end(); ++section ) {
+    if ( section->nEvents == 0 ) continue;
+    const double n = static_cast<double>( section->nEvents );
+    os << "  " << std::left << std::setw(30) << section->name << std::right << std::fixed
+       << std::setw(9) << section->nEvents
+       << std::setprecision(3) << std::setw(11) << 1e3 * section->wallSum / n
+       << std::setw(11) << 1e3 * section->wallMax
+       << std::setw(11) << 1e3 * section->cpuSum / n
+       << std::setprecision(1) << std::setw(7) << ( wallTotal > 0. ? 100. * section->wallSum / wallTotal : 0. ) << "%";
+    if ( hasAllocationCounter() ) os << std::setw(14) << section->allocationSum / n;
+    else os << std::setw(14) << "n/a";
+    os << std::endl;
+    for ( std::map<std::string, CollectionStatistics>::const_iterator collection = section->collections.begin();
+          collection != section->collections.end(); ++collection ) {
+      os << "    -> " << collection->first << ": " << std::setprecision(1)
+         << static_cast<double>( collection->second.sum ) / collection->second.nEvents << " elements per event, max "
+         << collection->second.max << std::endl;
+    }
+    os.unsetf( std::ios_base::floatfield );
+  }
+  if ( !hasAllocationCounter() ) {
+    os << "  allocations are counted if Marlin runs with LD_PRELOAD=libEUTelAllocationCounter.so" << std::endl;
+  }
+}
+
+void EUTelInstrumentation::writeJSON(std::ostream& os) const {
+  os << std::setprecision(9);
+  os << "{" << std::endl
+     << "  \"time_unit\": \"s\"," << std::endl
+     << "  \"histogram_bins\": \"bin i counts times in [2^i, 2^(i+1)) us, bin 0 also below 1 us\"," << std::endl
+     << "  \"allocations_counted\": " << ( hasAllocationCounter() ? "true" : "false" ) << "," << std::endl
+     << "  \"sections\": [";
+  bool first = true;
+  for ( std::vector<SectionStatistics>::const_iterator section = _sections.begin(); section != _sections.end(); ++section ) {
+    if ( section->nEvents == 0 ) continue;
+    os << ( first ? "" : "," ) << std::endl << "    {" << std::endl
+       << "      \"name\": " << quote( section->name ) << "," << std::endl
+       << "      \"events\": " << section->nEvents << "," << std::endl
+       << "      \"wall_sum\": " << section->wallSum << "," << std::endl
+       << "      \"wall_max\": " << section->wallMax << "," << std::endl
+       << "      \"cpu_sum\": " << section->cpuSum << "," << std::endl
+       << "      \"cpu_max\": " << section->cpuMax << "," << std::endl
+       << "      \"wall_histogram\": ";
+    writeHistogram( os, section->wallHistogram );
+    os << "," << std::endl << "      \"cpu_histogram\": ";
+    writeHistogram( os, section->cpuHistogram );
+    os << "," << std::endl
+       << "      \"allocations_sum\": " << section->allocationSum << "," << std::endl
+       << "      \"allocations_max\": " << section->allocationMax << "," << std::endl
+       << "      \"collections\": {";
+    bool firstCollection = true;
+    for ( std::map<std::string, CollectionStatistics>::const_iterator collection = section->collections.begin();
+          collection != section->collections.end(); ++collection ) {
+      os << ( firstCollection ? "" : "," ) << std::endl
+         << "        " << quote( collection->first ) << ": { \"events\": " << collection->second.nEvents
+         << ", \"elements_sum\": " << collection->second.sum << ", \"elements_max\": " << collection->second.max << " }";
+      firstCollection = false;
+    }
+    os << ( firstCollection ? "}" : "\n      }" ) << std::endl << "    }";
+    first = false;
+  }
+  os << std::endl << "  ]" << std::endl << "}" << std::endl;
+}
@@ -0,0 +1,62 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMergingGroups.h"
+
+using namespace eutelescope;
+
+EUTelMergingGroups::EUTelMergingGroups():
+  _parent(),
+  _groupIndex()
+{}
+
+void EUTelMergingGroups::reset(int nClusters) {
+  _parent.resize( nClusters );
+  for ( int iCluster = 0; iCluster < nClusters; iCluster++ ) _parent[iCluster] = iCluster;
+}
+
+int EUTelMergingGroups::findRoot(int iCluster) {
+  while ( _parent[iCluster] != iCluster ) {
+    _parent[iCluster] = _parent[ _parent[iCluster] ];
+    iCluster = _parent[iCluster];
+  }
+  return iCluster;
+}
+
+void EUTelMergingGroups::merge(int iCluster, int iOtherCluster) {
+  int root      = findRoot( iCluster );
+  int otherRoot = findRoot( iOtherCluster );
+  if ( root < otherRoot ) _parent[otherRoot] = root;
+  else if ( otherRoot < root ) _parent[root] = otherRoot;
+}
+
+void EUTelMergingGroups::getGroups(std::vector< std::vector< int > >& groups) {
+  groups.clear();
+
+  // first mark the roots with other clusters in their group
+  _groupIndex.assign( _parent.size(), -1 );
+  for ( int iCluster = 0; iCluster < size(); iCluster++ ) {
+    int root = findRoot( iCluster );
+    if ( root != iCluster ) _groupIndex[root] = 0;
+  }
+
+  // the root is the lowest index of a group, so its group is opened
+  // before any other member is reached and filled in increasing order
+  for ( int iCluster = 0; iCluster < size(); iCluster++ ) {
+    int root = findRoot( iCluster );
+    if ( root == iCluster ) {
+      if ( _groupIndex[root] == -1 ) continue;
+      _groupIndex[root] = groups.size();
+      groups.push_back( std::vector< int >( 1, root ) );
+    } else {
+      groups[ _groupIndex[root] ].push_back( iCluster );
+    }
+  }
+}
@@ -859,150 +859,30 @@ void EUTelMille::findtracks(
 void EUTelMille::FitTrack(unsigned int nPlanesFitter, double xPosFitter[], double yPosFitter[], double zPosFitter[], double xResFitter[], double yResFitter[], double chi2Fit[2], double residXFit[], 
 double residYFit[], double angleFit[2]) {
 
-  int sizearray;
+  // the batch fit of processEvent with a single track
+  EUTelStraightLineFitter fitter;
+  fitter.setPlanes(nPlanesFitter, xResFitter, yResFitter, _excludePlanes);
+  fitter.fit(1, xPosFitter, yPosFitter, zPosFitter);
 
-  if (_nExcludePlanes > 0) {
-    sizearray = nPlanesFitter - _nExcludePlanes;
-  } else {
-    sizearray = nPlanesFitter;
-  }
-
-  double * xPosFit = new double[sizearray];
-  double * yPosFit = new double[sizearray];
-  double * zPosFit = new double[sizearray];
-  double * xResFit = new double[sizearray];
-  double * yResFit = new double[sizearray];
-
-  int nPlanesFit = 0;
-
-  for (unsigned int help = 0; help < nPlanesFitter; help++) {
-
-    int excluded = 0;
-
-    // check if actual plane is excluded
-    if (_nExcludePlanes > 0) {
-      for (int helphelp = 0; helphelp < _nExcludePlanes; helphelp++) {
-        if (help == _excludePlanes[helphelp]) {
-          excluded = 1;
-        }
-      }
-    }
-
-    if (excluded == 1) {
-      // do noting
-    } else {
-      xPosFit[nPlanesFit] = xPosFitter[help];
-      yPosFit[nPlanesFit] = yPosFitter[help];
-      zPosFit[nPlanesFit] = zPosFitter[help];
-      xResFit[nPlanesFit] = xResFitter[help];
-      yResFit[nPlanesFit] = yResFitter[help];
-      nPlanesFit++;
-    }
-  }
-
-  int counter;
-
-  float S1[2]   = {0,0};
-  float Sx[2]   = {0,0};
-  float Xbar[2] = {0,0};
-
-  float * Zbar_X = new float[nPlanesFit];
-  float * Zbar_Y = new float[nPlanesFit];
-  for (counter = 0; counter < nPlanesFit; counter++){
-    Zbar_X[counter] = 0.;
-    Zbar_Y[counter] = 0.;
-  }
-
-  float Sy[2]     = {0,0};
-  float Ybar[2]   = {0,0};
-  float Sxybar[2] = {0,0};
-  float Sxxbar[2] = {0,0};
-  float A2[2]     = {0,0};
-
-  // define S1
-  for( counter = 0; counter < nPlanesFit; counter++ ){
-    S1[0] = S1[0] + 1/pow(xResFit[counter],2);
-    S1[1] = S1[1] + 1/pow(yResFit[counter],2);
-  }
-
-  // define Sx
-  for( counter = 0; counter < nPlanesFit; counter++ ){
-    Sx[0] = Sx[0] + zPosFit[counter]/pow(xResFit[counter],2);
-    Sx[1] = Sx[1] + zPosFit[counter]/pow(yResFit[counter],2);
-  }
-
-  // define Xbar
-  Xbar[0]=Sx[0]/S1[0];
-  Xbar[1]=Sx[1]/S1[1];
-
-  // coordinate transformation !! -> bar
-  for( counter = 0; counter < nPlanesFit; counter++ ){
-    Zbar_X[counter] = zPosFit[counter]-Xbar[0];
-    Zbar_Y[counter] = zPosFit[counter]-Xbar[1];
-  }
+  chi2Fit[0] += fitter.getChi2X(0);
+  chi2Fit[1] += fitter.getChi2Y(0);
 
-  // define Sy
-  for( counter = 0; counter < nPlanesFit; counter++ ){
-    Sy[0] = Sy[0] + xPosFit[counter]/pow(xResFit[counter],2);
-    Sy[1] = Sy[1] + yPosFit[counter]/pow(yResFit[counter],2);
+  for (unsigned int counter = 0; counter < nPlanesFitter; counter++) {
+    residXFit[counter] = fitter.getResidualX(0, counter);
+    residYFit[counter] = fitter.getResidualY(0, counter);
   }
 
-  // define Ybar
-  Ybar[0]=Sy[0]/S1[0];
-  Ybar[1]=Sy[1]/S1[1];
-
-  // define Sxybar
-  for( counter = 0; counter < nPlanesFit; counter++ ){
-    Sxybar[0] = Sxybar[0] + Zbar_X[counter] * xPosFit[counter]/pow(xResFit[counter],2);
-    Sxybar[1] = Sxybar[1] + Zbar_Y[counter] * yPosFit[counter]/pow(yResFit[counter],2);
-  }
-
-  // define Sxxbar
-  for( counter = 0; counter < nPlanesFit; counter++ ){
-    Sxxbar[0] = Sxxbar[0] + Zbar_X[counter] * Zbar_X[counter]/pow(xResFit[counter],2);
-    Sxxbar[1] = Sxxbar[1] + Zbar_Y[counter] * Zbar_Y[counter]/pow(yResFit[counter],2);
-  }
-
-  // define A2
-  A2[0]=Sxybar[0]/Sxxbar[0];
-  A2[1]=Sxybar[1]/Sxxbar[1];
-
-  // Calculate chi sqaured
-  // Chi^2 for X and Y coordinate for hits in all planes
-  for( counter = 0; counter < nPlanesFit; counter++ ){
-    chi2Fit[0] += pow(-zPosFit[counter]*A2[0]
-                      +xPosFit[counter]-Ybar[0]+Xbar[0]*A2[0],2)/pow(xResFit[counter],2);
-    chi2Fit[1] += pow(-zPosFit[counter]*A2[1]
-                      +yPosFit[counter]-Ybar[1]+Xbar[1]*A2[1],2)/pow(yResFit[counter],2);
-  }
-
-  for( counter = 0; counter < static_cast< int >(nPlanesFitter); counter++ ) {
-    residXFit[counter] = (Ybar[0]-Xbar[0]*A2[0]+zPosFitter[counter]*A2[0])-xPosFitter[counter];
-    residYFit[counter] = (Ybar[1]-Xbar[1]*A2[1]+zPosFitter[counter]*A2[1])-yPosFitter[counter];
-  }
-
-  // define angle
-  angleFit[0] = atan(A2[0]);
-  angleFit[1] = atan(A2[1]);
-
-  // clean up
-  delete [] zPosFit;
-  delete [] yPosFit;
-  delete [] xPosFit;
-  delete [] yResFit;
-  delete [] xResFit;
-
-  delete [] Zbar_X;
-  delete [] Zbar_Y;
+  angleFit[0] = fitter.getAngleX(0);
+  angleFit[1] = fitter.getAngleY(0);
 
 }
 
 void  EUTelMille::FillHotPixelMap(LCEvent *event)
 {
-    LCCollectionVec *hotPixelCollectionVec = 0;
+    _hotPixelMap.clear();
     try 
     {
-      hotPixelCollectionVec = static_cast< LCCollectionVec* > ( event->getCollection( _hotPixelCollectionName  ) );
+      _hotPixelMap.addCollection( event->getCollection( _hotPixelCollectionName  ) );
     }
     catch (...)
     {
@@ -1010,43 +890,7 @@ void  EUTelMille::FillHotPixelMap(LCEvent *event)
 	streamlog_out ( WARNING ) << "_hotPixelCollectionName " << _hotPixelCollectionName.c_str() << " not found" << endl; 
       return;
     }
-
-        CellIDDecoder<TrackerDataImpl> cellDecoder( hotPixelCollectionVec );
-	
-        for(int i=0; i<  hotPixelCollectionVec->getNumberOfElements(); i++)
-        {
-           TrackerDataImpl* hotPixelData = dynamic_cast< TrackerDataImpl *> ( hotPixelCollectionVec->getElementAt( i ) );
-	   SparsePixelType  type         = static_cast<SparsePixelType> (static_cast<int> (cellDecoder( hotPixelData )["sparsePixelType"]));
-
-	   int sensorID              = static_cast<int > ( cellDecoder( hotPixelData )["sensorID"] );
-
-           if( type  ==  kEUTelGenericSparsePixel ) {  
-				std::unique_ptr<EUTelSparseClusterImpl<EUTelGenericSparsePixel>> m26Data = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(hotPixelData);
-
-              std::vector<EUTelGenericSparsePixel*> m26PixelVec;
-	      EUTelGenericSparsePixel m26Pixel;
-  	      //Push all single Pixels of one plane in the m26PixelVec
-
-             for ( unsigned int iPixel = 0; iPixel < m26Data->size(); iPixel++ ) 
-             {
-              IntVec m26ColVec();
-              m26Data->getSparsePixelAt( iPixel, &m26Pixel);
-              streamlog_out ( DEBUG3 ) << iPixel << " of " << m26Data->size() << " HotPixelInfo:  " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << m26Pixel.getSignal() << endl;
-              try
-              {
-                 char ix[100];
-                 sprintf(ix, "%d,%d,%d", sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord() ); 
-                 _hotPixelMap[ix] = true;             
-              }
-              catch(...)
-              {
-                 std::cout << "can not add pixel " << std::endl;
-                 std::cout << sensorID << " " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << std::endl;   
-              }
-             }
-           }
-       }
-
+    streamlog_out ( DEBUG3 ) << _hotPixelMap.size() << " hot pixels read from " << _hotPixelCollectionName << endl;
 }
 
 void  EUTelMille::findMatchedHits(int& _ntrack, Track* TrackHere) {
@@ -1473,6 +1317,23 @@ void EUTelMille::processEvent (LCEvent * event) {
     double Chiquare[2] = {0,0};
     double angle[2] = {0,0};
 
+    // fit all the track candidates together, the loop below only
+    // reads the results
+    if (_alignMode != 3) {
+      _candidateXPos.resize(_nPlanes * _nTracks);
+      _candidateYPos.resize(_nPlanes * _nTracks);
+      _candidateZPos.resize(_nPlanes * _nTracks);
+      for (int track = 0; track < _nTracks; track++) {
+        for (unsigned int help = 0; help < _nPlanes; help++) {
+          _candidateXPos[help * _nTracks + track] = _xPos[track][help];
+          _candidateYPos[help * _nTracks + track] = _yPos[track][help];
+          _candidateZPos[help * _nTracks + track] = _zPos[track][help];
+        }
+      }
+      _lineFitter.setPlanes(_nPlanes, _telescopeResolX, _telescopeResolY, _excludePlanes);
+      _lineFitter.fit(_nTracks, _candidateXPos.data(), _candidateYPos.data(), _candidateZPos.data());
+    }
+
     // loop over all track candidates
     for (int track = 0; track < _nTracks; track++) {
 
@@ -1771,17 +1632,15 @@ void EUTelMille::processEvent (LCEvent * event) {
       else
         {
           streamlog_out(MESSAGE1) << " AlignMode = " << _alignMode << " _inputMode = " << _inputMode << std::endl;
-          // Calculate residuals
-          FitTrack(_nPlanes,
-                   _xPosHere,
-                   _yPosHere,
-                   _zPosHere,
-                   _telescopeResolX,
-                   _telescopeResolY,
-                   Chiquare,
-                   _waferResidX,
-                   _waferResidY,
-                   angle);
+          // Calculate residuals, taken from the fit of all the candidates
+          Chiquare[0] += _lineFitter.getChi2X(track);
+          Chiquare[1] += _lineFitter.getChi2Y(track);
+          for (unsigned int help = 0; help < _nPlanes; help++) {
+            _waferResidX[help] = _lineFitter.getResidualX(track, help);
+            _waferResidY[help] = _lineFitter.getResidualY(track, help);
+          }
+          angle[0] = _lineFitter.getAngleX(track);
+          angle[1] = _lineFitter.getAngleY(track);
         }
 
       }
@@ -2406,73 +2265,13 @@ TVector3 EUTelMille::Line2Plane(int iplane, const TVector3& lpoint, const TVecto
       
 bool EUTelMille::hitContainsHotPixels( TrackerHitImpl   * hit) 
 {
-  try
-    {
-      try{
-	LCObjectVec clusterVector = hit->getRawHits();
-
-	if ( hit->getType() == kEUTelSparseClusterImpl ) 
-	  {
-      
-	    TrackerDataImpl * clusterFrame = dynamic_cast<TrackerDataImpl*> ( clusterVector[0] );
-	    if (clusterFrame == 0){
-	      // found invalid result from cast
-	      throw UnknownDataTypeException("Invalid hit found in method hitContainsHotPixels()");
-	    }
-		
-	    eutelescope::EUTelSparseClusterImpl< eutelescope::EUTelGenericSparsePixel > *cluster = new eutelescope::EUTelSparseClusterImpl< eutelescope::EUTelGenericSparsePixel >(clusterFrame);
-	    int sensorID = cluster->getDetectorID();
- 
-	    for ( unsigned int iPixel = 0; iPixel < cluster->size(); iPixel++ ) 
-              {
-                EUTelGenericSparsePixel m26Pixel;
-                cluster->getSparsePixelAt( iPixel, &m26Pixel);
-                int pixelX, pixelY;
-                pixelX = m26Pixel.getXCoord();
-                pixelY = m26Pixel.getYCoord();
-
-		{                       
-		    char ix[100];
-		    sprintf(ix, "%d,%d,%d", sensorID, pixelX, pixelY ); 
-		    std::map<std::string, bool >::const_iterator z = _hotPixelMap.find(ix);
-		    if(z!=_hotPixelMap.end() && _hotPixelMap[ix] == true  )
-		      { 
-			streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << endl;
-			return true; // if TRUE  this hit will be skipped
-		      }
-		} 
-	      }
-
-	  } else if ( hit->getType() == kEUTelBrickedClusterImpl ) {
-
-	  // fixed cluster implementation. Remember it
-	  //  can come from
-	  //  both RAW and ZS data
-                   
-	} else if ( hit->getType() == kEUTelDFFClusterImpl ) {
-              
-	  // fixed cluster implementation. Remember it can come from
-	  // both RAW and ZS data
-	} else if ( hit->getType() == kEUTelFFClusterImpl ) {
-              
-	  // fixed cluster implementation. Remember it can come from
-	  // both RAW and ZS data
-	} 
-      }
-      catch(lcio::Exception e){
-	// catch specific exceptions
-          streamlog_out ( ERROR5 ) << "Exception occured in hitContainsHotPixels(): " << e.what() << endl;
-      }
-    }
-  catch(...)
-    { 
-      // if anything went wrong in the above return FALSE, meaning do not skip this hit
-      return 0;
-    }
-
-  // if none of the above worked return FALSE, meaning do not skip this hit
-  return 0;
+  if ( _hotPixelCollectionName.empty() ) return false;
 
+  // a bit test for the hits flagged by the hit maker, a bitmap lookup
+  // of every pixel of sparse clusters otherwise
+  bool isHot = _hotPixelMap.hitContainsHotPixels( hit );
+  if ( isHot ) streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << endl;
+  return isHot;
 }
 
 
@@ -306,6 +306,49 @@ void EUTelMillepede::CreateBinary(){
         }
 }
 
+void EUTelMillepede::closeBinary(){
+	delete _milleGBL;
+	_milleGBL = NULL;
+}
+
+void EUTelMillepede::resetBinary(){
+	closeBinary();
+	CreateBinary();
+}
+
+//The results file holds one line per parameter: label, value, presigma and optionally difference and error. We invert the label maps to find the sensor and degree of freedom.
+std::map<int, std::vector<double> > EUTelMillepede::readResults(){
+	ifstream file( _milleResultFileName.c_str() );
+	if ( !file.good( ) ) {
+		throw(lcio::Exception("Can not open millepede results file. In readResults()"));
+	}
+	std::map<int, std::pair<int,int> > labelToSensorAndParameter;
+	const std::map<int,int>* maps[6] = { &_xShiftsMap, &_yShiftsMap, &_zShiftsMap, &_xRotationsMap, &_yRotationsMap, &_zRotationsMap };
+	for(int iPar = 0; iPar < 6; ++iPar){
+		for(std::map<int,int>::const_iterator it = maps[iPar]->begin(); it != maps[iPar]->end(); ++it){
+			labelToSensorAndParameter[it->second] = std::make_pair(it->first, iPar);
+		}
+	}
+
+	std::map<int, std::vector<double> > results;
+	std::string line;
+	while(std::getline(file, line)){
+		std::istringstream tokenizer(line);
+		int label;
+		double value;
+		if(!(tokenizer >> label >> value)) continue;//Header line
+		std::map<int, std::pair<int,int> >::const_iterator it = labelToSensorAndParameter.find(label);
+		if(it == labelToSensorAndParameter.end()){
+			streamlog_out(WARNING1) << "Unknown label " << label << " in results file " << _milleResultFileName << std::endl;
+			continue;
+		}
+		std::vector<double>& corrections = results[it->second.first];
+		corrections.resize(6, 0.);
+		corrections[it->second.second] = value;
+	}
+	return results;
+}
+
 void EUTelMillepede::testUserInput(){
 	bool fixedGood=true;
 	if(_fixedAlignmentXShfitPlaneIds.size()== 0){
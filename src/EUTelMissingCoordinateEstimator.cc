@@ -13,6 +13,7 @@
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelEventImpl.h"
 #include "EUTELESCOPE.h"
+#include "EUTelLCObjectPool.h"
 
 
 // marlin includes ".h"
@@ -58,7 +59,9 @@ _knownHitPos(0),
 _nDutHits(0),
 _nDutHitsCreated(0),
 _maxExpectedCreatedHitPerDUTHit(10),
-_numberOfCreatedHitPerDUTHit()
+_numberOfCreatedHitPerDUTHit(),
+_referenceLineMatcher(),
+_acceptedPairs()
 {
     // modify processor description
     _description =  "EUTelMissingCoordinateEstimator As the name suggest this processor is finds the position of the missing coordinate on your How it works is simple, it gets the hits from specified two finds the closest hit pairs, make a straight line out of it and the estimated position in one axis on your sensor you want. No promises that this will work with tilted sensors and/or with magnetic field. One needs to used this with merged hits and after pre-alignment";
@@ -184,7 +187,7 @@ void EUTelMissingCoordinateEstimator::processEvent (LCEvent * event) {
     }
     catch(...)
     {
-        outputHitCollection = new LCCollectionVec(LCIO::TRACKERHIT);
+        outputHitCollection = new EUTelPooledCollectionVec<TrackerHitImpl>(LCIO::TRACKERHIT);
     }
     // prepare an encoder for the hit collection
     CellIDEncoder<TrackerHitImpl> outputCellIDEncoder(EUTELESCOPE::HITENCODING, outputHitCollection);
@@ -236,59 +239,63 @@ void EUTelMissingCoordinateEstimator::processEvent (LCEvent * event) {
 		countCreatedDutHits.push_back(0);
 	}
  
+    vector<const double*> refHit2Positions;
+    for (unsigned int iHitRefPlane2=0; iHitRefPlane2<referencePlaneHits2.size(); iHitRefPlane2++) {
+        TrackerHitImpl * refHit2 = dynamic_cast<TrackerHitImpl*> ( inputHitCollection->getElementAt( referencePlaneHits2[iHitRefPlane2] ) );
+        refHit2Positions.push_back(refHit2->getPosition());
+    }
+    // the lines are only tested against the second plane hits in the residual window of a DUT hit
+    _referenceLineMatcher.setSecondPlaneHits(refHit2Positions, _knownHitPos);
+
+    vector<TrackerHitImpl*> dutHits;
+    vector<const double*> dutHitPositions;
+    for (unsigned int iDutHit=0; iDutHit<dutPlaneHits.size(); iDutHit++) {
+        dutHits.push_back( dynamic_cast<TrackerHitImpl*> ( inputHitCollection->getElementAt( dutPlaneHits[iDutHit] ) ) );
+        dutHitPositions.push_back( dutHits.back()->getPosition() );
+    }
+
     // loop over first reference plane hits
     for (unsigned int iHitRefPlane1=0; iHitRefPlane1<referencePlaneHits1.size(); iHitRefPlane1++) {
         TrackerHitImpl * refHit1 = dynamic_cast<TrackerHitImpl*> ( inputHitCollection->getElementAt( referencePlaneHits1[iHitRefPlane1] ) );
         const double* refHit1Pos = refHit1->getPosition();
-        
-        // loop over second reference plane hits
-        for (unsigned int iHitRefPlane2=0; iHitRefPlane2<referencePlaneHits2.size(); iHitRefPlane2++) {
-            TrackerHitImpl * refHit2 = dynamic_cast<TrackerHitImpl*> ( inputHitCollection->getElementAt( referencePlaneHits2[iHitRefPlane2] ) );
-            const double* refHit2Pos = refHit2->getPosition();
+        _acceptedPairs.clear();
+
+        // all the second reference plane and DUT hits whose line passes close to the DUT hit
+        _referenceLineMatcher.findPairs(refHit1Pos, dutHitPositions, _maxResidual, _acceptedPairs);
+
+        // the new hits are stored in the order of the second reference plane and then the DUT hits
+        for (unsigned int iPair=0; iPair<_acceptedPairs.size(); iPair++) {
+            const double* refHit2Pos = refHit2Positions[_acceptedPairs[iPair].first];
+            unsigned int iDutHit = _acceptedPairs[iPair].second;
+            TrackerHitImpl * dutHit = dutHits[iDutHit];
+            const double* dutHitPos = dutHit->getPosition();
+            double newDutHitPos[3];
+
+            double t = ( dutHitPos[2] - refHit1Pos[2] ) / ( refHit2Pos[2] - refHit1Pos[2] );
+
+            // first copy old DUT hit position to the new one
+            newDutHitPos[0] = dutHitPos[0];
+            newDutHitPos[1] = dutHitPos[1];
+            newDutHitPos[2] = dutHitPos[2];
+            
+            // then replace the unknown one with the estimated one
+            double estimatedHitPos = refHit1Pos[_missingHitPos] + (refHit2Pos[_missingHitPos] - refHit1Pos[_missingHitPos]) * t;
             
-            // loop over second dut plane hits
-            for (unsigned int iDutHit=0; iDutHit<dutPlaneHits.size(); iDutHit++) {
-                TrackerHitImpl * dutHit = dynamic_cast<TrackerHitImpl*> ( inputHitCollection->getElementAt( dutPlaneHits[iDutHit] ) );
-                const double* dutHitPos = dutHit->getPosition();
-                double newDutHitPos[3];
-                
-                // find t value of the Z position of DUT
-                // t = (z-z1)/(z2-z1)
-                double t = ( dutHitPos[2] - refHit1Pos[2] ) / ( refHit2Pos[2] - refHit1Pos[2] );
-                
-                // find the known coordinate value correcponds to that z on the line
-                double knownHitPosOnLine = refHit1Pos[_knownHitPos] + (refHit2Pos[_knownHitPos] - refHit1Pos[_knownHitPos]) * t;
-                
-                // if knownHitPosOnLine is close to the knownHitPos
-                if ( fabs( knownHitPosOnLine - dutHitPos[_knownHitPos] ) < _maxResidual) {
-                    // first copy old DUT hit position to the new one
-                    newDutHitPos[0] = dutHitPos[0];
-                    newDutHitPos[1] = dutHitPos[1];
-                    newDutHitPos[2] = dutHitPos[2];
-                    
-                    // then replace the unknown one with the estimated one
-                    double estimatedHitPos = refHit1Pos[_missingHitPos] + (refHit2Pos[_missingHitPos] - refHit1Pos[_missingHitPos]) * t;
-                    
-                    newDutHitPos[_missingHitPos] = estimatedHitPos;
-                    
-                    // now store new hit position in the TrackerHit, copy and store in the collection
-                    
-                    TrackerHitImpl * newHit = cloneHit(dutHit);
-			const double* hitpos = newDutHitPos;
-                    newHit->setPosition( &hitpos[0] );
-                    outputHitCollection->push_back(newHit);
-
-                    // count new created hits
-                    _nDutHitsCreated++;
-
-		    // increase the created DUT hits
-		    countCreatedDutHits[iDutHit] ++;
-                }
-                
-            } // end of loop over first dut plane hits
+            newDutHitPos[_missingHitPos] = estimatedHitPos;
             
+            // now store new hit position in the TrackerHit, copy and store in the collection
             
-        } // end of loop over second reference plane hits
+            TrackerHitImpl * newHit = cloneHit(dutHit);
+            const double* hitpos = newDutHitPos;
+            newHit->setPosition( &hitpos[0] );
+            outputHitCollection->push_back(newHit);
+
+            // count new created hits
+            _nDutHitsCreated++;
+
+            // increase the created DUT hits
+            countCreatedDutHits[iDutHit] ++;
+        }
     } // end of loop over first reference plane hits
     
     for (unsigned int iDutHit=0; iDutHit<dutPlaneHits.size(); iDutHit++){
@@ -315,7 +322,7 @@ void EUTelMissingCoordinateEstimator::processEvent (LCEvent * event) {
 
 
 TrackerHitImpl* EUTelMissingCoordinateEstimator::cloneHit(TrackerHitImpl *inputHit){
-    TrackerHitImpl * newHit = new TrackerHitImpl;
+    TrackerHitImpl * newHit = EUTelLCObjectPool<TrackerHitImpl>::create();
     
     // copy hit position
     const double* hitPos = inputHit->getPosition();
@@ -0,0 +1,96 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelOccupancyCounter.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+namespace {
+  //! Counts are scanned in blocks of this size, a block is only inspected
+  //! pixel by pixel if one of its counts is above the threshold
+  const std::size_t SCANBLOCK = 64;
+}
+
+template <typename T>
+const typename EUTelOccupancyCounterT<T>::CountType EUTelOccupancyCounterT<T>::MAXCOUNT;
+
+template <typename T>
+EUTelOccupancyCounterT<T>::EUTelOccupancyCounterT():
+  _offX(0),
+  _offY(0),
+  _sizeX(0),
+  _sizeY(0),
+  _nHits(0),
+  _counts()
+{}
+
+template <typename T>
+EUTelOccupancyCounterT<T>::EUTelOccupancyCounterT(int offX, int sizeX, int offY, int sizeY):
+  _offX(0),
+  _offY(0),
+  _sizeX(0),
+  _sizeY(0),
+  _nHits(0),
+  _counts()
+{
+  resize(offX, sizeX, offY, sizeY);
+}
+
+template <typename T>
+void EUTelOccupancyCounterT<T>::resize(int offX, int sizeX, int offY, int sizeY) {
+  _offX = offX;
+  _offY = offY;
+  _sizeX = std::max(sizeX, 0);
+  _sizeY = std::max(sizeY, 0);
+  _counts.assign(static_cast<std::size_t>(_sizeX) * _sizeY, 0);
+  _nHits = 0;
+}
+
+template <typename T>
+void EUTelOccupancyCounterT<T>::clear() {
+  std::fill(_counts.begin(), _counts.end(), 0);
+  _nHits = 0;
+}
+
+template <typename T>
+void EUTelOccupancyCounterT<T>::findAbove(CountType threshold, std::vector<std::pair<int,int> >& pixels) const {
+  const std::size_t n = _counts.size();
+  const CountType* counts = _counts.data();
+  for ( std::size_t start = 0; start < n; start += SCANBLOCK ) {
+    const std::size_t end = std::min(start + SCANBLOCK, n);
+    // branch free reduction over the block
+    CountType blockMax = 0;
+    for ( std::size_t i = start; i < end; ++i ) blockMax = std::max(blockMax, counts[i]);
+    if ( blockMax <= threshold ) continue;
+
+    for ( std::size_t i = start; i < end; ++i ) {
+      if ( counts[i] > threshold ) {
+        pixels.push_back( std::make_pair( static_cast<int>(i / _sizeY) + _offX, static_cast<int>(i % _sizeY) + _offY ) );
+      }
+    }
+  }
+}
+
+template <typename T>
+void EUTelOccupancyCounterT<T>::firedPixelsPerColumn(std::vector<int>& nFired) const {
+  nFired.assign(_sizeX, 0);
+  for ( int ix = 0; ix < _sizeX; ++ix ) {
+    const CountType* column = _counts.data() + static_cast<std::size_t>(ix) * _sizeY;
+    int fired = 0;
+    for ( int iy = 0; iy < _sizeY; ++iy ) fired += ( column[iy] != 0 );
+    nFired[ix] = fired;
+  }
+}
+
+template class eutelescope::EUTelOccupancyCounterT<uint16_t>;
+template class eutelescope::EUTelOccupancyCounterT<uint32_t>;
@@ -14,6 +14,7 @@
 #include "EUTelEventImpl.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTELESCOPE.h"
+#include "EUTelEventPipeline.h"
 
 // marlin includes ".h"
 #include "marlin/LCIOOutputProcessor.h"
@@ -30,7 +31,13 @@ using namespace marlin;
 using namespace eutelescope;
 
  
-EUTelOutputProcessor::EUTelOutputProcessor() : LCIOOutputProcessor("EUTelOutputProcessor")  {
+EUTelOutputProcessor::EUTelOutputProcessor() : LCIOOutputProcessor("EUTelOutputProcessor"),
+  _appendEORE(true),
+  _writeEventIndex(false),
+  _eventIndexFile(""),
+  _eventIndex(),
+  _lastRunNumber(0),
+  _asynchronousWrite(false) {
     
   _description = "Writes the current event to the specified LCIO outputfile."
     " Eventually it adds a EORE at the of the file if it was missing"
@@ -82,6 +89,22 @@ EUTelOutputProcessor::EUTelOutputProcessor() : LCIOOutputProcessor("EUTelOutputP
 			     "Set it to true to remove intermediate EORE in merged runs",
 			     _skipIntermediateEORESwitch, static_cast< bool > ( true ) );
 
+  registerOptionalParameter("AppendEORE",
+			    "Set it to false to close the output without a EORE, e.g. for all but the last event range of a run processed in parallel",
+			    _appendEORE, static_cast< bool > ( true ) );
+
+  registerOptionalParameter("WriteEventIndex",
+			    "Set it to true to write an event index for EUTelIndexedLCIOReader next to the output file",
+			    _writeEventIndex, static_cast< bool > ( false ) );
+
+  registerOptionalParameter("EventIndexFile",
+			    "Name of the event index file, empty for the output file name with .idx appended",
+			    _eventIndexFile, std::string("") );
+
+  registerOptionalParameter("AsynchronousWrite",
+			    "Set it to true to write the events in a separate thread when reading with EUTelIndexedLCIOReader and PrefetchDepth > 0",
+			    _asynchronousWrite, static_cast< bool > ( false ) );
+
 
 }
 
@@ -90,6 +113,21 @@ void EUTelOutputProcessor::init() {
   // needs to be reimplemented since it is virtual in
   // LCIOOutputProcessor
   LCIOOutputProcessor::init();
+  _eventIndex.clear();
+  _lastRunNumber = 0;
+
+  if ( _writeEventIndex && parameterSet( "SplitFileSizekB" ) ) {
+    // the split writer opens new files on its own, an index of the
+    // positions in the first file would point to the wrong events
+    message<WARNING> ( "WriteEventIndex is not supported together with SplitFileSizekB, no event index is written" );
+    _writeEventIndex = false;
+  }
+
+  if ( _asynchronousWrite ) {
+    // called from the write thread, only this thread uses the writer
+    // until EUTelEventPipeline::finish() is called by the data source
+    EUTelEventPipeline::instance().setWriter( [this] ( LCEvent * evt ) { LCIOOutputProcessor::processEvent( evt ); } );
+  }
 
 }
 
@@ -98,12 +136,14 @@ void EUTelOutputProcessor::init() {
 void EUTelOutputProcessor::processRunHeader( LCRunHeader* run) { 
   std::unique_ptr<EUTelRunHeaderImpl> runHeader = std::make_unique<EUTelRunHeaderImpl>(run);
   runHeader->addProcessor(type());
+  _lastRunNumber = run->getRunNumber();
   LCIOOutputProcessor::processRunHeader(run);
 } 
 
 void EUTelOutputProcessor::processEvent( LCEvent * evt ) { 
 
   EUTelEventImpl * eutelEvt =  static_cast<EUTelEventImpl * > ( evt );
+  _lastRunNumber = evt->getRunNumber();
 
   if ( _skipIntermediateEORESwitch && ( eutelEvt->getEventType() == kEORE ) ) {
     // ok the user wants me to skip this because it may be an
@@ -115,20 +155,27 @@ void EUTelOutputProcessor::processEvent( LCEvent * evt ) {
     return ;
   }
 
-  LCIOOutputProcessor::processEvent(evt);
+  if ( _asynchronousWrite && EUTelEventPipeline::instance().isRunning() ) {
+    EUTelEventPipeline::instance().deferWrite();
+  } else {
+    LCIOOutputProcessor::processEvent(evt);
+  }
   _eventType = eutelEvt->getEventType();
 
+  if ( _writeEventIndex ) _eventIndex.addEvent( evt, _eventType, _dropCollectionNames, _dropCollectionTypes );
+
 }
 
 void EUTelOutputProcessor::end(){ 
 
-  if ( _eventType != kEORE ) {
+  if ( _appendEORE && _eventType != kEORE ) {
 
     message<WARNING> ( "Adding a EORE because was missing" );
 
     EUTelEventImpl * event = new EUTelEventImpl;
     event->setDetectorName("kEORE fix by EUTelOutputProcessor");
     event->setEventType(kEORE);
+    event->setRunNumber( _lastRunNumber );
     event->setEventNumber( _nEvt + 1 );
     
     LCTime * now = new LCTime;
@@ -136,6 +183,7 @@ void EUTelOutputProcessor::end(){
     delete now;
 
     _lcWrt->writeEvent( static_cast<LCEventImpl*> (event) );
+    if ( _writeEventIndex ) _eventIndex.addEvent( event, kEORE );
     delete event;
 
   }
@@ -143,6 +191,15 @@ void EUTelOutputProcessor::end(){
   message<MESSAGE5> ( log() << "Writing the output file " << _lcioOutputFile );
   _lcWrt->close() ;
 
+  if ( _writeEventIndex ) {
+    std::string indexFile = _eventIndexFile.empty() ? _lcioOutputFile + ".idx" : _eventIndexFile;
+    try {
+      _eventIndex.write( indexFile );
+    } catch ( lcio::Exception& e ) {
+      message<ERROR> ( log() << e.what() );
+    }
+  }
+
 }
 
 
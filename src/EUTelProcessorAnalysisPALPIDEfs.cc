@@ -88,6 +88,9 @@ EUTelProcessorAnalysisPALPIDEfs::EUTelProcessorAnalysisPALPIDEfs()
   nNoPAlpideHit(0),
   nWrongPAlpideHit(0),
   nPlanesWithTooManyHits(0),
+  hotPixelMatcher(),
+  noiseMaskMatcher(),
+  deadColumnMatcher(),
   xZero(0),
   yZero(0),
   xPitch(0),
@@ -228,6 +231,7 @@ void EUTelProcessorAnalysisPALPIDEfs::init() {
     chi2Max[i] = chi2MaxTemp[i];
   Cluster cluster;
   cluster.FindReferenceClusters(clusterVec,_maxNumberOfPixels);
+  clusterShapeIndex = cluster.ShapeIndex(clusterVec);
   xPairs = cluster.SymmetryPairs(clusterVec,"x");
   yPairs = cluster.SymmetryPairs(clusterVec,"y");
   symmetryGroups = cluster.sameShape(clusterVec);
@@ -287,7 +291,10 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
         auto sparsePixel = std::make_unique<EUTelGenericSparsePixel>();
         sparseData->getSparsePixelAt( iPixel, sparsePixel.get() );
         hotpixelHisto->Fill(sparsePixel->getXCoord()*xPitch+xPitch/2.,sparsePixel->getYCoord()*yPitch+yPitch/2.);
+        hotPixelMatcher.addHit(sparsePixel->getXCoord()*xPitch+xPitch/2.,sparsePixel->getYCoord()*yPitch+yPitch/2.);
       }
+      hotPixelMatcher.setWindow(limit,limit);
+      hotPixelMatcher.build();
     }
     ifstream noiseMaskFile(_noiseMaskFileName.c_str());
     if (noiseMaskFile.is_open())
@@ -301,7 +308,10 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
         noiseMaskX.push_back(x);
         noiseMaskY.push_back(y);
         hotpixelHisto->Fill(x*xPitch+xPitch/2.,y*yPitch+yPitch/2.);
+        noiseMaskMatcher.addHit(x*xPitch+xPitch/2.,y*yPitch+yPitch/2.);
       }
+      noiseMaskMatcher.setWindow(limit,limit);
+      noiseMaskMatcher.build();
     }
     else _noiseMaskAvailable = false;
 
@@ -324,7 +334,11 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
         auto sparsePixel = std::make_unique<EUTelGenericSparsePixel>();
         sparseData->getSparsePixelAt( iPixel, sparsePixel.get() );
         deadColumnHisto->Fill(sparsePixel->getXCoord()*xPitch+xPitch/2.,sparsePixel->getYCoord()*yPitch+yPitch/2.);
+        deadColumnMatcher.addHit(sparsePixel->getXCoord()*xPitch+xPitch/2.,sparsePixel->getYCoord()*yPitch+yPitch/2.);
       }
+      // only the column is compared
+      deadColumnMatcher.setWindow(limit,0.);
+      deadColumnMatcher.build();
     }
     if (_chipVersion == 3) {
       settingsFile << evt->getRunNumber() << ";" << _energy << ";" << _chipID[layerIndex] << ";" << _chipVersion << ";" << _irradiation[layerIndex] << ";" << _rate << ";" << evt->getParameters().getFloatVal("BackBiasVoltage") << ";" << evt->getParameters().getIntVal(Form("Ithr_%d",layerIndex)) << ";" << evt->getParameters().getIntVal(Form("Idb_%d",layerIndex)) << ";" << evt->getParameters().getIntVal(Form("Vcasn_%d",layerIndex)) << ";" << evt->getParameters().getIntVal(Form("Vcasn2_%d",layerIndex)) << ";" << evt->getParameters().getIntVal(Form("Vclip_%d",layerIndex)) << ";" << evt->getParameters().getIntVal(Form("Vcasp_%d",layerIndex)) << ";" << evt->getParameters().getIntVal(Form("VresetP_%d",layerIndex)) << ";" << evt->getParameters().getIntVal(Form("VresetD_%d",layerIndex)) << ";";
@@ -490,52 +504,9 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
           }
         }
         if (index == -1) continue;
-        if (_hotpixelAvailable)
-        {
-          std::unique_ptr<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> > sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> >(hotData);
-          bool hotpixel = false;
-          for ( unsigned int iPixel = 0; iPixel < sparseData->size(); iPixel++ )
-          {
-            auto sparsePixel = std::make_unique<EUTelGenericSparsePixel>();
-            sparseData->getSparsePixelAt( iPixel, sparsePixel.get() );
-            if (abs(xposfit-(sparsePixel->getXCoord()*xPitch+xPitch/2.)) < limit && abs(yposfit-(sparsePixel->getYCoord()*yPitch+yPitch/2.)) < limit)
-            {
-              hotpixel = true;
-              break;
-            }
-          }
-          if (hotpixel) continue;
-        }
-        if (_noiseMaskAvailable)
-        {
-          bool noisePixel = false;
-          for (unsigned int iNoise=0; iNoise<noiseMaskX.size(); iNoise++)
-          {
-            if (abs(xposfit-(noiseMaskX[iNoise]*xPitch+xPitch/2.)) < limit && abs(yposfit-(noiseMaskY[iNoise]*yPitch+yPitch/2.)) < limit)
-            {
-              noisePixel = true;
-              break;
-            }
-          }
-          if (noisePixel) continue;
-        }
-        if (_deadColumnAvailable)
-        {
-          auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> >(deadColumn);
-          bool dead = false;
-          for ( unsigned int iPixel = 0; iPixel < sparseData->size(); iPixel++ )
-          {
-            auto sparsePixel = std::make_unique<EUTelGenericSparsePixel>();
-            sparseData->getSparsePixelAt( iPixel, sparsePixel.get() );
-            if (abs(xposfit-(sparsePixel->getXCoord()*xPitch+xPitch/2.)) < limit)
-            {
-              dead = true;
-              break;
-            }
-          }
-          if (dead) continue;
-
-        }
+        if (_hotpixelAvailable && hotPixelMatcher.hasHitInWindow(xposfit,yposfit)) continue;
+        if (_noiseMaskAvailable && noiseMaskMatcher.hasHitInWindow(xposfit,yposfit)) continue;
+        if (_deadColumnAvailable && deadColumnMatcher.hasHitInWindow(xposfit,yposfit)) continue;
         nTrackPerEvent++;
         int nAssociatedhits = 0;
         int nDUThitsEvent = 0;
@@ -744,7 +715,7 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
                         nClusterVsYHisto[index]->Fill(fmod(yposfit,yPitch));
                         nClusterSizeHisto[index]->Fill(fmod(xposfit,xPitch),fmod(yposfit,yPitch));
                         nClusterSize2by2Histo[index]->Fill(fmod(xposfit,2*xPitch),fmod(yposfit,2*yPitch));
-                        int clusterShape = cluster.WhichClusterShape(cluster, clusterVec);
+                        int clusterShape = cluster.WhichClusterShape(cluster, clusterShapeIndex);
                         if (clusterShape>=0)
                         {
                           clusterShapeHisto->Fill(clusterShape);
@@ -1114,6 +1085,11 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
   { 
     int nH = pH.size();
     int nT = pT.size(); 
+    EUTelHitMatcher dutHitMatcher;
+    dutHitMatcher.setWindow(limit,limit);
+    for(int iH=0; iH<nH; iH++) dutHitMatcher.addHit(pH.at(iH).at(0),pH.at(iH).at(1));
+    dutHitMatcher.build();
+    std::vector<size_t> hitsInWindow;
     std::vector<int> aH(nH); 
     std::vector<int> aT(nT); 
     for(int i=0; i<nH; i++) aH[i] = -1;
@@ -1128,15 +1104,14 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
         if(aT[iT] == -1)
         {
           int associations = 0;
-          for(int iH=0; iH<nH; iH++)
+          dutHitMatcher.findInWindow(pT.at(iT).at(0),pT.at(iT).at(1),hitsInWindow);
+          for(size_t i=0; i<hitsInWindow.size(); i++)
           {
+            int iH = hitsInWindow[i];
             if(aH[iH] == -1)
             {
-              if(abs(pH.at(iH).at(0)-pT.at(iT).at(0))<limit && abs(pH.at(iH).at(1)-pT.at(iT).at(1))<limit)
-              {
-                associations++;
-                temp = iH;
-              }
+              associations++;
+              temp = iH;
             }
           }
           if(associations == 1)
@@ -1178,19 +1153,18 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
           int iT = order[i];
           double min = 1e10;
           bool associated = false;
-          for(int iH=0; iH<nH; iH++)
+          dutHitMatcher.findInWindow(pT.at(iT).at(0),pT.at(iT).at(1),hitsInWindow);
+          for(size_t iWindow=0; iWindow<hitsInWindow.size(); iWindow++)
           {
+            int iH = hitsInWindow[iWindow];
             if(aHTemp[iH]== -1)
             {
-              if(abs(pH.at(iH).at(0)-pT.at(iT).at(0))<limit && abs(pH.at(iH).at(1)-pT.at(iT).at(1))<limit)
+              double dist = sqrt(pow(abs(pH.at(iH).at(0)-pT.at(iT).at(0)),2)+pow(abs(pH.at(iH).at(1)-pT.at(iT).at(1)),2));
+              if(dist<min)
               {
-                double dist = sqrt(pow(abs(pH.at(iH).at(0)-pT.at(iT).at(0)),2)+pow(abs(pH.at(iH).at(1)-pT.at(iT).at(1)),2));
-                if(dist<min)
-                {
-                  min=dist;
-                  temp = iH;
-                  associated = true;
-                }
+                min=dist;
+                temp = iH;
+                associated = true;
               }
             }
           }
@@ -15,6 +15,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelExceptions.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelLCObjectPool.h"
 #include "CellIDReencoder.h"
 
 // marlin includes ".h"
@@ -22,6 +23,8 @@
 #include "marlin/Global.h"
 
 //Standard C++ libraries 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 
 // lcio includes <.h>
@@ -34,7 +37,21 @@ EUTelProcessorCoordinateTransformHits::EUTelProcessorCoordinateTransformHits():
 Processor("EUTelProcessorCoordinateTransformHits"),
 _hitCollectionNameInput(), 
 _hitCollectionNameOutput(),
-_undoAlignment(false)
+_undoAlignment(false),
+_transforms(),
+_hitSensorID(),
+_hitProperties(),
+_hitX(),
+_hitY(),
+_hitZ(),
+_hitCov(),
+_outputX(),
+_outputY(),
+_outputZ(),
+_outputCov(),
+_covMatrix(6, 0.),
+_nHitsTransformed(0),
+_transformTime(0.)
 {
 		_description ="EUTelLocaltoGlobalHitMaker is responsible to change local coordinates to global. This is done using the EUTelGeometryClass";
 
@@ -70,6 +87,30 @@ void EUTelProcessorCoordinateTransformHits::processRunHeader(LCRunHeader* rdr)
 						<< "The run header says the GeoID is " << header->getGeoID() << std::endl
 						<< "The GEAR description says is     " << geo::gGeometry().getSiPlanesLayoutID() << std::endl;
 		}
+
+		//The geometry may change from run to run
+		_transforms.clear();
+}
+
+void EUTelProcessorCoordinateTransformHits::setSensorTransform(int sensorID)
+{
+		//The geometry transform is affine: its translation is the image of the origin
+		//and the columns of its rotation are the images of the unit vectors
+		const double origin[3] = {0., 0., 0.};
+		double translation[3];
+		double rotation[9];
+		if(!_undoAlignment) geo::gGeometry().local2Master(sensorID, origin, translation);
+		else geo::gGeometry().master2Local(sensorID, origin, translation);
+		for(int col = 0; col < 3; ++col)
+		{
+			double unit[3] = {0., 0., 0.};
+			double column[3];
+			unit[col] = 1.;
+			if(!_undoAlignment) geo::gGeometry().local2MasterVec(sensorID, unit, column);
+			else geo::gGeometry().master2LocalVec(sensorID, unit, column);
+			for(int row = 0; row < 3; ++row) rotation[3*row+col] = column[row];
+		}
+		_transforms.setTransform(sensorID, rotation, translation);
 }
 
 void EUTelProcessorCoordinateTransformHits::processEvent(LCEvent* event)
@@ -106,7 +147,7 @@ void EUTelProcessorCoordinateTransformHits::processEvent(LCEvent* event)
 		}
 		catch(...)
 		{
-				outputCollection = new LCCollectionVec(LCIO::TRACKERHIT);
+				outputCollection = new EUTelPooledCollectionVec<TrackerHitImpl>(LCIO::TRACKERHIT);
 		}
 
 		std::string encoding = inputCollection->getParameters().getStringVal( LCIO::CellIDEncoding );
@@ -119,28 +160,31 @@ void EUTelProcessorCoordinateTransformHits::processEvent(LCEvent* event)
 		lcio::CellIDDecoder<TrackerHitImpl> hitDecoder ( encoding );
 		lcio::UTIL::CellIDReencoder<TrackerHitImpl> cellReencoder( encoding, outputCollection );
 
-		//Now get each individual hit LOOP OVER!
-		for(int iHit = 0; iHit < inputCollection->getNumberOfElements(); ++iHit)
+		//First read all the hits, so that the transforms run over all of them together
+		const int nHits = inputCollection->getNumberOfElements();
+		_hitSensorID.resize(nHits);
+		_hitProperties.resize(nHits);
+		_hitX.resize(nHits);
+		_hitY.resize(nHits);
+		_hitZ.resize(nHits);
+		_hitCov.resize(6*nHits);
+		_outputX.resize(nHits);
+		_outputY.resize(nHits);
+		_outputZ.resize(nHits);
+		_outputCov.resize(6*nHits);
+		for(int iHit = 0; iHit < nHits; ++iHit)
 		{  
 			TrackerHitImpl*	inputHit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(iHit));
-			TrackerHitImpl* outputHit = new IMPL::TrackerHitImpl(); 
 
-			//Call the local2masterHit/master2localHit function defined int EUTelGeometryTelescopeDescription
-			int properties = hitDecoder(inputHit)["properties"];
-			int sensorID = hitDecoder(inputHit)["sensorID"];
-			
-			const double* inputPos = inputHit->getPosition();
-			double outputPos[3];
+			//Decode the cell ID once for both fields
+			const UTIL::BitField64& cellID = hitDecoder(inputHit);
+			int properties = cellID["properties"];
+			int sensorID = cellID["sensorID"];
 
-			if( !(properties & kHitInGlobalCoord) && !_undoAlignment )
+			const bool isGlobal = (properties & kHitInGlobalCoord) != 0;
+			if( isGlobal == _undoAlignment )
 			{
-				streamlog_out(DEBUG5) << "Transforming hit from local to global!" << std::endl;
-				geo::gGeometry().local2Master(sensorID, inputPos, outputPos);
-			}
-			else if( (properties & kHitInGlobalCoord) && _undoAlignment )
-			{
-				streamlog_out(DEBUG5) << "Transforming hit from global to local!" << std::endl;
-				geo::gGeometry().master2Local(sensorID, inputPos, outputPos);
+				streamlog_out(DEBUG5) << (_undoAlignment ? "Transforming hit from global to local!" : "Transforming hit from local to global!") << std::endl;
 			}
 			else
 			{
@@ -150,10 +194,37 @@ void EUTelProcessorCoordinateTransformHits::processEvent(LCEvent* event)
 				else errMsg = "Provided local hit, but trying to transform into local. Something is wrong!";
 				throw InvalidGeometryException(errMsg);
 			}
-	
+
+			if(!_transforms.hasTransform(sensorID)) setSensorTransform(sensorID);
+
+			const double* inputPos = inputHit->getPosition();
+			const EVENT::FloatVec& inputCov = inputHit->getCovMatrix();
+			_hitSensorID[iHit] = sensorID;
+			_hitProperties[iHit] = properties;
+			_hitX[iHit] = inputPos[0];
+			_hitY[iHit] = inputPos[1];
+			_hitZ[iHit] = inputPos[2];
+			std::fill(_hitCov.begin() + 6*iHit, _hitCov.begin() + 6*iHit + 6, 0.f);
+			std::copy(inputCov.begin(), inputCov.begin() + std::min<std::size_t>(inputCov.size(), 6), _hitCov.begin() + 6*iHit);
+		}
+
+		//Positions and covariance matrices are transformed sensor by sensor
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		_transforms.apply(nHits, _hitSensorID.data(), _hitX.data(), _hitY.data(), _hitZ.data(), _outputX.data(), _outputY.data(), _outputZ.data());
+		_transforms.rotateCovariances(nHits, _hitSensorID.data(), _hitCov.data(), _outputCov.data());
+		_transformTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		_nHitsTransformed += nHits;
+
+		for(int iHit = 0; iHit < nHits; ++iHit)
+		{  
+			TrackerHitImpl*	inputHit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(iHit));
+			TrackerHitImpl* outputHit = EUTelLCObjectPool<TrackerHitImpl>::create();
+
 			//Fill the new outputHit with information
+			const double outputPos[3] = {_outputX[iHit], _outputY[iHit], _outputZ[iHit]};
 			outputHit->setPosition(outputPos);
-			outputHit->setCovMatrix( inputHit->getCovMatrix());
+			_covMatrix.assign(_outputCov.begin() + 6*iHit, _outputCov.begin() + 6*iHit + 6);
+			outputHit->setCovMatrix(_covMatrix);
 			outputHit->setType( inputHit->getType() );
 			outputHit->setTime( inputHit->getTime() );
 			outputHit->setCellID0( inputHit->getCellID0() );
@@ -163,7 +234,7 @@ void EUTelProcessorCoordinateTransformHits::processEvent(LCEvent* event)
 
 			cellReencoder.readValues(outputHit);
 			//^= is a bitwise XOR i.e. we will switch the coordinate sytsem
-			cellReencoder["properties"] = properties ^= kHitInGlobalCoord;
+			cellReencoder["properties"] = _hitProperties[iHit] ^ kHitInGlobalCoord;
 			cellReencoder.setCellID(outputHit);
 
 			outputCollection->push_back(outputHit);
@@ -182,5 +253,10 @@ void EUTelProcessorCoordinateTransformHits::processEvent(LCEvent* event)
 
 void EUTelProcessorCoordinateTransformHits::end()
 {
+	if(_transformTime > 0)
+	{
+		streamlog_out(MESSAGE4) << "Transformed " << _nHitsTransformed << " hits in " << _transformTime << " s, "
+			<< _nHitsTransformed / _transformTime << " hits/s" << std::endl;
+	}
 	streamlog_out(MESSAGE4) << "Successfully finished" << std::endl;
 }
@@ -22,7 +22,8 @@ EUTelProcessorDeadColumnFinder::EUTelProcessorDeadColumnFinder()
   _xPixel(),
   _yPixel(),
   _nEvent(0),
-  isDead(0)
+  isDead(0),
+  _occupancy()
   {
     _description="Search of dead columns in the chip";
     registerInputCollection (LCIO::TRACKERDATA, "ZSDataCollectionName",
@@ -45,6 +46,7 @@ void EUTelProcessorDeadColumnFinder::init() {
     _yPixel.push_back(geo::gGeometry().siPlaneYNpixels(iLayer));
     vector<bool> isDeadTmp(_xPixel[iLayer],false);
     isDead.push_back(isDeadTmp);
+    _occupancy.push_back(EUTelOccupancyCounter16(0, _xPixel[iLayer], 0, _yPixel[iLayer]));
 //    cerr << iLayer << "\t" << nFiredPixel[0][iLayer] << endl;
   }
 }
@@ -70,27 +72,31 @@ void EUTelProcessorDeadColumnFinder::processEvent(LCEvent *evt)
   }
   for ( unsigned int iDetector = 0 ; iDetector < zsInputDataCollectionVec->size(); iDetector++ )
   {
+    if (iDetector >= _occupancy.size()) break;
     TrackerDataImpl* zsData = dynamic_cast<TrackerDataImpl*>(zsInputDataCollectionVec->getElementAt(iDetector));
     auto sparseData = std::make_unique< EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
+    EUTelOccupancyCounter16& occupancy = _occupancy[iDetector];
+    const int nColumns = static_cast<int>(isDead[iDetector].size());
+    EUTelGenericSparsePixel sparsePixel, sparsePixel2;
     for ( unsigned int iPixel = 0; iPixel < sparseData->size(); iPixel++ )
     {
-      EUTelGenericSparsePixel *sparsePixel =  new EUTelGenericSparsePixel() ;
-      sparseData->getSparsePixelAt( iPixel, sparsePixel );
-      hitMap[iDetector]->Fill(sparsePixel->getXCoord(),sparsePixel->getYCoord());
+      sparseData->getSparsePixelAt( iPixel, &sparsePixel );
+      occupancy.fill(sparsePixel.getXCoord(),sparsePixel.getYCoord());
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+      if (_fillHistos) hitMap[iDetector]->Fill(sparsePixel.getXCoord(),sparsePixel.getYCoord());
+#endif
       if (iPixel != sparseData->size()-1)
       {
-        EUTelGenericSparsePixel *sparsePixel2 =  new EUTelGenericSparsePixel() ;
-        sparseData->getSparsePixelAt( iPixel+1, sparsePixel2 );
-        if (sparsePixel->getXCoord() == sparsePixel2->getXCoord() && sparsePixel->getYCoord() == sparsePixel2->getYCoord())
+        sparseData->getSparsePixelAt( iPixel+1, &sparsePixel2 );
+        const int x = sparsePixel.getXCoord();
+        if (x == sparsePixel2.getXCoord() && sparsePixel.getYCoord() == sparsePixel2.getYCoord() && x >= 0 && x < nColumns)
         {
-          isDead[iDetector][sparsePixel->getXCoord()] = true;
-          if (sparsePixel->getXCoord()%2 == 0) isDead[iDetector][sparsePixel->getXCoord()+1] = true;
-          else isDead[iDetector][sparsePixel->getXCoord()-1] = true;
+          isDead[iDetector][x] = true;
+          if (x%2 == 0) { if (x+1 < nColumns) isDead[iDetector][x+1] = true; }
+          else isDead[iDetector][x-1] = true;
         }
-//          cerr << "Same pixel (" << sparsePixel->getXCoord() << ", " << sparsePixel->getYCoord() << ") appearing twice in event " << evt->getEventNumber() << endl;
-        delete sparsePixel2;
+//          cerr << "Same pixel (" << sparsePixel.getXCoord() << ", " << sparsePixel.getYCoord() << ") appearing twice in event " << evt->getEventNumber() << endl;
       }
-      delete sparsePixel;
     }
   }
 }
@@ -134,7 +140,7 @@ void EUTelProcessorDeadColumnFinder::end()
 
   streamlog_out ( MESSAGE5 ) << "Average number of hits per event:" << endl;
   for (int iLayer=0; iLayer<_nLayer; iLayer++ )
-    streamlog_out ( MESSAGE5 ) << "Layer " << iLayer << "\t" << (double)hitMap[iLayer]->GetEntries()/_nEvent << endl;
+    streamlog_out ( MESSAGE5 ) << "Layer " << iLayer << "\t" << (double)_occupancy[iLayer].getNumberOfHits()/_nEvent << endl;
   for (int iLayer=0; iLayer<_nLayer; iLayer++ )
   {
     CellIDEncoder< TrackerDataImpl > deadColumnEncoder  ( eutelescope::EUTELESCOPE::ZSDATADEFAULTENCODING, deadColumnCollection);
@@ -143,25 +149,11 @@ void EUTelProcessorDeadColumnFinder::end()
     auto currentFrame = std::make_unique<lcio::TrackerDataImpl>();
     deadColumnEncoder.setCellID( currentFrame.get() );
     auto sparseFrame = std::make_unique<eutelescope::EUTelTrackerDataInterfacerImpl<eutelescope::EUTelGenericSparsePixel>>(currentFrame.get());
-    vector<int> hitPixels(hitMap[iLayer]->GetNbinsX(),0) ;
-//    for (int x=0; x<hitMap[iLayer]->GetNbinsX(); x++)
-//      hitPixels[x] = 0;
-    for (int x=1; x<hitMap[iLayer]->GetNbinsX()+1; x++)
-    {
-//      hitPixels[x-1] = 0;
-      for (int y=1; y<hitMap[iLayer]->GetNbinsY()+1; y++)
-      {
-        if (hitMap[iLayer]->GetBinContent(x,y) != 0)
-        {
-//          if ( x == 1) cerr << iLayer << "\t" << y << "\t" << hitMap[iLayer]->GetBinContent(x,y) << endl;
-          hitPixels[x-1]++;
-//          if (hitPixels > 1) deadColumn = false;
-//          cerr << iLayer << "\t" << x << "\t" << y << endl;
-//          return;
-        }
-      }
-    }
-    for (int x=0; x<hitMap[iLayer]->GetNbinsX(); x++)
+    // number of fired pixels in every column
+    vector<int> hitPixels;
+    _occupancy[iLayer].firedPixelsPerColumn(hitPixels);
+    const int nColumns = static_cast<int>(hitPixels.size());
+    for (int x=0; x+1<nColumns; x++)
     {
 //      bool deadColumn = false;
       if (hitPixels[x] <=1 && hitPixels[x+1] <=1)
@@ -170,7 +162,7 @@ void EUTelProcessorDeadColumnFinder::end()
         isDead[iLayer][x+1] = true;
 //      deadColumn = true;
       }
-      else if (x > 0 && x < hitMap[iLayer]->GetNbinsX()-2 && hitPixels[x-1] > 100 && hitPixels[x+2] > 100 && (double)hitPixels[x]/hitPixels[x-1] < 0.7 && (double)hitPixels[x]/hitPixels[x+2] < 0.7 && (double)hitPixels[x+1]/hitPixels[x-1] < 0.7 && (double)hitPixels[x+1]/hitPixels[x+2] < 0.7)
+      else if (x > 0 && x < nColumns-2 && hitPixels[x-1] > 100 && hitPixels[x+2] > 100 && (double)hitPixels[x]/hitPixels[x-1] < 0.7 && (double)hitPixels[x]/hitPixels[x+2] < 0.7 && (double)hitPixels[x+1]/hitPixels[x-1] < 0.7 && (double)hitPixels[x+1]/hitPixels[x+2] < 0.7)
       {
         isDead[iLayer][x] = true;
         isDead[iLayer][x+1] = true;
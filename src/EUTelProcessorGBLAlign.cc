@@ -1,5 +1,15 @@
 
 #include "EUTelProcessorGBLAlign.h"
+#include "EUTelAlignmentConstant.h"
+
+// lcio includes <.h>
+#include <IO/LCWriter.h>
+#include <UTIL/LCTime.h>
+#include <IMPL/LCEventImpl.h>
+#include <IMPL/LCRunHeaderImpl.h>
+
+// system includes <>
+#include <cmath>
 
 using namespace eutelescope;
 
@@ -15,7 +25,15 @@ _alignmentMode(7),
 _beamQ(-1),
 _eBeam(4),
 _createBinary(true),
-_mEstimatorType()
+_mEstimatorType(),
+_useTrackCache(false),
+_trackCacheFileName(""),
+_readTrackCache(false),
+_maxAlignmentIterations(5),
+_shiftTolerance(1e-3),
+_rotationTolerance(1e-5),
+_trackCache(),
+_accumulatedCorrections()
 {
   // TrackerHit input collection
   registerInputCollection(LCIO::TRACK, "TrackCandidatesInputCollectionName", "Input track candidate collection name",_trackCandidatesInputCollectionName,std::string("TrackCandidatesCollection"));
@@ -75,6 +93,18 @@ _mEstimatorType()
                             "constants (add .slcio)",_alignmentConstantLCIOFile, static_cast< std::string > ( "alignment.slcio" ) );
 		registerOptionalParameter("ExcludePlanes", "This is the planes that will not be included in analysis", _excludePlanes ,IntVec());
 
+		registerOptionalParameter("UseTrackCache", "Keep the track candidates in memory and iterate realign/refit/solve in-process at the end of the job", _useTrackCache, bool(false));
+
+		registerOptionalParameter("TrackCacheFile", "Binary file the track cache is written to. Leave empty to keep the cache in memory only", _trackCacheFileName, std::string(""));
+
+		registerOptionalParameter("ReadTrackCache", "Read the track candidates from TrackCacheFile instead of the input collection", _readTrackCache, bool(false));
+
+		registerOptionalParameter("MaxAlignmentIterations", "Maximum number of alignment iterations run on the track cache", _maxAlignmentIterations, static_cast<int>(5));
+
+		registerOptionalParameter("ShiftTolerance", "Iterations on the track cache stop once all shift corrections are below this value [mm]", _shiftTolerance, static_cast<double>(1e-3));
+
+		registerOptionalParameter("RotationTolerance", "Iterations on the track cache stop once all rotation corrections are below this value [rad]", _rotationTolerance, static_cast<double>(1e-5));
+
 
 }
 
@@ -161,34 +191,17 @@ void EUTelProcessorGBLAlign::processEvent(LCEvent * evt){
 			}else if (event->getEventType() == kUNKNOWN) {
 				streamlog_out(WARNING2) << "Event number " << event->getEventNumber() << " in run " << event->getRunNumber() << " is of unknown type. Continue considering it as a normal Data Event." << std::endl;
 			}
+            if(_useTrackCache && _readTrackCache){
+                return;
+            }
             EUTelReaderGenericLCIO reader = EUTelReaderGenericLCIO();
             std::vector<EUTelTrack> tracks = reader.getTracks(evt, _trackCandidatesInputCollectionName);
             for (size_t iTrack = 0; iTrack < tracks.size(); ++iTrack) {
                 _totalTrackCount++;
-                _trackFitter->resetPerTrack(); //Here we reset the label that connects state to GBL point to 1 again. Also we set the list of states->labels to 0
-                EUTelTrack track = tracks.at(iTrack);
-    //			float chi = track.getChi2();
-//				float ndf = static_cast<float>(track.getNdf());
-                std::vector< gbl::GblPoint > pointList;//This is the GBL points. These contain the state information, scattering and alignment jacobian. All the information that the mille binary will get.
-                _trackFitter->setInformationForGBLPointList(track, pointList);//We create all the GBL points with scatterer inbetween both planes. This is identical to creating GBL tracks
-                _trackFitter->setPairMeasurementStateAndPointLabelVec(pointList);
-                _trackFitter->setAlignmentToMeasurementJacobian(pointList); //This is place in GBLFitter since millepede has no idea about states and points. Only GBLFitter know about that
-                const gear::BField& B = geo::gGeometry().getMagneticField();
-                const double Bmag = B.at( TVector3(0.,0.,0.) ).r2();
-                gbl::GblTrajectory* traj = 0;
-//					printPointsInformation(pointList);
-                if ( Bmag < 1.E-6 ) {
-                    traj = new gbl::GblTrajectory( pointList, false ); //Must make sure this is not a memory leak
-                } else {
-                    traj = new gbl::GblTrajectory( pointList, true );
+                if(_useTrackCache){
+                    _trackCache.addTrack(tracks.at(iTrack));
                 }
-                double chi2, loss;
-                int ndf2;
-                traj->fit(chi2, ndf2, loss, _mEstimatorType );
-                streamlog_out ( DEBUG0 ) << "This is the trajectory we are just about to fit: " << std::endl;
-                streamlog_message( DEBUG0, traj->printTrajectory(10);, std::endl; );
-//				std::cout<<"WRITE TO MILLEPEDE. EVENT: " << 	event->getEventNumber() << "  Total number of tracks: " << _totalTrackCount << std::endl;	
-                traj->milleOut(*(_Mille->_milleGBL));
+                writeTrackToMille(tracks.at(iTrack));
             }//END OF LOOP FOR ALL TRACKS IN AN EVENT
 //			if(event->getEventNumber() == 1){
 //				throw marlin::StopProcessingException( this ) ;
@@ -214,8 +227,209 @@ void EUTelProcessorGBLAlign::processEvent(LCEvent * evt){
 
 }
 
+void EUTelProcessorGBLAlign::writeTrackToMille(EUTelTrack& track){
+	_trackFitter->resetPerTrack(); //Here we reset the label that connects state to GBL point to 1 again. Also we set the list of states->labels to 0
+	std::vector< gbl::GblPoint > pointList;//This is the GBL points. These contain the state information, scattering and alignment jacobian. All the information that the mille binary will get.
+	_trackFitter->setInformationForGBLPointList(track, pointList);//We create all the GBL points with scatterer inbetween both planes. This is identical to creating GBL tracks
+	_trackFitter->setPairMeasurementStateAndPointLabelVec(pointList);
+	_trackFitter->setAlignmentToMeasurementJacobian(pointList); //This is place in GBLFitter since millepede has no idea about states and points. Only GBLFitter know about that
+	const gear::BField& B = geo::gGeometry().getMagneticField();
+	const double Bmag = B.at( TVector3(0.,0.,0.) ).r2();
+	std::unique_ptr<gbl::GblTrajectory> traj;
+	if ( Bmag < 1.E-6 ) {
+		traj = std::make_unique<gbl::GblTrajectory>( pointList, false );
+	} else {
+		traj = std::make_unique<gbl::GblTrajectory>( pointList, true );
+	}
+	double chi2, loss;
+	int ndf2;
+	traj->fit(chi2, ndf2, loss, _mEstimatorType );
+	streamlog_out ( DEBUG0 ) << "This is the trajectory we are just about to fit: " << std::endl;
+	streamlog_message( DEBUG0, traj->printTrajectory(10);, std::endl; );
+	traj->milleOut(*(_Mille->_milleGBL));
+}
+
+//The first iteration uses the binary filled during the event loop (unless the cache was read from file). Every following iteration applies the corrections of the previous
+//one to the geometry, rebuilds the tracks from the cache in the updated local frames, refits them and runs pede again. Only the final geometry is written out.
+void EUTelProcessorGBLAlign::alignUsingTrackCache(){
+	try{
+		if(_readTrackCache){
+			if(_trackCacheFileName.empty()){
+				streamlog_out(ERROR5) << "ReadTrackCache is set but no TrackCacheFile is given. No alignment performed." << std::endl;
+				return;
+			}
+			_trackCache.read(_trackCacheFileName);
+			_totalTrackCount = _trackCache.getNumberOfTracks();
+		}else if(!_trackCacheFileName.empty()){
+			_trackCache.write(_trackCacheFileName);
+		}
+	}
+	catch(lcio::Exception& e){
+		streamlog_out(ERROR5) << e.what() << std::endl;
+		if(_readTrackCache){
+			streamlog_out(ERROR5) << "The track cache could not be read. No alignment performed." << std::endl;
+			return;
+		}
+	}
+	if(_trackCache.getNumberOfTracks() == 0){
+		streamlog_out(ERROR5) << "The track cache is empty. No alignment performed." << std::endl;
+		return;
+	}
+	//Every sensor with hits in the cache and not excluded must get corrections from pede.
+	std::set<int> alignedSensors = _trackCache.getSensorsWithHits();
+	for(IntVec::const_iterator it = _excludePlanes.begin(); it != _excludePlanes.end(); ++it){
+		alignedSensors.erase(*it);
+	}
+	_accumulatedCorrections.clear();
+	_Mille->writeMilleSteeringFile(_pedeSteerAddCmds);
+	bool converged = false;
+	for(int iteration = 0; iteration < _maxAlignmentIterations && !converged; ++iteration){
+		if(iteration > 0 || _readTrackCache){
+			_Mille->resetBinary();
+			for(size_t iTrack = 0; iTrack < _trackCache.getNumberOfTracks(); ++iTrack){
+				EUTelTrack track = _trackCache.getTrack(iTrack);
+				writeTrackToMille(track);
+			}
+			_Mille->closeBinary();
+		}
+		streamlog_out(MESSAGE9) << "TRACK CACHE ALIGNMENT ITERATION " << iteration << " WITH " << _trackCache.getNumberOfTracks() << " TRACKS" << std::endl;
+		bool tooManyRejects = _Mille->runPede();
+		if(tooManyRejects){
+			streamlog_out(WARNING5) << "Too many rejects in iteration " << iteration << ". Stop iterating." << std::endl;
+			break;
+		}
+		std::map<int, std::vector<double> > corrections;
+		try{
+			corrections = _Mille->readResults();
+		}
+		catch(lcio::Exception& e){
+			streamlog_out(ERROR5) << e.what() << std::endl;
+		}
+		if(!hasAllCorrections(corrections, alignedSensors)){
+			streamlog_out(ERROR5) << "Iteration " << iteration << " has no usable pede results. Stop iterating." << std::endl;
+			break;
+		}
+		converged = applyAlignmentCorrections(corrections);
+	}
+	if(converged){
+		streamlog_out (MESSAGE9) <<"Converge:Successful! "<< std::endl;
+	}else{
+		streamlog_out (MESSAGE9) <<"Converge:Fail! "<< std::endl;
+	}
+	if(!_accumulatedCorrections.empty()){
+		geo::gGeometry().writeGEARFile(_gear_aligned_file);
+		writeAccumulatedAlignmentConstants();
+	}
+}
+
+bool EUTelProcessorGBLAlign::hasAllCorrections(std::map<int, std::vector<double> > const & corrections, std::set<int> const & alignedSensors) const {
+	if(corrections.empty()){
+		streamlog_out(ERROR5) << "The pede results file " << _milleResultFileName << " holds no corrections for any known sensor." << std::endl;
+		return false;
+	}
+	bool complete = true;
+	for(std::set<int>::const_iterator it = alignedSensors.begin(); it != alignedSensors.end(); ++it){
+		if(corrections.find(*it) == corrections.end()){
+			streamlog_out(ERROR5) << "The pede results file " << _milleResultFileName << " holds no corrections for sensor " << *it << std::endl;
+			complete = false;
+		}
+	}
+	return complete;
+}
+
+void EUTelProcessorGBLAlign::sensorRotation(int sensorID, double* rotation){
+	//The columns of the rotation are the images of the local axes.
+	for(int col = 0; col < 3; ++col){
+		double axis[3] = {0., 0., 0.};
+		axis[col] = 1.;
+		double image[3];
+		geo::gGeometry().local2MasterVec(sensorID, axis, image);
+		for(int row = 0; row < 3; ++row) rotation[3 * row + col] = image[row];
+	}
+}
+
+bool EUTelProcessorGBLAlign::applyAlignmentCorrections(std::map<int, std::vector<double> > const & corrections){
+	//No corrections is a failure, not convergence.
+	if(corrections.empty()) return false;
+	bool belowTolerance = true;
+	std::map<int, std::vector<double> > globalCorrections;
+	//Transform all corrections with the current geometry before the geometry is changed.
+	for(std::map<int, std::vector<double> >::const_iterator it = corrections.begin(); it != corrections.end(); ++it){
+		const int sensorID = it->first;
+		const std::vector<double>& local = it->second;
+		double rotation[9];
+		sensorRotation(sensorID, rotation);
+		//IMPORTANT:Note the transformation of the angles assumes that they transform like a vector. This is not true unless the angles are small.   
+		std::vector<double>& global = globalCorrections[sensorID];
+		global.resize(6);
+		_accumulatedCorrections.add(sensorID, rotation, local.data(), global.data());
+
+		for(size_t i = 0; i < 6; ++i){
+			const double tolerance = (i < 3) ? _shiftTolerance : _rotationTolerance;
+			if(std::abs(local[i]) > tolerance) belowTolerance = false;
+		}
+		streamlog_out(MESSAGE5) << "Sensor " << sensorID << " corrections (local) x,y,z: " << local[0] << " " << local[1] << " " << local[2]
+		                        << " rotations x,y,z: " << local[3] << " " << local[4] << " " << local[5] << std::endl;
+	}
+	for(std::map<int, std::vector<double> >::const_iterator it = globalCorrections.begin(); it != globalCorrections.end(); ++it){
+		const int sensorID = it->first;
+		const std::vector<double>& delta = it->second;
+		geo::gGeometry().setPlaneXPosition(sensorID, geo::gGeometry().siPlaneXPosition(sensorID) + delta[0]);
+		geo::gGeometry().setPlaneYPosition(sensorID, geo::gGeometry().siPlaneYPosition(sensorID) + delta[1]);
+		geo::gGeometry().setPlaneZPosition(sensorID, geo::gGeometry().siPlaneZPosition(sensorID) + delta[2]);
+		geo::gGeometry().setPlaneXRotationRadians(sensorID, geo::gGeometry().siPlaneXRotationRadians(sensorID) + delta[3]);
+		geo::gGeometry().setPlaneYRotationRadians(sensorID, geo::gGeometry().siPlaneYRotationRadians(sensorID) + delta[4]);
+		geo::gGeometry().setPlaneZRotationRadians(sensorID, geo::gGeometry().siPlaneZRotationRadians(sensorID) + delta[5]);
+	}
+	geo::gGeometry().updateTGeoPlaneTransformations();
+	return belowTolerance;
+}
+
+void EUTelProcessorGBLAlign::writeAccumulatedAlignmentConstants(){
+	LCWriter* lcWriter = LCFactory::getInstance()->createLCWriter();
+	try {
+		lcWriter->open( _alignmentConstantLCIOFile, LCIO::WRITE_NEW );
+	} catch ( IOException& e ) {
+		streamlog_out ( ERROR4 ) << e.what() << std::endl;
+		delete lcWriter;
+		return;
+	}
+	streamlog_out ( MESSAGE5 ) << "Writing to " << _alignmentConstantLCIOFile << std::endl;
+
+	LCRunHeaderImpl * lcHeader  = new LCRunHeaderImpl;
+	lcHeader->setRunNumber( 0 );
+	lcWriter->writeRunHeader(lcHeader);
+	delete lcHeader;
+
+	LCEventImpl * event = new LCEventImpl;
+	event->setRunNumber( 0 );
+	event->setEventNumber( 0 );
+	LCTime now;
+	event->setTimeStamp( now.timeStamp() );
+
+	LCCollectionVec * constantsCollection = new LCCollectionVec( LCIO::LCGENERICOBJECT );
+	//Same frame as the constants parsemilleout.sh writes on the pede path: the local frame of the starting geometry.
+	const std::vector<int> sensorIDs = _accumulatedCorrections.getSensorIDs();
+	for(std::vector<int>::const_iterator it = sensorIDs.begin(); it != sensorIDs.end(); ++it){
+		double total[6];
+		_accumulatedCorrections.getStartingLocal(*it, total);
+		EUTelAlignmentConstant* constant = new EUTelAlignmentConstant(*it, total[0], total[1], total[2], total[3], total[4], total[5], 0., 0., 0., 0., 0., 0.);
+		constantsCollection->push_back( constant );
+		streamlog_out ( MESSAGE5 ) << (*constant) << std::endl;
+	}
+	event->addCollection( constantsCollection, "alignment" );
+	lcWriter->writeEvent( event );
+	delete event;
+	lcWriter->close();
+	delete lcWriter;
+}
+
 void EUTelProcessorGBLAlign::end(){
-	_Mille->_milleGBL->~MilleBinary();
+	_Mille->closeBinary();
+	if(_useTrackCache){
+		alignUsingTrackCache();
+		return;
+	}
 //	double size =	printSize("millepede.bin");
 //	std::cout<<"Binary after track addition " << size << " This is the size per track: " << size/_totalTrackCount << std::endl;
 
@@ -24,6 +24,7 @@
 #include "EUTelTrackerDataInterfacerImpl.h"
 #include "EUTelGenericSparseClusterImpl.h"
 #include "EUTelGeometricClusterImpl.h"
+#include "EUTelLCObjectPool.h"
 
 //eutel geometry
 #include "EUTelGeometryTelescopeGeoDescription.h"
@@ -58,6 +59,7 @@
 #include <vector>
 #include <memory>
 //#include <iostream>
+#include <chrono>
 #include <cmath>
 
 using namespace lcio;
@@ -86,7 +88,9 @@ EUTelProcessorGeometricClustering::EUTelProcessorGeometricClustering():
   _isGeometryReady(false),
   _sensorIDVec(),
   _zsInputDataCollectionVec(NULL),
-  _pulseCollectionVec(NULL)
+  _pulseCollectionVec(NULL),
+  _nPixelsClustered(0),
+  _clusteringTime(0)
  {
   
   // modify processor description
@@ -125,6 +129,8 @@ void EUTelProcessorGeometricClustering::init() {
 	//set to zero the run and event counters
 	_iRun = 0;
 	_iEvt = 0;
+	_nPixelsClustered = 0;
+	_clusteringTime = 0;
 
 	//the geometry is not yet initialized, so set the corresponding switch to false
 	_isGeometryReady = false;
@@ -212,7 +218,7 @@ void EUTelProcessorGeometricClustering::processEvent(LCEvent* event) {
 		pulseCollectionExists = true;
 		_initialPulseCollectionSize = pulseCollection->size();
 	} catch ( lcio::DataNotAvailableException& e ) {
-		pulseCollection = new LCCollectionVec(LCIO::TRACKERPULSE);
+		pulseCollection = new EUTelPooledCollectionVec<TrackerPulseImpl>(LCIO::TRACKERPULSE);
 	}
 
 	//HERE WE ACTUALLY CALL THE CLUSTERING ROUTINE:
@@ -246,7 +252,7 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 		sparseClusterCollectionVec = dynamic_cast< LCCollectionVec* > ( evt->getCollection( "original_zsdata") );
 		isDummyAlreadyExisting = true ;
 	} catch (lcio::DataNotAvailableException& e) {
-		sparseClusterCollectionVec =  new LCCollectionVec(LCIO::TRACKERDATA);
+		sparseClusterCollectionVec = new EUTelPooledCollectionVec<TrackerDataImpl>(LCIO::TRACKERDATA);
 		isDummyAlreadyExisting = false;
 	}
 
@@ -290,7 +296,11 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 		
 		int hitPixelsInEvent = sparseData->size();
 		std::vector<EUTelGeometricPixel> hitPixelVec;
+		hitPixelVec.reserve( hitPixelsInEvent );
 		EUTelGenericSparsePixel* pixel = NULL;
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		int skippedPixels = 0;
 			
 		//This for-loop loads all the hits of the given event and detector plane and stores them as GeometricPixels
 		for(int i = 0; i < hitPixelsInEvent; ++i )
@@ -298,58 +308,35 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 		   
 		    pixel = dynamic_cast<EUTelGenericSparsePixel *>( sparseData->getSparsePixelAt( i, pixel ) );
 		    EUTelGeometricPixel hitPixel( *pixel );
-		    
-		    //And get the path to the given pixel
-		    std::string pixelPath = geoDescr->getPixName(hitPixel.getXCoord(), hitPixel.getYCoord());
-		    
-		    //Then navigate to this pixel with the TGeo manager
-		    geo::gGeometry()._geoManager->cd( (planePath+pixelPath).c_str() );
-		    
-		    //get the imbedding box
-		    TGeoShape* currentShape =  geo::gGeometry()._geoManager->GetCurrentVolume()->GetShape();
-		    TGeoBBox* bbox = dynamic_cast<TGeoBBox*>( currentShape );
-		    //store the dimensions of this box in the GeometricPixel
-		    hitPixel.setBoundaryX( bbox->GetDX() );
-		    hitPixel.setBoundaryY( bbox->GetDY() );
-		    
-		    //Get how deep the node description goes (this is how often we have to transform to get coordinates in the local plane coordinate system)
-		    std::vector<std::string> split = Utility::stringSplit( planePath+pixelPath , "/", false);
-		    
-		    //Three recursions for the telescope/plane
-		    int recursionDepth = split.size() - 3;
-		    
-		    //The do the transformation
-		    Double_t origin_pt[3] = {0,0,0};
-		    Double_t transformed1_pt[3];
-		    Double_t transformed2_pt[3];
-		    gGeoManager->GetCurrentNode()->LocalToMaster(origin_pt, transformed1_pt);
-		    
-		    transformed2_pt[0] = transformed1_pt[0];
-		    transformed2_pt[1] = transformed1_pt[1];
-		    transformed2_pt[2] = transformed1_pt[2];
 
-		    //transform into local plane coordinate system
-		    for(int i = 1 ; i < recursionDepth; ++i)
-		      {
-			gGeoManager->GetMother(i)->LocalToMaster(transformed1_pt, transformed2_pt);
-			transformed1_pt[0] = transformed2_pt[0];
-			transformed1_pt[1] = transformed2_pt[1];
-			transformed1_pt[2] = transformed2_pt[2];
-		      }
+		    //A pixel outside the description can only come from corrupt or foreign data
+		    if( !geoDescr->isPixelInRange( hitPixel.getXCoord(), hitPixel.getYCoord() ) ) {
+		      ++skippedPixels;
+		      continue;
+		    }
 		    
-		    //store all the position information in the GeometricPixel
-		    hitPixel.setPosX( transformed2_pt[0] );
-		    hitPixel.setPosY( transformed2_pt[1] );
+		    //Look up the pixel geometry, the TGeo navigation is done only
+		    //the first time a pixel fires
+		    const EUTelGenericPixGeoDescr::PixelGeometry& pixelGeometry = geoDescr->getPixelGeometry( hitPixel.getXCoord(), hitPixel.getYCoord(), planePath );
+		    hitPixel.setBoundaryX( pixelGeometry.boundaryX );
+		    hitPixel.setBoundaryY( pixelGeometry.boundaryY );
+		    hitPixel.setPosX( pixelGeometry.posX );
+		    hitPixel.setPosY( pixelGeometry.posY );
 		    //and push this pixel back
 		    hitPixelVec.push_back( hitPixel );
 		  }		
+
+		if( skippedPixels > 0 ) {
+		  streamlog_out ( WARNING2 ) << "Skipped " << skippedPixels << " pixels outside the index range of sensor " << sensorID
+		                             << " in event " << evt->getEventNumber() << std::endl;
+		}
 		
 		std::vector<EUTelGeometricPixel> newlyAdded;
 		//We now cluster those hits together
 		while( !hitPixelVec.empty() )
 		  {
 		    // prepare a TrackerData to store the cluster candidate
-		    std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
+		    std::unique_ptr<TrackerDataImpl> zsCluster( EUTelLCObjectPool<TrackerDataImpl>::create() );
 		    // prepare a reimplementation of sparsified cluster
 		    std::unique_ptr<EUTelGenericSparseClusterImpl<EUTelGeometricPixel>> sparseCluster = std::make_unique<EUTelGenericSparseClusterImpl<EUTelGeometricPixel>>(zsCluster.get());
 		    
@@ -426,7 +413,7 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 			//sparseCluster->getClusterInfo(xSeed, ySeed, xSize, ySize);
 			
 			// prepare a pulse for this cluster
-			std::unique_ptr<TrackerPulseImpl> zsPulse = std::make_unique<TrackerPulseImpl>();
+			std::unique_ptr<TrackerPulseImpl> zsPulse( EUTelLCObjectPool<TrackerPulseImpl>::create() );
 			idZSPulseEncoder["sensorID"]  = sensorID;
 			//idZSPulseEncoder["xSeed"]     = xSeed;
 			//idZSPulseEncoder["ySeed"]     = ySeed;
@@ -451,6 +438,9 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 		  } //loop over all found clusters
 		
 		delete pixel;
+
+		_clusteringTime += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+		_nPixelsClustered += hitPixelsInEvent;
 		
 	} // this is the end of the loop over all ZS detectors
 	
@@ -483,6 +473,11 @@ void EUTelProcessorGeometricClustering::end() {
 		streamlog_out ( MESSAGE4 ) << "Found " << iter->second << " clusters on detector " << iter->first << std::endl;
 		++iter;
 	}
+
+	if ( _clusteringTime > 0 ) {
+		streamlog_out ( MESSAGE4 ) << "Clustered " << _nPixelsClustered << " pixels in " << _clusteringTime << " s, "
+		                           << _nPixelsClustered / _clusteringTime << " pixels/s" << std::endl;
+	}
 }
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
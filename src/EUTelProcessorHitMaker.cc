@@ -30,6 +30,9 @@
 #include "EUTelExceptions.h"
 #include "EUTelAlignmentConstant.h"
 #include "EUTelReferenceHit.h"
+#include "EUTelEtaFunctionImpl.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelLCObjectPool.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -48,6 +51,7 @@
 #include <IMPL/LCCollectionVec.h>
 #include <IMPL/TrackerPulseImpl.h>
 #include <IMPL/TrackerHitImpl.h>
+#include <EVENT/LCGenericObject.h>
 #include <UTIL/CellIDDecoder.h>
 #include <UTIL/LCTime.h>
 
@@ -81,13 +85,28 @@ _referenceHitCollectionName("referenceHit"),
 _referenceHitCollectionVec(),
 _wantLocalCoordinates(false),
 _referenceHitLCIOFile("reference.slcio"),
+_etaSwitch(false),
+_etaCollectionNames(),
+_cogAlgorithm("Full"),
+_nPixel(9),
+_xyCluSize(),
+_etaLookupSamples(1024),
+_hotPixelCollectionName(""),
 _iRun(0),
 _iEvt(0),
 _conversionIdMap(),
 _alreadyBookedSensorID(),
 _aidaHistoMap(),
 _histogramSwitch(true),
-_orderedSensorIDVec()
+_orderedSensorIDVec(),
+_xEtaTables(),
+_yEtaTables(),
+_etaTablesLoaded(false),
+_hotPixelMap(),
+_hotPixelMapLoaded(false),
+_clusterBatches(),
+_clusterBatchIndices(),
+_warnedUnbatchedPosition(false)
 {
   // modify processor description
   _description =  "EUTelProcessorHitMaker is responsible to translate cluster centers from the local frame of reference \nto the external frame of reference using the GEAR geometry description";
@@ -101,6 +120,24 @@ _orderedSensorIDVec()
   registerOptionalParameter("ReferenceCollection","This is the name of the reference hit collection initialized in this processor. This collection provides the reference vector to correctly determine a plane corresponding to a global hit coordiante.", _referenceHitCollectionName, static_cast<string>("referenceHit") );
  
   registerOptionalParameter("ReferenceHitFile","This is the file where the reference hit collection is stored", _referenceHitLCIOFile, std::string("reference.slcio") );
+
+  registerOptionalParameter("EtaSwitch","Apply the eta correction to the cluster center of gravity", _etaSwitch, static_cast<bool>(false) );
+
+  std::vector<std::string> etaNames;
+  etaNames.push_back("xEtaCondition");
+  etaNames.push_back("yEtaCondition");
+  registerOptionalParameter("EtaCollectionName","The name of the eta collections along x and y", _etaCollectionNames, etaNames );
+
+  registerOptionalParameter("CoGAlgorithm","Center of gravity algorithm: \"Full\", \"NPixel\" or \"NxMPixel\"", _cogAlgorithm, std::string("Full") );
+
+  registerOptionalParameter("NPixel","Number of most significant pixels used by the NPixel algorithm", _nPixel, static_cast<int>(9) );
+
+  std::vector<int> xyCluSize(2, 3);
+  registerOptionalParameter("NxMPixel","Window size along x and y used by the NxMPixel algorithm", _xyCluSize, xyCluSize );
+
+  registerOptionalParameter("EtaLookupSamples","Number of samples of the eta lookup tables", _etaLookupSamples, static_cast<int>(1024) );
+
+  registerOptionalParameter("HotPixelCollectionName","Name of the hot pixel collection, if given every hit is flagged in its quality when its cluster contains a hot pixel", _hotPixelCollectionName, std::string("") );
 }
 
 void EUTelProcessorHitMaker::init(){
@@ -114,6 +151,19 @@ void EUTelProcessorHitMaker::init(){
 
 	_histogramSwitch = true;
 
+	if( _cogAlgorithm != "Full" && _cogAlgorithm != "NPixel" && _cogAlgorithm != "NxMPixel" ) {
+		throw InvalidParameterException("Unknown CoGAlgorithm " + _cogAlgorithm + ", use Full, NPixel or NxMPixel");
+	}
+	if( _cogAlgorithm == "NxMPixel" && _xyCluSize.size() != 2 ) {
+		throw InvalidParameterException("NxMPixel needs two values");
+	}
+	if( _etaSwitch && _etaCollectionNames.size() != 2 ) {
+		throw InvalidParameterException("EtaCollectionName needs the x and the y collection");
+	}
+	_etaTablesLoaded = false;
+	_hotPixelMapLoaded = false;
+	_warnedUnbatchedPosition = false;
+
 	//only for global coord we need a refhit collection
 	if(!_wantLocalCoordinates) {
 				DumpReferenceHitDB();
@@ -256,7 +306,7 @@ void EUTelProcessorHitMaker::processEvent (LCEvent * event) {
     }
     catch(...)
     {
-       hitCollection = new LCCollectionVec(LCIO::TRACKERHIT);
+       hitCollection = new EUTelPooledCollectionVec<TrackerHitImpl>(LCIO::TRACKERHIT);
     }
 
 
@@ -265,6 +315,13 @@ void EUTelProcessorHitMaker::processEvent (LCEvent * event) {
     CellIDDecoder<TrackerPulseImpl> clusterCellDecoder(pulseCollection);
     CellIDDecoder<TrackerDataImpl> cellDecoder(EUTELESCOPE::ZSDATADEFAULTENCODING);
 
+    if( _etaSwitch && !_etaTablesLoaded ) loadEtaTables( event );
+    if( !_hotPixelMapLoaded ) loadHotPixelMap( event );
+
+    std::vector< double > batchXPos, batchYPos;
+    std::vector< char > hasBatchPos;
+    reconstructBatchPositions( pulseCollection, batchXPos, batchYPos, hasBatchPos );
+
     int oldDetectorID = -100;
 
     double xSize = 0., ySize = 0.;
@@ -309,8 +366,25 @@ void EUTelProcessorHitMaker::processEvent (LCEvent * event) {
 
 			// LOCAL coordinate system !!!!!!
 			double telPos[3];
+
+			// only the batched clusters know the CoG algorithms and the eta
+			// correction, all the others keep their own position
+			if( !hasBatchPos[iCluster] && !_warnedUnbatchedPosition && ( _etaSwitch || _cogAlgorithm != "Full" ) )
+			{
+				streamlog_out( WARNING2 ) << "CoGAlgorithm " << _cogAlgorithm << ( _etaSwitch ? " and EtaSwitch are" : " is" )
+				                          << " only applied to generic sparse clusters of generic sparse pixels. Clusters of type "
+				                          << clusterType << " with pixel type " << pixelType << " use their full center of gravity" << std::endl;
+				_warnedUnbatchedPosition = true;
+			}
 			
-			if(clusterType == kEUTelGenericSparseClusterImpl)
+			if( hasBatchPos[iCluster] )
+			{
+				telPos[0] = batchXPos[iCluster];
+				telPos[1] = batchYPos[iCluster];
+				telPos[2] = 0;
+			}
+
+			else if(clusterType == kEUTelGenericSparseClusterImpl)
 			{
 				float xPos = 0;
 				float yPos = 0;
@@ -465,7 +539,7 @@ void EUTelProcessorHitMaker::processEvent (LCEvent * event) {
 #endif
 
 			// create the new hit
-			TrackerHitImpl* hit = new TrackerHitImpl;
+			TrackerHitImpl* hit = EUTelLCObjectPool<TrackerHitImpl>::create();
 
 			hit->setPosition( &telPos[0] );
 			float cov[TRKHITNCOVMATRIX] = {0.,0.,0.,0.,0.,0.};
@@ -484,6 +558,9 @@ void EUTelProcessorHitMaker::processEvent (LCEvent * event) {
 			// add the clusterVec to the hit
 			hit->rawHits() = clusterVec;
 
+			// flag the hits with hot pixels once, the alignment processors only test the quality
+			if( !_hotPixelMap.empty() ) hit->setQuality( _hotPixelMap.hitQuality( hit ) );
+
 			// Determine sensorID from the cluster data.
 			idHitEncoder["sensorID"] =  sensorID ;
 
@@ -510,6 +587,141 @@ void EUTelProcessorHitMaker::processEvent (LCEvent * event) {
     if ( isFirstEvent() ) _isFirstEvent = false;
 }
 
+void EUTelProcessorHitMaker::loadHotPixelMap( LCEvent * event ) {
+	_hotPixelMapLoaded = true;
+	_hotPixelMap.clear();
+	if( _hotPixelCollectionName.empty() ) return;
+
+	try {
+		_hotPixelMap.addCollection( event->getCollection( _hotPixelCollectionName ) );
+	} catch ( DataNotAvailableException& e ) {
+		streamlog_out ( WARNING2 ) << "Hot pixel collection " << _hotPixelCollectionName << " not found, the hits are not flagged" << endl;
+		return;
+	}
+	streamlog_out ( MESSAGE4 ) << _hotPixelMap.size() << " hot pixels loaded from " << _hotPixelCollectionName << endl;
+}
+
+void EUTelProcessorHitMaker::loadEtaTables( LCEvent * event ) {
+	_etaTablesLoaded = true;
+
+	for( size_t axis = 0; axis < 2; ++axis ) {
+		std::map< int, EUTelEtaLookupTable >& tables = ( axis == 0 ) ? _xEtaTables : _yEtaTables;
+		tables.clear();
+
+		LCCollection * etaCollection = 0;
+		try {
+			etaCollection = event->getCollection( _etaCollectionNames[axis] );
+		} catch ( DataNotAvailableException& e ) {
+			streamlog_out ( ERROR4 ) << "Eta collection " << _etaCollectionNames[axis] << " not found, eta correction switched off" << endl;
+			_etaSwitch = false;
+			return;
+		}
+
+		for( int i = 0; i < etaCollection->getNumberOfElements(); ++i ) {
+			// the collection may have been read back from a condition
+			// file, so use only the LCGenericObject interface here.
+			LCGenericObject * etaFunction = dynamic_cast< LCGenericObject* >( etaCollection->getElementAt( i ) );
+			if( etaFunction == 0 || etaFunction->getNInt() < 1 ) continue;
+
+			const int sensorID = etaFunction->getIntVal( 0 );
+			const int nBin = etaFunction->getNDouble() / 2;
+			std::vector< double > centers( nBin ), values( nBin );
+			for( int iBin = 0; iBin < nBin; ++iBin ) {
+				centers[iBin] = etaFunction->getDoubleVal( iBin );
+				values[iBin]  = etaFunction->getDoubleVal( iBin + nBin );
+			}
+			tables[sensorID].build( centers, values, _etaLookupSamples );
+			streamlog_out ( DEBUG5 ) << "Eta lookup table " << _etaCollectionNames[axis] << " for sensor " << sensorID
+			                         << " built from " << nBin << " bins" << endl;
+		}
+	}
+}
+
+void EUTelProcessorHitMaker::reconstructBatchPositions( LCCollectionVec * pulseCollection, std::vector< double >& xPos,
+                                                        std::vector< double >& yPos, std::vector< char >& hasPos ) {
+	const int nClusters = pulseCollection->getNumberOfElements();
+	xPos.assign( nClusters, 0. );
+	yPos.assign( nClusters, 0. );
+	hasPos.assign( nClusters, 0 );
+
+	for( std::map< int, EUTelClusterBatch >::iterator it = _clusterBatches.begin(); it != _clusterBatches.end(); ++it ) {
+		it->second.clear();
+		_clusterBatchIndices[ it->first ].clear();
+	}
+
+	CellIDDecoder<TrackerPulseImpl> clusterCellDecoder(pulseCollection);
+	CellIDDecoder<TrackerDataImpl> cellDecoder(EUTELESCOPE::ZSDATADEFAULTENCODING);
+	const unsigned int stride = EUTelGenericSparsePixel().getNoOfElements();
+
+	// gather the pixels straight from the charge vectors, without going
+	// through the virtual cluster interface
+	for( int iCluster = 0; iCluster < nClusters; ++iCluster ) {
+		TrackerPulseImpl* pulse = static_cast<TrackerPulseImpl*>( pulseCollection->getElementAt( iCluster ) );
+		TrackerDataImpl* trackerData = static_cast<TrackerDataImpl*>( pulse->getTrackerData() );
+
+		ClusterType clusterType = static_cast<ClusterType>( static_cast<int>(clusterCellDecoder(pulse)["type"]) );
+		if( clusterType != kEUTelGenericSparseClusterImpl ) continue;
+		SparsePixelType pixelType = static_cast<SparsePixelType>( static_cast<int>(cellDecoder(trackerData)["sparsePixelType"]) );
+		if( pixelType != kEUTelGenericSparsePixel ) continue;
+
+		const int sensorID = clusterCellDecoder(pulse)["sensorID"];
+		EUTelClusterBatch& batch = _clusterBatches[ sensorID ];
+		_clusterBatchIndices[ sensorID ].push_back( iCluster );
+
+		const FloatVec& charges = trackerData->getChargeValues();
+		batch.beginCluster();
+		for( size_t i = 0; i + stride <= charges.size(); i += stride ) {
+			batch.addPixel( charges[i], charges[i + 1], charges[i + 2] );
+		}
+	}
+
+	std::vector< float > xSeed, ySeed, xCoG, yCoG, work;
+	for( std::map< int, EUTelClusterBatch >::iterator it = _clusterBatches.begin(); it != _clusterBatches.end(); ++it ) {
+		const int sensorID = it->first;
+		const EUTelClusterBatch& batch = it->second;
+		const size_t n = batch.size();
+		if( n == 0 ) continue;
+
+		xSeed.resize( n );
+		ySeed.resize( n );
+		xCoG.resize( n );
+		yCoG.resize( n );
+		work.resize( n );
+
+		ClusterPosition::seed( batch, &xSeed[0], &ySeed[0] );
+		if( _cogAlgorithm == "NxMPixel" ) {
+			ClusterPosition::centerOfGravityNxM( batch, _xyCluSize[0], _xyCluSize[1], &xSeed[0], &ySeed[0], &xCoG[0], &yCoG[0] );
+		} else if( _cogAlgorithm == "NPixel" ) {
+			ClusterPosition::centerOfGravityNPixel( batch, _nPixel, &xCoG[0], &yCoG[0] );
+		} else {
+			ClusterPosition::centerOfGravity( batch, &xCoG[0], &yCoG[0] );
+		}
+
+		if( _etaSwitch ) {
+			std::map< int, EUTelEtaLookupTable >::const_iterator xEta = _xEtaTables.find( sensorID );
+			std::map< int, EUTelEtaLookupTable >::const_iterator yEta = _yEtaTables.find( sensorID );
+			if( xEta != _xEtaTables.end() && xEta->second.isValid() ) {
+				ClusterPosition::applyEta( xEta->second, &xSeed[0], &xCoG[0], &xCoG[0], &work[0], n );
+			}
+			if( yEta != _yEtaTables.end() && yEta->second.isValid() ) {
+				ClusterPosition::applyEta( yEta->second, &ySeed[0], &yCoG[0], &yCoG[0], &work[0], n );
+			}
+		}
+
+		// from pixel index space to mm with the origin at the sensor centre
+		const double xPitch = geo::gGeometry().siPlaneXPitch( sensorID );
+		const double yPitch = geo::gGeometry().siPlaneYPitch( sensorID );
+		const double xSize  = geo::gGeometry().siPlaneXSize( sensorID );
+		const double ySize  = geo::gGeometry().siPlaneYSize( sensorID );
+		const std::vector< int >& indices = _clusterBatchIndices[ sensorID ];
+		for( size_t i = 0; i < n; ++i ) {
+			xPos[ indices[i] ] = ( xCoG[i] + 0.5 ) * xPitch - xSize/2.;
+			yPos[ indices[i] ] = ( yCoG[i] + 0.5 ) * yPitch - ySize/2.;
+			hasPos[ indices[i] ] = 1;
+		}
+	}
+}
+
 void EUTelProcessorHitMaker::end() 
 {
   streamlog_out ( MESSAGE4 )  << "Successfully finished" << endl;
@@ -44,6 +44,7 @@
 #include <Exceptions.h>
 
 // system includes <>
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <cmath>
@@ -65,11 +66,16 @@ EUTelProcessorNoisyPixelFinder::EUTelProcessorNoisyPixelFinder():
   _excludedPlanes(),
   _noOfEvents(0),
   _maxAllowedFiringFreq(0.0),
+  _narrowCounters(false),
   _iRun(0),
   _iEvt(0),
   _sensorIDVec(),
   _noisyPixelDBFile(""),
-  _finished(false)
+  _finished(false),
+  _updateFrequency(0),
+  _runningMaskCollectionName(""),
+  _runningNoisyPixelMap(),
+  _runningMaskEvents(0)
 {
   //processor description
   _description = "EUTelProcessorNoisyPixelFinder computes the firing frequency of pixels and applies a cut on this value to mask (NOT remove) noisy pixels.";
@@ -90,9 +96,17 @@ EUTelProcessorNoisyPixelFinder::EUTelProcessorNoisyPixelFinder():
 
   registerOptionalParameter("HotPixelCollectionName", "This is the name of the hot pixel collection to be saved into the output slcio file",
                              _noisyPixelCollectionName, std::string("noisyPixel"));
+
+  registerOptionalParameter("UpdateFrequency", "Evaluate the firing frequencies every this number of events while collecting NoOfEvents, 0 to disable",
+                             _updateFrequency, static_cast<int>(0) );
+
+  registerOptionalParameter("RunningMaskCollectionName", "If not empty, the noisy pixels of the last evaluation (the final one once NoOfEvents are collected)\n"
+                             "are added to every event as a transient collection of this name", _runningMaskCollectionName, std::string(""));
 }
 
 void EUTelProcessorNoisyPixelFinder::initializeHitMaps() {
+	//up to _noOfEvents+1 events are counted, see processEvent()
+	_narrowCounters = _noOfEvents < EUTelOccupancyCounter16::MAXCOUNT;
 	//it stored detectoID and itt stores the vector for the y-entries
 	for(auto sensorID: _sensorIDVec) {
 		try {
@@ -113,22 +127,16 @@ void EUTelProcessorNoisyPixelFinder::initializeHitMaps() {
 			thisSensor.offY = minY;
 			thisSensor.sizeY = maxY - minY+1;
 
-			//this is the 2-dimensional array used to store all the pixels, it is implemented as a vector of vectors
-			//first the x-entries-vector
-			std::vector<std::vector<int>> hitVecP = std::vector<std::vector<int>>( thisSensor.sizeX );
-
-			//and the y-entries vector
-			for(auto& i: hitVecP) {
-				//resize it now
-				i.resize(thisSensor.sizeY, 0);
-			}
-
 			//collection to later hold the hot pixels
 			std::vector<EUTelGenericSparsePixel> noisyPixelMap;
 
 			//store all the collections/pointers in the corresponding maps
 		    	_sensorMap[sensorID] = thisSensor;
-			_hitVecMap[sensorID] = hitVecP;
+			if( _narrowCounters ) {
+				_hitVecMap16[sensorID].resize(thisSensor.offX, thisSensor.sizeX, thisSensor.offY, thisSensor.sizeY);
+			} else {
+				_hitVecMap[sensorID].resize(thisSensor.offX, thisSensor.sizeX, thisSensor.offY, thisSensor.sizeY);
+			}
 			_noisyPixelMap[sensorID] = noisyPixelMap;
 		} catch(std::runtime_error& e) {
 			streamlog_out ( ERROR0 ) << "Noisy pixel masker could not retrieve plane " << sensorID << std::endl;
@@ -174,9 +182,6 @@ void EUTelProcessorNoisyPixelFinder::noisyPixelFinder(EUTelEventImpl* evt) {
 			TrackerDataImpl* zsData = dynamic_cast<TrackerDataImpl*>( zsInputCollectionVec->getElementAt(iDetector) );
 			int sensorID            = static_cast<int>( cellDecoder(zsData)["sensorID"] );
 
-			sensor* currentSensor = &_sensorMap[sensorID];
-			std::vector<std::vector<int>>* hitArray = &_hitVecMap[sensorID];
-
 			//if this is an excluded sensor go to the next element
 			bool foundexcludedsensor = false;
 			for(auto i : _excludedPlanes) {
@@ -191,20 +196,18 @@ void EUTelProcessorNoisyPixelFinder::noisyPixelFinder(EUTelEventImpl* evt) {
 			int pixelType = cellDecoder(zsData)["sparsePixelType"];
 			auto sparseData = Utility::getSparseData(zsData, pixelType);
 
+			EUTelOccupancyCounter16* narrowCounter = _narrowCounters ? &_hitVecMap16[sensorID] : nullptr;
+			EUTelOccupancyCounter* wideCounter = _narrowCounters ? nullptr : &_hitVecMap[sensorID];
+
 			// loop over all pixels in the sparseData object, these are the hit pixels!
 			for ( size_t iPixel = 0; iPixel < sparseData->size(); iPixel++ ) {
 				//get the pixel
 				pixel = sparseData->getSparsePixelAt( iPixel, pixel );
 
-				//compute the address in the array-like-structure, any offset
-				//has to be substracted (array index starts at 0)
-				int indexX = pixel->getXCoord() - currentSensor->offX;
-				int indexY = pixel->getYCoord() - currentSensor->offY;
-
-				try {
-					//increment the hit counter for this pixel
-					(hitArray->at(indexX)).at(indexY)++;
-				} catch(std::out_of_range& e) {
+				//increment the hit counter for this pixel
+				const bool inRange = narrowCounter ? narrowCounter->fill( pixel->getXCoord(), pixel->getYCoord() )
+				                                   : wideCounter->fill( pixel->getXCoord(), pixel->getYCoord() );
+				if( !inRange ) {
 					streamlog_out ( ERROR5 )  << "Pixel: " << pixel->getXCoord() << "|" <<  pixel->getYCoord() << " on plane: " << sensorID << " fired." << std::endl 
 						<< "This pixel is out of the range defined by the geometry. Either your data is corrupted or your pixel geometry not specified correctly!" << std::endl;
 				}
@@ -218,14 +221,15 @@ void EUTelProcessorNoisyPixelFinder::noisyPixelFinder(EUTelEventImpl* evt) {
 }
 
 void EUTelProcessorNoisyPixelFinder::processEvent (LCEvent * event) {
-	//if we are over the number of events we need we just skip
-	if(_noOfEvents < _iEvt) {
-		++_iEvt;
+	if( event == nullptr ) {
+		streamlog_out ( WARNING2 ) <<  "event does not exist!. skip " <<  std::endl;       
 		return;
 	}
 
-	if( event == nullptr ) {
-		streamlog_out ( WARNING2 ) <<  "event does not exist!. skip " <<  std::endl;       
+	//if we are over the number of events we need we just skip, the final map is still published
+	if(_noOfEvents < _iEvt) {
+		++_iEvt;
+		addRunningMask( event );
 		return;
 	}
 
@@ -252,6 +256,97 @@ void EUTelProcessorNoisyPixelFinder::processEvent (LCEvent * event) {
 
 	//don't forget to increment the event counter
 	++_iEvt;
+
+	//intermediate evaluation, the final one is done in check()
+	if( _updateFrequency > 0 && _iEvt % _updateFrequency == 0 && _iEvt < _noOfEvents ) {
+		_runningNoisyPixelMap.clear();
+		findNoisyPixels( _iEvt, _runningNoisyPixelMap, false );
+		_runningMaskEvents = _iEvt;
+		for(auto& mapEntry: _runningNoisyPixelMap) {
+			streamlog_out ( MESSAGE4 ) << "After " << _iEvt << " events " << mapEntry.second.size() << " noisy pixels on sensor " << mapEntry.first << std::endl;
+		}
+	}
+
+	addRunningMask( event );
+}
+
+void EUTelProcessorNoisyPixelFinder::addRunningMask(LCEvent* event) {
+	if( _runningMaskCollectionName.empty() ) {
+		return;
+	}
+	//once check() has done the final evaluation, the final map replaces the intermediate one
+	LCCollectionVec* runningMaskCollection = new LCCollectionVec( lcio::LCIO::TRACKERDATA );
+	runningMaskCollection->setTransient( true );
+	runningMaskCollection->parameters().setValue( "EvaluatedEvents", _finished ? _noOfEvents : _runningMaskEvents );
+	fillNoisyPixelCollection( runningMaskCollection, _finished ? _noisyPixelMap : _runningNoisyPixelMap );
+	event->addCollection( runningMaskCollection, _runningMaskCollectionName );
+}
+
+void EUTelProcessorNoisyPixelFinder::findNoisyPixels(int nEvents, std::map<int, std::vector<EUTelGenericSparsePixel>>& noisyPixelMap, bool verbose) {
+	//iterate over all the sensors in our sensorMap
+	for(auto& thisSensor: _sensorMap) {
+		auto sensorID = thisSensor.first;
+		if( verbose ) {
+			streamlog_out ( MESSAGE3 ) << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~" << std::endl;
+			streamlog_out ( MESSAGE3 ) << "Noisy pixels found on plane " << sensorID << " (max. fire freq set to: " << _maxAllowedFiringFreq << ")" << std::endl;
+			streamlog_out ( MESSAGE3 ) << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~" << std::endl;
+		}
+
+		//get the correpsonding hit counter
+		if( _narrowCounters ) {
+			findNoisyPixels( _hitVecMap16[sensorID], nEvents, noisyPixelMap[sensorID], verbose );
+		} else {
+			findNoisyPixels( _hitVecMap[sensorID], nEvents, noisyPixelMap[sensorID], verbose );
+		}
+	}
+}
+
+template <typename Counter>
+void EUTelProcessorNoisyPixelFinder::findNoisyPixels(const Counter& hitCounter, int nEvents, std::vector<EUTelGenericSparsePixel>& noisyPixels, bool verbose) {
+	//pixels with count/nEvents > _maxAllowedFiringFreq, the candidates are found on the integer
+	//counts and the cut is then applied exactly as on the firing frequency
+	typedef typename Counter::CountType CountType;
+	const double threshold = std::min( std::floor( _maxAllowedFiringFreq * nEvents ), static_cast<double>(Counter::MAXCOUNT) );
+	const CountType candidateThreshold = threshold >= 1. ? static_cast<CountType>(threshold) - 1 : 0;
+	std::vector<std::pair<int,int>> candidates;
+	hitCounter.findAbove( candidateThreshold, candidates );
+	for(auto& candidate: candidates) {
+		//compute the firing frequency
+		float fireFreq = (float)hitCounter.getCount( candidate.first, candidate.second )/(float)nEvents;
+		//if it is larger than the allowed one, we write this pixel into a collection
+		if(fireFreq > _maxAllowedFiringFreq) {
+			if( verbose ) {
+				streamlog_out ( MESSAGE3 ) << "Pixel: " << candidate.first << "|" << candidate.second << " fired " << fireFreq << std::endl;
+			}
+			EUTelGenericSparsePixel pixel;
+			pixel.setXCoord( candidate.first );
+			pixel.setYCoord( candidate.second );
+			pixel.setSignal( fireFreq );
+			noisyPixels.push_back(pixel);
+		}
+	}
+}
+
+void EUTelProcessorNoisyPixelFinder::fillNoisyPixelCollection(LCCollectionVec* collection, std::map<int, std::vector<EUTelGenericSparsePixel>>& noisyPixelMap) {
+	//noisyPixelMap holds the sensor id (first) and a vector of noisy pixels (second)
+	for(auto& mapEntry: noisyPixelMap) {
+		CellIDEncoder< TrackerDataImpl > noisyPixelEncoder  ( EUTELESCOPE::ZSDATADEFAULTENCODING, collection  );
+		noisyPixelEncoder["sensorID"]        = mapEntry.first;
+		noisyPixelEncoder["sparsePixelType"] = kEUTelGenericSparsePixel;
+
+		// prepare a new TrackerData for the hot Pixel data
+		std::unique_ptr<lcio::TrackerDataImpl> currentFrame( new lcio::TrackerDataImpl );
+		noisyPixelEncoder.setCellID( currentFrame.get() );
+
+		// this is the structure that will host the sparse pixel  
+		std::unique_ptr<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>
+			sparseFrame( new EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>(currentFrame.get()) );
+
+		for( auto& pixel: mapEntry.second) {
+			sparseFrame->addSparsePixel( &pixel );                
+		}
+		collection->push_back( currentFrame.release() );
+	}
 }
 
 void EUTelProcessorNoisyPixelFinder::end() {
@@ -272,40 +367,7 @@ void EUTelProcessorNoisyPixelFinder::check(LCEvent* /*event*/ ) {
 	if( _iEvt == _noOfEvents) {
 		streamlog_out ( MESSAGE4 ) << "Finished determining hot pixels, writing them out..." << std::endl;
 
-		//iterate over all the sensors in our sensorMap
-		for(auto& thisSensor: _sensorMap)
-		{
-			auto sensorID = thisSensor.first;
-			streamlog_out ( MESSAGE3 ) << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~" << std::endl;
-			streamlog_out ( MESSAGE3 ) << "Noisy pixels found on plane " << sensorID << " (max. fire freq set to: " << _maxAllowedFiringFreq << ")" << std::endl;
-			streamlog_out ( MESSAGE3 ) << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~" << std::endl;
-
-			//get the correpsonding hit array-like vector of vectors
-			std::vector<std::vector<int>>* hitVector =  &_hitVecMap[sensorID];
-			//and the sensor which stores offsets
-			sensor* currentSensor = &_sensorMap[sensorID];
-
-			//loop over all pixels
-			for (std::vector<std::vector<int> >::iterator xIt = hitVector->begin(); xIt != hitVector->end(); ++xIt)
-			{
-				for(std::vector<int>::iterator yIt = xIt->begin(); yIt != xIt->end(); ++yIt)
-				{
-					//compute the firing frequency
-					float fireFreq = (float)*yIt/(float)_iEvt;
-					//if it is larger than the allowed one, we write this pixel into a collection
-					if(fireFreq > _maxAllowedFiringFreq) {
-						streamlog_out ( MESSAGE3 )	<< "Pixel: " << xIt-hitVector->begin() + currentSensor->offX << "|" 
-										<< yIt - xIt->begin() + currentSensor->offY  << " fired " << fireFreq << std::endl;
-						EUTelGenericSparsePixel pixel;
-						pixel.setXCoord(xIt-hitVector->begin() + currentSensor->offX);
-						pixel.setYCoord(yIt - xIt->begin() + currentSensor->offY );
-						pixel.setSignal( fireFreq );
-						//writing out is done here
-						_noisyPixelMap[sensorID].push_back(pixel);
-					}
-				}
-			}
-		}
+		findNoisyPixels( _iEvt, _noisyPixelMap, true );
 
 		//write out the databases and histograms
 		noisyPixelDBWriter();
@@ -360,26 +422,10 @@ void EUTelProcessorNoisyPixelFinder::noisyPixelDBWriter() {
 		std::cout << "noisyPixelCollection: " << _noisyPixelCollectionName << " created" <<  std::endl; 
 	}
 
+	fillNoisyPixelCollection( noisyPixelCollection, _noisyPixelMap );
+
 	streamlog_out( MESSAGE5 ) << "Noisy Pixel Finder summary:" << std::endl;
-	//_noisyPixelMap holds the sensor if (first) and a vector of noisy pixels (second)
 	for(auto& mapEntry: _noisyPixelMap) {
-		CellIDEncoder< TrackerDataImpl > noisyPixelEncoder  ( EUTELESCOPE::ZSDATADEFAULTENCODING, noisyPixelCollection  );
-		noisyPixelEncoder["sensorID"]        = mapEntry.first;
-		noisyPixelEncoder["sparsePixelType"] = kEUTelGenericSparsePixel;
-
-		// prepare a new TrackerData for the hot Pixel data
-		std::unique_ptr<lcio::TrackerDataImpl> currentFrame( new lcio::TrackerDataImpl );
-		noisyPixelEncoder.setCellID( currentFrame.get() );
-
-		// this is the structure that will host the sparse pixel  
-		std::unique_ptr<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>
-			sparseFrame( new EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>(currentFrame.get()) );
-
-		for( auto& pixel: mapEntry.second) {
-			sparseFrame->addSparsePixel( &pixel );                
-		}
-		noisyPixelCollection->push_back( currentFrame.release() );
-
 		streamlog_out( MESSAGE5 ) << "Found " << mapEntry.second.size() << " noisy pixels on sensor: " << mapEntry.first << std::endl;
 	}
 	lcWriter->writeEvent( event.get() );
@@ -15,6 +15,7 @@
 #include "EUTelProcessorNoisyPixelRemover.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
 #include "EUTelUtility.h"
+#include "EUTelLCObjectPool.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -42,13 +43,17 @@ EUTelProcessorNoisyPixelRemover::EUTelProcessorNoisyPixelRemover():
   Processor("EUTelProcessorNoisyPixelRemover"),
   _inputCollectionName(""),
   _outputCollectionName(""),
-  _noisyPixelCollectionName("")
+  _noisyPixelCollectionName(""),
+  _runningMaskCollectionName(""),
+  _runningMaskEvents(-1)
 {
   _description ="EUTelProcessorNoisyPixelRemover removes noisy pixels (TrackerData) from a collection. This processor requires a noisy pixel collection.";
 
   registerInputCollection(LCIO::TRACKERDATA, "InputCollectionName", "Input collection containing noisy raw data", _inputCollectionName, std::string ("noisy_raw_data_collection"));
   registerOutputCollection(LCIO::TRACKERDATA, "OutputCollectionName", "Output collection where noisy pixels have been removed", _outputCollectionName, std::string("noisefree_raw_data_collection"));
   registerProcessorParameter("NoisyPixelCollectionName", "Name of the noisy pixel collection.",  _noisyPixelCollectionName, std::string("noisypixel"));
+  registerOptionalParameter("RunningMaskCollectionName", "If not empty, the running mask published by EUTelProcessorNoisyPixelFinder under this name\n"
+                             "replaces the noisy pixel collection in every event which contains it", _runningMaskCollectionName, std::string(""));
 }
 
 void EUTelProcessorNoisyPixelRemover::init() {
@@ -71,6 +76,20 @@ void EUTelProcessorNoisyPixelRemover::processEvent(LCEvent* event) {
 		_firstEvent = false;
 	}
 
+	//the running mask of a noisy pixel finder earlier in the same job, only re-read when it was re-evaluated
+	if( !_runningMaskCollectionName.empty() ) {
+		try {
+			LCCollection* runningMask = event->getCollection(_runningMaskCollectionName);
+			int evaluatedEvents = runningMask->getParameters().getIntVal("EvaluatedEvents");
+			if( evaluatedEvents != _runningMaskEvents ) {
+				_noisyPixelMap = Utility::readNoisyPixelList(event, _runningMaskCollectionName);
+				_runningMaskEvents = evaluatedEvents;
+			}
+		} catch( lcio::DataNotAvailableException& e ) {
+			//keep the last mask
+		}
+	}
+
  	// get the collection of interest from the event.
 	LCCollectionVec* inputCollection = nullptr;
 
@@ -90,7 +109,7 @@ void EUTelProcessorNoisyPixelRemover::processEvent(LCEvent* event) {
     		outputCollectionExists = true;
     		initialOutputCollectionSize = outputCollection->size();
   	} catch ( lcio::DataNotAvailableException& e ) {
-    		outputCollection = new LCCollectionVec(LCIO::TRACKERDATA);
+    		outputCollection = new EUTelPooledCollectionVec<TrackerDataImpl>(LCIO::TRACKERDATA);
   	}
 	
 	// prepare decoder for input data
@@ -100,13 +119,13 @@ void EUTelProcessorNoisyPixelRemover::processEvent(LCEvent* event) {
 	std::string encodingString = inputCollection->getParameters().getStringVal( LCIO::CellIDEncoding );	
 	outputCollection->parameters().setValue(LCIO::CellIDEncoding, encodingString);
 	
-	auto trackerData = std::make_unique<lcio::TrackerDataImpl>();
+	std::unique_ptr<lcio::TrackerDataImpl> trackerData( EUTelLCObjectPool<lcio::TrackerDataImpl>::create() );
 	
 	for ( size_t iEntry = 0; iEntry < inputCollection->size(); ++iEntry ){
 
 		if(iEntry > 0) {
 				outputCollection->push_back( trackerData.release() );
-				auto newTrackerData = std::make_unique<lcio::TrackerDataImpl>();
+				std::unique_ptr<lcio::TrackerDataImpl> newTrackerData( EUTelLCObjectPool<lcio::TrackerDataImpl>::create() );
 				trackerData = std::move( newTrackerData );	
 		}
 
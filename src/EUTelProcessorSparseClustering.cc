@@ -22,6 +22,7 @@
 //eutel data specific
 #include "EUTelTrackerDataInterfacerImpl.h"
 #include "EUTelSparseClusterImpl.h"
+#include "EUTelLCObjectPool.h"
 
 //eutel geometry
 #include "EUTelGeometryTelescopeGeoDescription.h"
@@ -245,7 +246,7 @@ void EUTelProcessorSparseClustering::processEvent (LCEvent * event)
 	} 
 	catch ( lcio::DataNotAvailableException& e ) 
 	{
-		pulseCollection = new LCCollectionVec(LCIO::TRACKERPULSE);
+		pulseCollection = new EUTelPooledCollectionVec<TrackerPulseImpl>(LCIO::TRACKERPULSE);
 	}
 
 	//HERE WE ACTUALLY CALL THE CLUSTERING ROUTINE:
@@ -288,7 +289,7 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 	}
 	catch (lcio::DataNotAvailableException& e)
 	{
-		sparseClusterCollectionVec = new LCCollectionVec(LCIO::TRACKERDATA);
+		sparseClusterCollectionVec = new EUTelPooledCollectionVec<TrackerDataImpl>(LCIO::TRACKERDATA);
 		isDummyAlreadyExisting = false;
 	}
 
@@ -348,7 +349,7 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 			while( !hitPixelVec.empty() )
 			{
                            	// prepare a TrackerData to store the cluster candidate
-				std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
+				std::unique_ptr<TrackerDataImpl> zsCluster( EUTelLCObjectPool<TrackerDataImpl>::create() );
 				// prepare a reimplementation of sparsified cluster
 				std::unique_ptr<EUTelSparseClusterImpl<EUTelGenericSparsePixel>> sparseCluster = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(zsCluster.get());
 
@@ -413,7 +414,7 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 					sparseClusterCollectionVec->push_back( zsCluster.get() );
 
 					// prepare a pulse for this cluster
-					std::unique_ptr<TrackerPulseImpl> zsPulse = std::make_unique<TrackerPulseImpl>();
+					std::unique_ptr<TrackerPulseImpl> zsPulse( EUTelLCObjectPool<TrackerPulseImpl>::create() );
 					idZSPulseEncoder["sensorID"] = sensorID;
 					idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
 					idZSPulseEncoder.setCellID( zsPulse.get() );
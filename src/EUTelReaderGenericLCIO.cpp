@@ -1,63 +1,155 @@
 #include "EUTelReaderGenericLCIO.h"
+
+// system includes <>
+#include <cstdint>
+
 using namespace eutelescope;
 
 EUTelReaderGenericLCIO::EUTelReaderGenericLCIO(){
 } 
-void EUTelReaderGenericLCIO::getColVec(std::vector<EUTelTrack> tracks,LCEvent* evt ,std::string colName ){
-    streamlog_out(DEBUG1)<<"CREATE GENERIC CONTAINER..." <<std::endl;
-
-    LCCollectionVec* colTrackVec = new LCCollectionVec(LCIO::LCGENERICOBJECT);
-    LCCollectionVec* colStateVec = new LCCollectionVec(LCIO::LCGENERICOBJECT);
-    LCCollectionVec* colHitVec = new LCCollectionVec(LCIO::LCGENERICOBJECT);
-    LCCollectionVec* relTrackStateVec = new LCCollectionVec(LCIO::LCRELATION);
-    LCCollectionVec* relStateHitVec = new LCCollectionVec(LCIO::LCRELATION);
-
+void EUTelReaderGenericLCIO::getColVec(std::vector<EUTelTrack>& tracks,LCEvent* evt ,std::string colName ){
+    streamlog_out(DEBUG1)<<"CREATE PACKED GENERIC CONTAINER..." <<std::endl;
 
+    //Serialise everything once. The strides are fixed by the classes, so we take them from the first object.
+    std::vector<double> trackValues;
+    std::vector<double> stateValues;
+    std::vector<double> hitValues;
+    std::vector<int> stateOffsets;
+    std::vector<int> hitIndices;
+    int trackStride = 0;
+    int stateStride = 0;
+    int hitStride = 0;
+    stateOffsets.reserve(tracks.size()+1);
     for(size_t i=0 ; i < tracks.size(); i++){
-        IMPL::LCGenericObjectImpl* conTrack = new  IMPL::LCGenericObjectImpl();  
-        //Save everything as double and down cast later.
-        for(size_t j=0; j < tracks.at(i).getLCIOOutput().size(); j++){
-            streamlog_out(DEBUG1)<<"Fill number: " << j << " Value " << tracks.at(i).getLCIOOutput().at(j) <<std::endl;
-            conTrack->setDoubleVal (j, tracks.at(i).getLCIOOutput().at(j));
-        }
-        streamlog_out(DEBUG1)<<"Fill all track information...        Double number: "<< conTrack->getNDouble()  <<std::endl;
-        colTrackVec->push_back(static_cast<EVENT::LCGenericObject*>(conTrack));
-        streamlog_out(DEBUG1)<<"Tracks filled" <<std::endl;
-        std::vector<EUTelState> states = tracks.at(i).getStates();
+        std::vector<double> trackOut = tracks.at(i).getLCIOOutput();
+        trackStride = trackOut.size();
+        trackValues.insert(trackValues.end(), trackOut.begin(), trackOut.end());
+        stateOffsets.push_back(hitIndices.size());
+        std::vector<EUTelState>& states = tracks.at(i).getStates();
         for(size_t j=0 ; j < states.size(); j++){
-            streamlog_out(DEBUG1)<<"Fill all state information " << " state location " << states.at(j).getLocation() <<std::endl;
-            IMPL::LCGenericObjectImpl* conState = new  IMPL::LCGenericObjectImpl();  
-            streamlog_out(DEBUG1)<<"Empty state container created" <<std::endl;
-            for(size_t k=0 ; k < states.at(j).getLCIOOutput().size(); k++){
-                streamlog_out(DEBUG1)<<"Fill number: " << k << " Value " << tracks.at(i).getStates().at(j).getLCIOOutput().at(k) <<std::endl;
-                conState->setDoubleVal (k,states.at(j).getLCIOOutput().at(k));
-            }
-            IMPL::LCRelationImpl *relTrackState = new IMPL::LCRelationImpl(conTrack,conState); 
-            colStateVec->push_back(static_cast<EVENT::LCGenericObject*>(conState));
-            relTrackStateVec->push_back(static_cast<EVENT::LCRelation*>(relTrackState));
+            std::vector<double> stateOut = states.at(j).getLCIOOutput();
+            stateStride = stateOut.size();
+            stateValues.insert(stateValues.end(), stateOut.begin(), stateOut.end());
             if(states.at(j).getStateHasHit()){
-                IMPL::LCGenericObjectImpl* conHit = new  IMPL::LCGenericObjectImpl();  
-                for(size_t k=0 ; k < states.at(j).getHit().getLCIOOutput().size(); k++){
-                    conHit->setDoubleVal (k, states.at(j).getHit().getLCIOOutput().at(k));
-                }
-                IMPL::LCRelationImpl *relStateHit = new IMPL::LCRelationImpl(conState,conHit); 
-                colHitVec->push_back(static_cast<EVENT::LCGenericObject*>(conHit));
-                relStateHitVec->push_back(static_cast<EVENT::LCRelation*>(relStateHit));
-
+                std::vector<double> hitOut = states.at(j).getHit().getLCIOOutput();
+                hitStride = hitOut.size();
+                hitIndices.push_back(hitStride == 0 ? 0 : hitValues.size()/hitStride);
+                hitValues.insert(hitValues.end(), hitOut.begin(), hitOut.end());
+            }else{
+                hitIndices.push_back(-1);
             }
-
         }
     }
-    streamlog_out(DEBUG1)<<"Add collection to event!" <<std::endl;
-    evt->addCollection(colTrackVec,"TrackFOR" + colName   );
-    evt->addCollection(colStateVec,"StatesFOR" + colName);
-    evt->addCollection(colHitVec,"HitsFOR" + colName);
-    evt->addCollection(relTrackStateVec,"TrackStateFOR" + colName);
-    evt->addCollection(relStateHitVec,"StateHitFOR" + colName);
+    stateOffsets.push_back(hitIndices.size());
+    const int nStates = hitIndices.size();
+    const int nHits = hitStride == 0 ? 0 : hitValues.size()/hitStride;
+
+    std::vector<int> header;
+    header.push_back(PACKEDVERSION);
+    header.push_back(tracks.size());
+    header.push_back(nStates);
+    header.push_back(nHits);
+    header.push_back(trackStride);
+    header.push_back(stateStride);
+    header.push_back(hitStride);
 
+    const int nInt = header.size() + stateOffsets.size() + hitIndices.size();
+    const int nDouble = trackValues.size() + stateValues.size() + hitValues.size();
+    IMPL::LCGenericObjectImpl* packed = new IMPL::LCGenericObjectImpl(nInt, 0, nDouble);
+    int iInt = 0;
+    for(size_t i = 0; i < header.size(); ++i) packed->setIntVal(iInt++, header[i]);
+    for(size_t i = 0; i < stateOffsets.size(); ++i) packed->setIntVal(iInt++, stateOffsets[i]);
+    for(size_t i = 0; i < hitIndices.size(); ++i) packed->setIntVal(iInt++, hitIndices[i]);
+    int iDouble = 0;
+    for(size_t i = 0; i < trackValues.size(); ++i) packed->setDoubleVal(iDouble++, trackValues[i]);
+    for(size_t i = 0; i < stateValues.size(); ++i) packed->setDoubleVal(iDouble++, stateValues[i]);
+    for(size_t i = 0; i < hitValues.size(); ++i) packed->setDoubleVal(iDouble++, hitValues[i]);
+
+    LCCollectionVec* colPacked = new LCCollectionVec(LCIO::LCGENERICOBJECT);
+    colPacked->push_back(static_cast<EVENT::LCGenericObject*>(packed));
+    streamlog_out(DEBUG1)<<"Add collection to event! Tracks: " << tracks.size() << " States: " << nStates << " Hits: " << nHits <<std::endl;
+    evt->addCollection(colPacked,"PackedFOR" + colName);
 } 
 
 std::vector<EUTelTrack> EUTelReaderGenericLCIO::getTracks( LCEvent* evt, std::string colName){
+    LCCollection* packed = nullptr;
+    try{
+        packed = evt->getCollection("PackedFOR" + colName);
+    }catch(DataNotAvailableException& e){
+        streamlog_out(DEBUG1)<<"No packed track collection. Read tracks from relations." <<std::endl;
+        return getTracksFromRelations(evt, colName);
+    }
+    return getTracksPacked(packed);
+}
+
+//All values are copied out of the generic object once, then tracks are built in order. Every state and hit is visited exactly once.
+std::vector<EUTelTrack> EUTelReaderGenericLCIO::getTracksPacked( EVENT::LCCollection* col ){
+    std::vector<EUTelTrack> tracks; 
+    if(col->getNumberOfElements() == 0) return tracks;
+    EVENT::LCGenericObject* packed = static_cast<EVENT::LCGenericObject*>(col->getElementAt(0));
+    const int nInt = packed->getNInt();
+    const int nDouble = packed->getNDouble();
+    if(nInt < 7 || packed->getIntVal(0) != PACKEDVERSION){
+        throw(lcio::Exception("Packed track collection has an unknown version."));
+    }
+    std::vector<int> ints(nInt);
+    for(int i = 0; i < nInt; ++i) ints[i] = packed->getIntVal(i);
+    std::vector<double> doubles(nDouble);
+    for(int i = 0; i < nDouble; ++i) doubles[i] = packed->getDoubleVal(i);
+
+    const int nTracks = ints[1];
+    const int nStates = ints[2];
+    const int nHits = ints[3];
+    const int trackStride = ints[4];
+    const int stateStride = ints[5];
+    const int hitStride = ints[6];
+    if(nTracks < 0 || nStates < 0 || nHits < 0 || trackStride < 0 || stateStride < 0 || hitStride < 0
+       || static_cast<int64_t>(nInt) != 7 + static_cast<int64_t>(nTracks) + 1 + nStates
+       || static_cast<int64_t>(nDouble) != static_cast<int64_t>(nTracks)*trackStride + static_cast<int64_t>(nStates)*stateStride + static_cast<int64_t>(nHits)*hitStride){
+        throw(lcio::Exception("Packed track collection is inconsistent with its offset tables."));
+    }
+    const int* stateOffsets = &ints[7];
+    const int* hitIndices = &ints[7 + nTracks + 1];
+    //The tracks must own consecutive state ranges covering all states, and every hit index must point into the hit table.
+    if(stateOffsets[0] != 0 || stateOffsets[nTracks] != nStates){
+        throw(lcio::Exception("Packed track collection has state offsets that do not cover its states."));
+    }
+    for(int i = 0; i < nTracks; ++i){
+        if(stateOffsets[i+1] < stateOffsets[i]){
+            throw(lcio::Exception("Packed track collection has decreasing state offsets."));
+        }
+    }
+    for(int j = 0; j < nStates; ++j){
+        if(hitIndices[j] >= nHits){
+            throw(lcio::Exception("Packed track collection has a hit index beyond its hits."));
+        }
+    }
+    std::vector<double>::const_iterator trackBegin = doubles.begin();
+    std::vector<double>::const_iterator stateBegin = trackBegin + nTracks*trackStride;
+    std::vector<double>::const_iterator hitBegin = stateBegin + nStates*stateStride;
+
+    tracks.resize(nTracks);
+    for(int i = 0; i < nTracks; ++i){
+        EUTelTrack& track = tracks[i];
+        track.setTrackFromLCIOVec(std::vector<double>(trackBegin + i*trackStride, trackBegin + (i+1)*trackStride));
+        std::vector<EUTelState>& states = track.getStates();
+        states.resize(stateOffsets[i+1] - stateOffsets[i]);
+        for(int j = stateOffsets[i]; j < stateOffsets[i+1]; ++j){
+            EUTelState& state = states[j - stateOffsets[i]];
+            state.setTrackFromLCIOVec(std::vector<double>(stateBegin + j*stateStride, stateBegin + (j+1)*stateStride));
+            if(hitIndices[j] >= 0){
+                EUTelHit hit;
+                hit.setTrackFromLCIOVec(std::vector<double>(hitBegin + hitIndices[j]*hitStride, hitBegin + (hitIndices[j]+1)*hitStride));
+                state.setHit(hit);
+            }
+        }
+    }
+    streamlog_out(DEBUG1)<<"Return "<< tracks.size() <<" tracks" <<std::endl;
+    return tracks;
+}
+
+//Older files store each track, state and hit as separate objects linked by relations.
+std::vector<EUTelTrack> EUTelReaderGenericLCIO::getTracksFromRelations( LCEvent* evt, std::string colName){
     std::vector<EUTelTrack> tracks; 
     streamlog_out(DEBUG1)<<"Open Collections... " <<std::endl;
 
@@ -0,0 +1,85 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelReferenceLineMatcher.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace eutelescope;
+
+EUTelReferenceLineMatcher::EUTelReferenceLineMatcher():
+  _positions(),
+  _knownHitPos(0),
+  _minZ(0.),
+  _maxZ(0.),
+  _sorted()
+{}
+
+void EUTelReferenceLineMatcher::setSecondPlaneHits(const std::vector<const double*>& positions, unsigned int knownHitPos) {
+  _positions = positions;
+  _knownHitPos = knownHitPos;
+  _minZ = std::numeric_limits<double>::max();
+  _maxZ = -std::numeric_limits<double>::max();
+  _sorted.clear();
+  for ( unsigned int iHit = 0; iHit < _positions.size(); iHit++ ) {
+    _minZ = std::min( _minZ, _positions[iHit][2] );
+    _maxZ = std::max( _maxZ, _positions[iHit][2] );
+    _sorted.push_back( std::make_pair( _positions[iHit][_knownHitPos], iHit ) );
+  }
+  std::sort( _sorted.begin(), _sorted.end() );
+}
+
+void EUTelReferenceLineMatcher::findPairs(const double* firstPlaneHitPos, const std::vector<const double*>& dutHitPositions,
+                                          double maxResidual, std::vector<std::pair<unsigned int, unsigned int> >& pairs) const {
+  const std::size_t nPairs = pairs.size();
+
+  for ( unsigned int iDutHit = 0; iDutHit < dutHitPositions.size(); iDutHit++ ) {
+    const double* dutHitPos = dutHitPositions[iDutHit];
+
+    std::vector<std::pair<double, unsigned int> >::const_iterator begin = _sorted.begin();
+    std::vector<std::pair<double, unsigned int> >::const_iterator end   = _sorted.end();
+    const double dz1 = dutHitPos[2] - firstPlaneHitPos[2];
+    const double dz2Min = _minZ - firstPlaneHitPos[2];
+    const double dz2Max = _maxZ - firstPlaneHitPos[2];
+    // the window is unbounded if the DUT hit or a second plane hit is at the z of the first plane hit
+    if ( dz1 != 0 && dz2Min * dz2Max > 0 ) {
+      const double sMin = dz2Min / dz1;
+      const double sMax = dz2Max / dz1;
+      const double lowOffset  = dutHitPos[_knownHitPos] - maxResidual - firstPlaneHitPos[_knownHitPos];
+      const double highOffset = dutHitPos[_knownHitPos] + maxResidual - firstPlaneHitPos[_knownHitPos];
+      const double window[4] = { lowOffset * sMin, lowOffset * sMax, highOffset * sMin, highOffset * sMax };
+      const double low  = firstPlaneHitPos[_knownHitPos] + *std::min_element( window, window + 4 );
+      const double high = firstPlaneHitPos[_knownHitPos] + *std::max_element( window, window + 4 );
+      // widen by far more than the rounding, the test decides
+      const double margin = 1e-9 * ( 1. + std::fabs( low ) + std::fabs( high ) );
+      if ( std::isfinite( low ) && std::isfinite( high ) ) {
+        begin = std::lower_bound( _sorted.begin(), _sorted.end(), std::make_pair( low - margin, 0u ) );
+        end   = std::upper_bound( begin, _sorted.end(), std::make_pair( high + margin, std::numeric_limits<unsigned int>::max() ) );
+      }
+    }
+
+    for ( std::vector<std::pair<double, unsigned int> >::const_iterator iter = begin; iter != end; ++iter ) {
+      const double* secondPlaneHitPos = _positions[iter->second];
+
+      // the known coordinate of the line at the z of the DUT hit
+      const double t = ( dutHitPos[2] - firstPlaneHitPos[2] ) / ( secondPlaneHitPos[2] - firstPlaneHitPos[2] );
+      const double knownHitPosOnLine = firstPlaneHitPos[_knownHitPos] + ( secondPlaneHitPos[_knownHitPos] - firstPlaneHitPos[_knownHitPos] ) * t;
+
+      if ( std::fabs( knownHitPosOnLine - dutHitPos[_knownHitPos] ) < maxResidual ) {
+        pairs.push_back( std::make_pair( iter->second, iDutHit ) );
+      }
+    }
+  }
+
+  std::sort( pairs.begin() + nPairs, pairs.end() );
+}
@@ -0,0 +1,102 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelSeedFinder.h"
+#include "EUTELESCOPE.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+namespace {
+  //! Pixels tested together before looking at them one by one
+  const std::size_t SCANBLOCK = 64;
+
+  //! True if any of the SCANBLOCK signals exceeds seedCut times its noise
+  inline bool anyAboveCut(const float* signal, const float* noise, float seedCut) {
+    int any = 0;
+    for ( std::size_t i = 0; i < SCANBLOCK; ++i ) {
+      any |= ( signal[i] > seedCut * noise[i] );
+    }
+    return any;
+  }
+}
+
+EUTelSeedFinder::EUTelSeedFinder():
+  _candidates(),
+  _isHeap(false),
+  _nPixels(0),
+  _clustered(),
+  _dirtyWords()
+{}
+
+void EUTelSeedFinder::findCandidates(const EVENT::FloatVec& signal, const EVENT::FloatVec& noise,
+                                     const EVENT::ShortVec& status, float seedCut) {
+  const std::size_t nPixels = signal.size();
+  resetClustered( nPixels );
+  _candidates.clear();
+  _isHeap = false;
+
+  const float* s = signal.data();
+  const float* n = noise.data();
+  const short* st = status.data();
+  const short good = static_cast<short>( EUTELESCOPE::GOODPIXEL );
+
+  unsigned int block[SCANBLOCK];
+  for ( std::size_t begin = 0; begin < nPixels; begin += SCANBLOCK ) {
+    const std::size_t end = std::min( begin + SCANBLOCK, nPixels );
+
+    // nearly all the blocks of a frame stop at this test; the trip
+    // count of full blocks is fixed so that it is vectorised at -O2 too
+    if ( end - begin == SCANBLOCK && !anyAboveCut( s + begin, n + begin, seedCut ) ) continue;
+
+    // compress the passing indices without branching on the data
+    std::size_t nBlock = 0;
+    for ( std::size_t i = begin; i < end; ++i ) {
+      block[nBlock] = static_cast<unsigned int>( i );
+      nBlock += ( s[i] > seedCut * n[i] ) & ( st[i] == good );
+    }
+    for ( std::size_t i = 0; i < nBlock; ++i ) {
+      _candidates.push_back( std::make_pair( s[ block[i] ], block[i] ) );
+    }
+  }
+}
+
+bool EUTelSeedFinder::nextSeed(unsigned int& index) {
+  if ( _candidates.empty() ) return false;
+  if ( !_isHeap ) {
+    std::make_heap( _candidates.begin(), _candidates.end() );
+    _isHeap = true;
+  }
+  std::pop_heap( _candidates.begin(), _candidates.end() );
+  index = _candidates.back().second;
+  _candidates.pop_back();
+  return true;
+}
+
+void EUTelSeedFinder::markClustered(unsigned int index) {
+  if ( index >= _nPixels ) return;
+  uint64_t& word = _clustered[ index >> 6 ];
+  if ( word == 0 ) _dirtyWords.push_back( index >> 6 );
+  word |= uint64_t(1) << ( index & 63 );
+}
+
+void EUTelSeedFinder::resetClustered(std::size_t nPixels) {
+  if ( nPixels != _nPixels ) {
+    _nPixels = nPixels;
+    _clustered.assign( ( nPixels + 63 ) / 64, 0 );
+  } else {
+    for ( std::vector<std::size_t>::const_iterator iter = _dirtyWords.begin(); iter != _dirtyWords.end(); ++iter ) {
+      _clustered[*iter] = 0;
+    }
+  }
+  _dirtyWords.clear();
+}
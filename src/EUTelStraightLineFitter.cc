@@ -0,0 +1,162 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelStraightLineFitter.h"
+
+// system includes <>
+#include <cmath>
+
+using namespace eutelescope;
+
+namespace {
+  //! Tracks fitted together, the trip count of the vectorised loops
+  const std::size_t FITBLOCK = 8;
+
+  //! Fit one coordinate of N tracks
+  /*! The position and z of track i on plane p are pos[p * stride + i]
+   *  and z[p * stride + i], its residual goes to resid[p * stride + i].
+   *  The types of the sums and the order of the operations are those
+   *  of EUTelMille::FitTrack.
+   */
+  template <std::size_t N>
+  void fitBlock(std::size_t nPlanes, const char* fitted, const double* resolution2, float weightSum,
+                const double* pos, const double* z, std::size_t stride,
+                double* chi2, float* offset, float* slope, double* resid) {
+    float sumZ[N], sumPos[N], sumPosZ[N], sumZZ[N];
+    float meanZ[N], meanPos[N], a[N], zMeanA[N];
+    for ( std::size_t i = 0; i < N; ++i ) {
+      sumZ[i] = 0;
+      sumPos[i] = 0;
+      sumPosZ[i] = 0;
+      sumZZ[i] = 0;
+    }
+
+    for ( std::size_t p = 0; p < nPlanes; ++p ) {
+      if ( !fitted[p] ) continue;
+      const double* zp = z + p * stride;
+      const double* posp = pos + p * stride;
+      for ( std::size_t i = 0; i < N; ++i ) {
+        sumZ[i]   = sumZ[i] + zp[i] / resolution2[p];
+        sumPos[i] = sumPos[i] + posp[i] / resolution2[p];
+      }
+    }
+    for ( std::size_t i = 0; i < N; ++i ) {
+      meanZ[i]   = sumZ[i] / weightSum;
+      meanPos[i] = sumPos[i] / weightSum;
+    }
+
+    for ( std::size_t p = 0; p < nPlanes; ++p ) {
+      if ( !fitted[p] ) continue;
+      const double* zp = z + p * stride;
+      const double* posp = pos + p * stride;
+      for ( std::size_t i = 0; i < N; ++i ) {
+        const float zBar = zp[i] - meanZ[i];
+        const float zBar2 = zBar * zBar;
+        sumPosZ[i] = sumPosZ[i] + zBar * posp[i] / resolution2[p];
+        sumZZ[i]   = sumZZ[i] + zBar2 / resolution2[p];
+      }
+    }
+    for ( std::size_t i = 0; i < N; ++i ) {
+      a[i] = sumPosZ[i] / sumZZ[i];
+      zMeanA[i] = meanZ[i] * a[i];
+      chi2[i] = 0.;
+      offset[i] = meanPos[i] - zMeanA[i];
+      slope[i] = a[i];
+    }
+
+    for ( std::size_t p = 0; p < nPlanes; ++p ) {
+      const double* zp = z + p * stride;
+      const double* posp = pos + p * stride;
+      double* residp = resid + p * stride;
+      for ( std::size_t i = 0; i < N; ++i ) {
+        residp[i] = ( offset[i] + zp[i] * a[i] ) - posp[i];
+      }
+      if ( !fitted[p] ) continue;
+      for ( std::size_t i = 0; i < N; ++i ) {
+        const double d = -zp[i] * a[i] + posp[i] - meanPos[i] + zMeanA[i];
+        chi2[i] += d * d / resolution2[p];
+      }
+    }
+  }
+}
+
+EUTelStraightLineFitter::EUTelStraightLineFitter():
+  _nPlanes(0),
+  _fitted(),
+  _xResolution2(),
+  _yResolution2(),
+  _xWeightSum(0),
+  _yWeightSum(0),
+  _nTracks(0),
+  _chi2X(),
+  _chi2Y(),
+  _offsetX(),
+  _offsetY(),
+  _slopeX(),
+  _slopeY(),
+  _angleX(),
+  _angleY(),
+  _residualX(),
+  _residualY()
+{}
+
+void EUTelStraightLineFitter::setPlanes(std::size_t nPlanes, const double* xResolution, const double* yResolution,
+                                        const std::vector<unsigned int>& excludedPlanes) {
+  _nPlanes = nPlanes;
+  _fitted.assign( nPlanes, 1 );
+  for ( std::vector<unsigned int>::const_iterator iter = excludedPlanes.begin(); iter != excludedPlanes.end(); ++iter ) {
+    if ( *iter < nPlanes ) _fitted[*iter] = 0;
+  }
+
+  _xResolution2.resize( nPlanes );
+  _yResolution2.resize( nPlanes );
+  _xWeightSum = 0;
+  _yWeightSum = 0;
+  for ( std::size_t p = 0; p < nPlanes; ++p ) {
+    _xResolution2[p] = std::pow( xResolution[p], 2 );
+    _yResolution2[p] = std::pow( yResolution[p], 2 );
+    if ( !_fitted[p] ) continue;
+    _xWeightSum = _xWeightSum + 1 / _xResolution2[p];
+    _yWeightSum = _yWeightSum + 1 / _yResolution2[p];
+  }
+}
+
+void EUTelStraightLineFitter::fit(std::size_t nTracks, const double* x, const double* y, const double* z) {
+  _nTracks = nTracks;
+  _chi2X.resize( nTracks );
+  _chi2Y.resize( nTracks );
+  _offsetX.resize( nTracks );
+  _offsetY.resize( nTracks );
+  _slopeX.resize( nTracks );
+  _slopeY.resize( nTracks );
+  _angleX.resize( nTracks );
+  _angleY.resize( nTracks );
+  _residualX.resize( _nPlanes * nTracks );
+  _residualY.resize( _nPlanes * nTracks );
+
+  std::size_t t = 0;
+  for ( ; t + FITBLOCK <= nTracks; t += FITBLOCK ) {
+    fitBlock<FITBLOCK>( _nPlanes, _fitted.data(), _xResolution2.data(), _xWeightSum, x + t, z + t, nTracks,
+                        &_chi2X[t], &_offsetX[t], &_slopeX[t], _residualX.data() + t );
+    fitBlock<FITBLOCK>( _nPlanes, _fitted.data(), _yResolution2.data(), _yWeightSum, y + t, z + t, nTracks,
+                        &_chi2Y[t], &_offsetY[t], &_slopeY[t], _residualY.data() + t );
+  }
+  for ( ; t < nTracks; ++t ) {
+    fitBlock<1>( _nPlanes, _fitted.data(), _xResolution2.data(), _xWeightSum, x + t, z + t, nTracks,
+                 &_chi2X[t], &_offsetX[t], &_slopeX[t], _residualX.data() + t );
+    fitBlock<1>( _nPlanes, _fitted.data(), _yResolution2.data(), _yWeightSum, y + t, z + t, nTracks,
+                 &_chi2Y[t], &_offsetY[t], &_slopeY[t], _residualY.data() + t );
+  }
+
+  for ( t = 0; t < nTracks; ++t ) {
+    _angleX[t] = std::atan( _slopeX[t] );
+    _angleY[t] = std::atan( _slopeY[t] );
+  }
+}
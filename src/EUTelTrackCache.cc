@@ -0,0 +1,213 @@
+#include "EUTelTrackCache.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+using namespace eutelescope;
+
+namespace {
+	const char CACHE_MAGIC[4] = {'E','U','T','C'};
+
+	bool isSensor(int location){
+		const std::vector<int>& ids = geo::gGeometry().sensorIDsVec();
+		return std::find(ids.begin(), ids.end(), location) != ids.end();
+	}
+}
+
+EUTelTrackCache::EUTelTrackCache():
+_tracks(),
+_states()
+{}
+
+void EUTelTrackCache::clear(){
+	_tracks.clear();
+	_states.clear();
+}
+
+void EUTelTrackCache::addTrack(EUTelTrack& track){
+	CachedTrack cTrack;
+	cTrack.chi2 = track.getChi2();
+	cTrack.ndf = track.getNdf();
+	cTrack.var = track.getTotalVariance();
+	cTrack.firstState = _states.size();
+	cTrack.nStates = track.getStates().size();
+
+	std::vector<EUTelState>& states = track.getStates();
+	for(size_t i = 0; i < states.size(); ++i){
+		EUTelState& state = states.at(i);
+		CachedState cState;
+		std::memset(&cState, 0, sizeof(CachedState));
+		cState.location = state.getLocation();
+		cState.dimension = state.getDimensionSize();
+		cState.hasHit = state.getStateHasHit() ? 1 : 0;
+		if(state.getStateHasHit()){
+			EUTelHit hit = state.getHit();
+			cState.hitID = hit.getID();
+			std::copy(hit.getPosition(), hit.getPosition()+3, cState.hitPos);
+		}
+		const float* pos = state.getPosition();
+		std::copy(pos, pos+3, cState.localPos);
+		cState.localMom[0] = state.getMomLocalX();
+		cState.localMom[1] = state.getMomLocalY();
+		cState.localMom[2] = state.getMomLocalZ();
+		if(isSensor(cState.location)){
+			const double localPos[] = {pos[0], pos[1], pos[2]};
+			const double localMom[] = {cState.localMom[0], cState.localMom[1], cState.localMom[2]};
+			geo::gGeometry().local2Master(cState.location, localPos, cState.globalPos);
+			geo::gGeometry().local2MasterVec(cState.location, localMom, cState.globalMom);
+		}
+		double cov[4];
+		state.getCombinedHitAndStateCovMatrixInLocalFrame(cov);
+		std::copy(cov, cov+4, cState.cov);
+		cState.kinks[0] = state.getKinks()[0];
+		cState.kinks[1] = state.getKinks()[1];
+		cState.kinksMedium1[0] = state.getKinksMedium1()[0];
+		cState.kinksMedium1[1] = state.getKinksMedium1()[1];
+		cState.kinksMedium2[0] = state.getKinksMedium2()[0];
+		cState.kinksMedium2[1] = state.getKinksMedium2()[1];
+		cState.arcLength = state.getArcLengthToNextState();
+		cState.radFracSensor = state.getRadFracSensor();
+		cState.radFracAir = state.getRadFracAir();
+		_states.push_back(cState);
+	}
+	_tracks.push_back(cTrack);
+}
+
+std::set<int> EUTelTrackCache::getSensorsWithHits() const {
+	std::set<int> sensors;
+	for(size_t j = 0; j < _states.size(); ++j){
+		if(_states[j].hasHit && isSensor(_states[j].location)) sensors.insert(_states[j].location);
+	}
+	return sensors;
+}
+
+EUTelTrack EUTelTrackCache::getTrack(size_t i) const {
+	const CachedTrack& cTrack = _tracks.at(i);
+	EUTelTrack track;
+	track.setChi2(cTrack.chi2);
+	track.setNdf(cTrack.ndf);
+	track.setTotalVariance(cTrack.var);
+
+	std::vector<EUTelState> states;
+	states.reserve(cTrack.nStates);
+	for(size_t j = cTrack.firstState; j < cTrack.firstState + cTrack.nStates; ++j){
+		const CachedState& cState = _states[j];
+		EUTelState state;
+		state.setLocation(cState.location);
+		state.setDimensionSize(cState.dimension);
+		double localPos[3] = {cState.localPos[0], cState.localPos[1], cState.localPos[2]};
+		double localMom[3] = {cState.localMom[0], cState.localMom[1], cState.localMom[2]};
+		if(isSensor(cState.location)){
+			//The global reference is fixed. Express it in the (possibly realigned) local frame and move it along the direction onto the plane.
+			geo::gGeometry().master2Local(cState.location, cState.globalPos, localPos);
+			geo::gGeometry().master2LocalVec(cState.location, cState.globalMom, localMom);
+			if(localMom[2] != 0){
+				localPos[0] -= localPos[2]*localMom[0]/localMom[2];
+				localPos[1] -= localPos[2]*localMom[1]/localMom[2];
+				localPos[2] = 0;
+			}
+		}
+		state.setPositionLocal(localPos);
+		state.setMomLocalX(localMom[0]);
+		state.setMomLocalY(localMom[1]);
+		state.setMomLocalZ(localMom[2]);
+		state.setArcLengthToNextState(cState.arcLength);
+		state.setRadFrac(cState.radFracSensor, cState.radFracAir);
+		TVectorD kinks(2);
+		kinks[0] = cState.kinks[0];
+		kinks[1] = cState.kinks[1];
+		state.setKinks(kinks);
+		kinks[0] = cState.kinksMedium1[0];
+		kinks[1] = cState.kinksMedium1[1];
+		state.setKinksMedium1(kinks);
+		kinks[0] = cState.kinksMedium2[0];
+		kinks[1] = cState.kinksMedium2[1];
+		state.setKinksMedium2(kinks);
+		double cov[4] = {cState.cov[0], cState.cov[1], cState.cov[2], cState.cov[3]};
+		state.setCombinedHitAndStateCovMatrixInLocalFrame(cov);
+		if(cState.hasHit){
+			EUTelHit hit;
+			hit.setID(cState.hitID);
+			hit.setPosition(cState.hitPos);
+			state.setHit(hit);
+		}
+		states.push_back(state);
+	}
+	track.setStates(states);
+	return track;
+}
+
+void EUTelTrackCache::write(const std::string& fileName) const {
+	std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+	if(!file.good()){
+		throw(lcio::Exception("Can not open track cache file for writing: " + fileName));
+	}
+	const uint32_t version = VERSION;
+	const uint64_t nTracks = _tracks.size();
+	const uint64_t nStates = _states.size();
+	file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	file.write(reinterpret_cast<const char*>(&nTracks), sizeof(nTracks));
+	file.write(reinterpret_cast<const char*>(&nStates), sizeof(nStates));
+	if(nTracks > 0) file.write(reinterpret_cast<const char*>(&_tracks[0]), nTracks*sizeof(CachedTrack));
+	if(nStates > 0) file.write(reinterpret_cast<const char*>(&_states[0]), nStates*sizeof(CachedState));
+	if(!file.good()){
+		throw(lcio::Exception("Failed writing track cache file: " + fileName));
+	}
+	streamlog_out(MESSAGE5) << "Track cache written to " << fileName << ": " << nTracks << " tracks, " << nStates << " states" << std::endl;
+}
+
+void EUTelTrackCache::read(const std::string& fileName){
+	std::ifstream file(fileName.c_str(), std::ios::binary);
+	if(!file.good()){
+		throw(lcio::Exception("Can not open track cache file: " + fileName));
+	}
+	char magic[4];
+	uint32_t version = 0;
+	uint64_t nTracks = 0;
+	uint64_t nStates = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&nTracks), sizeof(nTracks));
+	file.read(reinterpret_cast<char*>(&nStates), sizeof(nStates));
+	if(!file.good() || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0){
+		throw(lcio::Exception("File is not a track cache: " + fileName));
+	}
+	if(version != VERSION){
+		throw(lcio::Exception("Track cache " + fileName + " was written with an incompatible version."));
+	}
+	//The header sizes must account for the rest of the file exactly, before anything is allocated from them.
+	const std::streamoff headerEnd = file.tellg();
+	file.seekg(0, std::ios::end);
+	const uint64_t payload = static_cast<uint64_t>(static_cast<std::streamoff>(file.tellg()) - headerEnd);
+	file.seekg(headerEnd);
+	if(nTracks > payload/sizeof(CachedTrack) || nStates > payload/sizeof(CachedState)
+	   || nTracks*sizeof(CachedTrack) + nStates*sizeof(CachedState) != payload){
+		throw(lcio::Exception("Track cache file size does not match its header: " + fileName));
+	}
+	_tracks.resize(nTracks);
+	_states.resize(nStates);
+	if(nTracks > 0) file.read(reinterpret_cast<char*>(&_tracks[0]), nTracks*sizeof(CachedTrack));
+	if(nStates > 0) file.read(reinterpret_cast<char*>(&_states[0]), nStates*sizeof(CachedState));
+	if(!file.good()){
+		clear();
+		throw(lcio::Exception("Track cache file is truncated: " + fileName));
+	}
+	//Every track must own the next contiguous range of states, and the states must cover the whole table.
+	uint64_t nextState = 0;
+	for(size_t i = 0; i < _tracks.size(); ++i){
+		if(_tracks[i].firstState != nextState || _tracks[i].nStates > _states.size() - nextState){
+			clear();
+			throw(lcio::Exception("Track cache file has inconsistent state ranges: " + fileName));
+		}
+		nextState += _tracks[i].nStates;
+	}
+	if(nextState != _states.size()){
+		clear();
+		throw(lcio::Exception("Track cache file has states not owned by any track: " + fileName));
+	}
+	streamlog_out(MESSAGE5) << "Track cache read from " << fileName << ": " << nTracks << " tracks, " << nStates << " states" << std::endl;
+}
@@ -295,6 +295,10 @@ void EUTelUpdatePedestalNoiseProcessor::fixedWeightUpdate(LCEvent * evt) {
         }
       }
     }
+
+    // the noise changed in place, invalidate what other processors derived from it
+    noiseCollection->parameters().setValue( EUTELESCOPE::NOISEUPDATECOUNT,
+                                            noiseCollection->getParameters().getIntVal( EUTELESCOPE::NOISEUPDATECOUNT ) + 1 );
   }  catch ( DataNotAvailableException& e) {
     if ( _noOfConsecutiveMissing <= _maxNoOfConsecutiveMissing ) {
       streamlog_out( WARNING2 )  << "Collection not available in this event " << endl;
@@ -0,0 +1,41 @@
+#include "EUTelUtilityInstrumentation.h"
+#include "EUTelInstrumentation.h"
+
+using namespace lcio;
+using namespace marlin;
+using namespace eutelescope;
+
+
+EUTelUtilityInstrumentation::EUTelUtilityInstrumentation() : 
+  Processor("EUTelUtilityInstrumentation"),
+  _section(""),
+  _outputFile(""),
+  _point(0)
+{
+  _description = "EUTelUtilityInstrumentation measures the time, heap allocations and output collections"
+    " of the processors between the previous instance and this one" ;	
+	
+  registerOptionalParameter( "Section",
+			      "Name of the section ending at this point, the processor name if empty",
+			      _section, std::string(""));
+  registerOptionalParameter( "OutputFile",
+			      "Name of the JSON file the summary of all the sections is written to",
+			      _outputFile, std::string(""));
+}
+    
+    
+void EUTelUtilityInstrumentation::init() { 
+  printParameters ();	
+
+  EUTelInstrumentation& instrumentation = EUTelInstrumentation::instance();
+  _point = instrumentation.addPoint( _section.empty() ? name() : _section );
+  if ( !_outputFile.empty() ) instrumentation.setOutputFile( _outputFile );
+}
+    
+void EUTelUtilityInstrumentation::processEvent( LCEvent * evt ) { 
+  EUTelInstrumentation::instance().checkpoint( _point, evt );
+}
+    
+void EUTelUtilityInstrumentation::end(){ 
+  EUTelInstrumentation::instance().endPoint();
+}
@@ -6,17 +6,23 @@ namespace geo {
 GEARPixGeoDescr::GEARPixGeoDescr( int xPixel, int yPixel, double xSize, double ySize, double zSize,  double radLength ): 
 	EUTelGenericPixGeoDescr(	xSize, ySize, zSize,		//size X, Y, Z
 					0, xPixel-1, 0, yPixel-1,	//min max X,Y
-					radLength )			//rad length
+					radLength ),			//rad length
+	matSi(NULL),
+	Si(NULL),
+	plane(NULL)
+{}
+
+void GEARPixGeoDescr::createPixelVolumes()
 {
 	//Create the material for the sensor
 	matSi = new TGeoMaterial( "Si", 28.0855 , 14.0, 2.33, -_radLength, 45.753206 );
 	Si = new TGeoMedium("GenericSilicon",1, matSi);
 
 	//Create a plane for the sensitive area
-	plane = _tGeoManager->MakeBox( "sensarea_gen", Si, xSize/2., ySize/2., zSize/2. );
+	plane = _tGeoManager->MakeBox( "sensarea_gen", Si, _sizeSensitiveAreaX/2., _sizeSensitiveAreaY/2., _sizeSensitiveAreaZ/2. );
 	//Divide the regions to create pixels
-	TGeoVolume* row = plane->Divide("genrow", 1 , xPixel , 0 , 1, 0, "N"); 
-	row->Divide("genpixel", 2 , yPixel, 0 , 1, 0, "N");
+	TGeoVolume* row = plane->Divide("genrow", 1 , _maxIndexX+1 , 0 , 1, 0, "N"); 
+	row->Divide("genpixel", 2 , _maxIndexY+1, 0 , 1, 0, "N");
 }
 
 GEARPixGeoDescr::~ GEARPixGeoDescr()
@@ -28,6 +34,9 @@ GEARPixGeoDescr::~ GEARPixGeoDescr()
 
 void  GEARPixGeoDescr::createRootDescr(char const * planeVolume)
 {
+	//The pixel volumes are made once, on the first plane using this description
+	if( plane == NULL ) createPixelVolumes();
+
 	//Get the plane as provided by the EUTelGeometryTelescopeGeoDescription
 	TGeoVolume* topplane =_tGeoManager->GetVolume(planeVolume);
 	//Add the sensitive area to the plane
@@ -2,10 +2,46 @@
 
 #include "cluster.h"
 
+#include <unordered_set>
+
 using namespace std;
 
 Cluster aCluster;
 
+namespace {
+  // Bounding box width, then one bit per pixel of the box starting from its
+  // lower left corner, row by row. The last row always has a pixel, so the
+  // height is fixed by the length and the last bit.
+  string shapeKey(const vector<int> &x, const vector<int> &y, int sx, int sy, bool swap)
+  {
+    string key;
+    if (x.empty()) return key;
+    int xMin = 0, xMax = 0, yMin = 0, yMax = 0;
+    for (unsigned int i=0; i<x.size(); i++)
+    {
+      int u = swap ? sy*y[i] : sx*x[i];
+      int v = swap ? sx*x[i] : sy*y[i];
+      if (i == 0 || u < xMin) xMin = u;
+      if (i == 0 || u > xMax) xMax = u;
+      if (i == 0 || v < yMin) yMin = v;
+      if (i == 0 || v > yMax) yMax = v;
+    }
+    const unsigned int width = xMax - xMin + 1;
+    const unsigned int height = yMax - yMin + 1;
+    const unsigned int header = sizeof(width);
+    key.assign(header + (width*height + 7)/8, '\0');
+    for (unsigned int k=0; k<header; k++) key[k] = static_cast<char>(width >> (8*k));
+    for (unsigned int i=0; i<x.size(); i++)
+    {
+      int u = swap ? sy*y[i] : sx*x[i];
+      int v = swap ? sx*x[i] : sy*y[i];
+      unsigned int bit = (v - yMin)*width + (u - xMin);
+      key[header + bit/8] |= static_cast<char>(1 << (bit%8));
+    }
+    return key;
+  }
+}
+
 Cluster::Cluster()
     :size(0),
     x(0),
@@ -113,6 +149,35 @@ void Cluster::set_values (int s, vector<int> a, vector<int> b) {
       }
 }
 
+string Cluster::ShapeKey() const
+{
+  return shapeKey(x,y,1,1,false);
+}
+
+string Cluster::SymmetricShapeKey() const
+{
+  // the four rotations (x,y) (-y,x) (-x,-y) (y,-x) and their mirror images
+  string key = shapeKey(x,y,1,1,false);
+  for (int sx=-1; sx<=1; sx+=2)
+    for (int sy=-1; sy<=1; sy+=2)
+      for (int swap=0; swap<2; swap++)
+      {
+        string keyTmp = shapeKey(x,y,sx,sy,swap);
+        if (keyTmp < key) key = keyTmp;
+      }
+  return key;
+}
+
+unordered_map<string,int> Cluster::ShapeIndex(const vector<Cluster> &clusterVec)
+{
+  unordered_map<string,int> shapeIndex;
+  shapeIndex.reserve(clusterVec.size());
+  // the first one of equal shapes, as the linear search finds
+  for (unsigned int iCluster=0; iCluster<clusterVec.size(); iCluster++)
+    shapeIndex.insert(make_pair(clusterVec[iCluster].ShapeKey(),iCluster));
+  return shapeIndex;
+}
+
 void Cluster::NeighbourPixels(int x, int y, vector<int> xOriginal, vector<int> yOriginal, vector<int> &xNeighbour, vector<int> &yNeighbour)
 {
   int yTmp = 0;
@@ -170,6 +235,10 @@ void Cluster::FindReferenceClusters(vector<Cluster> &clusterVec, int sizeMax)
   Cluster cTmp;
   cTmp.set_values(1,xTmp,yTmp);
   clusterVec.push_back(cTmp);
+  // keys of the shapes found so far, to drop a grown shape found already
+  unordered_set<string> shapeKeys;
+  for (unsigned int k=0; k<clusterVec.size(); k++)
+    shapeKeys.insert(clusterVec[k].ShapeKey());
   for (int size=2; size<=sizeMax; size++)
   {
     cout << "Looking for clusters with size: " << size << endl;
@@ -187,7 +256,6 @@ void Cluster::FindReferenceClusters(vector<Cluster> &clusterVec, int sizeMax)
         NeighbourPixels(x[iPixel],y[iPixel],x,y,xNeighbour,yNeighbour);
         for (unsigned int i=0; i<xNeighbour.size();i++)
         {
-          bool areadyExists = false;
           if (x.size() < (unsigned int)size) 
           {
             x.push_back(xNeighbour[i]);
@@ -199,13 +267,7 @@ void Cluster::FindReferenceClusters(vector<Cluster> &clusterVec, int sizeMax)
             y[size-1] = yNeighbour[i];
           }
           cluster.set_values(size,x,y);
-          for (unsigned int k=0; k<clusterVec.size(); k++)
-            if (cluster == clusterVec[k]) 
-            {
-              areadyExists = true; 
-              break;
-            }
-          if (!areadyExists)
+          if (shapeKeys.insert(cluster.ShapeKey()).second)
             clusterVec.push_back(cluster);
         }
       }
@@ -239,87 +301,33 @@ std::map<int,int> Cluster::SymmetryPairs(vector<Cluster> clusterVec, const char*
     cerr << "Type has to be y or x, assuming x" << endl;
     type = "x";
   }
+  unordered_map<string,int> shapeIndex = ShapeIndex(clusterVec);
   for (unsigned int i=0; i<clusterVec.size(); i++)
   {
     Cluster cluster;
     if (type == typeX) cluster = clusterVec[i].mirrorX();
     else if (type == typeY) cluster = clusterVec[i].mirrorY();
-    for (unsigned int j=0; j<clusterVec.size(); j++)
-    {
-      bool alreadyAdded = false;
-      for(map<int,int>::iterator it = pair.begin(); it != pair.end(); ++it)
-        if (it->first == (int)j)
-        {
-          alreadyAdded = true;
-          break;
-        }
-      if (alreadyAdded) continue;
-      if (cluster == clusterVec[j]) 
-      {
-        if (i == j) break;
-        pair.insert(make_pair(i,j));
-      }
-    }
+    unordered_map<string,int>::const_iterator it = shapeIndex.find(cluster.ShapeKey());
+    if (it == shapeIndex.end()) continue;
+    int j = it->second;
+    // a pair is stored once, under its first member
+    if (j == (int)i || pair.count(j)) continue;
+    pair.insert(make_pair(i,j));
   }
   return pair;
 }
 
 vector< vector<int> > Cluster::sameShape(vector<Cluster> clusterVec){
+  // the clusters equal up to mirroring and rotations share the symmetric key,
+  // the groups are in the order of their first member
   vector< vector<int> > symmetryGroups;
+  unordered_map<string,int> groupIndex;
   for (unsigned int i=0; i<clusterVec.size(); i++)
   {
-    vector<int> group;
-    Cluster clusterOriginal = clusterVec[i];
-    bool alreadyAdded = false;
-    for (unsigned int k=0; k<symmetryGroups.size(); k++)
-    {
-      for (unsigned int l=0; l<symmetryGroups[k].size(); l++)
-        if (symmetryGroups[k][l] == (int)i)
-        {
-          alreadyAdded = true;
-          break;
-        }
-      if (alreadyAdded) break;
-    }
-    if (alreadyAdded) continue;
-    else group.push_back(i);
-    Cluster cluster2;
-    for (int mir=0; mir<2; mir++)
-    {
-      if (mir == 0)  cluster2 = clusterOriginal;
-      else  cluster2 = clusterOriginal.mirrorX();
-      for (int rot=0; rot<4; rot++)
-      {
-        cluster2 = cluster2.rotate90();
-        if (cluster2 == clusterOriginal) break;
-        for (unsigned int j=0; j<clusterVec.size(); j++)
-        {
-          if (clusterVec[j] == cluster2)
-          {
-            alreadyAdded = false;
-            for (unsigned int k=0; k<group.size(); k++)
-              if (group[k] == (int)j)
-              {
-                alreadyAdded = true;
-                break;
-              }
-            for (unsigned int k=0; k<symmetryGroups.size() && !alreadyAdded; k++)
-            {
-              for (unsigned int l=0; l<symmetryGroups[k].size(); l++)
-                if (symmetryGroups[k][l] == (int)j)
-                {
-                  alreadyAdded = true;
-                  break;
-                }
-              if (alreadyAdded) break;
-            }
-            if (!alreadyAdded) group.push_back(j);
-          }
-        }
-      }
-    }
-    sort(group.begin(), group.end());
-    symmetryGroups.push_back(group);
+    pair<unordered_map<string,int>::iterator,bool> group =
+      groupIndex.insert(make_pair(clusterVec[i].SymmetricShapeKey(),(int)symmetryGroups.size()));
+    if (group.second) symmetryGroups.push_back(vector<int>());
+    symmetryGroups[group.first->second].push_back(i);
   }
   return symmetryGroups;
 }
@@ -332,6 +340,13 @@ int Cluster::WhichClusterShape(Cluster cluster, vector<Cluster> clusterVec)
   return -1;
 }
 
+int Cluster::WhichClusterShape(const Cluster &cluster, const unordered_map<string,int> &shapeIndex)
+{
+  unordered_map<string,int>::const_iterator it = shapeIndex.find(cluster.ShapeKey());
+  if (it == shapeIndex.end()) return -1;
+  return it->second;
+}
+
 void Cluster::getCenterOfGravity(float &xCenter, float &yCenter)
 {
   xCenter = 0;
@@ -1,11 +1,12 @@
 #include "estmat.h"
 #include <gsl/gsl_multimin.h>
+#include <gsl/gsl_blas.h>
 #include <Eigen/LU>
 #include <Eigen/Cholesky>
 #include <TH2D.h>
 
 //#include <thread>         // std::this_thread::sleep_for
-//#include <chrono>         // std::chrono::seconds
+#include <chrono>
  
 
 inline double getScatterSigma(double eBeam, double radLength){
@@ -136,9 +137,7 @@ void FakeChi2::operator() (size_t offset, size_t stride){
   TrackCandidate<FITTERTYPE,4> candidate = system.tracks.at(0);
   
   {
-#if DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
+    std::lock_guard<std::mutex> lock(resultGurad);
     if(firstRun){ calibrate(system); }
   }
   Eigen::Matrix<FITTERTYPE, 2, 1> resv;
@@ -171,9 +170,7 @@ void FakeChi2::operator() (size_t offset, size_t stride){
   }
 
   {
-#if DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
+    std::lock_guard<std::mutex> lock(resultGurad);
     result += chi2;
   }
 }
@@ -187,9 +184,7 @@ void FakeAbsDev::operator() (size_t offset, size_t stride){
   TrackCandidate<FITTERTYPE,4> candidate = system.tracks.at(0);
   
   {
-#if DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
+    std::lock_guard<std::mutex> lock(resultGurad);
     if(firstRun){ calibrate(system); }
   }
   Eigen::Matrix<FITTERTYPE, 2, 1> resv;
@@ -222,9 +217,7 @@ void FakeAbsDev::operator() (size_t offset, size_t stride){
   }
 
   {
-#if DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
+    std::lock_guard<std::mutex> lock(resultGurad);
     result += chi2;
   }
 }
@@ -247,9 +240,7 @@ void Chi2::operator() (size_t offset, size_t stride){
   }
   
   {
-#if DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
+    std::lock_guard<std::mutex> lock(resultGurad);
     result += varchi2;
   }
 }
@@ -365,9 +356,7 @@ void SDR::operator() (size_t offset, size_t stride){
     }
   }
   {
-#if DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
+    std::lock_guard<std::mutex> lock(resultGurad);
     result += varvar;
   }
 }
@@ -456,26 +445,52 @@ void FwBw::operator() (size_t offset, size_t stride){
     return2 += resvar * resvar;
   }
   {
-#if DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
+    std::lock_guard<std::mutex> lock(resultGurad);
     result += -1.0 * logL;
     retVal2 += return2;
   }
 }
 
 void Minimizer::init(){
-  //Initialize nThread threads
-#ifndef DOTHREAD
-  cout << "Not using threads!" << endl;
-  nThreads = 1;
-#endif
+  //Start the nThreads - 1 workers, offset 0 is run by the calling thread
   if( not inited){
+    if(nThreads < 1){ nThreads = 1; }
     systems.assign(nThreads, mat.system);
+    for(size_t ii = 1; ii < nThreads; ii++){
+      workers.push_back( std::thread(&Minimizer::workerLoop, this, ii));
+    }
   }
   inited = true;
 }
 
+void Minimizer::workerLoop(size_t offset){
+  //Wait for a new evaluation, fit this worker's share of the tracks, report back
+  size_t seen = 0;
+  while(true){
+    {
+      std::unique_lock<std::mutex> lock(poolGuard);
+      while(generation == seen and not stopping){ workReady.wait(lock); }
+      if(stopping){ return; }
+      seen = generation;
+    }
+    (*this)(offset, nThreads);
+    {
+      std::unique_lock<std::mutex> lock(poolGuard);
+      if(--nBusy == 0){ workDone.notify_one(); }
+    }
+  }
+}
+
+void Minimizer::stopWorkers(){
+  {
+    std::unique_lock<std::mutex> lock(poolGuard);
+    stopping = true;
+  }
+  workReady.notify_all();
+  for(size_t ii = 0; ii < workers.size(); ii++){ workers.at(ii).join(); }
+  workers.clear();
+}
+
 void Minimizer::prepareThreads(){
   //Copy thicknesses and resolutions, reset resturn values
   for(size_t ii = 0; ii < mat.system.planes.size(); ii++){
@@ -491,17 +506,23 @@ void Minimizer::prepareThreads(){
 }
 
 FITTERTYPE Minimizer::operator() (void){
-  //Start threads if DOTHREAD, run job in main thread if not.
+  //Wake the worker pool and fit the first share in the calling thread
   prepareThreads();
-#ifdef DOTHREAD
-  boost::thread_group threads;
-  for(int ii = 0; ii < nThreads; ii++){
-    threads.create_thread( boost::bind(&Minimizer::operator(), this, ii, nThreads));
-  }
-  threads.join_all();
-#else
-  (*this)(0, 1);
-#endif
+  if(workers.empty()){
+    (*this)(0, 1);
+    return( result );
+  }
+  {
+    std::unique_lock<std::mutex> lock(poolGuard);
+    nBusy = workers.size();
+    generation++;
+  }
+  workReady.notify_all();
+  (*this)(0, nThreads);
+  {
+    std::unique_lock<std::mutex> lock(poolGuard);
+    while(nBusy > 0){ workDone.wait(lock); }
+  }
   return( result );
 }
 
@@ -939,9 +960,104 @@ double estimateSimplex(const gsl_vector* v, void * params){
   return((*minimize)());
 }
 
+void EstMat::gradient(Minimizer* minimize, const gsl_vector* params, gsl_vector* grad, FITTERTYPE& value){
+  //Central difference gradient of the objective, every evaluation runs on the worker pool.
+  //The system is left at params.
+  size_t nParams = params->size;
+  gsl_vector* vc = gsl_vector_alloc(nParams);
+  gsl_vector_memcpy(vc, params);
+  for(size_t ii = 0; ii < nParams; ii++){
+    double val = gsl_vector_get(params, ii);
+    double step = fabs(val) * 1e-3 + 1e-4; //Smaller steps drown in float precision
+    gsl_vector_set(vc, ii, val + step);
+    double fp = estimateSimplex(vc, minimize);
+    gsl_vector_set(vc, ii, val - step);
+    double fm = estimateSimplex(vc, minimize);
+    gsl_vector_set(vc, ii, val);
+    gsl_vector_set(grad, ii, (fp - fm) / (2.0 * step));
+  }
+  value = estimateSimplex(params, minimize);
+  gsl_vector_free(vc);
+}
+
+void estimateGradientFdf(const gsl_vector* v, void* params, double* f, gsl_vector* df){
+  //Wrappers for the gradient based search in GSL
+  Minimizer* minimize = (Minimizer*) params;
+  FITTERTYPE value;
+  minimize->mat.gradient(minimize, v, df, value);
+  *f = value;
+}
+
+void estimateGradientDf(const gsl_vector* v, void* params, gsl_vector* df){
+  double f;
+  estimateGradientFdf(v, params, &f, df);
+}
+
+void EstMat::gradientSearch(Minimizer* minimizeMe, size_t iterations, size_t maxIterations){
+  //BFGS search on the configured Minimizer object. Every gradient is a central
+  //difference, 2n+1 fits of the dataset for n free parameters. The fit count
+  //and wall time printed at the end compare directly with simplexSearch.
+  minimizeMe->init();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  int fitCountStart = fitCount;
+
+  cout << "Initial guesses" << endl;
+  printAllFreeParams();
+
+  if(tracks.size() < maxIterations){
+    itMax = tracks.size();
+  } else {
+    itMax = maxIterations;
+  }
+
+  size_t nParams = getNSimplexParams();
+  gsl_vector* x = systemToEst();
+  //The first trial step is on the scale of the simplex step sizes
+  gsl_vector* ss = simplesStepSize();
+  double firstStep = 0.1 * gsl_blas_dnrm2(ss);
+  gsl_vector_free(ss);
+
+  gsl_multimin_function_fdf minex_func;
+  minex_func.n = nParams;
+  minex_func.f = estimateSimplex;
+  minex_func.df = estimateGradientDf;
+  minex_func.fdf = estimateGradientFdf;
+  minex_func.params = minimizeMe;
+
+  gsl_multimin_fdfminimizer* s = gsl_multimin_fdfminimizer_alloc(gsl_multimin_fdfminimizer_vector_bfgs2, nParams);
+  gsl_multimin_fdfminimizer_set(s, &minex_func, x, firstStep, 0.1);
+
+  size_t iter = 0;
+  int status;
+  do{
+    iter++;
+    status = gsl_multimin_fdfminimizer_iterate(s);
+    if(status){ break; }
+    status = gsl_multimin_test_gradient(s->gradient, 1e-6 * fabs(s->f) + 1e-9);
+    if (status == GSL_SUCCESS) {
+      printf ("converged to minimum at\n");
+    }
+    if(iter % 10 == 0 or status == GSL_SUCCESS){
+      cout << "Iteration " << iter << ", nTracks = " << itMax << endl;
+      printf ("%5d f() = %7.7f\n", (int)iter, s->f);
+      printAllFreeParams();
+    }
+  }
+  while (status == GSL_CONTINUE && iter < iterations);
+  estToSystem(gsl_multimin_fdfminimizer_x(s), system);
+  gsl_vector_free(x);
+  gsl_multimin_fdfminimizer_free(s);
+  cout << "Status: " << status << endl;
+
+  double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  cout << "Gradient search: " << iter << " iterations, " << fitCount - fitCountStart
+       << " fits of the dataset, wall time " << wallTime << " s" << endl;
+}
+
 void EstMat::simplexSearch(Minimizer* minimizeMe, size_t iterations, int restarts, size_t maxIterations){
   //Do the simplex search on the configured Minimizer object
   minimizeMe->init();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
   
   cout << "Initial guesses" << endl;
   printAllFreeParams();
@@ -1010,6 +1126,7 @@ void EstMat::simplexSearch(Minimizer* minimizeMe, size_t iterations, int restart
     cout << "Status: " << status << endl;
   }
   cout << "The dataset has been fitted " << fitCount << " times." << endl;
+  cout << "Simplex search wall time " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << endl;
 }
 
 FITTERTYPE EstMat::stepVector(gsl_vector* vc, size_t index, FITTERTYPE value, bool doMSE, Minimizer* minimize){
@@ -1026,6 +1143,7 @@ FITTERTYPE EstMat::stepVector(gsl_vector* vc, size_t index, FITTERTYPE value, bo
 void EstMat::quasiNewtonHomeMade(Minimizer* minimizeMe, int iterations){
   //Try to find minimum using independent steps of variables using Newtons method
   minimizeMe->init();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
   // Successive steps in Newtons method to find the minimum
   cout << "Initial guesses" << endl;
   printAllFreeParams();
@@ -1091,4 +1209,5 @@ void EstMat::quasiNewtonHomeMade(Minimizer* minimizeMe, int iterations){
     printAllFreeParams();
   }
   gsl_vector_free(vc);
+  cout << "Newton search wall time " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << endl;
 }
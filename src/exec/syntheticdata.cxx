@@ -0,0 +1,414 @@
+// eutelescope includes ""
+#include "anyoption.h"
+#include "EUTELESCOPE.h"
+#include "EUTelRunHeaderImpl.h"
+#include "EUTelEventImpl.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+
+// lcio includes <>
+#include <IO/LCWriter.h>
+#include <lcio.h>
+#include <Exceptions.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <UTIL/CellIDEncoder.h>
+#include <UTIL/LCTime.h>
+
+// system includes <>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+
+// Generator of deterministic synthetic telescope data for benchmarking.
+//
+// Straight tracks are sent through a stack of planes perpendicular to
+// the beam, each crossed pixel fires together with the neighbours the
+// track passes close to, and random noise and a few hot pixels are
+// added on top. Multiple scattering, efficiency and misalignment are
+// not simulated. The same seed and options always give the same file.
+
+namespace {
+
+  //! Sensor type of a plane, matching a pixel geometry library
+  struct PlaneType {
+    string name;
+    string geometryLibrary;
+    int nPixelX;
+    int nPixelY;
+    double pitchX;
+    double pitchY;
+    //! Width of the first and last column, larger than pitchX for the FE-I4
+    double edgeX;
+    double thickness;
+    double resolution;
+
+    double sizeX() const { return 2 * edgeX + ( nPixelX - 2 ) * pitchX; }
+    double sizeY() const { return nPixelY * pitchY; }
+
+    //! Column of the local position @a x, -1 if outside
+    int column(double x) const {
+      const double u = x + sizeX() / 2;
+      if ( u < 0 || u >= sizeX() ) return -1;
+      if ( u < edgeX ) return 0;
+      const int col = 1 + static_cast<int>( ( u - edgeX ) / pitchX );
+      return col < nPixelX ? col : nPixelX - 1;
+    }
+
+    //! Lower and upper edge of column @a col
+    pair<double, double> columnEdges(int col) const {
+      const double low = ( col == 0 ) ? 0 : edgeX + ( col - 1 ) * pitchX;
+      const double high = ( col == nPixelX - 1 ) ? sizeX() : edgeX + col * pitchX;
+      return make_pair( low - sizeX() / 2, high - sizeX() / 2 );
+    }
+
+    int row(double y) const {
+      const double v = y + sizeY() / 2;
+      if ( v < 0 || v >= sizeY() ) return -1;
+      return static_cast<int>( v / pitchY );
+    }
+  };
+
+  const PlaneType mimosa26 = { "mimosa26", "Mimosa26.so", 1152, 576, 0.018402778, 0.018402778, 0.018402778, 0.05, 0.0045 };
+  const PlaneType fei4 = { "fei4", "FEI4Single.so", 80, 336, 0.25, 0.05, 0.4, 0.2, 0.1 };
+
+  struct Plane {
+    int sensorID;
+    PlaneType type;
+    double z;
+  };
+
+  bool planeTypeFromName(const string& name, PlaneType& type) {
+    if ( name == mimosa26.name ) type = mimosa26;
+    else if ( name == fei4.name ) type = fei4;
+    else return false;
+    return true;
+  }
+
+  //! Numeric option with a default value
+  double numericOption(AnyOption& option, const char* name, double defaultValue) {
+    return option.getValue( name ) ? atof( option.getValue( name ) ) : defaultValue;
+  }
+
+  void writeGear(const string& fileName, const vector< Plane >& planes) {
+    ofstream gear( fileName.c_str() );
+    gear << "<gear>" << endl
+         << "  <!-- synthetic telescope written by syntheticdata -->" << endl
+         << "  <global detectorName=\"EUTelescope\"/>" << endl
+         << "  <BField type=\"ConstantBField\" x=\"0\" y=\"0.0\" z=\"0.0\"/>" << endl
+         << "  <detectors>" << endl
+         << "    <detector name=\"SiPlanes\" geartype=\"SiPlanesParameters\">" << endl
+         << "      <parameter name=\"Geometry\" type=\"StringVec\" value=\"";
+    for ( size_t iPlane = 0; iPlane < planes.size(); ++iPlane ) {
+      gear << ( iPlane ? " " : "" ) << planes[iPlane].type.geometryLibrary;
+    }
+    gear << "\"/>" << endl
+         << "      <siplanesID ID=\"0\"/>" << endl
+         << "      <siplanesType type=\"TelescopeWithoutDUT\"/>" << endl
+         << "      <siplanesNumber number=\"" << planes.size() << "\"/>" << endl
+         << "      <layers>" << endl;
+    gear.precision( 9 );
+    for ( size_t iPlane = 0; iPlane < planes.size(); ++iPlane ) {
+      const Plane& plane = planes[iPlane];
+      gear << "        <layer>" << endl
+           << "          <ladder ID=\"" << plane.sensorID << "\" positionX=\"0.0\" positionY=\"0.0\" positionZ=\"" << plane.z << "\"" << endl
+           << "                  rotationZY=\"0.0\" rotationZX=\"0.0\" rotationXY=\"0.0\"" << endl
+           << "                  sizeX=\"" << plane.type.sizeX() << "\" sizeY=\"" << plane.type.sizeY() << "\" thickness=\"" << plane.type.thickness << "\"" << endl
+           << "                  radLength=\"93.660734\"/>" << endl
+           << "          <sensitive ID=\"" << plane.sensorID << "\" positionX=\"0.0\" positionY=\"0.0\" positionZ=\"" << plane.z << "\"" << endl
+           << "                     sizeX=\"" << plane.type.sizeX() << "\" sizeY=\"" << plane.type.sizeY() << "\" thickness=\"" << plane.type.thickness << "\"" << endl
+           << "                     npixelX=\"" << plane.type.nPixelX << "\" npixelY=\"" << plane.type.nPixelY << "\"" << endl
+           << "                     pitchX=\"" << plane.type.pitchX << "\" pitchY=\"" << plane.type.pitchY << "\" resolution=\"" << plane.type.resolution << "\"" << endl
+           << "                     rotation1=\"1.0\" rotation2=\"0.0\" rotation3=\"0.0\" rotation4=\"1.0\"" << endl
+           << "                     radLength=\"93.660734\"/>" << endl
+           << "        </layer>" << endl;
+    }
+    gear << "      </layers>" << endl
+         << "    </detector>" << endl
+         << "  </detectors>" << endl
+         << "</gear>" << endl;
+  }
+}
+
+int main( int argc, char ** argv ) {
+
+  unique_ptr< AnyOption > option( new AnyOption );
+
+  string usageString =
+    "\n"
+    "Generates deterministic synthetic telescope data in the zsdata_m26 format\n"
+    "of the converter together with the matching GEAR file, to benchmark the\n"
+    "reconstruction chain. Tracks are straight lines, multiple scattering,\n"
+    "inefficiency and misalignment are not simulated.\n"
+    "\n"
+    "syntheticdata [options] -o output.slcio -g gear.xml\n"
+    "\n"
+    "-h --help              Print this help\n"
+    "-o --output            Output LCIO file\n"
+    "-g --gear              Output GEAR file\n"
+    "-r --run               Run number (default 1)\n"
+    "-n --events            Number of events (default 10000)\n"
+    "-s --seed              Random seed (default 1)\n"
+    "   --planes            Number of telescope planes, Mimosa26 (default 6)\n"
+    "   --dut               Comma separated DUT types in the middle of the\n"
+    "                       telescope, mimosa26 or fei4 (default none)\n"
+    "   --spacing           Distance between the planes in mm (default 150)\n"
+    "   --tracks            Mean number of tracks per event (default 1)\n"
+    "   --noise             Noise occupancy per pixel and event (default 1e-5)\n"
+    "   --hotpixels         Number of hot pixels per plane, firing in half\n"
+    "                       of the events (default 10)\n"
+    "   --sharing           Fraction of the pitch from the pixel edge in which\n"
+    "                       the neighbour fires too (default 0.25)\n"
+    "   --beamspot          Beam spot sigma in mm (default 3)\n"
+    "   --divergence        Beam divergence sigma in mrad (default 1)\n";
+
+  option->addUsage( usageString.c_str() );
+  option->setFlag( "help", 'h' );
+  option->setOption( "output", 'o' );
+  option->setOption( "gear", 'g' );
+  option->setOption( "run", 'r' );
+  option->setOption( "events", 'n' );
+  option->setOption( "seed", 's' );
+  option->setOption( "planes" );
+  option->setOption( "dut" );
+  option->setOption( "spacing" );
+  option->setOption( "tracks" );
+  option->setOption( "noise" );
+  option->setOption( "hotpixels" );
+  option->setOption( "sharing" );
+  option->setOption( "beamspot" );
+  option->setOption( "divergence" );
+
+  option->processCommandArgs( argc, argv );
+
+  if ( option->getFlag( 'h' ) || option->getFlag( "help" ) ) {
+    option->printUsage();
+    return 0;
+  }
+
+  if ( option->getValue( "output" ) == NULL || option->getValue( "gear" ) == NULL ) {
+    cerr << "Please provide the output and the GEAR file names using the -o and -g options" << endl;
+    return 2;
+  }
+
+  string outputFileName = option->getValue( "output" );
+  if ( outputFileName.rfind( ".slcio", string::npos ) == string::npos ) {
+    outputFileName.append( ".slcio" );
+  }
+  const string gearFileName = option->getValue( "gear" );
+
+  const int runNumber            = static_cast<int>( numericOption( *option, "run", 1 ) );
+  const int nEvents              = static_cast<int>( numericOption( *option, "events", 10000 ) );
+  const unsigned int seed        = static_cast<unsigned int>( numericOption( *option, "seed", 1 ) );
+  const int nTelescopePlanes     = static_cast<int>( numericOption( *option, "planes", 6 ) );
+  const double spacing           = numericOption( *option, "spacing", 150. );
+  const double meanTracks        = numericOption( *option, "tracks", 1. );
+  const double noiseOccupancy    = numericOption( *option, "noise", 1e-5 );
+  const int nHotPixels           = static_cast<int>( numericOption( *option, "hotpixels", 10 ) );
+  const double sharing           = numericOption( *option, "sharing", 0.25 );
+  const double beamSpot          = numericOption( *option, "beamspot", 3. );
+  const double divergence        = 1e-3 * numericOption( *option, "divergence", 1. );
+
+  if ( nEvents <= 0 || nTelescopePlanes < 2 || meanTracks < 0 || noiseOccupancy < 0 || noiseOccupancy >= 1 ) {
+    cerr << "Invalid options, see syntheticdata --help" << endl;
+    return 2;
+  }
+
+  vector< PlaneType > dutTypes;
+  if ( option->getValue( "dut" ) ) {
+    stringstream dutList( option->getValue( "dut" ) );
+    string name;
+    while ( getline( dutList, name, ',' ) ) {
+      if ( name.empty() ) continue;
+      PlaneType type;
+      if ( !planeTypeFromName( name, type ) ) {
+        cerr << "Unknown DUT type " << name << ", use mimosa26 or fei4" << endl;
+        return 2;
+      }
+      dutTypes.push_back( type );
+    }
+  }
+
+  // telescope planes 0 .. n-1, DUTs 20, 21, ... in the middle
+  vector< Plane > planes;
+  for ( int iPlane = 0; iPlane < nTelescopePlanes; ++iPlane ) {
+    if ( iPlane == nTelescopePlanes / 2 ) {
+      for ( size_t iDUT = 0; iDUT < dutTypes.size(); ++iDUT ) {
+        Plane dut = { 20 + static_cast<int>( iDUT ), dutTypes[iDUT], 0. };
+        planes.push_back( dut );
+      }
+    }
+    Plane plane = { iPlane, mimosa26, 0. };
+    planes.push_back( plane );
+  }
+  for ( size_t iPlane = 0; iPlane < planes.size(); ++iPlane ) {
+    planes[iPlane].z = iPlane * spacing;
+  }
+
+  writeGear( gearFileName, planes );
+
+  // one generator drives everything, in a fixed order
+  mt19937 generator( seed );
+  uniform_real_distribution<double> uniform( 0., 1. );
+  normal_distribution<double> gauss( 0., 1. );
+  poisson_distribution<int> nTracksDistribution( meanTracks );
+
+  // hot pixels are chosen once per plane
+  vector< vector< pair<int, int> > > hotPixels( planes.size() );
+  for ( size_t iPlane = 0; iPlane < planes.size(); ++iPlane ) {
+    for ( int iHot = 0; iHot < nHotPixels; ++iHot ) {
+      hotPixels[iPlane].push_back( make_pair( static_cast<int>( uniform( generator ) * planes[iPlane].type.nPixelX ),
+                                              static_cast<int>( uniform( generator ) * planes[iPlane].type.nPixelY ) ) );
+    }
+  }
+
+  lcio::LCWriter * lcWriter = lcio::LCFactory::getInstance()->createLCWriter();
+  try {
+    lcWriter->open( outputFileName.c_str(), lcio::LCIO::WRITE_NEW );
+  } catch ( lcio::IOException& e ) {
+    cerr << e.what() << endl;
+    return 3;
+  }
+
+  lcio::LCRunHeaderImpl * lcHeader = new lcio::LCRunHeaderImpl;
+  lcHeader->setRunNumber( runNumber );
+  lcHeader->setDetectorName( "EUTelescope" );
+  EUTelRunHeaderImpl runHeader( lcHeader );
+  runHeader.setDAQHWName( "syntheticdata" );
+  runHeader.setNoOfEvent( nEvents );
+  runHeader.setNoOfDetector( static_cast<int>( planes.size() ) );
+  runHeader.setDateTime();
+  lcio::IntVec minX, maxX, minY, maxY;
+  for ( size_t iPlane = 0; iPlane < planes.size(); ++iPlane ) {
+    minX.push_back( 0 );
+    maxX.push_back( planes[iPlane].type.nPixelX - 1 );
+    minY.push_back( 0 );
+    maxY.push_back( planes[iPlane].type.nPixelY - 1 );
+  }
+  runHeader.setMinX( minX );
+  runHeader.setMaxX( maxX );
+  runHeader.setMinY( minY );
+  runHeader.setMaxY( maxY );
+  lcWriter->writeRunHeader( lcHeader );
+  delete lcHeader;
+
+  // fixed time stamps keep the output reproducible
+  lcio::LCTime startTime( 2015, 1, 1, 0, 0, 0 );
+
+  long nPixelsTotal = 0;
+  long nTracksTotal = 0;
+
+  for ( int iEvent = 0; iEvent <= nEvents; ++iEvent ) {
+
+    EUTelEventImpl * event = new EUTelEventImpl;
+    event->setDetectorName( "EUTelescope" );
+    event->setRunNumber( runNumber );
+    event->setEventNumber( iEvent );
+    event->setTimeStamp( startTime.timeStamp() + static_cast<lcio::long64>( iEvent ) * 1000000 );
+
+    if ( iEvent == nEvents ) {
+      event->setEventType( kEORE );
+      lcWriter->writeEvent( event );
+      delete event;
+      break;
+    }
+    event->setEventType( kDE );
+
+    // the fired pixels of every plane, ordered and without duplicates
+    vector< set< pair<int, int> > > firedPixels( planes.size() );
+
+    const int nTracks = nTracksDistribution( generator );
+    nTracksTotal += nTracks;
+    for ( int iTrack = 0; iTrack < nTracks; ++iTrack ) {
+      const double x0 = beamSpot * gauss( generator );
+      const double y0 = beamSpot * gauss( generator );
+      const double slopeX = divergence * gauss( generator );
+      const double slopeY = divergence * gauss( generator );
+
+      for ( size_t iPlane = 0; iPlane < planes.size(); ++iPlane ) {
+        const PlaneType& type = planes[iPlane].type;
+        const double x = x0 + slopeX * planes[iPlane].z;
+        const double y = y0 + slopeY * planes[iPlane].z;
+        const int col = type.column( x );
+        const int row = type.row( y );
+        if ( col < 0 || row < 0 ) continue;
+
+        // charge sharing with the neighbours the track passes close to
+        const pair<double, double> xEdges = type.columnEdges( col );
+        const double yLow = row * type.pitchY - type.sizeY() / 2;
+        int dCol = 0, dRow = 0;
+        if ( x - xEdges.first < sharing * type.pitchX ) dCol = -1;
+        else if ( xEdges.second - x < sharing * type.pitchX ) dCol = 1;
+        if ( y - yLow < sharing * type.pitchY ) dRow = -1;
+        else if ( yLow + type.pitchY - y < sharing * type.pitchY ) dRow = 1;
+
+        for ( int iCol = 0; iCol <= abs( dCol ); ++iCol ) {
+          for ( int iRow = 0; iRow <= abs( dRow ); ++iRow ) {
+            const int c = col + iCol * dCol;
+            const int r = row + iRow * dRow;
+            if ( c >= 0 && c < type.nPixelX && r >= 0 && r < type.nPixelY ) firedPixels[iPlane].insert( make_pair( c, r ) );
+          }
+        }
+      }
+    }
+
+    for ( size_t iPlane = 0; iPlane < planes.size(); ++iPlane ) {
+      const PlaneType& type = planes[iPlane].type;
+
+      // the number of noisy pixels follows the binomial distribution of the matrix
+      binomial_distribution<int> nNoiseDistribution( type.nPixelX * type.nPixelY, noiseOccupancy );
+      const int nNoise = nNoiseDistribution( generator );
+      for ( int iNoise = 0; iNoise < nNoise; ++iNoise ) {
+        firedPixels[iPlane].insert( make_pair( static_cast<int>( uniform( generator ) * type.nPixelX ),
+                                               static_cast<int>( uniform( generator ) * type.nPixelY ) ) );
+      }
+      for ( size_t iHot = 0; iHot < hotPixels[iPlane].size(); ++iHot ) {
+        if ( uniform( generator ) < 0.5 ) firedPixels[iPlane].insert( hotPixels[iPlane][iHot] );
+      }
+    }
+
+    lcio::LCCollectionVec * zsDataCollection = new lcio::LCCollectionVec( lcio::LCIO::TRACKERDATA );
+    lcio::CellIDEncoder< lcio::TrackerDataImpl > zsDataEncoder( EUTELESCOPE::ZSDATADEFAULTENCODING, zsDataCollection );
+    for ( size_t iPlane = 0; iPlane < planes.size(); ++iPlane ) {
+      lcio::TrackerDataImpl * zsData = new lcio::TrackerDataImpl;
+      zsDataEncoder["sensorID"] = planes[iPlane].sensorID;
+      zsDataEncoder["sparsePixelType"] = static_cast<int>( kEUTelGenericSparsePixel );
+      zsDataEncoder.setCellID( zsData );
+
+      EUTelTrackerDataInterfacerImpl< EUTelGenericSparsePixel > sparseData( zsData );
+      for ( set< pair<int, int> >::const_iterator pixel = firedPixels[iPlane].begin(); pixel != firedPixels[iPlane].end(); ++pixel ) {
+        EUTelGenericSparsePixel sparsePixel( pixel->first, pixel->second, 1, 0 );
+        sparseData.addSparsePixel( &sparsePixel );
+      }
+      nPixelsTotal += firedPixels[iPlane].size();
+      zsDataCollection->push_back( zsData );
+    }
+    event->addCollection( zsDataCollection, "zsdata_m26" );
+
+    lcWriter->writeEvent( event );
+    delete event;
+  }
+
+  lcWriter->close();
+  delete lcWriter;
+
+  cout << "Written " << nEvents << " events with " << planes.size() << " planes to " << outputFileName << endl
+       << "GEAR file: " << gearFileName << endl
+       << "Average number of tracks per event: " << static_cast<double>( nTracksTotal ) / nEvents << endl
+       << "Average number of fired pixels per plane and event: "
+       << static_cast<double>( nPixelsTotal ) / nEvents / planes.size() << endl;
+
+  return 0;
+}
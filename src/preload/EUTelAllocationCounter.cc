@@ -0,0 +1,111 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// Counting replacement of the global operator new, built as
+// libEUTelAllocationCounter. A replacement linked into libEutelescope
+// would not be used since Marlin resolves operator new from
+// libstdc++ first, so it has to be preloaded:
+//
+//   LD_PRELOAD=libEUTelAllocationCounter.so Marlin steering.xml
+//
+// EUTelInstrumentation finds the counter with dlsym().
+//
+// The count is kept per thread: eutel_allocation_count() returns the
+// allocations of the calling thread only, so the allocations of
+// prefetch, write or worker threads running next to the processor
+// chain are not attributed to the section measured by the chain.
+
+// system includes <>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+  // initial-exec: the library is preloaded, its TLS block exists at start up
+  // and reading the counter never calls into the dynamic loader
+  __attribute__((tls_model("initial-exec"))) thread_local uint64_t allocationCount = 0;
+
+  void* allocate(std::size_t size) {
+    ++allocationCount;
+    return std::malloc(size ? size : 1);
+  }
+
+#if __cpp_aligned_new
+  void* allocate(std::size_t size, std::align_val_t alignment) {
+    ++allocationCount;
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if ( align < sizeof(void*) ) align = sizeof(void*);
+    void* ptr = nullptr;
+    if ( posix_memalign( &ptr, align, size ? size : 1 ) != 0 ) return nullptr;
+    return ptr;
+  }
+#endif
+}
+
+extern "C" uint64_t eutel_allocation_count() {
+  return allocationCount;
+}
+
+void* operator new(std::size_t size) {
+  void* ptr = allocate(size);
+  if ( !ptr ) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new[](std::size_t size) {
+  void* ptr = allocate(size);
+  if ( !ptr ) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+#if __cpp_aligned_new
+// over-aligned types, memory from posix_memalign is released with free() as well
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  void* ptr = allocate(size, alignment);
+  if ( !ptr ) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  void* ptr = allocate(size, alignment);
+  if ( !ptr ) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return allocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return allocate(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+#endif
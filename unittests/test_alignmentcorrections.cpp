@@ -0,0 +1,108 @@
+//STL
+#include <cmath>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelAlignmentCorrections.h"
+#include "EUTelAlignmentTransforms.h"
+
+using eutelescope::EUTelAlignmentCorrections;
+using eutelescope::EUTelAlignmentTransforms;
+
+namespace {
+	//out = r v for a 3x3 matrix stored row by row
+	void rotate(const double* r, const double* v, double* out) {
+		for(int row = 0; row < 3; ++row) out[row] = r[3*row]*v[0] + r[3*row+1]*v[1] + r[3*row+2]*v[2];
+	}
+
+	//out = r^T v
+	void rotateBack(const double* r, const double* v, double* out) {
+		for(int col = 0; col < 3; ++col) out[col] = r[col]*v[0] + r[3+col]*v[1] + r[6+col]*v[2];
+	}
+}
+
+/** A plane rotated by 30 degrees around z and tilted, with a misalignment G in the global frame. The pede path
+ *  solves once in the starting geometry and writes the local corrections R0^T G. The track cache path gets part
+ *  of the correction in a first iteration, in the starting frame, and the rest in a second one, in the frame
+ *  moved by the first correction. Both must write the same constants.
+ */
+TEST(EUTelAlignmentCorrectionsTest, RotatedPlaneSameConstantsAsPede) {
+
+	double const abs_err = 1e-12;
+	int const sensorID = 3;
+
+	double startRotation[9];
+	EUTelAlignmentTransforms::eulerRotation(0.05, -0.1, 30*M_PI/180, startRotation);
+
+	//misalignment in the global frame: shifts [mm], then rotations [rad]
+	double const misalignment[6] = {0.12, -0.05, 0.3, 2e-3, -1e-3, 4e-3};
+
+	//pede path: one solution in the starting local frame
+	double pedeConstants[6];
+	rotateBack(startRotation, misalignment, pedeConstants);
+	rotateBack(startRotation, misalignment + 3, pedeConstants + 3);
+
+	EUTelAlignmentCorrections corrections;
+
+	//first iteration: 70% of the correction, in the starting frame
+	double local1[6];
+	for(int i = 0; i < 6; ++i) local1[i] = 0.7*pedeConstants[i];
+	double global1[6];
+	corrections.add(sensorID, startRotation, local1, global1);
+
+	//second iteration: the rest, in the frame rotated by the first correction
+	double movedRotation[9];
+	EUTelAlignmentTransforms::eulerRotation(0.05 + global1[3], -0.1 + global1[4], 30*M_PI/180 + global1[5], movedRotation);
+	double rest[6];
+	for(int i = 0; i < 6; ++i) rest[i] = misalignment[i] - global1[i];
+	double local2[6];
+	rotateBack(movedRotation, rest, local2);
+	rotateBack(movedRotation, rest + 3, local2 + 3);
+	double global2[6];
+	corrections.add(sensorID, movedRotation, local2, global2);
+
+	double total[6];
+	corrections.getGlobal(sensorID, total);
+	double constants[6];
+	corrections.getStartingLocal(sensorID, constants);
+	for(int i = 0; i < 6; ++i) {
+		ASSERT_NEAR(misalignment[i], total[i], abs_err);
+		ASSERT_NEAR(pedeConstants[i], constants[i], abs_err);
+	}
+
+	//the global sum itself is not what pede writes for a rotated plane
+	EXPECT_GT(std::abs(total[0] - pedeConstants[0]), 1e-2);
+}
+
+/** The global deltas returned by add() are the local ones rotated with the rotation given, which is what the
+ *  geometry is moved by.
+ */
+TEST(EUTelAlignmentCorrectionsTest, GlobalDeltaOfOneIteration) {
+
+	double const abs_err = 1e-14;
+
+	double rotation[9];
+	EUTelAlignmentTransforms::eulerRotation(0.3, 0.2, -1.1, rotation);
+	double const local[6] = {1., 2., 3., 1e-3, 2e-3, 3e-3};
+	double expected[6];
+	rotate(rotation, local, expected);
+	rotate(rotation, local + 3, expected + 3);
+
+	EUTelAlignmentCorrections corrections;
+	double global[6];
+	corrections.add(7, rotation, local, global);
+	for(int i = 0; i < 6; ++i) ASSERT_NEAR(expected[i], global[i], abs_err);
+
+	ASSERT_EQ(1u, corrections.getSensorIDs().size());
+	ASSERT_EQ(7, corrections.getSensorIDs()[0]);
+
+	//unknown sensors have no corrections
+	double none[6];
+	corrections.getStartingLocal(8, none);
+	for(int i = 0; i < 6; ++i) ASSERT_EQ(0., none[i]);
+
+	corrections.clear();
+	ASSERT_TRUE(corrections.empty());
+}
@@ -0,0 +1,228 @@
+//STL
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+//ROOT
+#include "TGeoMatrix.h"
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelAlignmentTransforms.h"
+
+using eutelescope::EUTelAlignmentTransforms;
+
+namespace {
+	//Transforms on the sensors 0, 1 and 3, none on 2
+	void setUpTransforms(EUTelAlignmentTransforms& transforms) {
+		double rotation[9];
+		EUTelAlignmentTransforms::eulerRotation(0.01, -0.02, 0.5, rotation);
+		double const t0[3] = {1., -2., 150.};
+		transforms.setTransform(0, rotation, t0);
+		EUTelAlignmentTransforms::eulerRotation(-0.3, 0.2, 3.0, rotation);
+		double const t1[3] = {-0.5, 0.25, 300.};
+		transforms.setTransform(1, rotation, t1);
+		EUTelAlignmentTransforms::eulerRotation(0., 0.7, -1.2, rotation);
+		double const t3[3] = {0., 0., -20.};
+		transforms.setTransform(3, rotation, t3);
+	}
+
+	//Sensor IDs drawn from the ones with a transform, the one without, an ID beyond them and a negative one
+	std::vector<int> randomSensors(std::size_t nHits, std::mt19937& generator) {
+		int const sensors[6] = {0, 1, 2, 3, 17, -1};
+		std::uniform_int_distribution<int> pick(0, 5);
+		std::vector<int> sensorID(nHits);
+		for(std::size_t i = 0; i < nHits; ++i) sensorID[i] = sensors[pick(generator)];
+		return sensorID;
+	}
+}
+
+/** apply() groups the hits by sensor and transforms them in blocks of eight with a one hit tail. For every total
+ *  number of hits up to 100, so with per sensor counts below, at and above a multiple of eight, the result is
+ *  R x + t of the hit's own sensor, computed hit by hit.
+ */
+TEST(EUTelAlignmentTransformsTest, BlockedMatchesHitByHit) {
+
+	double const abs_err = 1e-12;
+
+	EUTelAlignmentTransforms transforms;
+	setUpTransforms(transforms);
+
+	std::mt19937 generator(12345);
+	std::uniform_real_distribution<double> position(-10., 10.);
+
+	for(std::size_t nHits = 0; nHits <= 100; ++nHits) {
+		std::vector<int> const sensorID = randomSensors(nHits, generator);
+		std::vector<double> x(nHits), y(nHits), z(nHits);
+		for(std::size_t i = 0; i < nHits; ++i) {
+			x[i] = position(generator);
+			y[i] = position(generator);
+			z[i] = 0.01*position(generator);
+		}
+
+		std::vector<double> xOut(nHits), yOut(nHits), zOut(nHits);
+		transforms.apply(nHits, sensorID.data(), x.data(), y.data(), z.data(), xOut.data(), yOut.data(), zOut.data());
+
+		for(std::size_t i = 0; i < nHits; ++i) {
+			if(!transforms.hasTransform(sensorID[i])) continue;
+			double rotation[9];
+			double translation[3];
+			//the same constants as in setUpTransforms, looked up by hand
+			if(sensorID[i] == 0) {
+				EUTelAlignmentTransforms::eulerRotation(0.01, -0.02, 0.5, rotation);
+				translation[0] = 1.; translation[1] = -2.; translation[2] = 150.;
+			} else if(sensorID[i] == 1) {
+				EUTelAlignmentTransforms::eulerRotation(-0.3, 0.2, 3.0, rotation);
+				translation[0] = -0.5; translation[1] = 0.25; translation[2] = 300.;
+			} else {
+				EUTelAlignmentTransforms::eulerRotation(0., 0.7, -1.2, rotation);
+				translation[0] = 0.; translation[1] = 0.; translation[2] = -20.;
+			}
+			double const in[3] = {x[i], y[i], z[i]};
+			double const out[3] = {xOut[i], yOut[i], zOut[i]};
+			for(int row = 0; row < 3; ++row) {
+				double const expected = rotation[3*row]*in[0] + rotation[3*row+1]*in[1] + rotation[3*row+2]*in[2] + translation[row];
+				ASSERT_NEAR(expected, out[row], abs_err) << "hit " << i << " of " << nHits << " on sensor " << sensorID[i];
+			}
+		}
+	}
+}
+
+/** Hits of sensors without a transform, either never set, beyond the last one set or negative, are copied
+ *  unchanged, also when they are interleaved with transformed ones.
+ */
+TEST(EUTelAlignmentTransformsTest, UnknownSensorsUnchanged) {
+
+	EUTelAlignmentTransforms transforms;
+	setUpTransforms(transforms);
+
+	ASSERT_TRUE(transforms.hasTransform(3));
+	ASSERT_FALSE(transforms.hasTransform(2));
+	ASSERT_FALSE(transforms.hasTransform(17));
+	ASSERT_FALSE(transforms.hasTransform(-1));
+
+	int const sensorID[11] = {2, 0, 17, -1, 1, 2, 2, 3, -1, 17, 2};
+	std::vector<double> x(11), y(11), z(11);
+	for(std::size_t i = 0; i < 11; ++i) {
+		x[i] = 0.5*i - 1.;
+		y[i] = 2. - 0.25*i;
+		z[i] = 0.1*i;
+	}
+	std::vector<double> xOut(11), yOut(11), zOut(11);
+	transforms.apply(11, sensorID, x.data(), y.data(), z.data(), xOut.data(), yOut.data(), zOut.data());
+
+	for(std::size_t i = 0; i < 11; ++i) {
+		if(transforms.hasTransform(sensorID[i])) {
+			ASSERT_NE(x[i], xOut[i]);
+			continue;
+		}
+		ASSERT_EQ(x[i], xOut[i]);
+		ASSERT_EQ(y[i], yOut[i]);
+		ASSERT_EQ(z[i], zOut[i]);
+	}
+
+	//no transform at all
+	transforms.clear();
+	transforms.apply(11, sensorID, x.data(), y.data(), z.data(), xOut.data(), yOut.data(), zOut.data());
+	ASSERT_EQ(x, xOut);
+	ASSERT_EQ(y, yOut);
+	ASSERT_EQ(z, zOut);
+}
+
+/** eulerRotation(ax, ay, az) is the rotation around X by ax, then around Y by ay and then around Z by az, the same
+ *  as TGeoRotation built with RotateX, RotateY and RotateZ in that order.
+ */
+TEST(EUTelAlignmentTransformsTest, EulerRotationMatchesTGeo) {
+
+	double const abs_err = 1e-14;
+	double const angles[5][3] = { {0., 0., 0.}, {0.1, 0., 0.}, {0., -0.2, 0.}, {0., 0., 2.5}, {0.3, -0.7, 1.9} };
+
+	for(int k = 0; k < 5; ++k) {
+		double rotation[9];
+		EUTelAlignmentTransforms::eulerRotation(angles[k][0], angles[k][1], angles[k][2], rotation);
+
+		TGeoRotation geoRotation;
+		geoRotation.RotateX(angles[k][0]*180./M_PI);
+		geoRotation.RotateY(angles[k][1]*180./M_PI);
+		geoRotation.RotateZ(angles[k][2]*180./M_PI);
+		Double_t const* expected = geoRotation.GetRotationMatrix();
+
+		for(int i = 0; i < 9; ++i) ASSERT_NEAR(expected[i], rotation[i], abs_err) << "angles " << k << ", element " << i;
+	}
+}
+
+/** rotateCovariances() gives C' = R C R^T, checked against the 3x3 product done directly, for hit counts around the
+ *  block size. The covariances of sensors without a transform are copied unchanged.
+ */
+TEST(EUTelAlignmentTransformsTest, CovarianceRotation) {
+
+	EUTelAlignmentTransforms transforms;
+	setUpTransforms(transforms);
+
+	std::mt19937 generator(54321);
+	std::uniform_real_distribution<double> element(-1., 1.);
+
+	for(std::size_t nHits = 0; nHits <= 50; ++nHits) {
+		std::vector<int> const sensorID = randomSensors(nHits, generator);
+
+		//positive definite covariances A A^T, stored as (xx, yx, yy, zx, zy, zz)
+		std::vector<float> cov(6*nHits);
+		for(std::size_t i = 0; i < nHits; ++i) {
+			double a[9];
+			for(int k = 0; k < 9; ++k) a[k] = element(generator);
+			double full[9];
+			for(int row = 0; row < 3; ++row) {
+				for(int col = 0; col < 3; ++col) full[3*row+col] = a[3*row]*a[3*col] + a[3*row+1]*a[3*col+1] + a[3*row+2]*a[3*col+2];
+			}
+			float* c = &cov[6*i];
+			c[0] = full[0]; c[1] = full[3]; c[2] = full[4]; c[3] = full[6]; c[4] = full[7]; c[5] = full[8];
+		}
+
+		std::vector<float> covOut(6*nHits);
+		transforms.rotateCovariances(nHits, sensorID.data(), cov.data(), covOut.data());
+
+		for(std::size_t i = 0; i < nHits; ++i) {
+			float const* c = &cov[6*i];
+			float const* cOut = &covOut[6*i];
+			if(!transforms.hasTransform(sensorID[i])) {
+				for(int e = 0; e < 6; ++e) ASSERT_EQ(c[e], cOut[e]);
+				continue;
+			}
+
+			//the rotation of the hit's sensor, from the translation of the unit vectors and the origin
+			double rotation[9];
+			double const origin[3] = {0., 0., 0.};
+			double transformedOrigin[3];
+			int const oneHit[1] = {sensorID[i]};
+			transforms.apply(1, oneHit, &origin[0], &origin[1], &origin[2], &transformedOrigin[0], &transformedOrigin[1], &transformedOrigin[2]);
+			for(int col = 0; col < 3; ++col) {
+				double const unit[3] = {col == 0 ? 1. : 0., col == 1 ? 1. : 0., col == 2 ? 1. : 0.};
+				double column[3];
+				transforms.apply(1, oneHit, &unit[0], &unit[1], &unit[2], &column[0], &column[1], &column[2]);
+				for(int row = 0; row < 3; ++row) rotation[3*row+col] = column[row] - transformedOrigin[row];
+			}
+
+			double const full[9] = { c[0], c[1], c[3],   c[1], c[2], c[4],   c[3], c[4], c[5] };
+			double rc[9];
+			for(int row = 0; row < 3; ++row) {
+				for(int col = 0; col < 3; ++col) rc[3*row+col] = rotation[3*row]*full[col] + rotation[3*row+1]*full[3+col] + rotation[3*row+2]*full[6+col];
+			}
+			double expected[9];
+			for(int row = 0; row < 3; ++row) {
+				for(int col = 0; col < 3; ++col) expected[3*row+col] = rc[3*row]*rotation[3*col] + rc[3*row+1]*rotation[3*col+1] + rc[3*row+2]*rotation[3*col+2];
+			}
+
+			//the output is float, the input elements are up to 3
+			double const abs_err = 1e-5;
+			ASSERT_NEAR(expected[0], cOut[0], abs_err);
+			ASSERT_NEAR(expected[3], cOut[1], abs_err);
+			ASSERT_NEAR(expected[4], cOut[2], abs_err);
+			ASSERT_NEAR(expected[6], cOut[3], abs_err);
+			ASSERT_NEAR(expected[7], cOut[4], abs_err);
+			ASSERT_NEAR(expected[8], cOut[5], abs_err);
+		}
+	}
+}
@@ -0,0 +1,110 @@
+//STL
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "cluster.h"
+
+namespace {
+	//All the reference shapes of up to six pixels
+	std::vector<Cluster> referenceClusters() {
+		std::vector<Cluster> clusterVec;
+		Cluster().FindReferenceClusters(clusterVec, 6);
+		return clusterVec;
+	}
+
+	Cluster translated(Cluster cluster, int dx, int dy) {
+		std::vector<int> x = cluster.getX();
+		std::vector<int> y = cluster.getY();
+		for(size_t i = 0; i < x.size(); ++i) {
+			x[i] += dx;
+			y[i] += dy;
+		}
+		Cluster moved;
+		moved.set_values(cluster.Size(), x, y);
+		return moved;
+	}
+
+	//The same pixels in reverse order
+	Cluster reversed(Cluster cluster) {
+		std::vector<int> x = cluster.getX();
+		std::vector<int> y = cluster.getY();
+		Cluster reversedCluster;
+		reversedCluster.set_values(cluster.Size(), std::vector<int>(x.rbegin(), x.rend()), std::vector<int>(y.rbegin(), y.rend()));
+		return reversedCluster;
+	}
+}
+
+/** The reference shapes are the fixed polyominoes, 1, 2, 6, 19, 63 and 216 of one to six pixels. Two clusters have
+ *  the same ShapeKey exactly if they are equal up to a translation, whatever the order of their pixels.
+ */
+TEST(ClusterTest, ShapeKeyUniqueUpToTranslation) {
+
+	std::vector<Cluster> clusterVec = referenceClusters();
+
+	int nShapes[7] = {0, 0, 0, 0, 0, 0, 0};
+	for(size_t i = 0; i < clusterVec.size(); ++i) ++nShapes[clusterVec[i].Size()];
+	int const expectedShapes[7] = {0, 1, 2, 6, 19, 63, 216};
+	for(int size = 1; size <= 6; ++size) ASSERT_EQ(expectedShapes[size], nShapes[size]) << "size " << size;
+
+	for(size_t i = 0; i < clusterVec.size(); ++i) {
+		std::string const key = clusterVec[i].ShapeKey();
+		ASSERT_EQ(key, translated(clusterVec[i], 7, -3).ShapeKey());
+		ASSERT_EQ(key, translated(clusterVec[i], -120, 55).ShapeKey());
+		ASSERT_EQ(key, reversed(clusterVec[i]).ShapeKey());
+		for(size_t j = i + 1; j < clusterVec.size(); ++j) {
+			ASSERT_NE(key, clusterVec[j].ShapeKey()) << "shapes " << i << " and " << j;
+			ASSERT_FALSE(clusterVec[i] == clusterVec[j]) << "shapes " << i << " and " << j;
+		}
+	}
+
+	//the lookup finds the shape of a translated cluster, and nothing for a shape not in the list
+	std::unordered_map<std::string,int> shapeIndex = Cluster().ShapeIndex(clusterVec);
+	for(size_t i = 0; i < clusterVec.size(); ++i) {
+		ASSERT_EQ(static_cast<int>(i), Cluster().WhichClusterShape(translated(clusterVec[i], 11, 4), shapeIndex));
+	}
+	std::vector<int> const x(7, 0);
+	std::vector<int> const y = {0, 1, 2, 3, 4, 5, 6};
+	Cluster tooLarge;
+	tooLarge.set_values(7, x, y);
+	ASSERT_EQ(-1, Cluster().WhichClusterShape(tooLarge, shapeIndex));
+}
+
+/** The four rotations of a cluster and their mirror images all have the same SymmetricShapeKey. The reference
+ *  shapes fall into the free polyominoes, 1, 1, 2, 5, 12 and 35 of one to six pixels, which are the groups of
+ *  sameShape.
+ */
+TEST(ClusterTest, SymmetricShapeKeyOfAllImages) {
+
+	std::vector<Cluster> clusterVec = referenceClusters();
+
+	std::set<std::string> symmetricKeys[7];
+	for(size_t i = 0; i < clusterVec.size(); ++i) {
+		std::string const key = clusterVec[i].SymmetricShapeKey();
+		Cluster image = clusterVec[i];
+		for(int rotation = 0; rotation < 4; ++rotation) {
+			ASSERT_EQ(key, image.SymmetricShapeKey()) << "shape " << i << ", " << rotation << " rotations";
+			ASSERT_EQ(key, image.mirrorX().SymmetricShapeKey()) << "shape " << i << ", " << rotation << " rotations, mirrored";
+			ASSERT_EQ(key, image.mirrorY().SymmetricShapeKey()) << "shape " << i << ", " << rotation << " rotations, mirrored";
+			image = image.rotate90();
+		}
+		ASSERT_EQ(key, translated(clusterVec[i], -4, 9).SymmetricShapeKey());
+		symmetricKeys[clusterVec[i].Size()].insert(key);
+	}
+
+	int const expectedFree[7] = {0, 1, 1, 2, 5, 12, 35};
+	for(int size = 1; size <= 6; ++size) ASSERT_EQ(expectedFree[size], static_cast<int>(symmetricKeys[size].size())) << "size " << size;
+
+	std::vector< std::vector<int> > groups = Cluster().sameShape(clusterVec);
+	ASSERT_EQ(1u + 1u + 2u + 5u + 12u + 35u, groups.size());
+	for(size_t iGroup = 0; iGroup < groups.size(); ++iGroup) {
+		for(size_t k = 1; k < groups[iGroup].size(); ++k) {
+			ASSERT_EQ(clusterVec[groups[iGroup][0]].SymmetricShapeKey(), clusterVec[groups[iGroup][k]].SymmetricShapeKey());
+		}
+	}
+}
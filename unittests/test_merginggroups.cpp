@@ -0,0 +1,99 @@
+//STL
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelMergingGroups.h"
+
+using eutelescope::EUTelMergingGroups;
+
+/** Pairs chained through common clusters, given in any order and either way round, end up in one group whose root
+ *  is its lowest index. Clusters merging with nobody, or only with themselves, are in no group.
+ */
+TEST(EUTelMergingGroupsTest, ChainedPairsOneGroup) {
+
+	EUTelMergingGroups groups;
+	groups.reset(10);
+
+	groups.merge(7, 3);
+	groups.merge(9, 5);
+	groups.merge(1, 8);
+	groups.merge(3, 9);
+	groups.merge(2, 2);
+	groups.merge(5, 7);
+
+	ASSERT_EQ(3, groups.findRoot(3));
+	ASSERT_EQ(3, groups.findRoot(5));
+	ASSERT_EQ(3, groups.findRoot(7));
+	ASSERT_EQ(3, groups.findRoot(9));
+	ASSERT_EQ(1, groups.findRoot(8));
+	ASSERT_EQ(2, groups.findRoot(2));
+	ASSERT_EQ(0, groups.findRoot(0));
+
+	std::vector< std::vector<int> > groupVector;
+	groups.getGroups(groupVector);
+	ASSERT_EQ(2u, groupVector.size());
+	ASSERT_EQ(std::vector<int>({1, 8}), groupVector[0]);
+	ASSERT_EQ(std::vector<int>({3, 5, 7, 9}), groupVector[1]);
+
+	//a new event starts without groups
+	groups.reset(4);
+	groups.getGroups(groupVector);
+	ASSERT_TRUE(groupVector.empty());
+	ASSERT_EQ(4, groups.size());
+}
+
+/** For random merging pairs the groups are the connected components of the pairs with more than one cluster, as
+ *  found by a flood fill, with the root of every cluster the lowest index of its component.
+ */
+TEST(EUTelMergingGroupsTest, GroupsAreConnectedComponents) {
+
+	int const nClusters = 300;
+	std::mt19937 generator(2718);
+	std::uniform_int_distribution<int> pick(0, nClusters - 1);
+
+	for(int trial = 0; trial < 20; ++trial) {
+		int const nPairs = 10*trial;
+		std::vector< std::pair<int,int> > pairs;
+		for(int i = 0; i < nPairs; ++i) pairs.push_back(std::make_pair(pick(generator), pick(generator)));
+
+		EUTelMergingGroups groups;
+		groups.reset(nClusters);
+		for(size_t i = 0; i < pairs.size(); ++i) groups.merge(pairs[i].first, pairs[i].second);
+
+		//flood fill from the lowest index of every component
+		std::vector< std::vector<int> > neighbours(nClusters);
+		for(size_t i = 0; i < pairs.size(); ++i) {
+			neighbours[pairs[i].first].push_back(pairs[i].second);
+			neighbours[pairs[i].second].push_back(pairs[i].first);
+		}
+		std::vector<int> component(nClusters, -1);
+		std::vector< std::vector<int> > expected;
+		for(int start = 0; start < nClusters; ++start) {
+			if(component[start] != -1) continue;
+			std::vector<int> members(1, start);
+			component[start] = start;
+			for(size_t k = 0; k < members.size(); ++k) {
+				for(size_t n = 0; n < neighbours[members[k]].size(); ++n) {
+					int const other = neighbours[members[k]][n];
+					if(component[other] != -1) continue;
+					component[other] = start;
+					members.push_back(other);
+				}
+			}
+			std::sort(members.begin(), members.end());
+			if(members.size() > 1) expected.push_back(members);
+		}
+
+		for(int iCluster = 0; iCluster < nClusters; ++iCluster) ASSERT_EQ(component[iCluster], groups.findRoot(iCluster));
+
+		std::vector< std::vector<int> > groupVector;
+		groups.getGroups(groupVector);
+		ASSERT_EQ(expected, groupVector) << "trial " << trial;
+	}
+}
@@ -0,0 +1,65 @@
+//STL
+#include <utility>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelOccupancyCounter.h"
+
+using eutelescope::EUTelOccupancyCounter;
+using eutelescope::EUTelOccupancyCounter16;
+
+/** The 16 bit counter stops at 65535 instead of wrapping around to zero.
+ */
+TEST(EUTelOccupancyCounterTest, NarrowCounterSaturates) {
+
+	EUTelOccupancyCounter16 counter(0, 4, 0, 3);
+	for(int i = 0; i < 70000; ++i) ASSERT_TRUE(counter.fill(2, 1));
+	ASSERT_EQ(65535, counter.getCount(2, 1));
+	ASSERT_EQ(70000u, counter.getNumberOfHits());
+
+	std::vector<std::pair<int,int> > pixels;
+	counter.findAbove(65534, pixels);
+	ASSERT_EQ(1u, pixels.size());
+	ASSERT_EQ(std::make_pair(2, 1), pixels[0]);
+}
+
+/** Both counter types find the same pixels, ordered by column and row, on a sensor larger than one scan block and
+ *  with offset pixel indices.
+ */
+TEST(EUTelOccupancyCounterTest, NarrowAndWideFindSamePixels) {
+
+	EUTelOccupancyCounter wide(-5, 40, 10, 30);
+	EUTelOccupancyCounter16 narrow(-5, 40, 10, 30);
+	for(int x = -5; x < 35; ++x) {
+		for(int y = 10; y < 40; ++y) {
+			int const n = ((x + 7) * 31 + y * 17) % 23;
+			for(int i = 0; i < n; ++i) {
+				wide.fill(x, y);
+				narrow.fill(x, y);
+			}
+		}
+	}
+	ASSERT_FALSE(narrow.fill(35, 10));
+	ASSERT_FALSE(narrow.fill(0, 9));
+
+	std::vector<std::pair<int,int> > widePixels, narrowPixels;
+	wide.findAbove(19, widePixels);
+	narrow.findAbove(19, narrowPixels);
+	ASSERT_FALSE(widePixels.empty());
+	ASSERT_EQ(widePixels, narrowPixels);
+	for(size_t i = 0; i < narrowPixels.size(); ++i) {
+		ASSERT_GT(narrow.getCount(narrowPixels[i].first, narrowPixels[i].second), 19);
+		if(i > 0) {
+			ASSERT_LT(narrowPixels[i-1], narrowPixels[i]);
+		}
+	}
+
+	std::vector<int> wideFired, narrowFired;
+	wide.firedPixelsPerColumn(wideFired);
+	narrow.firedPixelsPerColumn(narrowFired);
+	ASSERT_EQ(40u, narrowFired.size());
+	ASSERT_EQ(wideFired, narrowFired);
+}
@@ -0,0 +1,116 @@
+//STL
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelReferenceLineMatcher.h"
+
+using eutelescope::EUTelReferenceLineMatcher;
+
+namespace {
+	typedef std::vector< std::pair<unsigned int, unsigned int> > PairVector;
+
+	//The triple loop the window search replaces, for one first plane hit
+	PairVector bruteForce(double const* first, std::vector<double const*> const& second, std::vector<double const*> const& dut,
+	                      unsigned int known, double maxResidual) {
+		PairVector pairs;
+		for(unsigned int i = 0; i < second.size(); ++i) {
+			for(unsigned int j = 0; j < dut.size(); ++j) {
+				double const t = (dut[j][2] - first[2]) / (second[i][2] - first[2]);
+				double const onLine = first[known] + (second[i][known] - first[known]) * t;
+				if(std::fabs(onLine - dut[j][known]) < maxResidual) pairs.push_back(std::make_pair(i, j));
+			}
+		}
+		return pairs;
+	}
+
+	std::vector<double const*> pointers(std::vector< std::vector<double> > const& positions) {
+		std::vector<double const*> result;
+		for(size_t i = 0; i < positions.size(); ++i) result.push_back(positions[i].data());
+		return result;
+	}
+}
+
+/** On random events with a few mm of z spread around every plane, and the DUT between or outside the reference
+ *  planes, the window search finds the same pairs in the same order as the triple loop, for both known
+ *  coordinates.
+ */
+TEST(EUTelReferenceLineMatcherTest, WindowMatchesBruteForce) {
+
+	std::mt19937 generator(1618);
+	std::uniform_real_distribution<double> position(-10., 10.);
+	std::uniform_real_distribution<double> spread(-3., 3.);
+	double const maxResidual = 0.5;
+
+	//z of the first reference plane, the second one and the DUT
+	double const planeZ[3][3] = { {0., 300., 150.}, {0., 150., 300.}, {300., 0., -50.} };
+
+	size_t nPairs = 0;
+	for(int trial = 0; trial < 30; ++trial) {
+		unsigned int const known = trial % 2;
+		double const* z = planeZ[trial % 3];
+
+		std::vector< std::vector<double> > firstHits(20), secondHits(60), dutHits(40);
+		for(size_t i = 0; i < firstHits.size(); ++i) firstHits[i] = {position(generator), position(generator), z[0] + spread(generator)};
+		for(size_t i = 0; i < secondHits.size(); ++i) secondHits[i] = {position(generator), position(generator), z[1] + spread(generator)};
+		for(size_t i = 0; i < dutHits.size(); ++i) dutHits[i] = {position(generator), position(generator), z[2] + spread(generator)};
+		std::vector<double const*> const second = pointers(secondHits);
+		std::vector<double const*> const dut = pointers(dutHits);
+
+		EUTelReferenceLineMatcher matcher;
+		matcher.setSecondPlaneHits(second, known);
+		for(size_t i = 0; i < firstHits.size(); ++i) {
+			PairVector pairs;
+			matcher.findPairs(firstHits[i].data(), dut, maxResidual, pairs);
+			ASSERT_EQ(bruteForce(firstHits[i].data(), second, dut, known, maxResidual), pairs) << "trial " << trial << ", first plane hit " << i;
+			nPairs += pairs.size();
+		}
+	}
+	//the comparison is not trivially on empty results
+	ASSERT_GT(nPairs, 100u);
+}
+
+/** A second plane hit at the z of the first plane hit, or a DUT hit at that z, leaves the window unbounded: all the
+ *  second plane hits are tried and the result is still the one of the triple loop. Pairs already in the output are
+ *  kept in front.
+ */
+TEST(EUTelReferenceLineMatcherTest, EqualZFallback) {
+
+	double const maxResidual = 0.5;
+	std::vector<double> const first = {1., 2., 0.};
+
+	//the second one shares the z of the first plane hit, the line through it has no finite slope in z
+	std::vector< std::vector<double> > secondHits = { {0.8, 2.2, 300.}, {1.0, 2.0, 0.}, {3.0, 4.0, 299.}, {1.1, 1.9, 301.} };
+	//the last DUT hit is at the z of the first plane hit
+	std::vector< std::vector<double> > dutHits = { {0.9, 2.1, 150.}, {2.0, 3.0, 149.}, {1.2, 2.3, 0.}, {5., 5., 0.} };
+	std::vector<double const*> const second = pointers(secondHits);
+	std::vector<double const*> const dut = pointers(dutHits);
+
+	for(unsigned int known = 0; known < 2; ++known) {
+		EUTelReferenceLineMatcher matcher;
+		matcher.setSecondPlaneHits(second, known);
+
+		PairVector pairs(1, std::make_pair(99u, 99u));
+		matcher.findPairs(first.data(), dut, maxResidual, pairs);
+		ASSERT_EQ(std::make_pair(99u, 99u), pairs[0]);
+		PairVector const found(pairs.begin() + 1, pairs.end());
+		PairVector const expected = bruteForce(first.data(), second, dut, known, maxResidual);
+		ASSERT_EQ(expected, found) << "known coordinate " << known;
+		ASSERT_FALSE(found.empty());
+
+		//without the hit at the z of the first plane hit the window is bounded, and the result the same without it
+		std::vector<double const*> secondBounded = second;
+		secondBounded.erase(secondBounded.begin() + 1);
+		std::vector<double const*> dutBounded(dut.begin(), dut.begin() + 2);
+		matcher.setSecondPlaneHits(secondBounded, known);
+		PairVector bounded;
+		matcher.findPairs(first.data(), dutBounded, maxResidual, bounded);
+		ASSERT_EQ(bruteForce(first.data(), secondBounded, dutBounded, known, maxResidual), bounded);
+		ASSERT_FALSE(bounded.empty());
+	}
+}
@@ -0,0 +1,137 @@
+//STL
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelStraightLineFitter.h"
+
+using eutelescope::EUTelStraightLineFitter;
+
+namespace {
+	size_t const nPlanes = 6;
+	double const planeZ[nPlanes] = {0., 150., 300., 450., 600., 750.};
+	double const xResolution[nPlanes] = {0.004, 0.004, 0.01, 0.004, 0.004, 0.004};
+	double const yResolution[nPlanes] = {0.004, 0.005, 0.01, 0.005, 0.004, 0.004};
+
+	//Weighted least squares line through the fitted planes, in double precision
+	void referenceFit(double const* pos, double const* z, size_t stride, double const* resolution, std::vector<char> const& fitted,
+	                  double& offset, double& slope, double& chi2) {
+		double s = 0., sz = 0., sp = 0., szz = 0., szp = 0.;
+		for(size_t p = 0; p < nPlanes; ++p) {
+			if(!fitted[p]) continue;
+			double const w = 1./(resolution[p]*resolution[p]);
+			double const zp = z[p*stride];
+			double const posp = pos[p*stride];
+			s += w; sz += w*zp; sp += w*posp; szz += w*zp*zp; szp += w*zp*posp;
+		}
+		slope = (s*szp - sz*sp) / (s*szz - sz*sz);
+		offset = (sp - slope*sz) / s;
+		chi2 = 0.;
+		for(size_t p = 0; p < nPlanes; ++p) {
+			if(!fitted[p]) continue;
+			double const d = pos[p*stride] - (offset + slope*z[p*stride]);
+			chi2 += d*d/(resolution[p]*resolution[p]);
+		}
+	}
+
+	//Track t: a line with its own offset and slope, a few microns of scatter, and 2 mm off on plane 2
+	void makeCandidates(size_t nTracks, std::vector<double>& x, std::vector<double>& y, std::vector<double>& z) {
+		x.resize(nPlanes*nTracks);
+		y.resize(nPlanes*nTracks);
+		z.resize(nPlanes*nTracks);
+		for(size_t p = 0; p < nPlanes; ++p) {
+			for(size_t t = 0; t < nTracks; ++t) {
+				double const scatter = 0.003*std::sin(1.7*p + 0.9*t);
+				double const outlier = p == 2 ? 2. : 0.;
+				z[p*nTracks + t] = planeZ[p] + 0.1*t;
+				x[p*nTracks + t] = -3. + 0.5*t + (1e-3 - 2e-4*t)*z[p*nTracks + t] + scatter + outlier;
+				y[p*nTracks + t] = 4. - 0.25*t + (-5e-4 + 1e-4*t)*z[p*nTracks + t] - scatter;
+			}
+		}
+	}
+}
+
+/** Hits exactly on straight lines are fitted with zero chi2 and residuals, up to the single precision sums, for
+ *  one track, one full block of eight and a block with one more.
+ */
+TEST(EUTelStraightLineFitterTest, ExactLines) {
+
+	EUTelStraightLineFitter fitter;
+	fitter.setPlanes(nPlanes, xResolution, yResolution, std::vector<unsigned int>());
+
+	size_t const trackCounts[3] = {1, 8, 9};
+	for(int k = 0; k < 3; ++k) {
+		size_t const nTracks = trackCounts[k];
+		std::vector<double> x(nPlanes*nTracks), y(nPlanes*nTracks), z(nPlanes*nTracks);
+		for(size_t p = 0; p < nPlanes; ++p) {
+			for(size_t t = 0; t < nTracks; ++t) {
+				z[p*nTracks + t] = planeZ[p];
+				x[p*nTracks + t] = 1. - 0.3*t + 2e-3*planeZ[p];
+				y[p*nTracks + t] = -2. + 0.1*t - 1e-3*t*planeZ[p];
+			}
+		}
+		fitter.fit(nTracks, x.data(), y.data(), z.data());
+		ASSERT_EQ(nTracks, fitter.getNumberOfTracks());
+
+		for(size_t t = 0; t < nTracks; ++t) {
+			ASSERT_NEAR(2e-3, std::tan(fitter.getAngleX(t)), 1e-7) << nTracks << " tracks, track " << t;
+			ASSERT_NEAR(-1e-3*t, std::tan(fitter.getAngleY(t)), 1e-7) << nTracks << " tracks, track " << t;
+			ASSERT_NEAR(1. - 0.3*t, fitter.getFitX(t, 0.), 1e-5);
+			ASSERT_NEAR(-2. + 0.1*t, fitter.getFitY(t, 0.), 1e-5);
+			ASSERT_LT(fitter.getChi2X(t), 1e-2);
+			ASSERT_LT(fitter.getChi2Y(t), 1e-2);
+			for(size_t p = 0; p < nPlanes; ++p) {
+				ASSERT_NEAR(0., fitter.getResidualX(t, p), 1e-4);
+				ASSERT_NEAR(0., fitter.getResidualY(t, p), 1e-4);
+			}
+		}
+	}
+}
+
+/** With plane 2 excluded, its 2 mm outlier in x does not pull the line: offset, slope and chi2 are those of the
+ *  weighted least squares line through the other planes, and the residuals on all the planes, the excluded one
+ *  included, are that line minus the hit. Each track has its own line, so a mix-up between the tracks of a block
+ *  and of the tail shows.
+ */
+TEST(EUTelStraightLineFitterTest, ExcludedPlaneAgainstReference) {
+
+	std::vector<unsigned int> const excluded(1, 2);
+	std::vector<char> fitted(nPlanes, 1);
+	fitted[2] = 0;
+
+	EUTelStraightLineFitter fitter;
+	fitter.setPlanes(nPlanes, xResolution, yResolution, excluded);
+
+	size_t const trackCounts[3] = {1, 8, 9};
+	for(int k = 0; k < 3; ++k) {
+		size_t const nTracks = trackCounts[k];
+		std::vector<double> x, y, z;
+		makeCandidates(nTracks, x, y, z);
+		fitter.fit(nTracks, x.data(), y.data(), z.data());
+
+		for(size_t t = 0; t < nTracks; ++t) {
+			double offsetX, slopeX, chi2X, offsetY, slopeY, chi2Y;
+			referenceFit(&x[t], &z[t], nTracks, xResolution, fitted, offsetX, slopeX, chi2X);
+			referenceFit(&y[t], &z[t], nTracks, yResolution, fitted, offsetY, slopeY, chi2Y);
+
+			ASSERT_NEAR(slopeX, std::tan(fitter.getAngleX(t)), 1e-7) << nTracks << " tracks, track " << t;
+			ASSERT_NEAR(slopeY, std::tan(fitter.getAngleY(t)), 1e-7) << nTracks << " tracks, track " << t;
+			ASSERT_NEAR(offsetX, fitter.getFitX(t, 0.), 1e-4);
+			ASSERT_NEAR(offsetY, fitter.getFitY(t, 0.), 1e-4);
+			ASSERT_NEAR(chi2X, fitter.getChi2X(t), 1e-2*chi2X + 0.05);
+			ASSERT_NEAR(chi2Y, fitter.getChi2Y(t), 1e-2*chi2Y + 0.05);
+			ASSERT_GT(chi2X, 0.1);
+
+			for(size_t p = 0; p < nPlanes; ++p) {
+				double const zp = z[p*nTracks + t];
+				ASSERT_NEAR(offsetX + slopeX*zp - x[p*nTracks + t], fitter.getResidualX(t, p), 2e-4) << "plane " << p;
+				ASSERT_NEAR(offsetY + slopeY*zp - y[p*nTracks + t], fitter.getResidualY(t, p), 2e-4) << "plane " << p;
+			}
+			ASSERT_NEAR(-2., fitter.getResidualX(t, 2), 0.01);
+		}
+	}
+}